@@ -0,0 +1,58 @@
+#!/bin/bash
+# Shell script to load test OpenDungeons dedicated servers on the local machine.
+# It launches the given number of servers, connects bots to each of them through loopback
+# (see source/tests/loadtest) and writes the reports in loadtest-N.txt.
+# Usage: run_load_test.sh [nbServers] [level] [nbClientsPerServer] [durationInSeconds] [other opendungeons-loadtest options]
+# The level should have at least nbClientsPerServer human seats.
+
+OD_BINARY="opendungeons"
+LOADTEST_BINARY="opendungeons-loadtest"
+FIRST_PORT=32300
+
+NB_SERVERS=${1:-1}
+LEVEL=${2:-"TestMultiplayerSmallFreeForAll.level"}
+NB_CLIENTS=${3:-4}
+DURATION=${4:-60}
+if [ $# -ge 4 ]; then shift 4; else shift $#; fi
+EXTRA_OPTIONS="$@"
+
+for binary in ${OD_BINARY} ${LOADTEST_BINARY}; do
+    if [ ! -x $(pwd)/${binary} ]; then
+        echo "Can't find the ${binary} binary in the current directory, aborting."
+        exit 1
+    fi
+done
+
+SERVER_PIDS=""
+LOADTEST_PIDS=""
+for ((i = 0; i < NB_SERVERS; i++)); do
+    port=$((FIRST_PORT + i))
+    echo "--- Starting a server with map ${LEVEL} on port ${port} ---"
+    ./${OD_BINARY} --server "${LEVEL}" --port ${port} --log "loadtest-srvLog-${i}.txt" &
+    SERVER_PIDS+=" $!"
+done
+
+# The bots retry to connect while the servers start
+for ((i = 0; i < NB_SERVERS; i++)); do
+    port=$((FIRST_PORT + i))
+    ./${LOADTEST_BINARY} --port ${port} --clients ${NB_CLIENTS} --duration ${DURATION} --seed $((i * 1000)) \
+        --csv "loadtest-${i}.csv" --log "loadtest-log-${i}.txt" ${EXTRA_OPTIONS} > "loadtest-${i}.txt" &
+    LOADTEST_PIDS+=" $!"
+done
+
+RESULT=0
+for pid in ${LOADTEST_PIDS}; do
+    wait ${pid} || RESULT=2
+done
+
+for pid in ${SERVER_PIDS}; do
+    kill ${pid}
+    wait ${pid}  # Wait for the process to terminate
+done
+
+for ((i = 0; i < NB_SERVERS; i++)); do
+    echo -e "\n### Server ${i}"
+    cat "loadtest-${i}.txt"
+done
+
+exit ${RESULT}
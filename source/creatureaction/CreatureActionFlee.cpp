@@ -59,9 +59,9 @@ bool CreatureActionFlee::handleFlee(Creature& creature, int32_t nbTurns)
     if(!tempRooms.empty())
     {
         // We can go to one dungeon temple
+        // Many creatures may flee to the same temple so we use the cached distance field to go there
         Room* room = tempRooms[Random::Int(0, tempRooms.size() - 1)];
-        Tile* tile = room->getCoveredTile(0);
-        std::list<Tile*> result = creature.getGameMap()->path(&creature, tile);
+        std::list<Tile*> result = creature.getGameMap()->pathToBuilding(&creature, myTile, room);
         // If we are not too near from the dungeon temple, we go there
         if(result.size() > 5)
         {
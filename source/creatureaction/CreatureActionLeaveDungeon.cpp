@@ -17,6 +17,7 @@
 
 #include "creatureaction/CreatureActionLeaveDungeon.h"
 
+#include "creatureaction/CreatureActionWalkToTile.h"
 #include "entities/Creature.h"
 #include "entities/Tile.h"
 #include "game/Player.h"
@@ -28,6 +29,7 @@
 #include "rooms/RoomType.h"
 #include "utils/Helper.h"
 #include "utils/LogManager.h"
+#include "utils/MakeUnique.h"
 #include "utils/Random.h"
 
 std::function<bool()> CreatureActionLeaveDungeon::action()
@@ -82,11 +84,29 @@ bool CreatureActionLeaveDungeon::handleLeaveDungeon(Creature& creature)
     int index = Random::Int(0, tempRooms.size() - 1);
     Room* room = tempRooms[index];
     Tile* tile = room->getCentralTile();
-    if(!creature.setDestination(tile))
+    if(myTile->getCoveringRoom() == room)
+    {
+        // We are in the portal, we can go to its central tile
+        if(!creature.setDestination(tile))
+        {
+            OD_LOG_ERR("creature=" + creature.getName() + ", myTile=" + Tile::displayAsString(myTile) + " cannot reach " + Tile::displayAsString(tile));
+            creature.popAction();
+        }
+        return false;
+    }
+
+    // Creatures leaving the dungeon all walk to the portal so we use the cached distance field to get there
+    std::list<Tile*> result = creature.getGameMap()->pathToBuilding(&creature, myTile, room);
+    if(result.empty())
     {
         OD_LOG_ERR("creature=" + creature.getName() + ", myTile=" + Tile::displayAsString(myTile) + " cannot reach " + Tile::displayAsString(tile));
         creature.popAction();
         return false;
     }
+
+    std::vector<Ogre::Vector3> path;
+    creature.tileToVector3(result, path, true, 0.0);
+    creature.setWalkPath(EntityAnimation::walk_anim, EntityAnimation::idle_anim, true, true, path);
+    creature.pushAction(Utils::make_unique<CreatureActionWalkToTile>(creature));
     return false;
 }
@@ -50,7 +50,7 @@ const std::string& CreatureMoodCreature::getModifierName() const
 
 int32_t CreatureMoodCreature::computeMood(const Creature& creature) const
 {
-    std::vector<GameEntity*> alliedCreatures = creature.getGameMap()->getVisibleCreatures(creature.getVisibleTiles(),
+    std::vector<GameEntity*> alliedCreatures = creature.getGameMap()->getVisibleCreatures(creature.getVisibleTilesBitmap(),
         creature.getSeat(), false);
     int nbCreatures = 0;
     for(GameEntity* entity : alliedCreatures)
@@ -208,6 +208,7 @@ bool Building::removeCoveredTile(Tile* t)
     mCoveredTilesDestroyed.push_back(t);
     mTileData[t]->mHP = 0.0;
     t->setCoveringBuilding(nullptr);
+    updateSeatCounts();
 
     return true;
 }
@@ -281,6 +282,7 @@ double Building::takeDamage(GameEntity* attacker, double absoluteDamage, double
 
     double damageDone = std::min(tileData->mHP, absoluteDamage + physicalDamage + magicalDamage + elementDamage);
     tileData->mHP -= damageDone;
+    updateSeatCounts();
 
     // We check if the building is still alive
     bool isAlive = false;
@@ -418,6 +420,7 @@ bool Building::importFromStream(std::istream& is)
         }
 
         tile->setSeat(getSeat());
+        tile->updateClaimedTilesCount();
 
         TileData* tileData = createTileData(tile);
         mTileData[tile] = tileData;
@@ -118,6 +118,12 @@ public:
     { return 0.0; }
 
     virtual void clearCoveredTiles();
+
+    //! \brief Called on server side when the building HP, covered tiles or seat changed. Allows the
+    //! buildings counted in their seat data (see Room) to update it
+    virtual void updateSeatCounts()
+    {}
+
     double getHP(Tile *tile) const;
     double takeDamage(GameEntity* attacker, double absoluteDamage, double physicalDamage, double magicalDamage, double elementDamage,
         Tile *tileTakingDamage, bool ko) override;
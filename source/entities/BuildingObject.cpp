@@ -124,14 +124,14 @@ void BuildingObject::fireRefresh()
         if(!seat->getPlayer()->getIsHuman())
             continue;
 
-        const std::string& name = getName();
+        uint32_t networkId = getNetworkId();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotificationType::entitiesRefresh, seat->getPlayer());
         uint32_t nb = 1;
         GameEntityType entityType = getObjectType();
         serverNotification->mPacket << nb;
         serverNotification->mPacket << entityType;
-        serverNotification->mPacket << name;
+        serverNotification->mPacket << networkId;
         exportToPacketForUpdate(serverNotification->mPacket, seat);
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
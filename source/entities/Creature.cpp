@@ -95,6 +95,19 @@
 
 static const Ogre::Real CANNON_MISSILE_HEIGHT = 0.3;
 
+//! \brief Working buffer of visibleTiles for updateTilesInSight. There is one per thread because it is
+//! called from several threads during the perception phase
+static thread_local std::vector<ShadowCastingTable::ProcessState<Tile*>> visibleTilesStates;
+
+//! \brief Removes the dead objects and the ones that are not on the map anymore from the given list
+static void removeObjectsNotOnMap(std::vector<GameEntity*>& objects)
+{
+    objects.erase(std::remove_if(objects.begin(), objects.end(), [](GameEntity* entity)
+        {
+            return !entity->getIsOnMap() || (entity->getHP(nullptr) <= 0);
+        }), objects.end());
+}
+
 const int32_t Creature::NB_TURNS_BEFORE_CHECKING_TASK = 15;
 const uint32_t Creature::NB_OVERLAY_HEALTH_VALUES = 8;
 
@@ -117,6 +130,20 @@ enum CreatureMoodEnum
     MoodPrisonFiltersPrisonAllies = KoTemp | InJail
 };
 
+//! Fields sent by Creature::exportToPacketForUpdate. Only the ones that changed since the last refresh are sent
+enum CreatureRefreshField
+{
+    RefreshLevel = 0x0001,
+    RefreshSeatId = 0x0002,
+    RefreshHealthValue = 0x0004,
+    RefreshMoodValue = 0x0008,
+    RefreshGroundSpeed = 0x0010,
+    RefreshWaterSpeed = 0x0020,
+    RefreshLavaSpeed = 0x0040,
+    RefreshSpeedModifier = 0x0080,
+    RefreshSeatPrisonId = 0x0100
+};
+
 CreatureParticuleEffect::CreatureParticuleEffect(Creature& creature, const std::string& name, const std::string& script, uint32_t nbTurnsEffect,
         CreatureEffect* effect) :
     EntityParticleEffect(name, script, nbTurnsEffect),
@@ -143,6 +170,19 @@ CreatureParticuleEffect::~CreatureParticuleEffect()
     mEffect = nullptr;
 }
 
+CreatureRefreshState::CreatureRefreshState() :
+    mLevel(0),
+    mSeatId(-1),
+    mOverlayHealthValue(0),
+    mMoodValue(0),
+    mGroundSpeed(0.0),
+    mWaterSpeed(0.0),
+    mLavaSpeed(0.0),
+    mSpeedModifier(0.0),
+    mSeatPrisonId(-1)
+{
+}
+
 Creature::Creature(GameMap* gameMap, const CreatureDefinition* definition, Seat* seat, Ogre::Vector3 position) :
     MovableGameEntity        (gameMap),
     mPhysicalDefense         (3.0),
@@ -173,6 +213,13 @@ Creature::Creature(GameMap* gameMap, const CreatureDefinition* definition, Seat*
     mWeaponDropDeath         ("none"),
     mStatsWindow             (nullptr),
     mNbTurnsWithoutBattle    (0),
+    mVisibleTilesPosTile     (nullptr),
+    mVisionGivenSeat         (nullptr),
+    mVisionGivenPosTile      (nullptr),
+    mIsPerceptionDone        (false),
+    mIsSightRefreshed        (false),
+    mPerceptionSeat          (nullptr),
+    mPerceptionPosTile       (nullptr),
     mCarriedEntity           (nullptr),
     mMoodCooldownTurns       (0),
     mMoodValue               (CreatureMoodLevel::Neutral),
@@ -188,7 +235,10 @@ Creature::Creature(GameMap* gameMap, const CreatureDefinition* definition, Seat*
     mSeatPrison              (nullptr),
     mNbTurnsTorture          (0),
     mNbTurnsPrison           (0),
-    mActiveSlapsCount        (0)
+    mActiveSlapsCount        (0),
+    mIsSeatCounted           (false),
+    mCountedSeat             (nullptr),
+    mIsCountedAsWorker       (false)
 
 {
     //TODO: This should be set in initialiser list in parent classes
@@ -251,6 +301,13 @@ Creature::Creature(GameMap* gameMap) :
     mWeaponDropDeath         ("none"),
     mStatsWindow             (nullptr),
     mNbTurnsWithoutBattle    (0),
+    mVisibleTilesPosTile     (nullptr),
+    mVisionGivenSeat         (nullptr),
+    mVisionGivenPosTile      (nullptr),
+    mIsPerceptionDone        (false),
+    mIsSightRefreshed        (false),
+    mPerceptionSeat          (nullptr),
+    mPerceptionPosTile       (nullptr),
     mCarriedEntity           (nullptr),
     mMoodCooldownTurns       (0),
     mMoodValue               (CreatureMoodLevel::Neutral),
@@ -266,7 +323,10 @@ Creature::Creature(GameMap* gameMap) :
     mSeatPrison              (nullptr),
     mNbTurnsTorture          (0),
     mNbTurnsPrison           (0),
-    mActiveSlapsCount        (0)
+    mActiveSlapsCount        (0),
+    mIsSeatCounted           (false),
+    mCountedSeat             (nullptr),
+    mIsCountedAsWorker       (false)
 {
 }
 
@@ -358,6 +418,7 @@ void Creature::removeFromGameMap()
         home->releaseTileForSleeping(getHomeTile(), this);
     }
 
+    releaseVision();
     fireRemoveEntityToSeatsWithVision();
     getGameMap()->removeActiveObject(this);
 }
@@ -654,6 +715,7 @@ void Creature::setHP(double nHP)
         mHp = nHP;
 
     computeCreatureOverlayHealthValue();
+    updateSeatCreaturesCount();
 }
 
 void Creature::heal(double hp)
@@ -661,6 +723,7 @@ void Creature::heal(double hp)
     mHp = std::min(mHp + hp, mMaxHP);
 
     computeCreatureOverlayHealthValue();
+    updateSeatCreaturesCount();
 }
 
 bool Creature::isAlive() const
@@ -694,25 +757,110 @@ void Creature::update(Ogre::Real timeSinceLastFrame)
 
 void Creature::computeVisibleTiles()
 {
-    // dead Creatures do not give vision
-    if (getHP() <= 0.0)
+    // dead Creatures, KO Creatures and creatures in jail do not give vision
+    if (!canSee())
+    {
+        releaseVision();
         return;
+    }
 
-    // KO Creatures do not give vision
-    if (isKo())
+    // The tiles in sight are usually refreshed during the perception phase
+    Tile* posTile = getPositionTile();
+    bool needsUpdate;
+    if (mIsPerceptionDone && (mPerceptionPosTile == posTile))
+        needsUpdate = mIsSightRefreshed;
+    else
+        needsUpdate = refreshTilesInSight();
+
+    if (!needsUpdate &&
+        (mVisionGivenSeat == getSeat()) &&
+        (mVisionGivenPosTile == posTile))
+    {
         return;
+    }
+
+    // If the seat did not change, we only update the tiles that gained or lost vision. We give vision on
+    // the new tiles before removing it from the old ones so that the seats keep vision on the tiles
+    // seen from both positions
+    Seat* oldSeat = mVisionGivenSeat;
+    bool isSameSeat = (oldSeat == getSeat());
+    for(Tile* tile : mVisibleTiles)
+    {
+        if(isSameSeat && mVisionGivenBitmap.test(tile->getX(), tile->getY()))
+            continue;
+
+        tile->addVision(getSeat());
+    }
+
+    if (oldSeat != nullptr)
+    {
+        for(Tile* tile : mVisionGivenTiles)
+        {
+            if(isSameSeat && mVisibleTilesBitmap.test(tile->getX(), tile->getY()))
+                continue;
+
+            tile->removeVision(oldSeat);
+        }
+    }
+
+    mVisionGivenTiles = mVisibleTiles;
+    mVisionGivenBitmap = mVisibleTilesBitmap;
+    mVisionGivenSeat = getSeat();
+    mVisionGivenPosTile = posTile;
+}
+
+bool Creature::canSee() const
+{
+    return (getHP() > 0.0) &&
+        !isKo() &&
+        (mSeatPrison == nullptr) &&
+        getIsOnMap() &&
+        (getPositionTile() != nullptr);
+}
 
-    // creatures in jail do not give vision
-    if (mSeatPrison != nullptr)
+bool Creature::refreshTilesInSight()
+{
+    // Look at the surrounding area if we moved or if something changed around
+    Tile* posTile = getPositionTile();
+    if ((posTile == mVisibleTilesPosTile) &&
+        !getGameMap()->isVisionBlockingChangedAround(posTile->getX(), posTile->getY(), mDefinition->getSightRadius()))
+    {
+        return false;
+    }
+
+    updateTilesInSight();
+    return true;
+}
+
+void Creature::perceive()
+{
+    mIsPerceptionDone = false;
+    if (!canSee())
         return;
 
-    if (!getIsOnMap())
+    mIsSightRefreshed = refreshTilesInSight();
+    mVisibleEnemyObjects = getVisibleEnemyObjects();
+    mVisibleAlliedObjects = getVisibleAlliedObjects();
+    mReachableAlliedObjects = getReachableAttackableObjects(mVisibleAlliedObjects);
+    mPerceptionSeat = getSeat();
+    mPerceptionPosTile = getPositionTile();
+    mIsPerceptionDone = true;
+}
+
+void Creature::releaseVision()
+{
+    // The visible tiles will be computed again when the creature gives vision again
+    mVisibleTilesPosTile = nullptr;
+    if (mVisionGivenSeat == nullptr)
         return;
 
-    // Look at the surrounding area
-    updateTilesInSight();
-    for(Tile* tile : mVisibleTiles)
-        tile->notifyVision(getSeat());
+    for(Tile* tile : mVisionGivenTiles)
+        tile->removeVision(mVisionGivenSeat);
+
+    mVisionGivenTiles.clear();
+    mVisionGivenBitmap.clearAll();
+    mVisionGivenSeat = nullptr;
+    mVisionGivenPosTile = nullptr;
 }
 
 void Creature::setLevel(unsigned int level)
@@ -845,6 +993,7 @@ void Creature::doUpkeep()
         mHp = 0;
         computeCreatureOverlayHealthValue();
         computeCreatureOverlayMoodValue();
+        updateSeatCreaturesCount();
     }
 
     // Handle creature death
@@ -904,6 +1053,7 @@ void Creature::doUpkeep()
         mHp = getMaxHp();
 
     computeCreatureOverlayHealthValue();
+    updateSeatCreaturesCount();
 
     // Rogue creatures are not affected by wakefulness/hunger
     if(!getSeat()->isRogueSeat())
@@ -913,9 +1063,23 @@ void Creature::doUpkeep()
         increaseHunger(mDefinition->getHungerGrowthPerTurn());
     }
 
-    mVisibleEnemyObjects         = getVisibleEnemyObjects();
-    mVisibleAlliedObjects        = getVisibleAlliedObjects();
-    mReachableAlliedObjects      = getReachableAttackableObjects(mVisibleAlliedObjects);
+    // The objects are usually computed by perceive at the beginning of the turn. Since then, the objects
+    // that already did their upkeep may have died or left the map
+    if(mIsPerceptionDone &&
+       (mPerceptionSeat == getSeat()) &&
+       (mPerceptionPosTile == getPositionTile()))
+    {
+        removeObjectsNotOnMap(mVisibleEnemyObjects);
+        removeObjectsNotOnMap(mVisibleAlliedObjects);
+        removeObjectsNotOnMap(mReachableAlliedObjects);
+    }
+    else
+    {
+        mVisibleEnemyObjects         = getVisibleEnemyObjects();
+        mVisibleAlliedObjects        = getVisibleAlliedObjects();
+        mReachableAlliedObjects      = getReachableAttackableObjects(mVisibleAlliedObjects);
+    }
+    mIsPerceptionDone = false;
 
     // Check if we should compute mood
     if(mMoodCooldownTurns > 0)
@@ -1284,7 +1448,7 @@ bool Creature::searchBestTargetInList(const std::vector<GameEntity*>& listObject
         std::vector<Tile*> coveredTiles = entity->getCoveredTiles();
         for(Tile* tile : coveredTiles)
         {
-            if(std::find(mVisibleTiles.begin(), mVisibleTiles.end(), tile) == mVisibleTiles.end())
+            if(!mVisibleTilesBitmap.test(tile->getX(), tile->getY()))
                 continue;
 
             int dist = Pathfinding::squaredDistanceTile(*tile, *myTile);
@@ -1351,7 +1515,7 @@ bool Creature::searchBestTargetInList(const std::vector<GameEntity*>& listObject
         int bestScoreAttack = -1;
         std::vector<Tile*> tiles;
         if(tilesFilter.empty())
-            tiles = getGameMap()->visibleTiles(tileAttackCheck->getX(), tileAttackCheck->getY(), skillRangeMaxInt);
+            getGameMap()->visibleTiles(tileAttackCheck->getX(), tileAttackCheck->getY(), skillRangeMaxInt, tiles);
         else
         {
             float radiusSquared = skillRangeMaxInt * skillRangeMaxInt;
@@ -1407,7 +1571,7 @@ bool Creature::searchBestTargetInList(const std::vector<GameEntity*>& listObject
         Tile* fleeTile = nullptr;
         std::vector<Tile*> tiles;
         if(tilesFilter.empty())
-            tiles = getGameMap()->visibleTiles(tileEntityFlee->getX(), tileEntityFlee->getY(), fightIdleDist);
+            getGameMap()->visibleTiles(tileEntityFlee->getX(), tileEntityFlee->getY(), fightIdleDist, tiles);
         else
         {
             float radiusSquared = fightIdleDist * fightIdleDist;
@@ -1572,49 +1736,114 @@ void Creature::exportToPacketForUpdate(ODPacket& os, const Seat* seat) const
 {
     MovableGameEntity::exportToPacketForUpdate(os, seat);
 
-    int seatId = getSeat()->getId();
-    os << mLevel;
-    os << seatId;
-    os << mOverlayHealthValue;
+    CreatureRefreshState state;
+    state.mLevel = mLevel;
+    state.mSeatId = getSeat()->getId();
+    state.mOverlayHealthValue = mOverlayHealthValue;
 
     // Only allied players should see creature mood (except some states)
-    uint32_t moodValue = 0;
     if(seat->isAlliedSeat(getSeat()))
-        moodValue = mOverlayMoodValue;
+        state.mMoodValue = mOverlayMoodValue;
     else if(mSeatPrison != nullptr)
     {
         if(mSeatPrison->isAlliedSeat(seat))
-            moodValue = mOverlayMoodValue & CreatureMoodEnum::MoodPrisonFiltersPrisonAllies;
+            state.mMoodValue = mOverlayMoodValue & CreatureMoodEnum::MoodPrisonFiltersPrisonAllies;
         else
-            moodValue = mOverlayMoodValue & CreatureMoodEnum::MoodPrisonFiltersAllPlayers;
+            state.mMoodValue = mOverlayMoodValue & CreatureMoodEnum::MoodPrisonFiltersAllPlayers;
     }
 
-    os << moodValue;
-    os << mGroundSpeed;
-    os << mWaterSpeed;
-    os << mLavaSpeed;
-    os << mSpeedModifier;
+    state.mGroundSpeed = mGroundSpeed;
+    state.mWaterSpeed = mWaterSpeed;
+    state.mLavaSpeed = mLavaSpeed;
+    state.mSpeedModifier = mSpeedModifier;
 
-    int seatPrisonId = -1;
     if(mSeatPrison != nullptr)
-        seatPrisonId = mSeatPrison->getId();
+        state.mSeatPrisonId = mSeatPrison->getId();
+
+    // We only send the fields that changed since the last refresh sent to this seat. If there is none (the creature
+    // has just been added for this seat), every field is sent
+    CreatureRefreshState* stateSent = nullptr;
+    for(std::pair<const Seat*, CreatureRefreshState>& p : mRefreshStatesSent)
+    {
+        if(p.first != seat)
+            continue;
 
-    os << seatPrisonId;
+        stateSent = &p.second;
+        break;
+    }
+
+    uint16_t fields = 0;
+    if((stateSent == nullptr) || (stateSent->mLevel != state.mLevel))
+        fields |= CreatureRefreshField::RefreshLevel;
+    if((stateSent == nullptr) || (stateSent->mSeatId != state.mSeatId))
+        fields |= CreatureRefreshField::RefreshSeatId;
+    if((stateSent == nullptr) || (stateSent->mOverlayHealthValue != state.mOverlayHealthValue))
+        fields |= CreatureRefreshField::RefreshHealthValue;
+    if((stateSent == nullptr) || (stateSent->mMoodValue != state.mMoodValue))
+        fields |= CreatureRefreshField::RefreshMoodValue;
+    if((stateSent == nullptr) || (stateSent->mGroundSpeed != state.mGroundSpeed))
+        fields |= CreatureRefreshField::RefreshGroundSpeed;
+    if((stateSent == nullptr) || (stateSent->mWaterSpeed != state.mWaterSpeed))
+        fields |= CreatureRefreshField::RefreshWaterSpeed;
+    if((stateSent == nullptr) || (stateSent->mLavaSpeed != state.mLavaSpeed))
+        fields |= CreatureRefreshField::RefreshLavaSpeed;
+    if((stateSent == nullptr) || (stateSent->mSpeedModifier != state.mSpeedModifier))
+        fields |= CreatureRefreshField::RefreshSpeedModifier;
+    if((stateSent == nullptr) || (stateSent->mSeatPrisonId != state.mSeatPrisonId))
+        fields |= CreatureRefreshField::RefreshSeatPrisonId;
+
+    os << fields;
+    if((fields & CreatureRefreshField::RefreshLevel) != 0)
+        os << state.mLevel;
+    if((fields & CreatureRefreshField::RefreshSeatId) != 0)
+        os << state.mSeatId;
+    if((fields & CreatureRefreshField::RefreshHealthValue) != 0)
+        os << state.mOverlayHealthValue;
+    if((fields & CreatureRefreshField::RefreshMoodValue) != 0)
+        os << state.mMoodValue;
+    if((fields & CreatureRefreshField::RefreshGroundSpeed) != 0)
+        os << state.mGroundSpeed;
+    if((fields & CreatureRefreshField::RefreshWaterSpeed) != 0)
+        os << state.mWaterSpeed;
+    if((fields & CreatureRefreshField::RefreshLavaSpeed) != 0)
+        os << state.mLavaSpeed;
+    if((fields & CreatureRefreshField::RefreshSpeedModifier) != 0)
+        os << state.mSpeedModifier;
+    if((fields & CreatureRefreshField::RefreshSeatPrisonId) != 0)
+        os << state.mSeatPrisonId;
+
+    if(stateSent == nullptr)
+        mRefreshStatesSent.push_back(std::pair<const Seat*, CreatureRefreshState>(seat, state));
+    else
+        *stateSent = state;
 }
 
 void Creature::updateFromPacket(ODPacket& is)
 {
     MovableGameEntity::updateFromPacket(is);
 
-    int seatId;
-    OD_ASSERT_TRUE(is >> mLevel);
-    OD_ASSERT_TRUE(is >> seatId);
-    OD_ASSERT_TRUE(is >> mOverlayHealthValue);
-    OD_ASSERT_TRUE(is >> mOverlayMoodValue);
-    OD_ASSERT_TRUE(is >> mGroundSpeed);
-    OD_ASSERT_TRUE(is >> mWaterSpeed);
-    OD_ASSERT_TRUE(is >> mLavaSpeed);
-    OD_ASSERT_TRUE(is >> mSpeedModifier);
+    // This function should read parameters as sent by Creature::exportToPacketForUpdate. The fields
+    // not sent did not change
+    uint16_t fields;
+    OD_ASSERT_TRUE(is >> fields);
+
+    int seatId = getSeat()->getId();
+    if((fields & CreatureRefreshField::RefreshLevel) != 0)
+        OD_ASSERT_TRUE(is >> mLevel);
+    if((fields & CreatureRefreshField::RefreshSeatId) != 0)
+        OD_ASSERT_TRUE(is >> seatId);
+    if((fields & CreatureRefreshField::RefreshHealthValue) != 0)
+        OD_ASSERT_TRUE(is >> mOverlayHealthValue);
+    if((fields & CreatureRefreshField::RefreshMoodValue) != 0)
+        OD_ASSERT_TRUE(is >> mOverlayMoodValue);
+    if((fields & CreatureRefreshField::RefreshGroundSpeed) != 0)
+        OD_ASSERT_TRUE(is >> mGroundSpeed);
+    if((fields & CreatureRefreshField::RefreshWaterSpeed) != 0)
+        OD_ASSERT_TRUE(is >> mWaterSpeed);
+    if((fields & CreatureRefreshField::RefreshLavaSpeed) != 0)
+        OD_ASSERT_TRUE(is >> mLavaSpeed);
+    if((fields & CreatureRefreshField::RefreshSpeedModifier) != 0)
+        OD_ASSERT_TRUE(is >> mSpeedModifier);
 
     // We do not scale the creature if it is picked up (because it is already not at its normal size). It will be
     // resized anyway when dropped
@@ -1634,6 +1863,9 @@ void Creature::updateFromPacket(ODPacket& is)
         }
     }
 
+    if((fields & CreatureRefreshField::RefreshSeatPrisonId) == 0)
+        return;
+
     OD_ASSERT_TRUE(is >> seatId);
     if(seatId == -1)
         mSeatPrison = nullptr;
@@ -1654,10 +1886,17 @@ void Creature::updateTilesInSight()
         return;
 
     // The tiles with sight radius without constraints
-    mTilesWithinSightRadius = getGameMap()->circularRegion(posTile->getX(), posTile->getY(), mDefinition->getSightRadius());
+    getGameMap()->circularRegion(posTile->getX(), posTile->getY(), mDefinition->getSightRadius(), mTilesWithinSightRadius);
+
+    // Only the tiles the creature can "see". The vectors are filled in place to reuse their memory
+    int sightRadius = mDefinition->getSightRadius();
+    getGameMap()->visibleTiles(posTile->getX(), posTile->getY(), sightRadius, mVisibleTiles, visibleTilesStates);
+    mVisibleTilesBitmap.reset(posTile->getX() - sightRadius, posTile->getY() - sightRadius,
+        2 * sightRadius + 1, 2 * sightRadius + 1);
+    for(Tile* tile : mVisibleTiles)
+        mVisibleTilesBitmap.set(tile->getX(), tile->getY());
 
-    // Only the tiles the creature can "see".
-    mVisibleTiles = getGameMap()->visibleTiles(posTile->getX(), posTile->getY(), mDefinition->getSightRadius());
+    mVisibleTilesPosTile = posTile;
 }
 
 std::vector<GameEntity*> Creature::getVisibleEnemyObjects()
@@ -1716,7 +1955,7 @@ std::vector<GameEntity*> Creature::getVisibleAlliedObjects()
 
 std::vector<GameEntity*> Creature::getVisibleForce(Seat* seat, bool invert)
 {
-    return getGameMap()->getVisibleForce(mVisibleTiles, seat, invert);
+    return getGameMap()->getVisibleForce(mVisibleTilesBitmap, seat, invert);
 }
 
 void Creature::computeVisualDebugEntities()
@@ -1993,6 +2232,7 @@ double Creature::takeDamage(GameEntity* attacker, double absoluteDamage, double
 
     computeCreatureOverlayHealthValue();
     computeCreatureOverlayMoodValue();
+    updateSeatCreaturesCount();
 
     if(!isAlive())
         fireEntityDead();
@@ -2446,20 +2686,12 @@ void Creature::releaseCarriedEntity()
         return;
     }
 
-    for(Seat* seat : mSeatsWithVisionNotified)
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        ServerNotification* serverNotification = new ServerNotification(
-            ServerNotificationType::releaseCarriedEntity, seat->getPlayer());
-        serverNotification->mPacket << getName() << carriedEntity->getObjectType();
-        serverNotification->mPacket << carriedEntity->getName();
-        serverNotification->mPacket << mPosition;
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    ServerNotification* serverNotification = new ServerNotification(
+        ServerNotificationType::releaseCarriedEntity, mSeatsWithVisionNotified);
+    serverNotification->mPacket << getNetworkId() << carriedEntity->getObjectType();
+    serverNotification->mPacket << carriedEntity->getNetworkId();
+    serverNotification->mPacket << mPosition;
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
 bool Creature::canSlap(Seat* seat)
@@ -2511,10 +2743,14 @@ void Creature::slap()
     addCreatureEffect(effect);
     mHp -= mMaxHP * ConfigManager::getSingleton().getSlapDamagePercent() / 100.0;
     computeCreatureOverlayHealthValue();
+    updateSeatCreaturesCount();
 }
 
 void Creature::fireAddEntity(Seat* seat, bool async)
 {
+    // The client creates the creature from scratch. The next refresh has to be complete
+    removeRefreshStateSent(seat);
+
     if(async)
     {
         ServerNotification serverNotification(
@@ -2542,36 +2778,50 @@ void Creature::fireAddEntity(Seat* seat, bool async)
 
         serverNotification = new ServerNotification(
             ServerNotificationType::carryEntity, seat->getPlayer());
-        serverNotification->mPacket << getName() << mCarriedEntity->getObjectType();
-        serverNotification->mPacket << mCarriedEntity->getName();
+        serverNotification->mPacket << getNetworkId() << mCarriedEntity->getObjectType();
+        serverNotification->mPacket << mCarriedEntity->getNetworkId();
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
 }
 
 void Creature::fireRemoveEntity(Seat* seat)
 {
+    removeRefreshStateSent(seat);
+
     // If we are carrying an entity, we release it first, then we can remove it and us
     if(mCarriedEntity != nullptr)
     {
         ServerNotification* serverNotification = new ServerNotification(
             ServerNotificationType::releaseCarriedEntity, seat->getPlayer());
-        serverNotification->mPacket << getName() << mCarriedEntity->getObjectType();
-        serverNotification->mPacket << mCarriedEntity->getName();
+        serverNotification->mPacket << getNetworkId() << mCarriedEntity->getObjectType();
+        serverNotification->mPacket << mCarriedEntity->getNetworkId();
         serverNotification->mPacket << mPosition;
         ODServer::getSingleton().queueServerNotification(serverNotification);
 
         mCarriedEntity->removeSeatWithVision(seat);
     }
 
-    const std::string& name = getName();
+    uint32_t networkId = getNetworkId();
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotificationType::removeEntity, seat->getPlayer());
     GameEntityType type = getObjectType();
     serverNotification->mPacket << type;
-    serverNotification->mPacket << name;
+    serverNotification->mPacket << networkId;
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
+void Creature::removeRefreshStateSent(const Seat* seat)
+{
+    for(auto it = mRefreshStatesSent.begin(); it != mRefreshStatesSent.end(); ++it)
+    {
+        if(it->first != seat)
+            continue;
+
+        mRefreshStatesSent.erase(it);
+        return;
+    }
+}
+
 void Creature::fireCreatureRefreshIfNeeded()
 {
     if(!mNeedFireRefresh)
@@ -2585,13 +2835,13 @@ void Creature::fireCreatureRefreshIfNeeded()
         if(!seat->getPlayer()->getIsHuman())
             continue;
 
-        const std::string& name = getName();
+        uint32_t networkId = getNetworkId();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotificationType::entitiesRefresh, seat->getPlayer());
         uint32_t nbCreature = 1;
         serverNotification->mPacket << nbCreature;
         serverNotification->mPacket << GameEntityType::creature;
-        serverNotification->mPacket << name;
+        serverNotification->mPacket << networkId;
         exportToPacketForUpdate(serverNotification->mPacket, seat);
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
@@ -2734,7 +2984,7 @@ void Creature::setupDefinition(GameMap& gameMap, const CreatureDefinition& defau
             if (getName().compare("autoname") == 0)
             {
                 std::string name = getGameMap()->nextUniqueNameCreature(mDefinition->getClassName());
-                setName(name);
+                getGameMap()->setCreatureName(this, name);
             }
         }
     }
@@ -2760,6 +3010,37 @@ void Creature::setupDefinition(GameMap& gameMap, const CreatureDefinition& defau
 
         computeCreatureOverlayHealthValue();
     }
+
+    updateSeatCreaturesCount();
+}
+
+void Creature::setSeatCounted(bool counted)
+{
+    mIsSeatCounted = counted;
+    updateSeatCreaturesCount();
+}
+
+void Creature::updateSeatCreaturesCount()
+{
+    if(!getIsOnServerMap())
+        return;
+
+    Seat* seat = nullptr;
+    if(mIsSeatCounted && (mDefinition != nullptr) && isAlive())
+        seat = getSeat();
+
+    bool isWorker = (seat != nullptr) && mDefinition->isWorker();
+    if((seat == mCountedSeat) && (isWorker == mIsCountedAsWorker))
+        return;
+
+    if(mCountedSeat != nullptr)
+        mCountedSeat->addNumCreatures(mIsCountedAsWorker, -1);
+
+    if(seat != nullptr)
+        seat->addNumCreatures(isWorker, 1);
+
+    mCountedSeat = seat;
+    mIsCountedAsWorker = isWorker;
 }
 
 void Creature::fireCreatureSound(CreatureSound sound)
@@ -2795,18 +3076,10 @@ void Creature::fireCreatureSound(CreatureSound sound)
     }
 
     std::string soundComplete = "Creatures/" + soundFamily;
-    for(Seat* seat : mSeatsWithVisionNotified)
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        ServerNotification *serverNotification = new ServerNotification(
-            ServerNotificationType::playSpatialSound, seat->getPlayer());
-        serverNotification->mPacket << soundComplete << posTile->getX() << posTile->getY();
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    ServerNotification *serverNotification = new ServerNotification(
+        ServerNotificationType::playSpatialSound, mSeatsWithVisionNotified);
+    serverNotification->mPacket << soundComplete << posTile->getX() << posTile->getY();
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
 void Creature::itsPayDay()
@@ -3220,6 +3493,7 @@ void Creature::changeSeat(Seat* newSeat)
     OD_LOG_INF("creature=" + getName() + " changes side from seatId=" + Helper::toString(getSeat()->getId()) + " to seatId=" + Helper::toString(newSeat->getId()));
     OD_ASSERT_TRUE_MSG(getSeat() != newSeat, "creature=" + getName() + ", seatId=" + Helper::toString(newSeat->getId()));
     setSeat(newSeat);
+    updateSeatCreaturesCount();
     mMoodValue = CreatureMoodLevel::Neutral;
     mMoodPoints = 0;
     mWakefulness = 100;
@@ -22,6 +22,7 @@
 #define CREATURE_H
 
 #include "entities/MovableGameEntity.h"
+#include "gamemap/TileBitmap.h"
 
 #include <OgreVector2.h>
 #include <OgreVector3.h>
@@ -97,6 +98,24 @@ public:
     Creature& mCreature;
 };
 
+//! Class used on server side to save the last creature state refreshed to a seat. Creature::exportToPacketForUpdate
+//! only sends the fields that changed since then
+class CreatureRefreshState
+{
+public:
+    CreatureRefreshState();
+
+    unsigned int mLevel;
+    int mSeatId;
+    uint32_t mOverlayHealthValue;
+    uint32_t mMoodValue;
+    double mGroundSpeed;
+    double mWaterSpeed;
+    double mLavaSpeed;
+    double mSpeedModifier;
+    int mSeatPrisonId;
+};
+
 /*! \class Creature Creature.h
  *  \brief Position, status, and AI state for a single game creature.
  *
@@ -252,6 +271,13 @@ public:
     //! \brief Computes the visible tiles and tags them to know which are visible
     void computeVisibleTiles();
 
+    /*! \brief Refreshes the tiles in sight if needed and computes the visible and reachable objects used by
+     * the next doUpkeep. It only reads the map so it can be called for several creatures from several threads
+     * at once (see GameMap::perceiveCreatures). If it was not called or if the creature changes seat or moves
+     * before doUpkeep, the objects are computed there.
+     */
+    void perceive();
+
     virtual bool isAttackable(Tile* tile, Seat* seat) const;
 
     double getPhysicalDefense() const;
@@ -265,6 +291,17 @@ public:
     //! And the tiles the creature can "see" (removing the ones behind walls).
     void updateTilesInSight();
 
+    //! \brief Removes the vision this creature gives on the tiles it sees
+    void releaseVision();
+
+    //! \brief Returns true if the creature can see (and give vision). Dead creatures, KO creatures, creatures
+    //! in jail and creatures not on the map cannot
+    bool canSee() const;
+
+    //! \brief Calls updateTilesInSight if the creature moved or if something changed around. Returns true
+    //! if the tiles in sight were updated
+    bool refreshTilesInSight();
+
     //! \brief Loops over the visibleTiles and adds all enemy creatures in each tile to a list which it returns.
     std::vector<GameEntity*> getVisibleEnemyObjects();
 
@@ -398,6 +435,9 @@ public:
     inline const std::vector<Tile*>& getVisibleTiles() const
     { return mVisibleTiles; }
 
+    inline const TileBitmap& getVisibleTilesBitmap() const
+    { return mVisibleTilesBitmap; }
+
     inline const std::vector<Tile*>& getTilesWithinSightRadius() const
     { return mTilesWithinSightRadius; }
 
@@ -593,6 +633,14 @@ public:
     //! \brief Called when the creature changes seat (for example when it becomes rogue or after torture)
     void changeSeat(Seat* newSeat);
 
+    //! \brief Called by the GameMap when the creature is added (true) or removed (false) from its creature list.
+    //! Only creatures in the list are counted in the fighters/workers count of their seat
+    void setSeatCounted(bool counted);
+
+    //! \brief Updates the fighters/workers count of the seats if the creature changed since it was last
+    //! counted (HP, seat or definition). Used on server side only
+    void updateSeatCreaturesCount();
+
 protected:
     virtual void exportToPacket(ODPacket& os, const Seat* seat) const override;
     virtual void importFromPacket(ODPacket& is) override;
@@ -689,9 +737,31 @@ private:
     //! used for actions linked to enemies.
     std::vector<Tile*>              mVisibleTiles;
 
+    //! \brief Same tiles as mVisibleTiles on a bitmap around the creature to check quickly if a tile is visible
+    TileBitmap                      mVisibleTilesBitmap;
+
+    //! \brief Position tile mVisibleTiles was computed from. They are computed again when the creature
+    //! moves to another tile or when a tile blocking vision changes near it
+    Tile*                           mVisibleTilesPosTile;
+
+    //! \brief Tiles this creature gives vision on, the seat it gives vision to (see Tile::addVision) and
+    //! the position tile they were computed from
+    std::vector<Tile*>              mVisionGivenTiles;
+    TileBitmap                      mVisionGivenBitmap;
+    Seat*                           mVisionGivenSeat;
+    Tile*                           mVisionGivenPosTile;
+
     std::vector<GameEntity*>        mVisibleEnemyObjects;
     std::vector<GameEntity*>        mVisibleAlliedObjects;
     std::vector<GameEntity*>        mReachableAlliedObjects;
+
+    //! \brief true if the objects above were computed by perceive since the last doUpkeep. In that case,
+    //! mPerceptionSeat and mPerceptionPosTile are the seat and position tile they were computed from and
+    //! mIsSightRefreshed tells if the tiles in sight were updated
+    bool                            mIsPerceptionDone;
+    bool                            mIsSightRefreshed;
+    Seat*                           mPerceptionSeat;
+    Tile*                           mPerceptionPosTile;
     std::vector<std::unique_ptr<CreatureAction>>    mActions;
     std::vector<Tile*>              mVisualDebugEntityTiles;
 
@@ -763,9 +833,22 @@ private:
     //! \brief Counts the number of active slaps affecting the creature
     uint32_t                        mActiveSlapsCount;
 
+    //! \brief true if the creature is in the GameMap creature list. mCountedSeat is the seat the creature
+    //! is counted for (nullptr if not counted) and mIsCountedAsWorker tells if it is counted as a worker
+    bool                            mIsSeatCounted;
+    Seat*                           mCountedSeat;
+    bool                            mIsCountedAsWorker;
+
     //! \brief Skills the creature can use
     std::vector<CreatureSkillData> mSkillData;
 
+    //! \brief Last state refreshed to each seat with vision. The entry of a seat is removed when the creature is added
+    //! or removed for it so that the next refresh is complete. It is updated by exportToPacketForUpdate, hence mutable
+    mutable std::vector<std::pair<const Seat*, CreatureRefreshState>> mRefreshStatesSent;
+
+    //! \brief Forgets the last state refreshed to the given seat (see mRefreshStatesSent)
+    void removeRefreshStateSent(const Seat* seat);
+
     //! \brief A sub-function called by doTurn()
     //! This one checks if there is something prioritary to do (like fighting). If it is the case,
     //! it should empty the action list before adding what to do.
@@ -86,6 +86,7 @@ GameEntity::GameEntity(
           ) :
     mPosition          (Ogre::Vector3::ZERO),
     mName              (name),
+    mNetworkId         (0),
     mMeshName          (meshName),
     mMeshExists        (false),
     mSeat              (seat),
@@ -154,7 +155,7 @@ void GameEntity::firePickupEntity(Player* playerPicking)
 {
     int seatId = playerPicking->getSeat()->getId();
     GameEntityType entityType = getObjectType();
-    const std::string& entityName = getName();
+    uint32_t networkId = getNetworkId();
     for(std::vector<Seat*>::iterator it = mSeatsWithVisionNotified.begin(); it != mSeatsWithVisionNotified.end();)
     {
         Seat* seat = *it;
@@ -184,14 +185,14 @@ void GameEntity::firePickupEntity(Player* playerPicking)
         {
             ServerNotification serverNotification(
                 ServerNotificationType::entityPickedUp, seat->getPlayer());
-            serverNotification.mPacket << seatId << entityType << entityName;
+            serverNotification.mPacket << seatId << entityType << networkId;
             ODServer::getSingleton().sendAsyncMsg(serverNotification);
         }
         else
         {
             ServerNotification* serverNotification = new ServerNotification(
                 ServerNotificationType::entityPickedUp, seat->getPlayer());
-            serverNotification->mPacket << seatId << entityType << entityName;
+            serverNotification->mPacket << seatId << entityType << networkId;
             ODServer::getSingleton().queueServerNotification(serverNotification);
         }
     }
@@ -366,6 +367,7 @@ void GameEntity::exportToPacket(ODPacket& os, const Seat* seat) const
 
     os << seatId;
     os << mName;
+    os << mNetworkId;
     os << mMeshName;
     os << mPosition;
 
@@ -383,6 +385,7 @@ void GameEntity::importFromPacket(ODPacket& is)
         mSeat = mGameMap->getSeatById(seatId);
 
     OD_ASSERT_TRUE(is >> mName);
+    OD_ASSERT_TRUE(is >> mNetworkId);
     OD_ASSERT_TRUE(is >> mMeshName);
     OD_ASSERT_TRUE(is >> mPosition);
 
@@ -161,6 +161,11 @@ class GameEntity
     inline const std::string& getName() const
     { return mName; }
 
+    //! \brief Get the id used to refer to this entity in network messages. 0 if the entity has
+    //! never been added to a gamemap (see GameMap::addAnimatedObject)
+    inline uint32_t getNetworkId() const
+    { return mNetworkId; }
+
     //! \brief Get the mesh name of the object
     inline const std::string& getMeshName() const
     { return mMeshName; }
@@ -186,6 +191,9 @@ class GameEntity
     inline void setName(const std::string& name)
     { mName = name; }
 
+    inline void setNetworkId(uint32_t networkId)
+    { mNetworkId = networkId; }
+
     //! \brief Set the name of the mesh file
     inline void setMeshName(const std::string& meshName)
     { mMeshName = meshName; }
@@ -414,6 +422,9 @@ class GameEntity
     //! brief The name of the entity
     std::string mName;
 
+    //! \brief Id used to refer to this entity in network messages
+    uint32_t mNetworkId;
+
     //! \brief The name of the mesh
     std::string mMeshName;
 
@@ -174,12 +174,12 @@ void MapLight::fireAddEntity(Seat* seat, bool async)
 
 void MapLight::fireRemoveEntity(Seat* seat)
 {
-    const std::string& name = getName();
+    uint32_t networkId = getNetworkId();
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotificationType::removeEntity, seat->getPlayer());
     GameEntityType type = getObjectType();
     serverNotification->mPacket << type;
-    serverNotification->mPacket << name;
+    serverNotification->mPacket << networkId;
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
@@ -312,6 +312,7 @@ void MapLight::exportToPacket(ODPacket& os, const Seat* seat) const
 {
     const std::string& name = getName();
     os << name;
+    os << mNetworkId;
     os << mPosition.x << mPosition.y << mPosition.z;
     os << mDiffuseColor.r << mDiffuseColor.g << mDiffuseColor.b;
     os << mSpecularColor.r << mSpecularColor.g << mSpecularColor.b;
@@ -324,6 +325,7 @@ void MapLight::importFromPacket(ODPacket& is)
     std::string name;
     OD_ASSERT_TRUE(is >> name);
     setName(name);
+    OD_ASSERT_TRUE(is >> mNetworkId);
     OD_ASSERT_TRUE(is >> mPosition.x >> mPosition.y >> mPosition.z);
     OD_ASSERT_TRUE(is >> mDiffuseColor.r >> mDiffuseColor.g >> mDiffuseColor.b);
     OD_ASSERT_TRUE(is >> mSpecularColor.r >> mSpecularColor.g >> mSpecularColor.b);
@@ -91,23 +91,15 @@ void MovableGameEntity::setWalkPath(const std::string& walkAnim, const std::stri
     if(!getIsOnServerMap())
         return;
 
-    for(Seat* seat : mSeatsWithVisionNotified)
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        const std::string& name = getName();
-        uint32_t nbDest = mWalkQueue.size();
-        ServerNotification *serverNotification = new ServerNotification(
-            ServerNotificationType::animatedObjectSetWalkPath, seat->getPlayer());
-        serverNotification->mPacket << name << walkAnim << endAnim << loopEndAnim << playIdleWhenAnimationEnds << nbDest;
-        for(const Ogre::Vector3& v : mWalkQueue)
-            serverNotification->mPacket << v;
-
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    uint32_t networkId = getNetworkId();
+    uint32_t nbDest = mWalkQueue.size();
+    ServerNotification *serverNotification = new ServerNotification(
+        ServerNotificationType::animatedObjectSetWalkPath, mSeatsWithVisionNotified);
+    serverNotification->mPacket << networkId << walkAnim << endAnim << loopEndAnim << playIdleWhenAnimationEnds << nbDest;
+    for(const Ogre::Vector3& v : mWalkQueue)
+        serverNotification->mPacket << v;
+
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
 void MovableGameEntity::clearDestinations(const std::string& animation, bool loopAnim, bool playIdleWhenAnimationEnds)
@@ -115,22 +107,14 @@ void MovableGameEntity::clearDestinations(const std::string& animation, bool loo
     mWalkQueue.clear();
     stopWalking();
 
-    for(Seat* seat : mSeatsWithVisionNotified)
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        const std::string& name = getName();
-        const std::string emptyString;
-        uint32_t nbDest = 0;
-        ServerNotification *serverNotification = new ServerNotification(
-            ServerNotificationType::animatedObjectSetWalkPath, seat->getPlayer());
-        serverNotification->mPacket << name << emptyString << animation
-            << loopAnim << playIdleWhenAnimationEnds << nbDest;
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    uint32_t networkId = getNetworkId();
+    const std::string emptyString;
+    uint32_t nbDest = 0;
+    ServerNotification *serverNotification = new ServerNotification(
+        ServerNotificationType::animatedObjectSetWalkPath, mSeatsWithVisionNotified);
+    serverNotification->mPacket << networkId << emptyString << animation
+        << loopAnim << playIdleWhenAnimationEnds << nbDest;
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
 void MovableGameEntity::stopWalking()
@@ -300,25 +284,17 @@ void MovableGameEntity::setPosition(const Ogre::Vector3& v)
 
 void MovableGameEntity::fireObjectAnimationState(const std::string& state, bool loop, const Ogre::Vector3& direction, bool playIdleWhenAnimationEnds)
 {
-    for(Seat* seat : mSeatsWithVisionNotified)
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        ServerNotification* serverNotification = new ServerNotification(
-            ServerNotificationType::setObjectAnimationState, seat->getPlayer());
-        const std::string& name = getName();
-        serverNotification->mPacket << name << state << loop << playIdleWhenAnimationEnds;
-        if(direction != Ogre::Vector3::ZERO)
-            serverNotification->mPacket << true << direction;
-        else if(mWalkDirection != Ogre::Vector3::ZERO)
-            serverNotification->mPacket << true << mWalkDirection;
-        else
-            serverNotification->mPacket << false;
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    ServerNotification* serverNotification = new ServerNotification(
+        ServerNotificationType::setObjectAnimationState, mSeatsWithVisionNotified);
+    uint32_t networkId = getNetworkId();
+    serverNotification->mPacket << networkId << state << loop << playIdleWhenAnimationEnds;
+    if(direction != Ogre::Vector3::ZERO)
+        serverNotification->mPacket << true << direction;
+    else if(mWalkDirection != Ogre::Vector3::ZERO)
+        serverNotification->mPacket << true << mWalkDirection;
+    else
+        serverNotification->mPacket << false;
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
 void MovableGameEntity::exportToStream(std::ostream& os) const
@@ -120,19 +120,11 @@ void RenderedMovableEntity::setMeshOpacity(float opacity)
 
     if(getIsOnServerMap())
     {
-        for(Seat* seat : mSeatsWithVisionNotified)
-        {
-            if(seat->getPlayer() == nullptr)
-                continue;
-            if(!seat->getPlayer()->getIsHuman())
-                continue;
-
-            ServerNotification* serverNotification = new ServerNotification(
-                ServerNotificationType::setEntityOpacity, seat->getPlayer());
-            const std::string& name = getName();
-            serverNotification->mPacket << name << opacity;
-            ODServer::getSingleton().queueServerNotification(serverNotification);
-        }
+        ServerNotification* serverNotification = new ServerNotification(
+            ServerNotificationType::setEntityOpacity, mSeatsWithVisionNotified);
+        uint32_t networkId = getNetworkId();
+        serverNotification->mPacket << networkId << opacity;
+        ODServer::getSingleton().queueServerNotification(serverNotification);
         return;
     }
 
@@ -174,10 +166,10 @@ void RenderedMovableEntity::fireRemoveEntity(Seat* seat)
 {
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotificationType::removeEntity, seat->getPlayer());
-    const std::string& name = getName();
+    uint32_t networkId = getNetworkId();
     GameEntityType type = getObjectType();
     serverNotification->mPacket << type;
-    serverNotification->mPacket << name;
+    serverNotification->mPacket << networkId;
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
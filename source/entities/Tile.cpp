@@ -57,8 +57,11 @@ Tile::Tile(GameMap* gameMap, int x, int y, TileType type, double fullness) :
     mFullness           (fullness),
     mRefundPriceRoom    (0),
     mRefundPriceTrap    (0),
+    mVisionGivenSeat    (nullptr),
+    mVisionGivenToAllSeats  (false),
     mCoveringBuilding   (nullptr),
     mClaimedPercentage  (0.0),
+    mClaimedTilesSeat   (nullptr),
     mIsRoom             (false),
     mIsTrap             (false),
     mDisplayTileMesh    (true),
@@ -619,7 +622,11 @@ void Tile::copyFloodFillToOtherSeats(Seat* seatToCopy)
         return;
     }
 
-    std::vector<uint32_t>& valuesToCopy = mFloodFillColor[seatToCopy->getTeamIndex()];
+    // Color aliases are specific to each team so we copy the resolved colors
+    std::vector<uint32_t> valuesToCopy(static_cast<uint32_t>(FloodFillType::nbValues), NO_FLOODFILL);
+    for(uint32_t intType = 0; intType < static_cast<uint32_t>(FloodFillType::nbValues); ++intType)
+        valuesToCopy[intType] = getFloodFillValue(seatToCopy, static_cast<FloodFillType>(intType));
+
     for(uint32_t indexFloodFill = 0; indexFloodFill < mFloodFillColor.size(); ++indexFloodFill)
     {
         if(seatToCopy->getTeamIndex() == indexFloodFill)
@@ -687,22 +694,52 @@ bool Tile::isClaimed() const
     return true;
 }
 
-void Tile::clearVision()
+void Tile::addVision(Seat* seat)
 {
-    mSeatsWithVision.clear();
+    // Allied seats share vision
+    addVisionForSeat(seat);
+    for(Seat* alliedSeat : seat->getAlliedSeats())
+        addVisionForSeat(alliedSeat);
 }
 
-void Tile::notifyVision(Seat* seat)
+void Tile::removeVision(Seat* seat)
 {
-    if(std::find(mSeatsWithVision.begin(), mSeatsWithVision.end(), seat) != mSeatsWithVision.end())
+    removeVisionForSeat(seat);
+    for(Seat* alliedSeat : seat->getAlliedSeats())
+        removeVisionForSeat(alliedSeat);
+}
+
+void Tile::addVisionForSeat(Seat* seat)
+{
+    auto it = std::find(mSeatsWithVision.begin(), mSeatsWithVision.end(), seat);
+    if(it != mSeatsWithVision.end())
+    {
+        ++mSeatsWithVisionCount[it - mSeatsWithVision.begin()];
         return;
+    }
 
-    seat->notifyVisionOnTile(this);
     mSeatsWithVision.push_back(seat);
+    mSeatsWithVisionCount.push_back(1);
+    seat->notifyVisionOnTile(this);
+}
 
-    // We also notify vision for allied seats
-    for(Seat* alliedSeat : seat->getAlliedSeats())
-        notifyVision(alliedSeat);
+void Tile::removeVisionForSeat(Seat* seat)
+{
+    auto it = std::find(mSeatsWithVision.begin(), mSeatsWithVision.end(), seat);
+    if(it == mSeatsWithVision.end())
+    {
+        OD_LOG_ERR("tile=" + Tile::displayAsString(this) + ", seatId=" + Helper::toString(seat->getId()));
+        return;
+    }
+
+    uint32_t index = static_cast<uint32_t>(it - mSeatsWithVision.begin());
+    --mSeatsWithVisionCount[index];
+    if(mSeatsWithVisionCount[index] > 0)
+        return;
+
+    mSeatsWithVision.erase(it);
+    mSeatsWithVisionCount.erase(mSeatsWithVisionCount.begin() + index);
+    seat->notifyVisionLostOnTile(this);
 }
 
 void Tile::setSeats(const std::vector<Seat*>& seats)
@@ -839,7 +876,8 @@ uint32_t Tile::getFloodFillValue(Seat* seat, FloodFillType type) const
         return NO_FLOODFILL;
     }
 
-    return values.at(intType);
+    // The color may have been merged with another one since it was set
+    return getGameMap()->getFloodFillAliases().resolve(seat->getTeamIndex(), values.at(intType));
 }
 
 void Tile::setTeamsNumber(uint32_t nbTeams)
@@ -877,6 +915,12 @@ void Tile::setFullness(double f)
         setMarkedForDiggingForAllPlayersExcept(false, nullptr);
     }
 
+    if ((oldFullness > 0.0) != (mFullness > 0.0))
+    {
+        getGameMap()->notifyTilePassabilityChanged(this);
+        getGameMap()->notifyTileVisionBlockingChanged(this);
+    }
+
     if ((oldFullness > 0.0) && (mFullness == 0.0))
     {
         fireTileSound(TileSound::Digged);
@@ -939,7 +983,10 @@ void Tile::setCoveringBuilding(Building *building)
             seatChanged.second = true;
         }
     }
+    getGameMap()->notifyCoveringBuildingChanged(this, mCoveringBuilding, building);
     mCoveringBuilding = building;
+    getGameMap()->notifyTilePassabilityChanged(this);
+    getGameMap()->notifyTileVisionBlockingChanged(this);
     mIsRoom = false;
     if(getCoveringRoom() != nullptr)
     {
@@ -967,6 +1014,7 @@ void Tile::setCoveringBuilding(Building *building)
         // Set the tile as claimed and of the team color of the building
         setSeat(mCoveringBuilding->getSeat());
         mClaimedPercentage = 1.0;
+        updateClaimedTilesCount();
     }
 }
 
@@ -991,34 +1039,43 @@ void Tile::exportToPacketForUpdate(ODPacket& os, const Seat* seat) const
 {
     GameEntity::exportToPacketForUpdate(os, seat);
 
-    seat->exportTileToPacket(os, this);
+    seat->exportTileToPacket(os, this, false);
 }
 
-void Tile::updateFromPacket(ODPacket& is)
+void Tile::exportToPacketForAsyncUpdate(ODPacket& os, const Seat* seat) const
 {
-    GameEntity::updateFromPacket(is);
+    GameEntity::exportToPacketForUpdate(os, seat);
 
-    // This function should read parameters as sent by Tile::exportToPacketForUpdate
-    int seatId;
-    std::string meshName;
-    std::stringstream ss;
+    seat->exportTileToPacket(os, this, true);
+}
 
-    // We set the seat if there is one
-    OD_ASSERT_TRUE(is >> mIsRoom);
-    OD_ASSERT_TRUE(is >> mIsTrap);
-    OD_ASSERT_TRUE(is >> mRefundPriceRoom);
-    OD_ASSERT_TRUE(is >> mRefundPriceTrap);
+void Tile::updateFromPacket(ODPacket& is)
+{
+    GameEntity::updateFromPacket(is);
 
-    OD_ASSERT_TRUE(is >> mDisplayTileMesh);
-    OD_ASSERT_TRUE(is >> mColorCustomMesh);
-    OD_ASSERT_TRUE(is >> mHasBridge);
+    // This function should read parameters as sent by Tile::exportToPacketForUpdate. The fields
+    // not sent did not change
+    Seat* localSeat = getGameMap()->getLocalPlayer()->getSeat();
+    TileRefreshState state;
+    uint8_t fields = localSeat->importTileFromPacket(is, state);
 
-    OD_ASSERT_TRUE(is >> seatId);
+    if((fields & TileRefreshField::TileRefreshFlags) != 0)
+    {
+        mIsRoom = state.mIsRoom;
+        mIsTrap = state.mIsTrap;
+        mDisplayTileMesh = state.mDisplayTileMesh;
+        mColorCustomMesh = state.mColorCustomMesh;
+        mHasBridge = state.mHasBridge;
+    }
+    if((fields & TileRefreshField::TileRefreshRefundPriceRoom) != 0)
+        mRefundPriceRoom = state.mRefundPriceRoom;
+    if((fields & TileRefreshField::TileRefreshRefundPriceTrap) != 0)
+        mRefundPriceTrap = state.mRefundPriceTrap;
 
-    OD_ASSERT_TRUE(is >> meshName);
-    setMeshName(meshName);
+    if((fields & TileRefreshField::TileRefreshMeshName) != 0)
+        setMeshName(state.mMeshName);
 
-    ss.str(std::string());
+    std::stringstream ss;
     ss << TILE_PREFIX;
     ss << getX();
     ss << "_";
@@ -1026,18 +1083,23 @@ void Tile::updateFromPacket(ODPacket& is)
 
     setName(ss.str());
 
-    OD_ASSERT_TRUE(is >> mTileVisual);
+    if((fields & TileRefreshField::TileRefreshTileVisual) != 0)
+        mTileVisual = state.mTileVisual;
 
-    if(seatId == -1)
-    {
-        setSeat(nullptr);
-    }
-    else
+    // We set the seat if there is one
+    if((fields & TileRefreshField::TileRefreshSeatId) != 0)
     {
-        Seat* seat = getGameMap()->getSeatById(seatId);
-        if(seat != nullptr)
-            setSeat(seat);
+        if(state.mSeatId == -1)
+        {
+            setSeat(nullptr);
+        }
+        else
+        {
+            Seat* seat = getGameMap()->getSeatById(state.mSeatId);
+            if(seat != nullptr)
+                setSeat(seat);
 
+        }
     }
 
     // We need to check if the tile is unmarked after reading the needed information.
@@ -1102,6 +1164,7 @@ void Tile::loadFromLine(const std::string& line, Tile *t)
     if(!shouldSetSeat)
     {
         t->setSeat(nullptr);
+        t->updateClaimedTilesCount();
         return;
     }
 
@@ -1111,6 +1174,7 @@ void Tile::loadFromLine(const std::string& line, Tile *t)
         return;
     t->setSeat(seat);
     t->mClaimedPercentage = 1.0;
+    t->updateClaimedTilesCount();
 }
 
 void Tile::refreshMesh()
@@ -1153,6 +1217,7 @@ bool Tile::addEntity(GameEntity *entity)
     }
 
     mEntitiesInTile.push_back(entity);
+    getGameMap()->notifyEntityAddedOnTile(entity, this);
     return true;
 }
 
@@ -1166,6 +1231,7 @@ void Tile::removeEntity(GameEntity *entity)
     }
 
     mEntitiesInTile.erase(it);
+    getGameMap()->notifyEntityRemovedFromTile(entity, this);
 }
 
 
@@ -1209,7 +1275,11 @@ void Tile::claimForSeat(Seat* seat, double nDanceRate)
         (getSeat()->isAlliedSeat(seat)))
     {
         claimTile(seat);
+        return;
     }
+
+    // An enemy claimed tile is not claimed anymore as soon as its percentage decreases
+    updateClaimedTilesCount();
 }
 
 void Tile::claimTile(Seat* seat)
@@ -1218,6 +1288,7 @@ void Tile::claimTile(Seat* seat)
     // We need this because if we are a client, the tile may be from a non allied seat
     setSeat(seat);
     mClaimedPercentage = 1.0;
+    updateClaimedTilesCount();
 
     if(isFullTile())
         fireTileSound(TileSound::ClaimWall);
@@ -1248,6 +1319,7 @@ void Tile::unclaimTile()
     // Unclaim the tile.
     setSeat(nullptr);
     mClaimedPercentage = 0.0;
+    updateClaimedTilesCount();
 
     computeTileVisual();
     setDirtyForAllSeats();
@@ -1265,6 +1337,24 @@ void Tile::unclaimTile()
     }
 }
 
+void Tile::updateClaimedTilesCount()
+{
+    if(!getIsOnServerMap())
+        return;
+
+    Seat* claimedSeat = isClaimed() ? getSeat() : nullptr;
+    if(claimedSeat == mClaimedTilesSeat)
+        return;
+
+    if(mClaimedTilesSeat != nullptr)
+        mClaimedTilesSeat->decrementNumClaimedTiles();
+
+    if(claimedSeat != nullptr)
+        claimedSeat->incrementNumClaimedTiles();
+
+    mClaimedTilesSeat = claimedSeat;
+}
+
 double Tile::digOut(double digRate)
 {
     // We scle dig rate depending on the tile type
@@ -1643,24 +1733,43 @@ bool Tile::checkCoveringTrapType(TrapType type) const
 
 void Tile::computeVisibleTiles()
 {
-    if(!getGameMap()->getIsFOWActivated())
-    {
-        // If the FOW is deactivated, we allow vision for every seat
-        for(Seat* seat : getGameMap()->getSeats())
-            notifyVision(seat);
+    // If the FOW is deactivated, we allow vision for every seat. Otherwise, a claimed tile can
+    // see it self and its neighboors
+    bool giveToAllSeats = !getGameMap()->getIsFOWActivated();
+    Seat* seatClaimed = nullptr;
+    if(!giveToAllSeats && isClaimed())
+        seatClaimed = getSeat();
 
+    if((giveToAllSeats == mVisionGivenToAllSeats) && (seatClaimed == mVisionGivenSeat))
         return;
-    }
 
-    if(!isClaimed())
-        return;
+    // We give the new vision before removing the old one so that tiles seen by both are not lost
+    if(giveToAllSeats)
+    {
+        for(Seat* seat : getGameMap()->getSeats())
+            addVision(seat);
+    }
+    if(seatClaimed != nullptr)
+    {
+        addVision(seatClaimed);
+        for(Tile* tile : mNeighbors)
+            tile->addVision(seatClaimed);
+    }
 
-    // A claimed tile can see it self and its neighboors
-    notifyVision(getSeat());
-    for(Tile* tile : mNeighbors)
+    if(mVisionGivenToAllSeats)
     {
-        tile->notifyVision(getSeat());
+        for(Seat* seat : getGameMap()->getSeats())
+            removeVision(seat);
+    }
+    if(mVisionGivenSeat != nullptr)
+    {
+        removeVision(mVisionGivenSeat);
+        for(Tile* tile : mNeighbors)
+            tile->removeVision(mVisionGivenSeat);
     }
+
+    mVisionGivenToAllSeats = giveToAllSeats;
+    mVisionGivenSeat = seatClaimed;
 }
 
 void Tile::setDirtyForAllSeats()
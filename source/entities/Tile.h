@@ -19,6 +19,7 @@
 #define TILE_H
 
 #include "entities/GameEntity.h"
+#include "entities/TileVisual.h"
 
 #include <OgreVector3.h>
 
@@ -75,30 +76,6 @@ std::ostream& operator<<(std::ostream& os, const TileType& type);
 std::istream& operator>>(std::istream& is, TileType& type);
 
 
-//! Different representations a tile can have (ground or full)
-enum class TileVisual
-{
-    nullTileVisual = 0,
-    dirtGround,
-    dirtFull,
-    goldGround,
-    goldFull,
-    rockGround,
-    rockFull,
-    waterGround,
-    lavaGround,
-    claimedGround,
-    claimedFull,
-    gemGround,
-    gemFull,
-    countTileVisual
-};
-
-ODPacket& operator<<(ODPacket& os, const TileVisual& type);
-ODPacket& operator>>(ODPacket& is, TileVisual& type);
-std::ostream& operator<<(std::ostream& os, const TileVisual& type);
-std::istream& operator>>(std::istream& is, TileVisual& type);
-
 enum class FloodFillType
 {
     ground = 0,
@@ -260,6 +237,10 @@ public:
     void claimForSeat(Seat* seat, double nDanceRate);
     void claimTile(Seat* seat);
     void unclaimTile();
+
+    //! \brief Updates the claimed tiles count of the seats if the claim state of this tile changed. Must be
+    //! called on server side each time the tile seat or claimed percentage is changed
+    void updateClaimedTilesCount();
     double digOut(double digRate);
 
     inline Building* getCoveringBuilding() const
@@ -354,10 +335,16 @@ public:
     //! Fills the given vector with corresponding entities on this tile.
     void fillWithEntities(std::vector<GameEntity*>& entities, SelectionEntityWanted entityWanted, Player* player);
 
-    //! \brief Computes the visible tiles and tags them to know which are visible
+    //! \brief Updates the vision this tile gives: a claimed tile gives vision on itself and its neighbors
+    //! to its seat and, if the FOW is deactivated, every seat sees every tile. Nothing is done if the
+    //! tile state did not change since the last call
     void computeVisibleTiles();
-    void clearVision();
-    void notifyVision(Seat* seat);
+
+    //! \brief Each viewer (creature, claimed tile, spell, ...) that sees this tile calls addVision once
+    //! and removeVision once when it does not see it anymore. The count of viewers is kept for each seat
+    //! (allied seats included). The seat is notified when it gains or loses vision on this tile
+    void addVision(Seat* seat);
+    void removeVision(Seat* seat);
 
     void setSeats(const std::vector<Seat*>& seats);
     bool hasChangedForSeat(Seat* seat) const;
@@ -443,6 +430,9 @@ public:
     static void exportToStream(Tile* tile, std::ostream& os);
 
     virtual void exportToPacketForUpdate(ODPacket& os, const Seat* seat) const override;
+    //! \brief Same as exportToPacketForUpdate for refreshes sent with ODServer::sendAsyncMsg. As they can reach
+    //! the client before the queued ones, the whole tile state is sent (see Seat::exportTileToPacket)
+    void exportToPacketForAsyncUpdate(ODPacket& os, const Seat* seat) const;
     virtual void updateFromPacket(ODPacket& is) override;
 
 protected:
@@ -490,6 +480,13 @@ private:
     std::vector<std::pair<Seat*, bool>> mTileChangedForSeats;
     std::vector<Seat*> mSeatsWithVision;
 
+    //! \brief Number of viewers giving vision for each seat in mSeatsWithVision (same index)
+    std::vector<uint32_t> mSeatsWithVisionCount;
+
+    //! \brief Vision given by computeVisibleTiles: to the seat owning the tile (if claimed) or to all the seats
+    Seat* mVisionGivenSeat;
+    bool mVisionGivenToAllSeats;
+
     //! \brief List of the entities actually on this tile. Most of the creatures actions will rely on this list
     std::vector<GameEntity*> mEntitiesInTile;
 
@@ -500,6 +497,9 @@ private:
     //! \brief The tile claiming. Used on server side only
     double mClaimedPercentage;
 
+    //! \brief Seat this tile is counted for in its claimed tiles count. Used on server side only
+    Seat* mClaimedTilesSeat;
+
     //! \brief True if a building is on this tile. False otherwise. It is used on client side because the clients do not know about
     //! buildings. However, it needs to know the tiles where a building is to display the room/trap costs.
     bool mIsRoom;
@@ -523,6 +523,10 @@ private:
 
     void setDirtyForAllSeats();
 
+    //! \brief Updates the viewers count of the given seat only (see addVision)
+    void addVisionForSeat(Seat* seat);
+    void removeVisionForSeat(Seat* seat);
+
     uint32_t mNbWorkersDigging;
     uint32_t mNbWorkersClaiming;
 };
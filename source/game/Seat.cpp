@@ -43,6 +43,7 @@
 #include "utils/LogManager.h"
 #include "utils/Random.h"
 
+#include <algorithm>
 #include <istream>
 #include <ostream>
 
@@ -60,8 +61,7 @@ TileStateNotified::TileStateNotified():
     mTileVisual(TileVisual::nullTileVisual),
     mSeatIdOwner(-1),
     mMarkedForDigging(false),
-    mVisionTurnLast(false),
-    mVisionTurnCurrent(false),
+    mVisionTemporary(false),
     mBuilding(nullptr)
 {
 }
@@ -71,6 +71,7 @@ Seat::Seat(GameMap* gameMap) :
     mGameMap(gameMap),
     mPlayer(nullptr),
     mGoldMined(0),
+    mStartingGold(0),
     mDefaultWorkerClass(nullptr),
     mTeamIndex(0),
     mIsDebuggingVision(false),
@@ -225,24 +226,43 @@ void Seat::addAlliedSeat(Seat* seat)
     mAlliedSeats.push_back(seat);
 }
 
-void Seat::clearTilesWithVision()
+void Seat::clearTemporaryVision()
+{
+    for(Tile* tile : mTilesVisionTemporary)
+    {
+        TileStateNotified& tileState = mTilesStates[tile->getX()][tile->getY()];
+        tileState.mVisionTemporary = false;
+        const std::vector<Seat*>& seatsWithVision = tile->getSeatsWithVision();
+        if(std::find(seatsWithVision.begin(), seatsWithVision.end(), this) != seatsWithVision.end())
+            continue;
+
+        mVisionCurrent.unset(tile->getX(), tile->getY());
+    }
+    mTilesVisionTemporary.clear();
+}
+
+void Seat::notifyVisionOnTile(Tile* tile)
 {
     if(mPlayer == nullptr)
         return;
     if(!mPlayer->getIsHuman())
         return;
 
-    for(std::vector<TileStateNotified>& vec : mTilesStates)
+    if(tile->getX() >= static_cast<int>(mTilesStates.size()))
     {
-        for(TileStateNotified& p : vec)
-        {
-            p.mVisionTurnLast = p.mVisionTurnCurrent;
-            p.mVisionTurnCurrent = false;
-        }
+        OD_LOG_ERR("Tile=" + Tile::displayAsString(tile));
+        return;
+    }
+    if(tile->getY() >= static_cast<int>(mTilesStates[tile->getX()].size()))
+    {
+        OD_LOG_ERR("Tile=" + Tile::displayAsString(tile));
+        return;
     }
+
+    mVisionCurrent.set(tile->getX(), tile->getY());
 }
 
-void Seat::notifyVisionOnTile(Tile* tile)
+void Seat::notifyVisionLostOnTile(Tile* tile)
 {
     if(mPlayer == nullptr)
         return;
@@ -260,8 +280,12 @@ void Seat::notifyVisionOnTile(Tile* tile)
         return;
     }
 
-    TileStateNotified& tileState = mTilesStates[tile->getX()][tile->getY()];
-    tileState.mVisionTurnCurrent = true;
+    // If the tile was claimed by an enemy during this turn, we keep vision until the next upkeep
+    const TileStateNotified& tileState = mTilesStates[tile->getX()][tile->getY()];
+    if(tileState.mVisionTemporary)
+        return;
+
+    mVisionCurrent.unset(tile->getX(), tile->getY());
 }
 
 void Seat::notifyTileClaimedByEnemy(Tile* tile)
@@ -284,10 +308,15 @@ void Seat::notifyTileClaimedByEnemy(Tile* tile)
 
     TileStateNotified& tileState = mTilesStates[tile->getX()][tile->getY()];
 
-    // By default, we set the tile like if it was not claimed anymore
+    // By default, we set the tile like if it was not claimed anymore. The seat sees the tile until the next upkeep
     tileState.mSeatIdOwner = -1;
     tileState.mTileVisual = TileVisual::dirtGround;
-    tileState.mVisionTurnCurrent = true;
+    if(!tileState.mVisionTemporary)
+    {
+        tileState.mVisionTemporary = true;
+        mTilesVisionTemporary.push_back(tile);
+    }
+    mVisionCurrent.set(tile->getX(), tile->getY());
 }
 
 const std::string Seat::getFactionFromLine(const std::string& line)
@@ -355,9 +384,7 @@ bool Seat::hasVisionOnTile(Tile* tile)
         return false;
     }
 
-    TileStateNotified& stateTile = mTilesStates[tile->getX()][tile->getY()];
-
-    return stateTile.mVisionTurnCurrent;
+    return mVisionCurrent.test(tile->getX(), tile->getY());
 }
 
 void Seat::initSeat()
@@ -439,10 +466,7 @@ void Seat::initSeat()
 
         if(!tilesRefresh.empty())
         {
-            ServerNotification *serverNotification = new ServerNotification(
-                ServerNotificationType::refreshTiles, getPlayer());
-            uint32_t nbTiles = tilesRefresh.size();
-            serverNotification->mPacket << nbTiles;
+            std::vector<Tile*> tilesRestored;
             for(Tile* tile : tilesRefresh)
             {
                 std::pair<int, int> tileCoords(tile->getX(), tile->getY());
@@ -461,11 +485,17 @@ void Seat::initSeat()
                     continue;
                 }
                 mTilesStates[tile->getX()][tile->getY()] = tileState;
+                tilesRestored.push_back(tile);
+            }
 
-                // Then, we export tile state to the client
-                mGameMap->tileToPacket(serverNotification->mPacket, tile);
+            // Then, we export tiles state to the client
+            ServerNotification *serverNotification = new ServerNotification(
+                ServerNotificationType::refreshTiles, getPlayer());
+            mGameMap->tilesToPacket(serverNotification->mPacket, tilesRestored, [this, serverNotification](Tile* tile)
+            {
                 tile->exportToPacketForUpdate(serverNotification->mPacket, this);
-            }
+            });
+
             ODServer::getSingleton().queueServerNotification(serverNotification);
         }
 
@@ -481,6 +511,10 @@ void Seat::setMapSize(int x, int y)
         return;
 
     mTilesStates = std::vector<std::vector<TileStateNotified>>(x, std::vector<TileStateNotified>(y));
+    mTilesRefreshSent = std::vector<std::vector<TileRefreshState>>(x, std::vector<TileRefreshState>(y));
+    mVisionCurrent.reset(0, 0, x, y);
+    mVisionLast.reset(0, 0, x, y);
+    mTilesVisionTemporary.clear();
     // By default, we know that rock (ground & full) will be set as rock full tiles,
     // gold (ground & full) will be set as gold full tiles,
     // other tiles will be set as dirt full tiles
@@ -603,37 +637,27 @@ void Seat::notifyChangedVisibleTiles()
         return;
 
     std::vector<Tile*> tilesToNotify;
-    int xMax = static_cast<int>(mTilesStates.size());
-    for(int xxx = 0; xxx < xMax; ++xxx)
+    mVisionCurrent.forEachSet([this, &tilesToNotify](int xxx, int yyy)
     {
-        int yMax = static_cast<int>(mTilesStates[xxx].size());
-        for(int yyy = 0; yyy < yMax; ++yyy)
-        {
-            if(!mTilesStates[xxx][yyy].mVisionTurnCurrent)
-                continue;
-
-            Tile* tile = mGameMap->getTile(xxx, yyy);
-            if(!tile->hasChangedForSeat(this))
-                continue;
+        Tile* tile = mGameMap->getTile(xxx, yyy);
+        if(!tile->hasChangedForSeat(this))
+            return;
 
-            tilesToNotify.push_back(tile);
-            tile->changeNotifiedForSeat(this);
-        }
-    }
+        tilesToNotify.push_back(tile);
+        tile->changeNotifiedForSeat(this);
+    });
 
     if(tilesToNotify.empty())
         return;
 
-    uint32_t nbTiles = tilesToNotify.size();
+    // Tiles are already sorted by x then y
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotificationType::refreshTiles, getPlayer());
-    serverNotification->mPacket << nbTiles;
-    for(Tile* tile : tilesToNotify)
+    mGameMap->tilesToPacket(serverNotification->mPacket, tilesToNotify, [this, serverNotification](Tile* tile)
     {
-        mGameMap->tileToPacket(serverNotification->mPacket, tile);
         updateTileStateForSeat(tile);
         tile->exportToPacketForUpdate(serverNotification->mPacket, this);
-    }
+    });
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
@@ -709,19 +733,10 @@ void Seat::refreshSeatVisualDebug()
     if(mIsDebuggingVision)
     {
         std::vector<Tile*> tiles;
-        int xMax = static_cast<int>(mTilesStates.size());
-        for(int xxx = 0; xxx < xMax; ++xxx)
+        mVisionCurrent.forEachSet([this, &tiles](int xxx, int yyy)
         {
-            int yMax = static_cast<int>(mTilesStates[xxx].size());
-            for(int yyy = 0; yyy < yMax; ++yyy)
-            {
-                if(!mTilesStates[xxx][yyy].mVisionTurnCurrent)
-                    continue;
-
-                Tile* tile = mGameMap->getTile(xxx, yyy);
-                tiles.push_back(tile);
-            }
-        }
+            tiles.push_back(mGameMap->getTile(xxx, yyy));
+        });
         uint32_t nbTiles = tiles.size();
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotificationType::refreshSeatVisDebug, nullptr);
@@ -755,75 +770,40 @@ void Seat::sendVisibleTiles()
     if(!getPlayer()->getIsHuman())
         return;
 
-    uint32_t nbTiles;
     ServerNotification *serverNotification = new ServerNotification(
         ServerNotificationType::refreshVisibleTiles, getPlayer());
     std::vector<Tile*> tilesVisionGained;
     std::vector<Tile*> tilesVisionLost;
-    // Tiles we gained vision
-    int xMax = static_cast<int>(mTilesStates.size());
-    for(int xxx = 0; xxx < xMax; ++xxx)
-    {
-        int yMax = static_cast<int>(mTilesStates[xxx].size());
-        for(int yyy = 0; yyy < yMax; ++yyy)
-        {
-            if(mTilesStates[xxx][yyy].mVisionTurnCurrent == mTilesStates[xxx][yyy].mVisionTurnLast)
-                continue;
-
-            Tile* tile = mGameMap->getTile(xxx, yyy);
-            if(mTilesStates[xxx][yyy].mVisionTurnCurrent)
-            {
-                // Vision gained
-                tilesVisionGained.push_back(tile);
-            }
-            else
-            {
-                // Vision lost
-                tilesVisionLost.push_back(tile);
-            }
-        }
-    }
-
-    // Notify tiles we gained vision
-    nbTiles = tilesVisionGained.size();
-    serverNotification->mPacket << nbTiles;
-    for(Tile* tile : tilesVisionGained)
-    {
-        mGameMap->tileToPacket(serverNotification->mPacket, tile);
-    }
-
-    // Notify tiles we lost vision
-    nbTiles = tilesVisionLost.size();
-    serverNotification->mPacket << nbTiles;
-    for(Tile* tile : tilesVisionLost)
-    {
-        mGameMap->tileToPacket(serverNotification->mPacket, tile);
-    }
+    // We compare the current vision with the one sent last time. Tiles that gained and lost
+    // vision in the meantime are not sent
+    TileBitmap::andNot(mVisionCurrent, mVisionLast, mVisionGained);
+    TileBitmap::andNot(mVisionLast, mVisionCurrent, mVisionLost);
+    mVisionLast = mVisionCurrent;
+    mVisionGained.forEachSet([this, &tilesVisionGained](int xxx, int yyy)
+    {
+        tilesVisionGained.push_back(mGameMap->getTile(xxx, yyy));
+    });
+    mVisionLost.forEachSet([this, &tilesVisionLost](int xxx, int yyy)
+    {
+        tilesVisionLost.push_back(mGameMap->getTile(xxx, yyy));
+    });
+
+    // Notify tiles we gained then lost vision. Vision changes by areas so runs of tiles are much
+    // smaller than the coordinates of each tile
+    mGameMap->tilesToPacket(serverNotification->mPacket, tilesVisionGained);
+    mGameMap->tilesToPacket(serverNotification->mPacket, tilesVisionLost);
     ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
-void Seat::computeSeatBeginTurn()
+void Seat::addNbRooms(RoomType roomType, int nb)
 {
-    if(mPlayer != nullptr)
+    uint32_t index = static_cast<uint32_t>(roomType);
+    if(index >= mNbRooms.size())
     {
-        std::fill(mNbRooms.begin(), mNbRooms.end(), 0);
-        for(Room* room : mGameMap->getRooms())
-        {
-            if(room->getSeat() != this)
-                continue;
-
-            if(room->getHP(nullptr) <= 0.0)
-                continue;
-
-            uint32_t index = static_cast<uint32_t>(room->getType());
-            if(index >= mNbRooms.size())
-            {
-                OD_LOG_ERR("wrong index=" + Helper::toString(index) + ", size=" + Helper::toString(mNbRooms.size()));
-                return;
-            }
-            ++mNbRooms[index];
-        }
+        OD_LOG_ERR("wrong index=" + Helper::toString(index) + ", size=" + Helper::toString(mNbRooms.size()));
+        return;
     }
+    mNbRooms[index] += nb;
 }
 
 
@@ -836,8 +816,7 @@ Seat* Seat::createRogueSeat(GameMap* gameMap)
     seat->mPlayerType = PLAYER_TYPE_INACTIVE;
     seat->mStartingX = 0;
     seat->mStartingY = 0;
-    seat->mGold = 0;
-    seat->mGoldMax = 0;
+    seat->mStartingGold = 0;
     seat->mGoldMined = 0;
     seat->mColorId = "0";
     seat->mMana = 0;
@@ -939,7 +918,7 @@ bool Seat::importSeatFromStream(std::istream& is)
         OD_LOG_INF("WARNING: expected gold and read " + str);
         return false;
     }
-    OD_ASSERT_TRUE(is >> mGold);
+    OD_ASSERT_TRUE(is >> mStartingGold);
 
     OD_ASSERT_TRUE(is >> str);
     if(str != "goldMined")
@@ -1181,7 +1160,7 @@ bool Seat::exportSeatToStream(std::ostream& os) const
     os << std::endl;
 
     os << "gold\t";
-    os << mGold;
+    os << mStartingGold;
     os << std::endl;
 
     os << "goldMined\t";
@@ -1627,7 +1606,7 @@ void Seat::setVisibleBuildingOnTile(Building* building, Tile* tile)
     tileState.mSeatIdOwner = building->getSeat()->getId();
 }
 
-void Seat::exportTileToPacket(ODPacket& os, const Tile* tile) const
+void Seat::exportTileToPacket(ODPacket& os, const Tile* tile, bool isAsync) const
 {
     if(getPlayer() == nullptr)
     {
@@ -1712,16 +1691,31 @@ void Seat::exportTileToPacket(ODPacket& os, const Tile* tile) const
                 refundPriceTrap = (TrapManager::costPerTile(trap->getType()) / 2);
         }
     }
-    os << isRoom;
-    os << isTrap;
-    os << refundPriceRoom;
-    os << refundPriceTrap;
-    os << displayTileMesh;
-    os << colorCustomMesh;
-    os << hasBridge;
-    os << tileSeatId;
-    os << meshName;
-    os << tileState.mTileVisual;
+
+    TileRefreshState state;
+    state.mIsRoom = isRoom;
+    state.mIsTrap = isTrap;
+    state.mRefundPriceRoom = refundPriceRoom;
+    state.mRefundPriceTrap = refundPriceTrap;
+    state.mDisplayTileMesh = displayTileMesh;
+    state.mColorCustomMesh = colorCustomMesh;
+    state.mHasBridge = hasBridge;
+    state.mSeatId = tileSeatId;
+    state.mMeshName = meshName;
+    state.mTileVisual = tileState.mTileVisual;
+
+    TileRefreshState& refreshSent = mTilesRefreshSent[tile->getX()][tile->getY()];
+    state.exportToPacket(os, refreshSent, isAsync, mTileMeshNames);
+
+    // An async refresh may be received before the queued ones. In that case, the client could end up with
+    // fields from an older refresh. To fix that, the next refresh will also be complete
+    if(isAsync)
+        refreshSent.mIsSent = false;
+}
+
+uint8_t Seat::importTileFromPacket(ODPacket& is, TileRefreshState& state)
+{
+    return state.importFromPacket(is, mTileMeshNames);
 }
 
 void Seat::notifyBuildingRemovedFromGameMap(Building* building, Tile* tile)
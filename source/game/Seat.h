@@ -19,6 +19,8 @@
 #define SEAT_H
 
 #include "game/SeatData.h"
+#include "gamemap/TileBitmap.h"
+#include "network/TilePacket.h"
 
 #include <OgreVector3.h>
 #include <OgreColourValue.h>
@@ -54,8 +56,8 @@ public:
     TileVisual mTileVisual;
     int mSeatIdOwner;
     bool mMarkedForDigging;
-    bool mVisionTurnLast;
-    bool mVisionTurnCurrent;
+    //! \brief true if the tile was given vision until the next upkeep (see Seat::notifyTileClaimedByEnemy)
+    bool mVisionTemporary;
     Building* mBuilding;
 };
 
@@ -156,6 +158,10 @@ public:
     inline int getGoldMined() const
     { return mGoldMined; }
 
+    //! \brief Gold given to the seat when the game starts (read from the level file)
+    inline int getStartingGold() const
+    { return mStartingGold; }
+
     inline bool getKoCreatures() const
     { return mKoCreatures; }
 
@@ -200,8 +206,14 @@ public:
     bool canOwnedCreatureUseRoomFrom(const Seat* seat) const;
     bool canBuildingBeDestroyedBy(const Seat* seat) const;
 
-    void clearTilesWithVision();
+    //! \brief Removes the vision given by notifyTileClaimedByEnemy. Called at each upkeep before vision is updated
+    void clearTemporaryVision();
+
+    //! \brief Called by the tiles when this seat gains or loses vision on them. The tiles keep the count of the
+    //! viewers of each seat so these are only called when the count goes from 0 to 1 or from 1 to 0
     void notifyVisionOnTile(Tile* tile);
+    void notifyVisionLostOnTile(Tile* tile);
+
     void notifyTileClaimedByEnemy(Tile* tile);
 
     //! \brief Returns true if this seat can see the given tile and false otherwise
@@ -225,7 +237,24 @@ public:
     inline const std::vector<Seat*>& getAlliedSeats()
     { return mAlliedSeats; }
 
-    void computeSeatBeginTurn();
+    //! \brief Functions used on server side by the creatures and the rooms to keep the seat counts up to
+    //! date when they are added, removed or change (see Creature::updateSeatCreaturesCount and
+    //! Room::updateSeatRoomsCount)
+    inline void addNumCreatures(bool isWorker, int nb)
+    {
+        if(isWorker)
+            mNumCreaturesWorkers += nb;
+        else
+            mNumCreaturesFighters += nb;
+    }
+
+    void addNbRooms(RoomType roomType, int nb);
+
+    inline void addGold(int gold, int goldMax)
+    {
+        mGold += gold;
+        mGoldMax += goldMax;
+    }
 
     //! \brief Gets whether a skill is being done
     bool isSkilling() const
@@ -294,9 +323,15 @@ public:
     void setPlayerSettings(bool koCreatures);
 
     /*! \brief Exports the tile data to the packet so that the client associated to the seat have the needed information
-     *         to display the tile correctly
+     *         to display the tile correctly. Only the fields that changed since the last refresh sent are exported.
+     *         isAsync should be true if the packet is sent with ODServer::sendAsyncMsg. As it may reach the client before
+     *         refreshes already queued, every field is exported and the next refresh will be complete too
      */
-    void exportTileToPacket(ODPacket& os, const Tile* tile) const;
+    void exportTileToPacket(ODPacket& os, const Tile* tile, bool isAsync) const;
+
+    //! \brief Used on client side to read the tile data written by exportTileToPacket. Returns the TileRefreshField
+    //! mask of the fields read into state
+    uint8_t importTileFromPacket(ODPacket& is, TileRefreshState& state);
 
     static bool sortForMapSave(Seat* s1, Seat* s2);
 
@@ -331,6 +366,9 @@ private:
     //! \brief The total amount of gold coins mined by workers under this seat's control.
     int mGoldMined;
 
+    //! \brief The gold read from the level file. It is deposited in the seat rooms when the game starts
+    int mStartingGold;
+
     //! \brief The actual color that this color index translates into.
     Ogre::ColourValue mColorValue;
 
@@ -359,6 +397,27 @@ private:
     //! state (last tile state notified, vision last turn for this seat, vision for current turn, ...
     std::vector<std::vector<TileStateNotified>> mTilesStates;
 
+    //! \brief Last refresh sent to the player for each tile (same indexes as mTilesStates). It is updated by
+    //! exportTileToPacket, hence mutable
+    mutable std::vector<std::vector<TileRefreshState>> mTilesRefreshSent;
+
+    //! \brief Tile mesh names sent to the player (on server side) or received (on client side). It is updated
+    //! by exportTileToPacket, hence mutable
+    mutable TileMeshNames mTileMeshNames;
+
+    //! \brief Current vision. Updated each time a tile gains or loses vision for the seat. Used for human players seats only
+    TileBitmap mVisionCurrent;
+
+    //! \brief Vision sent to the player by the last sendVisibleTiles
+    TileBitmap mVisionLast;
+
+    //! \brief Buffers used by sendVisibleTiles to compute the tiles where vision changed
+    TileBitmap mVisionGained;
+    TileBitmap mVisionLost;
+
+    //! \brief Tiles with mVisionTemporary set. Used for human players seats only
+    std::vector<Tile*> mTilesVisionTemporary;
+
     std::map<std::pair<int, int>, TileStateNotified> mTilesStateLoaded;
 
     std::vector<Tile*> mVisualDebugEntityTiles;
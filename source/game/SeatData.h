@@ -57,6 +57,9 @@ public:
     inline void incrementNumClaimedTiles()
     { ++mNumClaimedTiles; }
 
+    inline void decrementNumClaimedTiles()
+    { --mNumClaimedTiles; }
+
     void setTeamId(int teamId);
 
     inline const std::vector<int>& getAvailableTeamIds() const
@@ -97,6 +100,12 @@ public:
 
     uint32_t getNbRooms(RoomType roomType) const;
 
+    inline int getStartingX() const
+    { return mStartingX; }
+
+    inline int getStartingY() const
+    { return mStartingY; }
+
     inline const std::string& getPlayerType() const
     { return mPlayerType; }
 
@@ -147,7 +156,7 @@ protected:
     //! \brief Team ids this seat can use defined in the level file.
     std::vector<int> mAvailableTeamIds;
 
-    //! \brief How many tiles have been claimed by this seat, updated in GameMap::doTurn().
+    //! \brief How many tiles have been claimed by this seat, updated by the tiles when their claim state changes (see Tile::updateClaimedTilesCount).
     unsigned int mNumClaimedTiles;
 
     bool mHasGoalsChanged;
@@ -0,0 +1,151 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/AstarNodePool.h"
+
+#include <cassert>
+
+const uint32_t AstarNodePool::NO_NODE = 0xFFFFFFFF;
+
+AstarNodePool::AstarNodePool() :
+    mMapSizeX(0),
+    mMapSizeY(0),
+    mGeneration(0),
+    mNbInserted(0)
+{
+}
+
+void AstarNodePool::startSearch(int mapSizeX, int mapSizeY)
+{
+    mOpenHeap.clear();
+    mNbInserted = 0;
+
+    if((mapSizeX != mMapSizeX) || (mapSizeY != mMapSizeY))
+    {
+        mMapSizeX = mapSizeX;
+        mMapSizeY = mapSizeY;
+        AstarNode node;
+        node.mGeneration = 0;
+        node.mGoalGeneration = 0;
+        node.mState = NodeState::open;
+        node.mParent = NO_NODE;
+        node.mHeapPos = 0;
+        node.mInsertionOrder = 0;
+        node.mG = 0.0;
+        node.mH = 0.0;
+        mNodes.assign(static_cast<uint32_t>(mMapSizeX * mMapSizeY), node);
+        mGeneration = 0;
+    }
+
+    ++mGeneration;
+    // If the generation counter wraps, old nodes could be seen as part of the current
+    // search. In this case, we reset them
+    if(mGeneration == 0)
+    {
+        for(AstarNode& node : mNodes)
+        {
+            node.mGeneration = 0;
+            node.mGoalGeneration = 0;
+        }
+
+        mGeneration = 1;
+    }
+}
+
+void AstarNodePool::pushOpen(uint32_t index, double g, double h, uint32_t parent)
+{
+    assert(index < mNodes.size());
+    AstarNode& node = mNodes[index];
+    node.mGeneration = mGeneration;
+    node.mState = NodeState::open;
+    node.mParent = parent;
+    node.mInsertionOrder = mNbInserted++;
+    node.mG = g;
+    node.mH = h;
+    node.mHeapPos = static_cast<uint32_t>(mOpenHeap.size());
+    mOpenHeap.push_back(index);
+    siftUp(node.mHeapPos);
+}
+
+void AstarNodePool::decreaseG(uint32_t index, double g, uint32_t parent)
+{
+    assert(isOpen(index));
+    AstarNode& node = mNodes[index];
+    node.mG = g;
+    node.mParent = parent;
+    siftUp(node.mHeapPos);
+}
+
+uint32_t AstarNodePool::popOpen()
+{
+    assert(!mOpenHeap.empty());
+    uint32_t index = mOpenHeap.front();
+    uint32_t last = mOpenHeap.back();
+    mOpenHeap.pop_back();
+    if(!mOpenHeap.empty())
+    {
+        mOpenHeap[0] = last;
+        mNodes[last].mHeapPos = 0;
+        siftDown(0);
+    }
+
+    mNodes[index].mState = NodeState::closed;
+    return index;
+}
+
+void AstarNodePool::siftUp(uint32_t heapPos)
+{
+    uint32_t index = mOpenHeap[heapPos];
+    while(heapPos > 0)
+    {
+        uint32_t parentPos = (heapPos - 1) / 2;
+        uint32_t parentIndex = mOpenHeap[parentPos];
+        if(!isBefore(index, parentIndex))
+            break;
+
+        mOpenHeap[heapPos] = parentIndex;
+        mNodes[parentIndex].mHeapPos = heapPos;
+        heapPos = parentPos;
+    }
+    mOpenHeap[heapPos] = index;
+    mNodes[index].mHeapPos = heapPos;
+}
+
+void AstarNodePool::siftDown(uint32_t heapPos)
+{
+    uint32_t size = static_cast<uint32_t>(mOpenHeap.size());
+    uint32_t index = mOpenHeap[heapPos];
+    while(true)
+    {
+        uint32_t childPos = heapPos * 2 + 1;
+        if(childPos >= size)
+            break;
+
+        if((childPos + 1 < size) && isBefore(mOpenHeap[childPos + 1], mOpenHeap[childPos]))
+            ++childPos;
+
+        uint32_t childIndex = mOpenHeap[childPos];
+        if(!isBefore(childIndex, index))
+            break;
+
+        mOpenHeap[heapPos] = childIndex;
+        mNodes[childIndex].mHeapPos = heapPos;
+        heapPos = childPos;
+    }
+    mOpenHeap[heapPos] = index;
+    mNodes[index].mHeapPos = heapPos;
+}
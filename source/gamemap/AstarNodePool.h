@@ -0,0 +1,139 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASTARNODEPOOL_H
+#define ASTARNODEPOOL_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Node storage and open set used by the A* search in GameMap::path.
+ *
+ * There is one node per map tile (index = x * mapSizeY + y). Nodes are not cleared between
+ * searches: each search bumps a generation counter and a node only belongs to the current
+ * search if its generation matches. That way, starting a search is O(1) and checking if a tile
+ * is in the open or closed set does not need any lookup.
+ *
+ * The open set is a binary heap of node indexes where each node knows its position in the heap
+ * so that its cost can be decreased in place. Nodes with the same cost are ordered by insertion
+ * order. That is the order the former linear search used so paths are the same.
+ *
+ * The A* description can be found here:
+ * http://en.wikipedia.org/wiki/A*_search_algorithm
+ */
+class AstarNodePool
+{
+public:
+    AstarNodePool();
+
+    static const uint32_t NO_NODE;
+
+    //! \brief Prepares the pool for a new search on a map with the given size. The node array is only
+    //! reallocated if the map size changed.
+    void startSearch(int mapSizeX, int mapSizeY);
+
+    inline uint32_t getIndex(int x, int y) const
+    { return static_cast<uint32_t>(x * mMapSizeY + y); }
+
+    inline int getX(uint32_t index) const
+    { return static_cast<int>(index) / mMapSizeY; }
+
+    inline int getY(uint32_t index) const
+    { return static_cast<int>(index) % mMapSizeY; }
+
+    inline bool isOpen(uint32_t index) const
+    { return (mNodes[index].mGeneration == mGeneration) && (mNodes[index].mState == NodeState::open); }
+
+    inline bool isClosed(uint32_t index) const
+    { return (mNodes[index].mGeneration == mGeneration) && (mNodes[index].mState == NodeState::closed); }
+
+    inline bool isOpenEmpty() const
+    { return mOpenHeap.empty(); }
+
+    inline double getG(uint32_t index) const
+    { return mNodes[index].mG; }
+
+    inline uint32_t getParent(uint32_t index) const
+    { return mNodes[index].mParent; }
+
+    //! \brief Marks the given node as a destination of the current search. Must be called after startSearch.
+    inline void setGoal(uint32_t index)
+    { mNodes[index].mGoalGeneration = mGeneration; }
+
+    inline bool isGoal(uint32_t index) const
+    { return mNodes[index].mGoalGeneration == mGeneration; }
+
+    //! \brief Adds the given node to the open set. The node must not be part of the current search yet.
+    void pushOpen(uint32_t index, double g, double h, uint32_t parent);
+
+    //! \brief Lowers the cost of a node already in the open set and changes its parent.
+    void decreaseG(uint32_t index, double g, uint32_t parent);
+
+    //! \brief Removes the node with the lowest cost from the open set, moves it to the closed set
+    //! and returns its index. The open set must not be empty.
+    uint32_t popOpen();
+
+private:
+    enum class NodeState : uint8_t
+    {
+        open,
+        closed
+    };
+
+    struct AstarNode
+    {
+        uint32_t mGeneration;
+        //! \brief Generation of the last search the node was a destination of
+        uint32_t mGoalGeneration;
+        NodeState mState;
+        uint32_t mParent;
+        uint32_t mHeapPos;
+        uint32_t mInsertionOrder;
+        double mG;
+        double mH;
+    };
+
+    int mMapSizeX;
+    int mMapSizeY;
+
+    //! \brief Current search generation. Nodes with another generation are considered unvisited
+    uint32_t mGeneration;
+
+    //! \brief Number of nodes pushed during the current search. Used to break ties in the open set
+    uint32_t mNbInserted;
+
+    std::vector<AstarNode> mNodes;
+    std::vector<uint32_t> mOpenHeap;
+
+    //! \brief Returns true if node1 should be expanded before node2
+    inline bool isBefore(uint32_t index1, uint32_t index2) const
+    {
+        const AstarNode& node1 = mNodes[index1];
+        const AstarNode& node2 = mNodes[index2];
+        double f1 = node1.mG + node1.mH;
+        double f2 = node2.mG + node2.mH;
+        if(f1 != f2)
+            return f1 < f2;
+
+        return node1.mInsertionOrder < node2.mInsertionOrder;
+    }
+
+    void siftUp(uint32_t heapPos);
+    void siftDown(uint32_t heapPos);
+};
+
+#endif // ASTARNODEPOOL_H
@@ -0,0 +1,262 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/DistanceFieldCache.h"
+
+const uint32_t DistanceFieldCache::UNREACHABLE = 0xFFFFFFFF;
+
+DistanceFieldCache::DistanceFieldCache() :
+    mMapSizeX(0),
+    mMapSizeY(0),
+    mMaxFields(0),
+    mUseCounter(0),
+    mNbFieldsComputed(0)
+{
+}
+
+void DistanceFieldCache::setup(int mapSizeX, int mapSizeY, uint32_t maxFields)
+{
+    clear();
+    mMapSizeX = mapSizeX;
+    mMapSizeY = mapSizeY;
+    mMaxFields = maxFields;
+}
+
+void DistanceFieldCache::clear()
+{
+    mMapSizeX = 0;
+    mMapSizeY = 0;
+    mMaxFields = 0;
+    mUseCounter = 0;
+    mNbFieldsComputed = 0;
+    mFields.clear();
+    mQueue.clear();
+}
+
+const std::vector<uint32_t>& DistanceFieldCache::getField(int seatId, uint32_t layer, const std::string& targetName,
+    const std::vector<uint32_t>& targetTiles, const PassabilityFunction& passabilityFunction)
+{
+    ++mUseCounter;
+    DistanceField* leastRecentlyUsed = nullptr;
+    for(DistanceField& field : mFields)
+    {
+        if((field.mSeatId == seatId) &&
+           (field.mLayer == layer) &&
+           (field.mTargetName == targetName))
+        {
+            field.mLastUse = mUseCounter;
+            if(field.mIsDirty)
+                computeField(field, targetTiles, passabilityFunction);
+
+            return field.mDistances;
+        }
+
+        if((leastRecentlyUsed == nullptr) || (field.mLastUse < leastRecentlyUsed->mLastUse))
+            leastRecentlyUsed = &field;
+    }
+
+    // The field does not exist yet. If there is no room left, we reuse the least recently used one
+    DistanceField* field;
+    if((leastRecentlyUsed != nullptr) && (mFields.size() >= mMaxFields))
+    {
+        field = leastRecentlyUsed;
+    }
+    else
+    {
+        mFields.emplace_back();
+        field = &mFields.back();
+    }
+
+    field->mSeatId = seatId;
+    field->mLayer = layer;
+    field->mTargetName = targetName;
+    field->mLastUse = mUseCounter;
+    computeField(*field, targetTiles, passabilityFunction);
+    return field->mDistances;
+}
+
+void DistanceFieldCache::markTileChanged(int x, int y)
+{
+    for(DistanceField& field : mFields)
+    {
+        if(field.mIsDirty)
+            continue;
+
+        // If a tile next to the changed one is reached, the changed tile may open (or close) a shorter way
+        if(isReached(field, x, y) ||
+           isReached(field, x - 1, y) ||
+           isReached(field, x + 1, y) ||
+           isReached(field, x, y - 1) ||
+           isReached(field, x, y + 1))
+        {
+            field.mIsDirty = true;
+        }
+    }
+}
+
+bool DistanceFieldCache::followField(const std::vector<uint32_t>& field, int x, int y, std::vector<uint32_t>& path) const
+{
+    path.clear();
+    if((x < 0) || (x >= mMapSizeX) || (y < 0) || (y >= mMapSizeY))
+        return false;
+
+    static const int NEIGHBOURS_X[4] = {-1, 1, 0, 0};
+    static const int NEIGHBOURS_Y[4] = {0, 0, -1, 1};
+
+    uint32_t index = static_cast<uint32_t>(x * mMapSizeY + y);
+    if(field[index] == UNREACHABLE)
+    {
+        // We start from the closest reached neighbour
+        path.push_back(index);
+        uint32_t bestIndex = UNREACHABLE;
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            int neighX = x + NEIGHBOURS_X[i];
+            int neighY = y + NEIGHBOURS_Y[i];
+            if((neighX < 0) || (neighX >= mMapSizeX) || (neighY < 0) || (neighY >= mMapSizeY))
+                continue;
+
+            uint32_t neighIndex = static_cast<uint32_t>(neighX * mMapSizeY + neighY);
+            if(field[neighIndex] == UNREACHABLE)
+                continue;
+
+            if((bestIndex == UNREACHABLE) || (field[neighIndex] < field[bestIndex]))
+                bestIndex = neighIndex;
+        }
+
+        if(bestIndex == UNREACHABLE)
+        {
+            path.clear();
+            return false;
+        }
+
+        index = bestIndex;
+        x = static_cast<int>(index) / mMapSizeY;
+        y = static_cast<int>(index) % mMapSizeY;
+    }
+
+    path.push_back(index);
+    while(field[index] > 0)
+    {
+        uint32_t distance = field[index];
+        // Diagonals first: we can go there if both tiles next to the diagonal are 1 step closer to the target
+        bool found = false;
+        for(int diagX = -1; (diagX <= 1) && !found; diagX += 2)
+        {
+            for(int diagY = -1; (diagY <= 1) && !found; diagY += 2)
+            {
+                int neighX = x + diagX;
+                int neighY = y + diagY;
+                if((neighX < 0) || (neighX >= mMapSizeX) || (neighY < 0) || (neighY >= mMapSizeY))
+                    continue;
+
+                uint32_t neighIndex = static_cast<uint32_t>(neighX * mMapSizeY + neighY);
+                if((distance < 2) || (field[neighIndex] != distance - 2))
+                    continue;
+
+                if((field[neighX * mMapSizeY + y] != distance - 1) ||
+                   (field[x * mMapSizeY + neighY] != distance - 1))
+                {
+                    continue;
+                }
+
+                found = true;
+                index = neighIndex;
+            }
+        }
+
+        for(uint32_t i = 0; (i < 4) && !found; ++i)
+        {
+            int neighX = x + NEIGHBOURS_X[i];
+            int neighY = y + NEIGHBOURS_Y[i];
+            if((neighX < 0) || (neighX >= mMapSizeX) || (neighY < 0) || (neighY >= mMapSizeY))
+                continue;
+
+            uint32_t neighIndex = static_cast<uint32_t>(neighX * mMapSizeY + neighY);
+            if(field[neighIndex] != distance - 1)
+                continue;
+
+            found = true;
+            index = neighIndex;
+        }
+
+        // A reached tile always has a neighbour 1 step closer. If not, the field is broken
+        if(!found)
+        {
+            path.clear();
+            return false;
+        }
+
+        x = static_cast<int>(index) / mMapSizeY;
+        y = static_cast<int>(index) % mMapSizeY;
+        path.push_back(index);
+    }
+
+    return true;
+}
+
+void DistanceFieldCache::computeField(DistanceField& field, const std::vector<uint32_t>& targetTiles,
+    const PassabilityFunction& passabilityFunction)
+{
+    ++mNbFieldsComputed;
+    field.mIsDirty = false;
+    uint32_t nbTiles = static_cast<uint32_t>(mMapSizeX * mMapSizeY);
+    field.mDistances.assign(nbTiles, UNREACHABLE);
+
+    mQueue.clear();
+    for(uint32_t index : targetTiles)
+    {
+        if(index >= nbTiles)
+            continue;
+
+        if(field.mDistances[index] != UNREACHABLE)
+            continue;
+
+        if(!passabilityFunction(static_cast<int>(index) / mMapSizeY, static_cast<int>(index) % mMapSizeY))
+            continue;
+
+        field.mDistances[index] = 0;
+        mQueue.push_back(index);
+    }
+
+    static const int NEIGHBOURS_X[4] = {-1, 1, 0, 0};
+    static const int NEIGHBOURS_Y[4] = {0, 0, -1, 1};
+    for(uint32_t queueIndex = 0; queueIndex < mQueue.size(); ++queueIndex)
+    {
+        uint32_t index = mQueue[queueIndex];
+        int x = static_cast<int>(index) / mMapSizeY;
+        int y = static_cast<int>(index) % mMapSizeY;
+        uint32_t distance = field.mDistances[index] + 1;
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            int neighX = x + NEIGHBOURS_X[i];
+            int neighY = y + NEIGHBOURS_Y[i];
+            if((neighX < 0) || (neighX >= mMapSizeX) || (neighY < 0) || (neighY >= mMapSizeY))
+                continue;
+
+            uint32_t neighIndex = static_cast<uint32_t>(neighX * mMapSizeY + neighY);
+            if(field.mDistances[neighIndex] != UNREACHABLE)
+                continue;
+
+            if(!passabilityFunction(neighX, neighY))
+                continue;
+
+            field.mDistances[neighIndex] = distance;
+            mQueue.push_back(neighIndex);
+        }
+    }
+}
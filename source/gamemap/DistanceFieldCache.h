@@ -0,0 +1,122 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DISTANCEFIELDCACHE_H
+#define DISTANCEFIELDCACHE_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*! \brief Cache of distance fields towards the buildings creatures often walk to (dungeon temple, portal, ...).
+ *
+ * A distance field gives, for each tile of the map, the walking distance to the closest tile of a target. It
+ * is computed once with a breadth first search starting from the target tiles. Then, any creature can find
+ * its path to the target by following the decreasing distances from its position instead of running an A*
+ * search. Fields are identified by the seat, the layer (GameMap uses one layer per FloodFillType) and the
+ * target name because doors and floodfill types do not block the same creatures.
+ *
+ * When a tile passability may have changed, markTileChanged should be called. Only the fields that reached
+ * that tile (or one of its neighbours) are recomputed (lazily, when they are used again). The number of fields
+ * kept is limited. When the limit is reached, the least recently used one is dropped.
+ *
+ * Like in PathClusterGraph, distances are counted in 4-neighbour moves which is what GameMap::path computes
+ * for a creature with an uniform speed (diagonals cost as much as 2 straight moves).
+ */
+class DistanceFieldCache
+{
+public:
+    //! \brief Should return true if the tile at the given position is passable for the field being computed
+    typedef std::function<bool(int x, int y)> PassabilityFunction;
+
+    //! \brief Distance of the tiles that cannot reach the target
+    static const uint32_t UNREACHABLE;
+
+    DistanceFieldCache();
+
+    //! \brief Releases all the fields. maxFields is the number of fields kept at the same time
+    void setup(int mapSizeX, int mapSizeY, uint32_t maxFields);
+
+    //! \brief Releases all the fields
+    void clear();
+
+    inline int getMapSizeX() const
+    { return mMapSizeX; }
+
+    inline int getMapSizeY() const
+    { return mMapSizeY; }
+
+    //! \brief Returns the distance field identified by the given parameters. If it does not exist or if it needs
+    //! to be recomputed, it is computed from the given target tiles (indexed by x * mapSizeY + y) and the given
+    //! passability. Not passable targets are ignored. The returned vector is indexed like the tiles and is valid
+    //! until the next call to a non const function
+    const std::vector<uint32_t>& getField(int seatId, uint32_t layer, const std::string& targetName,
+        const std::vector<uint32_t>& targetTiles, const PassabilityFunction& passabilityFunction);
+
+    //! \brief Marks the fields going through the given tile as needing to be recomputed. That should be
+    //! called each time a tile passability may have changed (dug, claimed, door locked, ...)
+    void markTileChanged(int x, int y);
+
+    /*! \brief Fills path with the tiles (indexed by x * mapSizeY + y) from (x, y) to the closest target of
+     * the given field by following the decreasing distances. If the start tile was not reached by the
+     * field (it can happen on a closed door), the path starts with it and goes on with its closest neighbour.
+     * Diagonal moves are used when both tiles next to the diagonal are reachable.
+     * Returns false if no target can be reached from (x, y).
+     */
+    bool followField(const std::vector<uint32_t>& field, int x, int y, std::vector<uint32_t>& path) const;
+
+    //! \brief Returns the number of fields computed since the cache was set up. Used for tests
+    inline uint32_t getNbFieldsComputed() const
+    { return mNbFieldsComputed; }
+
+private:
+    struct DistanceField
+    {
+        int mSeatId;
+        uint32_t mLayer;
+        std::string mTargetName;
+        bool mIsDirty;
+        //! \brief Value of mUseCounter the last time the field was used
+        uint64_t mLastUse;
+        std::vector<uint32_t> mDistances;
+    };
+
+    int mMapSizeX;
+    int mMapSizeY;
+    uint32_t mMaxFields;
+    uint64_t mUseCounter;
+    uint32_t mNbFieldsComputed;
+    std::vector<DistanceField> mFields;
+
+    //! \brief Scratch buffer for the breadth first search
+    std::vector<uint32_t> mQueue;
+
+    void computeField(DistanceField& field, const std::vector<uint32_t>& targetTiles,
+        const PassabilityFunction& passabilityFunction);
+
+    inline bool isReached(const DistanceField& field, int x, int y) const
+    {
+        if((x < 0) || (x >= mMapSizeX) || (y < 0) || (y >= mMapSizeY))
+            return false;
+
+        return field.mDistances[x * mMapSizeY + y] != UNREACHABLE;
+    }
+};
+
+#endif // DISTANCEFIELDCACHE_H
@@ -0,0 +1,82 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTITYNAMEINDEX_H
+#define ENTITYNAMEINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/*! \brief Hash index of entities by name. GameMap keeps one per entity list so that the lookups by name
+ * (used by most network messages) do not go through the whole list.
+ * Names are supposed to be unique but some entities may share a name for a while (for example, the creatures
+ * loaded with the name "autoname" until they are given a real one). That is why several entities can be indexed
+ * with the same name. In that case, find returns one of them.
+ * T should have a getName() method returning the name the entity was indexed with.
+ */
+template<typename T>
+class EntityNameIndex
+{
+public:
+    void add(T* entity)
+    {
+        mEntities.emplace(entity->getName(), entity);
+    }
+
+    //! \brief Removes the entity indexed with the given name. Returns false if it was not there
+    bool remove(T* entity, const std::string& name)
+    {
+        auto range = mEntities.equal_range(name);
+        for(auto it = range.first; it != range.second; ++it)
+        {
+            if(it->second != entity)
+                continue;
+
+            mEntities.erase(it);
+            return true;
+        }
+
+        return false;
+    }
+
+    inline bool remove(T* entity)
+    { return remove(entity, entity->getName()); }
+
+    //! \brief Returns the entity with the given name or nullptr if there is none
+    T* find(const std::string& name) const
+    {
+        auto it = mEntities.find(name);
+        if(it == mEntities.end())
+            return nullptr;
+
+        return it->second;
+    }
+
+    void clear()
+    {
+        mEntities.clear();
+    }
+
+    inline uint32_t size() const
+    { return static_cast<uint32_t>(mEntities.size()); }
+
+private:
+    std::unordered_multimap<std::string, T*> mEntities;
+};
+
+#endif // ENTITYNAMEINDEX_H
@@ -0,0 +1,116 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ENTITYSLOTLIST_H
+#define ENTITYSLOTLIST_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/*! \brief List of entities that can be added, removed and searched in constant time while keeping the order
+ * they were added in. GameMap uses it for the active objects that get their upkeep each turn.
+ * Removed entities leave an empty slot (nullptr) so that the other entities keep their index. The empty
+ * slots are dropped by compact once they are numerous enough, which keeps the removals constant time
+ * on average. As the iteration order only depends on the order of the additions, it is deterministic.
+ * An entity can only be in the list once.
+ */
+template<typename T>
+class EntitySlotList
+{
+public:
+    EntitySlotList() :
+        mNbEmptySlots(0)
+    {}
+
+    //! \brief Adds the entity at the end of the list. Returns false if it was already in the list
+    bool add(T* entity)
+    {
+        if(!mIndexes.emplace(entity, static_cast<uint32_t>(mSlots.size())).second)
+            return false;
+
+        mSlots.push_back(entity);
+        return true;
+    }
+
+    //! \brief Empties the slot of the given entity. Returns false if it was not in the list
+    bool remove(T* entity)
+    {
+        auto it = mIndexes.find(entity);
+        if(it == mIndexes.end())
+            return false;
+
+        mSlots[it->second] = nullptr;
+        mIndexes.erase(it);
+        ++mNbEmptySlots;
+        return true;
+    }
+
+    inline bool contains(T* entity) const
+    { return mIndexes.count(entity) > 0; }
+
+    /*! \brief Drops the empty slots if there are at least as many as entities. Calling it after each
+     * batch of removals keeps the list size under twice the number of entities.
+     * The index of the entities may change so it should not be called while iterating
+     */
+    void compact()
+    {
+        if(mNbEmptySlots == 0)
+            return;
+
+        if(mNbEmptySlots < mIndexes.size())
+            return;
+
+        uint32_t nbSlots = 0;
+        for(T* entity : mSlots)
+        {
+            if(entity == nullptr)
+                continue;
+
+            mIndexes[entity] = nbSlots;
+            mSlots[nbSlots] = entity;
+            ++nbSlots;
+        }
+        mSlots.resize(nbSlots);
+        mNbEmptySlots = 0;
+    }
+
+    void clear()
+    {
+        mSlots.clear();
+        mIndexes.clear();
+        mNbEmptySlots = 0;
+    }
+
+    //! \brief Slots of the list in the order entities were added. Removed entities are nullptr until compact is called
+    inline const std::vector<T*>& getSlots() const
+    { return mSlots; }
+
+    //! \brief Number of entities in the list
+    inline uint32_t size() const
+    { return static_cast<uint32_t>(mIndexes.size()); }
+
+    inline bool empty() const
+    { return mIndexes.empty(); }
+
+private:
+    std::vector<T*> mSlots;
+    std::unordered_map<T*, uint32_t> mIndexes;
+    uint32_t mNbEmptySlots;
+};
+
+#endif // ENTITYSLOTLIST_H
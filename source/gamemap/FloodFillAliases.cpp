@@ -0,0 +1,103 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/FloodFillAliases.h"
+
+void FloodFillAliases::clear()
+{
+    mParents.clear();
+    mIsFlat = true;
+}
+
+uint32_t FloodFillAliases::resolve(uint32_t teamIndex, uint32_t color)
+{
+    if(teamIndex >= mParents.size())
+        return color;
+
+    std::vector<uint32_t>& parents = mParents[teamIndex];
+    if(color >= parents.size())
+        return color;
+
+    // Path halving: each visited color is linked to its grand parent so that next
+    // resolutions are faster. Nothing is written if the parent is already the root
+    while(parents[color] != color)
+    {
+        uint32_t grandParent = parents[parents[color]];
+        if(parents[color] != grandParent)
+            parents[color] = grandParent;
+
+        color = parents[color];
+    }
+
+    return color;
+}
+
+void FloodFillAliases::flatten()
+{
+    if(mIsFlat)
+        return;
+
+    for(std::vector<uint32_t>& parents : mParents)
+    {
+        // Every color on the path to the root is linked to the root
+        for(uint32_t color = 0; color < parents.size(); ++color)
+        {
+            uint32_t root = color;
+            while(parents[root] != root)
+                root = parents[root];
+
+            uint32_t current = color;
+            while(parents[current] != root)
+            {
+                uint32_t next = parents[current];
+                parents[current] = root;
+                current = next;
+            }
+        }
+    }
+
+    mIsFlat = true;
+}
+
+void FloodFillAliases::merge(uint32_t teamIndex, uint32_t colorOld, uint32_t colorNew)
+{
+    // 0 is Tile::NO_FLOODFILL
+    if((colorOld == 0) || (colorNew == 0))
+        return;
+
+    colorOld = resolve(teamIndex, colorOld);
+    colorNew = resolve(teamIndex, colorNew);
+    if(colorOld == colorNew)
+        return;
+
+    if(teamIndex >= mParents.size())
+        mParents.resize(teamIndex + 1);
+
+    std::vector<uint32_t>& parents = mParents[teamIndex];
+    uint32_t maxColor = (colorOld > colorNew) ? colorOld : colorNew;
+    if(maxColor >= parents.size())
+    {
+        uint32_t oldSize = static_cast<uint32_t>(parents.size());
+        parents.resize(maxColor + 1);
+        for(uint32_t color = oldSize; color <= maxColor; ++color)
+            parents[color] = color;
+    }
+
+    // colorNew stays the root because callers may keep on comparing tile colors with it
+    parents[colorOld] = colorNew;
+    mIsFlat = false;
+}
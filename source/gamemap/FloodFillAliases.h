@@ -0,0 +1,65 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLOODFILLALIASES_H
+#define FLOODFILLALIASES_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Union-find structure used to merge floodfill colors without going through all the tiles.
+ *
+ * When 2 floodfilled areas get connected (a wall is dug, a door is unlocked, ...), one of the colors
+ * becomes an alias of the other one. Tiles keep the color they were given and the actual color is
+ * resolved through this table when it is read. There is one table per team because floodfill colors
+ * are copied from a team to the others when the map is loaded and then change independently.
+ *
+ * Colors are the values given by GameMap::nextUniqueFloodFillValue. The color 0 is
+ * Tile::NO_FLOODFILL and is never an alias.
+ */
+class FloodFillAliases
+{
+public:
+    FloodFillAliases() :
+        mIsFlat(true)
+    {}
+
+    //! \brief Forgets all the aliases. Should be called when the floodfill is computed from scratch
+    void clear();
+
+    //! \brief Returns the color the given one is an alias of (or itself if it is not an alias).
+    //! Once flatten has been called (and until the next merge), it does not modify the table and
+    //! can be called from several threads at once.
+    uint32_t resolve(uint32_t teamIndex, uint32_t color);
+
+    //! \brief Links every color directly to the color it resolves to
+    void flatten();
+
+    //! \brief Makes colorOld (and all its aliases) an alias of colorNew for the given team. After that,
+    //! resolve will return the color colorNew resolves to for all of them.
+    void merge(uint32_t teamIndex, uint32_t colorOld, uint32_t colorNew);
+
+private:
+    //! \brief mParents[teamIndex][color] is the color the given one has been merged in. Colors that
+    //! were never merged are their own parent. Colors greater than the vector size were never merged
+    std::vector<std::vector<uint32_t>> mParents;
+
+    //! \brief true if no merge happened since the last call to flatten
+    bool mIsFlat;
+};
+
+#endif // FLOODFILLALIASES_H
@@ -0,0 +1,116 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/FloodFillLabeling.h"
+
+#include <thread>
+
+namespace FloodFillLabeling
+{
+uint32_t labelConnectedTiles(int sizeX, int sizeY, const std::vector<uint8_t>& passable,
+    std::vector<uint32_t>& labels)
+{
+    uint32_t nbTiles = static_cast<uint32_t>(sizeX * sizeY);
+    labels.assign(nbTiles, 0);
+    if(passable.size() < nbTiles)
+        return 0;
+
+    uint32_t nbLabels = 0;
+    std::vector<uint32_t> stack;
+    for(uint32_t startIndex = 0; startIndex < nbTiles; ++startIndex)
+    {
+        if((passable[startIndex] == 0) || (labels[startIndex] != 0))
+            continue;
+
+        ++nbLabels;
+        stack.push_back(startIndex);
+        while(!stack.empty())
+        {
+            uint32_t index = stack.back();
+            stack.pop_back();
+            if(labels[index] != 0)
+                continue;
+
+            // We look for the span of passable tiles containing the current one
+            int x = static_cast<int>(index) / sizeY;
+            int y = static_cast<int>(index) % sizeY;
+            uint32_t columnIndex = static_cast<uint32_t>(x * sizeY);
+            int yMin = y;
+            while((yMin > 0) && (passable[columnIndex + yMin - 1] != 0) && (labels[columnIndex + yMin - 1] == 0))
+                --yMin;
+            int yMax = y;
+            while((yMax < sizeY - 1) && (passable[columnIndex + yMax + 1] != 0) && (labels[columnIndex + yMax + 1] == 0))
+                ++yMax;
+
+            for(int yy = yMin; yy <= yMax; ++yy)
+                labels[columnIndex + yy] = nbLabels;
+
+            // In the neighbour columns, we push the first tile of each span next to this one
+            for(int neighX = x - 1; neighX <= x + 1; neighX += 2)
+            {
+                if((neighX < 0) || (neighX >= sizeX))
+                    continue;
+
+                uint32_t neighColumnIndex = static_cast<uint32_t>(neighX * sizeY);
+                bool isInSpan = false;
+                for(int yy = yMin; yy <= yMax; ++yy)
+                {
+                    uint32_t neighIndex = neighColumnIndex + yy;
+                    if((passable[neighIndex] == 0) || (labels[neighIndex] != 0))
+                    {
+                        isInSpan = false;
+                        continue;
+                    }
+
+                    if(isInSpan)
+                        continue;
+
+                    isInSpan = true;
+                    stack.push_back(neighIndex);
+                }
+            }
+        }
+    }
+
+    return nbLabels;
+}
+
+void labelConnectedTilesParallel(int sizeX, int sizeY, const std::vector<std::vector<uint8_t>>& passables,
+    std::vector<std::vector<uint32_t>>& labels, std::vector<uint32_t>& nbLabels)
+{
+    labels.resize(passables.size());
+    nbLabels.assign(passables.size(), 0);
+    if(passables.empty())
+        return;
+
+    // Each grid is independent. The last one is labelled on the calling thread
+    std::vector<std::thread> threads;
+    for(uint32_t i = 0; i + 1 < passables.size(); ++i)
+    {
+        threads.emplace_back([sizeX, sizeY, i, &passables, &labels, &nbLabels]()
+        {
+            nbLabels[i] = labelConnectedTiles(sizeX, sizeY, passables[i], labels[i]);
+        });
+    }
+
+    uint32_t last = static_cast<uint32_t>(passables.size()) - 1;
+    nbLabels[last] = labelConnectedTiles(sizeX, sizeY, passables[last], labels[last]);
+
+    for(std::thread& thread : threads)
+        thread.join();
+}
+} //namespace FloodFillLabeling
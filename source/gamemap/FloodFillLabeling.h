@@ -0,0 +1,46 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FLOODFILLLABELING_H
+#define FLOODFILLLABELING_H
+
+#include <cstdint>
+#include <vector>
+
+//! \brief Labelling of the connected areas of a map, used to compute the initial floodfill.
+//! Tiles are indexed by x * sizeY + y like in the rest of the gamemap code.
+namespace FloodFillLabeling
+{
+    /*! \brief Gives the same label to all the passable tiles connected through their 4 neighbours.
+     * Each tile is visited a constant number of times: the tiles are filled by spans along the y axis
+     * and only the start of each span in the neighbour columns is pushed to the stack.
+     * \param passable passable[x * sizeY + y] is not 0 if the tile can be walked on
+     * \param labels Filled with 0 for the not passable tiles and with a label from 1 to the returned
+     * value for the others
+     * \returns The number of labels used
+     */
+    uint32_t labelConnectedTiles(int sizeX, int sizeY, const std::vector<uint8_t>& passable,
+        std::vector<uint32_t>& labels);
+
+    /*! \brief Labels several passability grids of the same size at the same time, each one on its own
+     * thread. nbLabels[i] will be the number of labels used for passables[i].
+     */
+    void labelConnectedTilesParallel(int sizeX, int sizeY, const std::vector<std::vector<uint8_t>>& passables,
+        std::vector<std::vector<uint32_t>>& labels, std::vector<uint32_t>& nbLabels);
+}
+
+#endif // FLOODFILLLABELING_H
@@ -38,8 +38,10 @@
 #include "game/Skill.h"
 #include "game/SkillType.h"
 #include "game/Seat.h"
+#include "gamemap/FloodFillLabeling.h"
 #include "gamemap/MapHandler.h"
 #include "gamemap/Pathfinding.h"
+#include "gamemap/TileBitmap.h"
 #include "gamemap/TileSet.h"
 #include "goals/Goal.h"
 #include "modes/ModeManager.h"
@@ -60,6 +62,7 @@
 #include "utils/Helper.h"
 #include "utils/LogManager.h"
 #include "utils/ResourceManager.h"
+#include "utils/ThreadPool.h"
 
 #include <OgreTimer.h>
 
@@ -73,74 +76,22 @@
 
 const std::string DEFAULT_NICK = "You";
 
-using namespace std;
-
-/*! \brief A helper class for the A* search in the GameMap::path function.
-*
-* This class stores the requisite information about a tile which is placed in
-* the search queue for the A-star, or A*, algorithm which is used to
-* calculate paths in the path function.
-*
-* The A* description can be found here:
-* http://en.wikipedia.org/wiki/A*_search_algorithm
-*/
-class AstarEntry
-{
-public:
-    AstarEntry() :
-        tile    (nullptr),
-        parent  (nullptr),
-        g       (0.0),
-        h       (0.0)
-    {}
-
-    AstarEntry(Tile* tile, int x1, int y1, int x2, int y2) :
-        tile    (tile),
-        parent  (nullptr),
-        g       (0.0),
-        h       (0.0)
-    {
-        h = computeHeuristic(x1, y1, x2, y2);
-    }
-
-    static double computeHeuristic(const int& x1, const int& y1, const int& x2, const int& y2)
-    {
-        return fabs(static_cast<double>(x2 - x1)) + fabs(static_cast<double>(y2 - y1));
-    }
-
-    void setHeuristic(const int& x1, const int& y1, const int& x2, const int& y2)
-    {
-        h = fabs(static_cast<double>(x2 - x1)) + fabs(static_cast<double>(y2 - y1));
-    }
-
-    inline double fCost() const
-    { return g + h; }
-
-    inline Tile* getTile() const
-    { return tile; }
-
-    inline void setTile(Tile* newTile)
-    { tile = newTile; }
+//! \brief Number of distance fields kept by GameMap::pathToBuilding. A 400x400 map uses 640 KB per field
+const uint32_t MAX_DISTANCE_FIELDS = 32;
 
-    inline AstarEntry* getParent() const
-    { return parent; }
+//! \brief Below this number of creatures, there is no perception phase
+const uint32_t MIN_CREATURES_PARALLEL_PERCEPTION = 32;
 
-    inline void setParent(AstarEntry* newParent)
-    { parent = newParent; }
+//! \brief Number of creatures taken at once by a thread during the perception phase
+const uint32_t PERCEPTION_BATCH_SIZE = 8;
 
-    inline const double& getG() const
-    { return g; }
-
-    inline void setG(const double& newG)
-    { g = newG; }
-
-private:
-    Tile*       tile;
-    AstarEntry* parent;
-    double      g;
-    double      h;
-};
+using namespace std;
 
+//! \brief Manhattan distance used as heuristic and as weight between 2 tiles by the A* search in GameMap::path
+static inline double astarHeuristic(int x1, int y1, int x2, int y2)
+{
+    return fabs(static_cast<double>(x2 - x1)) + fabs(static_cast<double>(y2 - y1));
+}
 
 GameMap::GameMap(bool isServerGameMap) :
         TileContainer(isServerGameMap ? 15 : 0),
@@ -164,6 +115,113 @@ GameMap::~GameMap()
     clearAll();
 }
 
+void GameMap::perceiveCreatures()
+{
+    // Without parallelism, there is no perception phase. The creatures compute what they
+    // see during their upkeep, as the map is at that time
+    uint32_t nbCreatures = static_cast<uint32_t>(mCreatures.size());
+    int32_t nbThreads = ConfigManager::getSingleton().getPerceptionThreads();
+    if((nbThreads == 0) || (nbCreatures < MIN_CREATURES_PARALLEL_PERCEPTION))
+        return;
+
+    // The shared tables are prepared so that the creatures only read the map
+    int maxSightRadius = 0;
+    for(Creature* creature : mCreatures)
+        maxSightRadius = std::max(maxSightRadius, creature->getDefinition()->getSightRadius());
+
+    reserveTileDistance(maxSightRadius);
+    mFloodFillAliases.flatten();
+
+    if(mPerceptionPool == nullptr)
+    {
+        uint32_t nbWorkers = (nbThreads < 0) ? ThreadPool::getDefaultNbWorkers() : static_cast<uint32_t>(nbThreads);
+        OD_LOG_INF("Creature perception uses " + Helper::toString(nbWorkers) + " worker threads");
+        mPerceptionPool.reset(new ThreadPool(nbWorkers));
+    }
+
+    // Each creature only writes its own perception so the result does not depend on the
+    // order the creatures are processed in
+    mPerceptionPool->parallelFor(nbCreatures, PERCEPTION_BATCH_SIZE, [this](uint32_t index)
+    {
+        mCreatures[index]->perceive();
+    });
+}
+
+void GameMap::checkSeatCounts() const
+{
+    std::map<const Seat*, unsigned int> claimedTilesBySeat;
+    for (int jj = 0; jj < getMapSizeY(); ++jj)
+    {
+        for (int ii = 0; ii < getMapSizeX(); ++ii)
+        {
+            const Tile* tile = getTile(ii, jj);
+            if (tile->isClaimed())
+                ++claimedTilesBySeat[tile->getSeat()];
+        }
+    }
+
+    for (const Seat* seat : mSeats)
+    {
+        int nbFighters = 0;
+        int nbWorkers = 0;
+        for(const Creature* creature : mCreatures)
+        {
+            if(creature->getSeat() != seat)
+                continue;
+            if(creature->getDefinition() == nullptr)
+                continue;
+            if(!creature->isAlive())
+                continue;
+
+            if(creature->getDefinition()->isWorker())
+                ++nbWorkers;
+            else
+                ++nbFighters;
+        }
+
+        int gold = 0;
+        int goldMax = 0;
+        std::vector<uint32_t> nbRooms(static_cast<uint32_t>(RoomType::nbRooms), 0);
+        for (const Room* room : mRooms)
+        {
+            if(room->getSeat() != seat)
+                continue;
+
+            gold += room->getTotalGoldStored();
+            goldMax += room->getTotalGoldStorage();
+            if(room->getHP(nullptr) > 0.0)
+                ++nbRooms[static_cast<uint32_t>(room->getType())];
+        }
+
+        const std::string seatStr = "seatId=" + Helper::toString(seat->getId());
+        unsigned int nbClaimedTiles = claimedTilesBySeat[seat];
+        if(seat->mNumClaimedTiles != nbClaimedTiles)
+        {
+            OD_LOG_ERR(seatStr + ", claimed tiles=" + Helper::toString(seat->mNumClaimedTiles)
+                + ", recount=" + Helper::toString(nbClaimedTiles));
+        }
+        if((seat->mNumCreaturesFighters != nbFighters) || (seat->mNumCreaturesWorkers != nbWorkers))
+        {
+            OD_LOG_ERR(seatStr + ", fighters=" + Helper::toString(seat->mNumCreaturesFighters)
+                + ", workers=" + Helper::toString(seat->mNumCreaturesWorkers)
+                + ", recount fighters=" + Helper::toString(nbFighters) + ", workers=" + Helper::toString(nbWorkers));
+        }
+        if((seat->mGold != gold) || (seat->mGoldMax != goldMax))
+        {
+            OD_LOG_ERR(seatStr + ", gold=" + Helper::toString(seat->mGold) + ", goldMax=" + Helper::toString(seat->mGoldMax)
+                + ", recount gold=" + Helper::toString(gold) + ", goldMax=" + Helper::toString(goldMax));
+        }
+        for(uint32_t index = 0; index < nbRooms.size(); ++index)
+        {
+            if(seat->mNbRooms[index] == nbRooms[index])
+                continue;
+
+            OD_LOG_ERR(seatStr + ", roomType=" + Helper::toString(index) + ", rooms=" + Helper::toString(seat->mNbRooms[index])
+                + ", recount=" + Helper::toString(nbRooms[index]));
+        }
+    }
+}
+
 std::string GameMap::serverStr()
 {
     if (mIsServerGameMap)
@@ -218,6 +276,9 @@ bool GameMap::createNewMap(int sizeX, int sizeY)
     if (!allocateMapMemory(sizeX, sizeY))
         return false;
 
+    mCreatureGrid.reset(sizeX, sizeY);
+    mBuildingGrid.reset(sizeX, sizeY);
+
     for (int jj = 0; jj < mMapSizeY; ++jj)
     {
         for (int ii = 0; ii < mMapSizeX; ++ii)
@@ -274,6 +335,12 @@ void GameMap::clearAll()
 
     clearAiManager();
 
+    mPathClusterGraph.clear();
+    mDistanceFieldCache.clear();
+    mTilesVisionBlockingChanged.clear();
+    mCreatureGrid.clear();
+    mBuildingGrid.clear();
+
     mLocalPlayerNick = DEFAULT_NICK;
     mTurnNumber = -1;
     resetUniqueNumbers();
@@ -283,18 +350,24 @@ void GameMap::clearAll()
     // We check if the different vectors are empty
     if(!mActiveObjects.empty())
     {
-        OD_LOG_ERR("mActiveObjects not empty size=" + Helper::toString(static_cast<uint32_t>(mActiveObjects.size())));
-        for(GameEntity* entity : mActiveObjects)
+        OD_LOG_ERR("mActiveObjects not empty size=" + Helper::toString(mActiveObjects.size()));
+        for(GameEntity* entity : mActiveObjects.getSlots())
         {
+            if(entity == nullptr)
+                continue;
+
             OD_LOG_ERR("entity not removed=" + entity->getName());
         }
         mActiveObjects.clear();
     }
     if(!mActiveObjectsToAdd.empty())
     {
-        OD_LOG_ERR("mActiveObjectsToAdd not empty size=" + Helper::toString(static_cast<uint32_t>(mActiveObjectsToAdd.size())));
-        for(GameEntity* entity : mActiveObjectsToAdd)
+        OD_LOG_ERR("mActiveObjectsToAdd not empty size=" + Helper::toString(mActiveObjectsToAdd.size()));
+        for(GameEntity* entity : mActiveObjectsToAdd.getSlots())
         {
+            if(entity == nullptr)
+                continue;
+
             OD_LOG_ERR("entity not removed=" + entity->getName());
         }
         mActiveObjectsToAdd.clear();
@@ -317,6 +390,8 @@ void GameMap::clearAll()
         }
         mAnimatedObjects.clear();
     }
+    mAnimatedObjectsByNetworkId.clear();
+    mAnimatedObjectsByName.clear();
     if(!mEntitiesToDelete.empty())
     {
         OD_LOG_ERR("mEntitiesToDelete not empty size=" + Helper::toString(static_cast<uint32_t>(mEntitiesToDelete.size())));
@@ -348,6 +423,7 @@ void GameMap::clearCreatures()
     }
 
     mCreatures.clear();
+    mCreaturesByName.clear();
 }
 
 void GameMap::clearAiManager()
@@ -394,6 +470,7 @@ void GameMap::clearRenderedMovableEntities()
     }
 
     mRenderedMovableEntities.clear();
+    mRenderedMovableEntitiesByName.clear();
 }
 
 void GameMap::clearPlayers()
@@ -412,7 +489,9 @@ void GameMap::resetUniqueNumbers()
     mUniqueNumberRenderedMovableEntity = 0;
     mUniqueNumberTrap = 0;
     mUniqueNumberMapLight = 0;
+    mLastNetworkId = 0;
     mUniqueFloodFillValue = 0;
+    mFloodFillAliases.clear();
 }
 
 void GameMap::addClassDescription(const CreatureDefinition *c)
@@ -502,6 +581,8 @@ void GameMap::addCreature(Creature *cc)
         + ", seatId=" + (cc->getSeat() != nullptr ? Helper::toString(cc->getSeat()->getId()) : std::string("null")));
 
     mCreatures.push_back(cc);
+    mCreaturesByName.add(cc);
+    cc->setSeatCounted(true);
 }
 
 void GameMap::removeCreature(Creature *c)
@@ -516,6 +597,8 @@ void GameMap::removeCreature(Creature *c)
     }
 
     mCreatures.erase(it);
+    mCreaturesByName.remove(c);
+    c->setSeatCounted(false);
 }
 
 void GameMap::queueEntityForDeletion(GameEntity *ge)
@@ -818,6 +901,17 @@ Creature* GameMap::getFighterToPickupBySeat(Seat* seat)
 void GameMap::addAnimatedObject(MovableGameEntity *a)
 {
     mAnimatedObjects.push_back(a);
+    mAnimatedObjectsByName.add(a);
+
+    // On server side, the entity keeps its id if it is removed and added again. On client side, the
+    // id is received with the entity. Entities only known by the client do not have any
+    if(isServerGameMap() && (a->getNetworkId() == 0))
+        a->setNetworkId(++mLastNetworkId);
+
+    if(a->getNetworkId() == 0)
+        return;
+
+    mAnimatedObjectsByNetworkId[a->getNetworkId()] = a;
 }
 
 void GameMap::removeAnimatedObject(MovableGameEntity *a)
@@ -827,17 +921,25 @@ void GameMap::removeAnimatedObject(MovableGameEntity *a)
         return;
 
     mAnimatedObjects.erase(it);
+    mAnimatedObjectsByName.remove(a);
+
+    auto itId = mAnimatedObjectsByNetworkId.find(a->getNetworkId());
+    if((itId != mAnimatedObjectsByNetworkId.end()) && (itId->second == a))
+        mAnimatedObjectsByNetworkId.erase(itId);
 }
 
 MovableGameEntity* GameMap::getAnimatedObject(const std::string& name) const
 {
-    for (MovableGameEntity* mge : mAnimatedObjects)
-    {
-        if (mge->getName().compare(name) == 0)
-            return mge;
-    }
+    return mAnimatedObjectsByName.find(name);
+}
 
-    return nullptr;
+MovableGameEntity* GameMap::getAnimatedObjectFromNetworkId(uint32_t networkId) const
+{
+    auto it = mAnimatedObjectsByNetworkId.find(networkId);
+    if(it == mAnimatedObjectsByNetworkId.end())
+        return nullptr;
+
+    return it->second;
 }
 
 void GameMap::addRenderedMovableEntity(RenderedMovableEntity *obj)
@@ -845,6 +947,7 @@ void GameMap::addRenderedMovableEntity(RenderedMovableEntity *obj)
     OD_LOG_INF(serverStr() + "Adding rendered object " + obj->getName()
         + ",MeshName=" + obj->getMeshName());
     mRenderedMovableEntities.push_back(obj);
+    mRenderedMovableEntitiesByName.add(obj);
 }
 
 void GameMap::removeRenderedMovableEntity(RenderedMovableEntity *obj)
@@ -859,16 +962,12 @@ void GameMap::removeRenderedMovableEntity(RenderedMovableEntity *obj)
     }
 
     mRenderedMovableEntities.erase(it);
+    mRenderedMovableEntitiesByName.remove(obj);
 }
 
 RenderedMovableEntity* GameMap::getRenderedMovableEntity(const std::string& name)
 {
-    for(RenderedMovableEntity* renderedMovableEntity : mRenderedMovableEntities)
-    {
-        if(name.compare(renderedMovableEntity->getName()) == 0)
-            return renderedMovableEntity;
-    }
-    return nullptr;
+    return mRenderedMovableEntitiesByName.find(name);
 }
 
 void GameMap::addActiveObject(GameEntity *a)
@@ -877,7 +976,8 @@ void GameMap::addActiveObject(GameEntity *a)
     if(!isServerGameMap())
         return;
 
-    mActiveObjectsToAdd.push_back(a);
+    if(!mActiveObjectsToAdd.add(a))
+        OD_LOG_ERR("name=" + a->getName());
 }
 
 void GameMap::removeActiveObject(GameEntity *a)
@@ -886,17 +986,12 @@ void GameMap::removeActiveObject(GameEntity *a)
     if(!isServerGameMap())
         return;
 
-    if(std::find(mActiveObjects.begin(), mActiveObjects.end(), a) != mActiveObjects.end())
-    {
-        mActiveObjectsToRemove.push_back(a);
+    // If the object was not added yet, we can forget it right away
+    if(mActiveObjectsToAdd.remove(a))
         return;
-    }
 
-    if(std::find(mActiveObjectsToAdd.begin(), mActiveObjectsToAdd.end(), a) != mActiveObjectsToAdd.end())
-    {
+    if(mActiveObjects.contains(a))
         mActiveObjectsToRemove.push_back(a);
-        return;
-    }
 }
 
 unsigned int GameMap::numClassDescriptions()
@@ -1079,12 +1174,19 @@ void GameMap::destroyAllEntities()
 
 Creature* GameMap::getCreature(const std::string& cName) const
 {
-    for (Creature* creature : mCreatures)
-    {
-        if (creature->getName().compare(cName) == 0)
-            return creature;
-    }
-    return nullptr;
+    return mCreaturesByName.find(cName);
+}
+
+void GameMap::setCreatureName(Creature* creature, const std::string& name)
+{
+    // The creature is only indexed again if it was indexed with its former name
+    bool isCreatureIndexed = mCreaturesByName.remove(creature);
+    bool isAnimatedObjectIndexed = mAnimatedObjectsByName.remove(creature);
+    creature->setName(name);
+    if(isCreatureIndexed)
+        mCreaturesByName.add(creature);
+    if(isAnimatedObjectIndexed)
+        mAnimatedObjectsByName.add(creature);
 }
 
 void GameMap::doTurn(double timeSinceLastTurn)
@@ -1113,7 +1215,6 @@ void GameMap::doPlayerAITurn(double timeSinceLastTurn)
 
 unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
 {
-    Tile *tempTile;
     Ogre::Timer stopwatch;
     unsigned long int timeTaken;
 
@@ -1175,41 +1276,17 @@ unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
             addWinningSeat(seat);
 
         seat->mNumCreaturesFightersMax = getMaxNumberCreatures(seat);
-
-        // Set the creatures count to 0. It will be reset by the next count in doTurn()
-        seat->mNumCreaturesFighters = 0;
-        seat->mNumCreaturesWorkers = 0;
     }
 
-    // Count how many creatures the player controls
-    for(Creature* creature : mCreatures)
-    {
-        // Check to see if the creature has died.
-        if (!creature->isAlive())
-            continue;
-
-        Seat *tempSeat = creature->getSeat();
-        if(tempSeat == nullptr)
-            continue;
-
-        // We only count fighters
-        if (creature->getDefinition()->isWorker())
-            ++(tempSeat->mNumCreaturesWorkers);
-        else
-            ++(tempSeat->mNumCreaturesFighters);
-    }
+#ifdef OD_DEBUG
+    // The seat counts are updated by the entities when they change. We check they did not miss anything
+    checkSeatCounts();
+#endif
 
-    // At each upkeep, we re-compute tiles with vision
+    // At each upkeep, we update tiles with vision. Tiles count the viewers of each seat. Viewers only
+    // update the tiles they see when they moved or when a tile blocking vision changed near them
     for (Seat* seat : mSeats)
-        seat->clearTilesWithVision();
-
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
-    {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            getTile(ii,jj)->clearVision();
-        }
-    }
+        seat->clearTemporaryVision();
 
     // Compute vision. We need to compute every seats including AI because
     // a human can be allied with an AI and they would share vision
@@ -1221,6 +1298,8 @@ unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
         }
     }
 
+    perceiveCreatures();
+
     for (Creature* creature : mCreatures)
     {
         creature->computeVisibleTiles();
@@ -1231,6 +1310,8 @@ unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
         spell->computeVisibleTiles();
     }
 
+    mTilesVisionBlockingChanged.clear();
+
     for (Seat* seat : mSeats)
     {
         if(!seat->getIsDebuggingVision())
@@ -1244,12 +1325,15 @@ unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
         seat->sendVisibleTiles();
 
     // Carry out the upkeep round of all the active objects in the game.
+    // Removed objects leave an empty slot until processActiveObjectsChanges is called
+    const std::vector<GameEntity*>& activeObjects = mActiveObjects.getSlots();
     unsigned int activeObjectCount = 0;
-    unsigned int nbActiveObjectCount = mActiveObjects.size();
+    unsigned int nbActiveObjectCount = activeObjects.size();
     while (activeObjectCount < nbActiveObjectCount)
     {
-        GameEntity* ge = mActiveObjects[activeObjectCount];
-        ge->doUpkeep();
+        GameEntity* ge = activeObjects[activeObjectCount];
+        if(ge != nullptr)
+            ge->doUpkeep();
 
         ++activeObjectCount;
     }
@@ -1261,8 +1345,6 @@ unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
         if(seat->getPlayer() == nullptr)
             continue;
 
-        seat->computeSeatBeginTurn();
-
         // Add the amount of mana this seat accrued this turn if the player has a dungeon temple
         if(seat->getNbRooms(RoomType::dungeonTemple) == 0)
         {
@@ -1277,39 +1359,6 @@ unsigned long int GameMap::doMiscUpkeep(double timeSinceLastTurn)
             if (seat->mMana > maxMana)
                 seat->mMana = maxMana;
         }
-
-        // Update the count on how much gold is available in all of the treasuries claimed by the given seat.
-        seat->mGold = 0;
-        seat->mGoldMax = 0;
-        for (Room* room : getRooms())
-        {
-            if(room->getSeat() != seat)
-                continue;
-
-            seat->mGold += room->getTotalGoldStored();
-            seat->mGoldMax += room->getTotalGoldStorage();
-        }
-    }
-
-    // Determine the number of tiles claimed by each seat.
-    // Begin by setting the number of claimed tiles for each seat to 0.
-    for (Seat* seat : mSeats)
-        seat->setNumClaimedTiles(0);
-
-    // Now loop over all of the tiles, if the tile is claimed increment the given seats count.
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
-    {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            tempTile = getTile(ii,jj);
-
-            // Check to see if the current tile is claimed by anyone.
-            if (tempTile->isClaimed())
-            {
-                // Increment the count of the seat who owns the tile.
-                tempTile->getSeat()->incrementNumClaimedTiles();
-            }
-        }
     }
 
     timeTaken = stopwatch.getMicroseconds();
@@ -1358,7 +1407,7 @@ void GameMap::playerIsFighting(Player* player, Tile* tile)
     }
 }
 
-std::list<Tile*> GameMap::findBestPath(const Creature* creature, Tile* tileStart, const std::vector<Tile*> possibleDests,
+std::list<Tile*> GameMap::findBestPath(const Creature* creature, Tile* tileStart, const std::vector<Tile*>& possibleDests,
     Tile*& chosenTile)
 {
     chosenTile = nullptr;
@@ -1366,42 +1415,73 @@ std::list<Tile*> GameMap::findBestPath(const Creature* creature, Tile* tileStart
     if(possibleDests.empty())
         return returnList;
 
-    // We start by sorting the vector
-    std::vector<Tile*> possibleDestsTmp = possibleDests;
-    std::sort(possibleDestsTmp.begin(), possibleDestsTmp.end(), [this, &tileStart](Tile* tile1, Tile* tile2){
-              int d1 = Pathfinding::squaredDistanceTile(*tile1, *tileStart);
-              int d2 = Pathfinding::squaredDistanceTile(*tile2, *tileStart);
-              return d1 < d2;
-        });
+    if((creature == nullptr) || (tileStart == nullptr))
+        return returnList;
 
-    double magic = 2.0;
-    for(Tile* tile : possibleDestsTmp)
+    // We only search the destinations that can be reached. Otherwise, the search would go through
+    // the whole area before failing
+    std::vector<Tile*> reachableDests;
+    reachableDests.reserve(possibleDests.size());
+    for(Tile* tile : possibleDests)
     {
-        if(!pathExists(creature, tileStart, tile))
+        if(tile == nullptr)
             continue;
 
-        // The first reachable tile is the best by default
-        Ogre::Real dist = std::hypotf(tile->getX() - tileStart->getX(), tile->getY() - tileStart->getY());
-        if(chosenTile == nullptr)
-        {
-            chosenTile = tile;
-            returnList = path(tileStart, tile, creature, creature->getSeat(), false);
+        if(!pathExists(creature, tileStart, tile))
             continue;
-        }
 
-        // We compute the path only if walkableDist < (dist * magic).
-        double walkableDist = static_cast<double>(returnList.size());
-        if(walkableDist < (dist * magic))
-            continue;
+        reachableDests.push_back(tile);
+    }
 
-        std::list<Tile*> pathTmp = path(tileStart, tile, creature, creature->getSeat(), false);
-        if(pathTmp.size() < returnList.size())
-        {
-            // The path is shorter
-            chosenTile = tile;
-            returnList = pathTmp;
-        }
+    if(reachableDests.empty())
+        return returnList;
+
+    return pathAstar(tileStart, reachableDests.data(), static_cast<uint32_t>(reachableDests.size()),
+        creature, creature->getSeat(), false, chosenTile);
+}
+
+std::list<Tile*> GameMap::pathToBuilding(const Creature* creature, Tile* tileStart, Building* building)
+{
+    std::list<Tile*> returnList;
+    if((creature == nullptr) || (tileStart == nullptr) || (building == nullptr))
+        return returnList;
+
+    Seat* seat = creature->getSeat();
+    if(seat == nullptr)
+        return returnList;
+
+    if((mDistanceFieldCache.getMapSizeX() != getMapSizeX()) ||
+       (mDistanceFieldCache.getMapSizeY() != getMapSizeY()))
+    {
+        mDistanceFieldCache.setup(getMapSizeX(), getMapSizeY(), MAX_DISTANCE_FIELDS);
     }
+
+    std::vector<uint32_t> targetTiles;
+    for(Tile* tile : building->getCoveredTiles())
+        targetTiles.push_back(static_cast<uint32_t>(tile->getX() * getMapSizeY() + tile->getY()));
+
+    // Enemy creatures fighting or fleeing cannot go through closed doors (see TrapDoor::getCreatureSpeed). They
+    // use their own layers
+    FloodFillType floodFillType = getFloodFillTypeForCreature(creature);
+    bool isFightingOrFleeing = creature->isActionInList(CreatureActionType::fight) ||
+        creature->isActionInList(CreatureActionType::flee);
+    uint32_t layer = static_cast<uint32_t>(floodFillType);
+    if(isFightingOrFleeing)
+        layer += static_cast<uint32_t>(FloodFillType::nbValues);
+
+    const std::vector<uint32_t>& field = mDistanceFieldCache.getField(seat->getId(), layer,
+        building->getName(), targetTiles, [this, floodFillType, seat, isFightingOrFleeing](int x, int y)
+        {
+            return isTilePassableForSeat(x, y, floodFillType, seat, isFightingOrFleeing);
+        });
+
+    std::vector<uint32_t> tiles;
+    if(!mDistanceFieldCache.followField(field, tileStart->getX(), tileStart->getY(), tiles))
+        return returnList;
+
+    for(uint32_t index : tiles)
+        returnList.push_back(getTile(static_cast<int>(index) / getMapSizeY(), static_cast<int>(index) % getMapSizeY()));
+
     return returnList;
 }
 
@@ -1416,24 +1496,7 @@ bool GameMap::pathExists(const Creature* creature, Tile* tileStart, Tile* tileEn
     if(creature == nullptr)
         return false;
 
-    FloodFillType floodFill = FloodFillType::ground;
-    if((creature->getMoveSpeedGround() > 0.0) &&
-        (creature->getMoveSpeedWater() > 0.0) &&
-        (creature->getMoveSpeedLava() > 0.0))
-    {
-        floodFill = FloodFillType::groundWaterLava;
-    }
-    if((creature->getMoveSpeedGround() > 0.0) &&
-        (creature->getMoveSpeedWater() > 0.0))
-    {
-        floodFill = FloodFillType::groundWater;
-    }
-    if((creature->getMoveSpeedGround() > 0.0) &&
-        (creature->getMoveSpeedLava() > 0.0))
-    {
-        floodFill = FloodFillType::groundLava;
-    }
-
+    FloodFillType floodFill = getFloodFillTypeForCreature(creature);
     if(creature->getDefinition()->isWorker())
     {
         // Workers can go on a tile if and only if the path is open for any creature. If it is closed, that
@@ -1456,6 +1519,29 @@ bool GameMap::pathExists(const Creature* creature, Tile* tileStart, Tile* tileEn
     }
 }
 
+FloodFillType GameMap::getFloodFillTypeForCreature(const Creature* creature)
+{
+    FloodFillType floodFill = FloodFillType::ground;
+    if((creature->getMoveSpeedGround() > 0.0) &&
+        (creature->getMoveSpeedWater() > 0.0) &&
+        (creature->getMoveSpeedLava() > 0.0))
+    {
+        floodFill = FloodFillType::groundWaterLava;
+    }
+    if((creature->getMoveSpeedGround() > 0.0) &&
+        (creature->getMoveSpeedWater() > 0.0))
+    {
+        floodFill = FloodFillType::groundWater;
+    }
+    if((creature->getMoveSpeedGround() > 0.0) &&
+        (creature->getMoveSpeedLava() > 0.0))
+    {
+        floodFill = FloodFillType::groundLava;
+    }
+
+    return floodFill;
+}
+
 std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* creature, Seat* seat, bool throughDiggableTiles)
 {
     ++mNumCallsTo_path;
@@ -1478,39 +1564,112 @@ std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* c
     if (!throughDiggableTiles && !pathExists(creature, start, destination))
         return returnList;
 
-    AstarEntry *currentEntry = new AstarEntry(start, x1, y1, x2, y2);
-    AstarEntry neighbor;
+    // Long paths are searched on the cluster graph first. If it fails, we search on the whole map
+    int clusterSize = static_cast<int>(ConfigManager::getSingleton().getPathClusterSize());
+    if(!throughDiggableTiles && mFloodFillEnabled && (clusterSize > 0) &&
+       ((std::abs(x2 - x1) + std::abs(y2 - y1)) > 2 * clusterSize))
+    {
+        if(mPathClusterGraph.getClusterSize() != clusterSize)
+        {
+            mPathClusterGraph.setup(getMapSizeX(), getMapSizeY(), clusterSize, static_cast<uint32_t>(FloodFillType::nbValues),
+                [this](int x, int y, uint32_t layer)
+                {
+                    return isTilePassableForFloodFill(x, y, static_cast<FloodFillType>(layer));
+                });
+        }
 
-    std::vector<AstarEntry*> openList;
-    openList.push_back(currentEntry);
+        if(pathHierarchical(start, destination, creature, seat, returnList))
+            return returnList;
+    }
+
+    return pathAstar(start, destination, creature, seat, throughDiggableTiles);
+}
 
-    std::vector<AstarEntry*> closedList;
-    AstarEntry* destinationEntry = nullptr;
-    while (true)
+bool GameMap::pathHierarchical(Tile* start, Tile* destination, const Creature* creature, Seat* seat, std::list<Tile*>& returnList)
+{
+    std::vector<std::pair<int, int>> waypoints;
+    uint32_t layer = static_cast<uint32_t>(getFloodFillTypeForCreature(creature));
+    if(!mPathClusterGraph.findPath(start->getX(), start->getY(), destination->getX(), destination->getY(), layer, waypoints))
+        return false;
+
+    // The abstract graph does not know about the creature speed or the seat so each segment
+    // is searched with the creature. Segments are short so it is cheap
+    returnList.push_back(start);
+    for(uint32_t i = 1; i < waypoints.size(); ++i)
     {
-        // if the openList is empty we failed to find a path
-        if (openList.empty())
-            break;
+        Tile* segmentEnd = getTile(waypoints[i].first, waypoints[i].second);
+        std::list<Tile*> segment;
+        if(segmentEnd != nullptr)
+            segment = pathAstar(returnList.back(), segmentEnd, creature, seat, false);
 
-        // Get the lowest fScore from the openList and move it to the closed list
-        std::vector<AstarEntry*>::iterator smallestAstar = openList.begin();
-        for (std::vector<AstarEntry*>::iterator itr = openList.begin(); itr != openList.end(); ++itr)
+        if(segment.empty())
         {
-            if ((*itr)->fCost() < (*smallestAstar)->fCost())
-                smallestAstar = itr;
+            returnList.clear();
+            return false;
         }
 
-        currentEntry = *smallestAstar;
-        openList.erase(smallestAstar);
-        closedList.push_back(currentEntry);
+        // The first tile of the segment is the last one of the path
+        segment.pop_front();
+        returnList.splice(returnList.end(), segment);
+    }
+
+    return true;
+}
+
+std::list<Tile*> GameMap::pathAstar(Tile* start, Tile* destination, const Creature* creature, Seat* seat, bool throughDiggableTiles)
+{
+    Tile* reachedTile;
+    return pathAstar(start, &destination, 1, creature, seat, throughDiggableTiles, reachedTile);
+}
+
+std::list<Tile*> GameMap::pathAstar(Tile* start, Tile* const* destinations, uint32_t nbDestinations, const Creature* creature,
+    Seat* seat, bool throughDiggableTiles, Tile*& reachedTile)
+{
+    std::list<Tile*> returnList;
+    reachedTile = nullptr;
+    int x1 = start->getX();
+    int y1 = start->getY();
+
+    // The heuristic is the distance to the closest destination. With only one destination, that is
+    // the usual manhattan distance
+    auto heuristic = [destinations, nbDestinations](int x, int y)
+    {
+        double h = astarHeuristic(x, y, destinations[0]->getX(), destinations[0]->getY());
+        for(uint32_t i = 1; i < nbDestinations; ++i)
+            h = std::min(h, astarHeuristic(x, y, destinations[i]->getX(), destinations[i]->getY()));
+
+        return h;
+    };
+
+    mAstarNodePool.startSearch(getMapSizeX(), getMapSizeY());
+    for(uint32_t i = 0; i < nbDestinations; ++i)
+        mAstarNodePool.setGoal(mAstarNodePool.getIndex(destinations[i]->getX(), destinations[i]->getY()));
+
+    mAstarNodePool.pushOpen(mAstarNodePool.getIndex(x1, y1), 0.0, heuristic(x1, y1), AstarNodePool::NO_NODE);
+
+    uint32_t destinationIndex = AstarNodePool::NO_NODE;
+    // if the open set gets empty we failed to find a path
+    while (!mAstarNodePool.isOpenEmpty())
+    {
+        // Get the lowest fScore from the open set and move it to the closed set
+        uint32_t currentIndex = mAstarNodePool.popOpen();
 
         // We found the path, break out of the search loop
-        if (currentEntry->getTile() == destination)
+        if (mAstarNodePool.isGoal(currentIndex))
         {
-            destinationEntry = currentEntry;
+            destinationIndex = currentIndex;
             break;
         }
 
+        Tile* currentTile = getTile(mAstarNodePool.getX(currentIndex), mAstarNodePool.getY(currentIndex));
+
+        // The weight to go from the current tile to its neighbors only depends on the current tile
+        double currentTileSpeed;
+        if(currentTile->getFullness() == 0)
+            currentTileSpeed = creature->getMoveSpeed(currentTile);
+        else
+            currentTileSpeed = creature->getMoveSpeedGround();
+
         // Check the tiles surrounding the current square
         bool areTilesPassable[4] = {false, false, false, false};
         // Note : to disable diagonals, process tiles from 0 to 3. To allow them, process tiles from 0 to 7
@@ -1521,34 +1680,34 @@ std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* c
             {
                 // We process the 4 adjacent tiles
                 case 0:
-                    neighborTile = getTile(currentEntry->getTile()->getX() - 1, currentEntry->getTile()->getY());
+                    neighborTile = getTile(currentTile->getX() - 1, currentTile->getY());
                     break;
                 case 1:
-                    neighborTile = getTile(currentEntry->getTile()->getX() + 1, currentEntry->getTile()->getY());
+                    neighborTile = getTile(currentTile->getX() + 1, currentTile->getY());
                     break;
                 case 2:
-                    neighborTile = getTile(currentEntry->getTile()->getX(), currentEntry->getTile()->getY() - 1);
+                    neighborTile = getTile(currentTile->getX(), currentTile->getY() - 1);
                     break;
                 case 3:
-                    neighborTile = getTile(currentEntry->getTile()->getX(), currentEntry->getTile()->getY() + 1);
+                    neighborTile = getTile(currentTile->getX(), currentTile->getY() + 1);
                     break;
                 // We process the 4 diagonal tiles. We only process a diagonal tile if the 2 tiles adjacent to the original one are
                 // passable.
                 case 4:
                     if(areTilesPassable[0] && areTilesPassable[2])
-                        neighborTile = getTile(currentEntry->getTile()->getX() - 1, currentEntry->getTile()->getY() - 1);
+                        neighborTile = getTile(currentTile->getX() - 1, currentTile->getY() - 1);
                     break;
                 case 5:
                     if(areTilesPassable[0] && areTilesPassable[3])
-                        neighborTile = getTile(currentEntry->getTile()->getX() - 1, currentEntry->getTile()->getY() + 1);
+                        neighborTile = getTile(currentTile->getX() - 1, currentTile->getY() + 1);
                     break;
                 case 6:
                     if(areTilesPassable[1] && areTilesPassable[2])
-                        neighborTile = getTile(currentEntry->getTile()->getX() + 1, currentEntry->getTile()->getY() - 1);
+                        neighborTile = getTile(currentTile->getX() + 1, currentTile->getY() - 1);
                     break;
                 case 7:
                     if(areTilesPassable[1] && areTilesPassable[3])
-                        neighborTile = getTile(currentEntry->getTile()->getX() + 1, currentEntry->getTile()->getY() + 1);
+                        neighborTile = getTile(currentTile->getX() + 1, currentTile->getY() + 1);
                     break;
                 default:
                     break;
@@ -1556,111 +1715,58 @@ std::list<Tile*> GameMap::path(int x1, int y1, int x2, int y2, const Creature* c
             if(neighborTile == nullptr)
                 continue;
 
-            neighbor.setTile(neighborTile);
-
             bool processNeighbor = false;
             // We process the tile if the creature can go through. But if it is the first tile that is
             // not passable, we also process it. That happens if a door is closed
-            if((creature->canGoThroughTile(neighbor.getTile())) ||
-               (neighbor.getTile() == start))
+            if((creature->canGoThroughTile(neighborTile)) ||
+               (neighborTile == start))
             {
                 processNeighbor = true;
                 // We set passability for the 4 adjacent tiles only
                 if(i < 4)
                     areTilesPassable[i] = true;
              }
-            else if(throughDiggableTiles && neighbor.getTile()->isDiggable(seat))
+            else if(throughDiggableTiles && neighborTile->isDiggable(seat))
                 processNeighbor = true;
 
             if (!processNeighbor)
                 continue;
 
-            // See if the neighbor is in the closed list
-            AstarEntry* neighborEntry = nullptr;
-            for(std::vector<AstarEntry*>::iterator itr = closedList.begin(); itr != closedList.end(); ++itr)
-            {
-                if (neighbor.getTile() == (*itr)->getTile())
-                {
-                    neighborEntry = *itr;
-                    break;
-                }
-            }
-
-            // Ignore the neighbor if it is on the closed list
-            if (neighborEntry != nullptr)
+            // Ignore the neighbor if it is on the closed set
+            uint32_t neighborIndex = mAstarNodePool.getIndex(neighborTile->getX(), neighborTile->getY());
+            if (mAstarNodePool.isClosed(neighborIndex))
                 continue;
 
-            // See if the neighbor is in the open list
-            for(std::vector<AstarEntry*>::iterator itr = openList.begin(); itr != openList.end(); ++itr)
-            {
-                if (neighbor.getTile() == (*itr)->getTile())
-                {
-                    neighborEntry = *itr;
-                    break;
-                }
-            }
+            double weightToParent = astarHeuristic(neighborTile->getX(), neighborTile->getY(),
+                currentTile->getX(), currentTile->getY());
+            weightToParent /= currentTileSpeed;
+            double g = mAstarNodePool.getG(currentIndex) + weightToParent;
 
-            // If the neighbor is not in the open list
-            if (neighborEntry == nullptr)
+            // If the neighbor is not in the open set
+            if (!mAstarNodePool.isOpen(neighborIndex))
             {
-                double weightToParent = AstarEntry::computeHeuristic(neighbor.getTile()->getX(), neighbor.getTile()->getY(),
-                    currentEntry->getTile()->getX(), currentEntry->getTile()->getY());
-
-                if(currentEntry->getTile()->getFullness() == 0)
-                    weightToParent /= creature->getMoveSpeed(currentEntry->getTile());
-                else
-                    weightToParent /= creature->getMoveSpeedGround();
-                neighbor.setG(currentEntry->getG() + weightToParent);
-
-                // Use the manhattan distance for the heuristic
-                neighbor.setHeuristic(neighbor.getTile()->getX(), neighbor.getTile()->getY(), x2, y2);
-                neighbor.setParent(currentEntry);
-
-                openList.push_back(new AstarEntry(neighbor));
+                // Use the manhattan distance to the closest destination for the heuristic
+                mAstarNodePool.pushOpen(neighborIndex, g,
+                    heuristic(neighborTile->getX(), neighborTile->getY()), currentIndex);
             }
-            else
+            else if (g < mAstarNodePool.getG(neighborIndex))
             {
                 // If this path to the given neighbor tile is a shorter path than the
                 // one already given, make this the new parent.
-                double weightToParent = AstarEntry::computeHeuristic(neighbor.getTile()->getX(), neighbor.getTile()->getY(),
-                    currentEntry->getTile()->getX(), currentEntry->getTile()->getY());
-
-                if(currentEntry->getTile()->getFullness() == 0)
-                    weightToParent /= creature->getMoveSpeed(currentEntry->getTile());
-                else
-                    weightToParent /= creature->getMoveSpeedGround();
-
-                if (currentEntry->getG() + weightToParent < neighborEntry->getG())
-                {
-                    neighborEntry->setG(currentEntry->getG() + weightToParent);
-                    neighborEntry->setParent(currentEntry);
-                }
+                mAstarNodePool.decreaseG(neighborIndex, g, currentIndex);
             }
         }
     }
 
-    if (destinationEntry != nullptr)
+    if (destinationIndex != AstarNodePool::NO_NODE)
     {
         // Follow the parent chain back the the starting tile
-        AstarEntry* curEntry = destinationEntry;
-        do
-        {
-            if (curEntry->getTile() != nullptr)
-            {
-                returnList.push_front(curEntry->getTile());
-                curEntry = curEntry->getParent();
-            }
+        for(uint32_t index = destinationIndex; index != AstarNodePool::NO_NODE; index = mAstarNodePool.getParent(index))
+            returnList.push_front(getTile(mAstarNodePool.getX(index), mAstarNodePool.getY(index)));
 
-        } while (curEntry != nullptr);
+        reachedTile = returnList.back();
     }
 
-    // Clean up the memory we allocated by deleting the astarEntries in the open and closed lists
-    for (std::vector<AstarEntry*>::iterator itr = openList.begin(); itr != openList.end(); ++itr)
-        delete *itr;
-
-    for (std::vector<AstarEntry*>::iterator itr = closedList.begin(); itr != closedList.end(); ++itr)
-        delete *itr;
-
     return returnList;
 }
 
@@ -1784,6 +1890,67 @@ std::vector<GameEntity*> GameMap::getVisibleCreatures(const std::vector<Tile*>&
     return returnList;
 }
 
+std::vector<GameEntity*> GameMap::getVisibleForce(const TileBitmap& visibleTiles, Seat* seat, bool enemyForce)
+{
+    std::vector<GameEntity*> returnList = getVisibleCreatures(visibleTiles, seat, enemyForce);
+
+    // A building can be on several visible tiles. We only add it once
+    std::vector<Building*> buildings;
+    int xMax = visibleTiles.getOriginX() + visibleTiles.getSizeX() - 1;
+    int yMax = visibleTiles.getOriginY() + visibleTiles.getSizeY() - 1;
+    mBuildingGrid.forEachInRect(visibleTiles.getOriginX(), visibleTiles.getOriginY(), xMax, yMax,
+        [this, &visibleTiles, seat, enemyForce, &buildings](Building* building, int x, int y)
+    {
+        if(!visibleTiles.test(x, y))
+            return;
+
+        if(building->getSeat()->isAlliedSeat(seat) == enemyForce)
+            return;
+
+        if(std::find(buildings.begin(), buildings.end(), building) != buildings.end())
+            return;
+
+        if(enemyForce && !building->isAttackable(getTile(x, y), seat))
+            return;
+
+        buildings.push_back(building);
+    });
+
+    returnList.insert(returnList.end(), buildings.begin(), buildings.end());
+    return returnList;
+}
+
+std::vector<GameEntity*> GameMap::getVisibleCreatures(const TileBitmap& visibleTiles, Seat* seat, bool enemyCreatures)
+{
+    std::vector<GameEntity*> returnList;
+
+    int xMax = visibleTiles.getOriginX() + visibleTiles.getSizeX() - 1;
+    int yMax = visibleTiles.getOriginY() + visibleTiles.getSizeY() - 1;
+    mCreatureGrid.forEachInRect(visibleTiles.getOriginX(), visibleTiles.getOriginY(), xMax, yMax,
+        [this, &visibleTiles, seat, enemyCreatures, &returnList](Creature* creature, int x, int y)
+    {
+        if(!visibleTiles.test(x, y))
+            return;
+
+        // Same checks as Tile::fillWithEntities with creatureAliveEnemyAttackable or creatureAliveAllied
+        if(creature->getSeat() == nullptr)
+            return;
+
+        if(creature->getSeat()->isAlliedSeat(seat) == enemyCreatures)
+            return;
+
+        if(!creature->isAlive())
+            return;
+
+        if(enemyCreatures && !creature->isAttackable(getTile(x, y), seat))
+            return;
+
+        returnList.push_back(creature);
+    });
+
+    return returnList;
+}
+
 std::vector<GameEntity*> GameMap::getCarryableEntities(Creature* carrier, const std::vector<Tile*>& tiles)
 {
     std::vector<GameEntity*> returnList;
@@ -1814,6 +1981,7 @@ void GameMap::clearRooms()
     }
 
     mRooms.clear();
+    mRoomsByName.clear();
 }
 
 void GameMap::addRoom(Room *r)
@@ -1827,6 +1995,8 @@ void GameMap::addRoom(Room *r)
     }
 
     mRooms.push_back(r);
+    mRoomsByName.add(r);
+    r->setSeatCounted(true);
 }
 
 void GameMap::removeRoom(Room *r)
@@ -1842,6 +2012,8 @@ void GameMap::removeRoom(Room *r)
     }
 
     mRooms.erase(it);
+    mRoomsByName.remove(r);
+    r->setSeatCounted(false);
 }
 
 std::vector<Room*> GameMap::getRoomsByType(RoomType type) const
@@ -1947,24 +2119,12 @@ std::vector<Building*> GameMap::getReachableBuildingsPerSeat(Seat* seat,
 
 Room* GameMap::getRoomByName(const std::string& name)
 {
-    for (Room* room : mRooms)
-    {
-        if(room->getName().compare(name) == 0)
-            return room;
-    }
-
-    return nullptr;
+    return mRoomsByName.find(name);
 }
 
 Trap* GameMap::getTrapByName(const std::string& name)
 {
-    for (Trap* trap : mTraps)
-    {
-        if(trap->getName().compare(name) == 0)
-            return trap;
-    }
-
-    return nullptr;
+    return mTrapsByName.find(name);
 }
 
 void GameMap::clearTraps()
@@ -1978,6 +2138,7 @@ void GameMap::clearTraps()
     }
 
     mTraps.clear();
+    mTrapsByName.clear();
 }
 
 void GameMap::addTrap(Trap *trap)
@@ -1987,6 +2148,7 @@ void GameMap::addTrap(Trap *trap)
         + Helper::toString(nbTiles) + ", seatId=" + Helper::toString(trap->getSeat()->getId()));
 
     mTraps.push_back(trap);
+    mTrapsByName.add(trap);
 }
 
 void GameMap::removeTrap(Trap *t)
@@ -2000,6 +2162,7 @@ void GameMap::removeTrap(Trap *t)
     }
 
     mTraps.erase(it);
+    mTrapsByName.remove(t);
 }
 
 bool GameMap::withdrawFromTreasuries(int gold, Seat* seat)
@@ -2035,12 +2198,14 @@ void GameMap::clearMapLights()
     }
 
     mMapLights.clear();
+    mMapLightsByName.clear();
 }
 
 void GameMap::addMapLight(MapLight *m)
 {
     OD_LOG_INF(serverStr() + "Adding MapLight " + m->getName());
     mMapLights.push_back(m);
+    mMapLightsByName.add(m);
 }
 
 void GameMap::removeMapLight(MapLight *m)
@@ -2055,17 +2220,12 @@ void GameMap::removeMapLight(MapLight *m)
     }
 
     mMapLights.erase(it);
+    mMapLightsByName.remove(m);
 }
 
 MapLight* GameMap::getMapLight(const std::string& name) const
 {
-    for (MapLight* mapLight : mMapLights)
-    {
-        if (mapLight->getName() == name)
-            return mapLight;
-    }
-
-    return nullptr;
+    return mMapLightsByName.find(name);
 }
 
 void GameMap::clearSeats()
@@ -2167,67 +2327,121 @@ void GameMap::clearGoalsForAllSeats()
     mGoalsForAllSeats.clear();
 }
 
-bool GameMap::doFloodFill(Seat* seat, Tile* tile)
+bool GameMap::isTilePassableForFloodFill(int x, int y, FloodFillType floodFillType)
 {
-    if (!mFloodFillEnabled)
+    Tile* tile = getTile(x, y);
+    if(tile == nullptr)
         return false;
 
-    if(tile->isFloodFillFilled(seat))
+    if(tile->getFullness() > 0.0)
         return false;
 
-    bool hasChanged = false;
-    // If a neigboor is colored with the same colors, we color the tile
-    for(Tile* neigh : tile->getAllNeighbors())
-    {
-        switch(tile->getType())
-        {
-            case TileType::dirt:
-            case TileType::gold:
-            case TileType::rock:
-            {
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::ground, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWater, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundLava, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWaterLava, neigh);
-                break;
-            }
-            case TileType::water:
-            {
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWater, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWaterLava, neigh);
-                break;
-            }
-            case TileType::lava:
-            {
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundLava, neigh);
-                hasChanged |= tile->updateFloodFillFromTile(seat, FloodFillType::groundWaterLava, neigh);
-                break;
-            }
-            default:
-                continue;
-        }
+    // A not full tile that blocks vision is a closed door
+    if(!tile->permitsVision())
+        return false;
 
-        // If the tile is fully filled, no need to continue
-        if(tile->isFloodFillFilled(seat))
+    switch(tile->getType())
+    {
+        case TileType::dirt:
+        case TileType::gold:
+        case TileType::rock:
             return true;
+        case TileType::water:
+            // Bridges can be walked on like ground
+            if(tile->getCoveringBuilding() != nullptr)
+                return true;
+
+            return (floodFillType == FloodFillType::groundWater) ||
+                (floodFillType == FloodFillType::groundWaterLava);
+        case TileType::lava:
+            if(tile->getCoveringBuilding() != nullptr)
+                return true;
+
+            return (floodFillType == FloodFillType::groundLava) ||
+                (floodFillType == FloodFillType::groundWaterLava);
+        default:
+            return false;
     }
-
-    return hasChanged;
 }
 
-void GameMap::replaceFloodFill(Seat* seat, FloodFillType floodFillType, uint32_t colorOld, uint32_t colorNew)
+bool GameMap::isTilePassableForSeat(int x, int y, FloodFillType floodFillType, const Seat* seat,
+    bool isFightingOrFleeing)
 {
-    for (int jj = 0; jj < getMapSizeY(); ++jj)
+    Tile* tile = getTile(x, y);
+    if(tile == nullptr)
+        return false;
+
+    if((tile->getFullness() <= 0.0) &&
+       !tile->permitsVision() &&
+       (tile->getCoveringBuilding() != nullptr))
     {
-        for (int ii = 0; ii < getMapSizeX(); ++ii)
-        {
-            Tile* tile = getTile(ii,jj);
-            if(tile->getFloodFillValue(seat, floodFillType) != colorOld)
-                continue;
+        return Pathfinding::isClosedDoorPassable(tile->getCoveringBuilding()->getSeat()->isAlliedSeat(seat),
+            isFightingOrFleeing);
+    }
 
-            tile->replaceFloodFill(seat, floodFillType, colorNew);
-        }
+    return isTilePassableForFloodFill(x, y, floodFillType);
+}
+
+void GameMap::notifyTileVisionBlockingChanged(Tile* tile)
+{
+    // Vision is only computed on server side
+    if(!isServerGameMap())
+        return;
+
+    mTilesVisionBlockingChanged.push_back(tile);
+}
+
+void GameMap::notifyEntityAddedOnTile(GameEntity* entity, Tile* tile)
+{
+    if(entity->getObjectType() != GameEntityType::creature)
+        return;
+
+    mCreatureGrid.add(static_cast<Creature*>(entity), tile->getX(), tile->getY());
+}
+
+void GameMap::notifyEntityRemovedFromTile(GameEntity* entity, Tile* tile)
+{
+    if(entity->getObjectType() != GameEntityType::creature)
+        return;
+
+    if(!mCreatureGrid.remove(static_cast<Creature*>(entity), tile->getX(), tile->getY()))
+        OD_LOG_ERR(serverStr() + "creature=" + entity->getName() + " not indexed on tile=" + Tile::displayAsString(tile));
+}
+
+void GameMap::notifyCoveringBuildingChanged(Tile* tile, Building* oldBuilding, Building* newBuilding)
+{
+    if(oldBuilding != nullptr)
+        mBuildingGrid.remove(oldBuilding, tile->getX(), tile->getY());
+
+    if(newBuilding != nullptr)
+        mBuildingGrid.add(newBuilding, tile->getX(), tile->getY());
+}
+
+bool GameMap::isVisionBlockingChangedAround(int x, int y, int radius) const
+{
+    int radiusSquared = radius * radius;
+    for(Tile* tile : mTilesVisionBlockingChanged)
+    {
+        int diffX = tile->getX() - x;
+        int diffY = tile->getY() - y;
+        if(diffX * diffX + diffY * diffY <= radiusSquared)
+            return true;
     }
+
+    return false;
+}
+
+void GameMap::notifyTilePassabilityChanged(Tile* tile)
+{
+    mPathClusterGraph.markTileChanged(tile->getX(), tile->getY());
+    mDistanceFieldCache.markTileChanged(tile->getX(), tile->getY());
+}
+
+void GameMap::replaceFloodFill(Seat* seat, FloodFillType floodFillType, uint32_t colorOld, uint32_t colorNew)
+{
+    // Floodfill colors are unique for each type so we don't need to know the type: tiles
+    // will resolve colorOld as colorNew when reading their floodfill value
+    mFloodFillAliases.merge(seat->getTeamIndex(), colorOld, colorNew);
 }
 
 void GameMap::refreshFloodFill(Seat* seat, Tile* tile)
@@ -2266,6 +2480,7 @@ void GameMap::enableFloodFill()
             getTile(ii,jj)->resetFloodFill();
         }
     }
+    mFloodFillAliases.clear();
 
     // The algorithm used to find a path is efficient when the path exists but not if it doesn't.
     // To improve path finding, we tag the contiguous tiles to know if a path exists between 2 tiles or not.
@@ -2273,138 +2488,75 @@ void GameMap::enableFloodFill()
     // Note : when a tile is digged, floodfill will have to be refreshed.
     mFloodFillEnabled = true;
 
-    // To optimize floodfilling, we start by tagging the dirt tiles with fullness = 0
-    // because they are walkable for most creatures. When we will have tagged all
-    // thoses, we will deal with water/lava remaining (there can be some left if
-    // surrounded by not passable tiles).
-    FloodFillType currentType = FloodFillType::ground;
-    // We do the floodfill for the rogue seat. Then, once it is done, we copy for the other seats.
-    // If there are locked doors, floodfill will be refreshed when they are added
-    Seat* rogueSeat = getSeatRogue();
-    while(true)
-    {
-        int yy = 0;
+    // Tiles may have changed while floodfill was disabled. The path cluster graph and the distance
+    // fields will be rebuilt when they are used
+    mPathClusterGraph.clear();
+    mDistanceFieldCache.clear();
 
-        bool isTileFound;
-        isTileFound = false;
-        while(!isTileFound && (yy < getMapSizeY()))
+    // Each floodfill type is labelled independently on its own thread. Tiles are only read
+    // here to build the passability grids. Colors are then given on this thread.
+    int mapSizeX = getMapSizeX();
+    int mapSizeY = getMapSizeY();
+    uint32_t nbTypes = static_cast<uint32_t>(FloodFillType::nbValues);
+    std::vector<std::vector<uint8_t>> passables(nbTypes,
+        std::vector<uint8_t>(static_cast<uint32_t>(mapSizeX * mapSizeY), 0));
+    for(int xx = 0; xx < mapSizeX; ++xx)
+    {
+        for(int yy = 0; yy < mapSizeY; ++yy)
         {
-            for(int xx = 0; xx < getMapSizeX(); ++xx)
-            {
-                Tile* tile = getTile(xx, yy);
-                if(tile->getFullness() > 0.0)
-                    continue;
-
-                if(currentType == FloodFillType::ground)
-                {
-                    if(((tile->getType() == TileType::dirt) ||
-                        (tile->getType() == TileType::gold) ||
-                        (tile->getType() == TileType::rock)) &&
-                       (tile->getFloodFillValue(rogueSeat, FloodFillType::ground) == Tile::NO_FLOODFILL))
-                    {
-                        isTileFound = true;
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::ground) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::ground, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWater) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWater, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundLava, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWaterLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWaterLava, nextUniqueFloodFillValue());
-                        break;
-                    }
-                }
-                else if(currentType == FloodFillType::groundWater)
-                {
-                    if((tile->getType() == TileType::water) &&
-                       (tile->getFloodFillValue(rogueSeat, FloodFillType::groundWater) == Tile::NO_FLOODFILL))
-                    {
-                        isTileFound = true;
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWater) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWater, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWaterLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWaterLava, nextUniqueFloodFillValue());
-                        break;
-                    }
-                }
-                else if(currentType == FloodFillType::groundLava)
-                {
-                    if((tile->getType() == TileType::lava) &&
-                       (tile->getFloodFillValue(rogueSeat, FloodFillType::groundLava) == Tile::NO_FLOODFILL))
-                    {
-                        isTileFound = true;
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundLava, nextUniqueFloodFillValue());
-                        if(tile->getFloodFillValue(rogueSeat, FloodFillType::groundWaterLava) == Tile::NO_FLOODFILL)
-                            tile->replaceFloodFill(rogueSeat, FloodFillType::groundWaterLava, nextUniqueFloodFillValue());
-                        break;
-                    }
-                }
-            }
-
-            if(!isTileFound)
-                ++yy;
-        }
+            Tile* tile = getTile(xx, yy);
+            if(tile->getFullness() > 0.0)
+                continue;
 
-        // If there are no more walkable tiles, we go for water. Then, for lava. After that, floodfill should be complete
-        if(!isTileFound)
-        {
-            switch(currentType)
+            uint32_t index = static_cast<uint32_t>(xx * mapSizeY + yy);
+            switch(tile->getType())
             {
-                case FloodFillType::ground:
-                {
-                    // There are no more ground tiles. We go for water tiles
-                    currentType = FloodFillType::groundWater;
-                    isTileFound = true;
+                case TileType::dirt:
+                case TileType::gold:
+                case TileType::rock:
+                    passables[static_cast<uint32_t>(FloodFillType::ground)][index] = 1;
+                    passables[static_cast<uint32_t>(FloodFillType::groundWater)][index] = 1;
+                    passables[static_cast<uint32_t>(FloodFillType::groundLava)][index] = 1;
+                    passables[static_cast<uint32_t>(FloodFillType::groundWaterLava)][index] = 1;
                     break;
-                }
-                case FloodFillType::groundWater:
-                {
-                    // There are no more ground tiles. We go for water tiles
-                    currentType = FloodFillType::groundLava;
-                    isTileFound = true;
+                case TileType::water:
+                    passables[static_cast<uint32_t>(FloodFillType::groundWater)][index] = 1;
+                    passables[static_cast<uint32_t>(FloodFillType::groundWaterLava)][index] = 1;
                     break;
-                }
-                case FloodFillType::groundLava:
-                {
-                    // There are no more tiles. We can stop
+                case TileType::lava:
+                    passables[static_cast<uint32_t>(FloodFillType::groundLava)][index] = 1;
+                    passables[static_cast<uint32_t>(FloodFillType::groundWaterLava)][index] = 1;
                     break;
-                }
                 default:
-                    OD_LOG_ERR("Unexpected enum value=" + Tile::toString(currentType));
                     break;
             }
         }
+    }
 
-        if(!isTileFound)
-            break;
+    std::vector<std::vector<uint32_t>> labels;
+    std::vector<uint32_t> nbLabels;
+    FloodFillLabeling::labelConnectedTilesParallel(mapSizeX, mapSizeY, passables, labels, nbLabels);
 
-        while(yy < getMapSizeY())
+    // We do the floodfill for the rogue seat. Then, once it is done, we copy for the other seats.
+    // If there are locked doors, floodfill will be refreshed when they are added
+    Seat* rogueSeat = getSeatRogue();
+    for(uint32_t i = 0; i < nbTypes; ++i)
+    {
+        // Labels start at 1 so the colors will be the same as if they were given by nextUniqueFloodFillValue
+        FloodFillType type = static_cast<FloodFillType>(i);
+        uint32_t firstColor = mUniqueFloodFillValue;
+        mUniqueFloodFillValue += nbLabels[i];
+        const std::vector<uint32_t>& typeLabels = labels[i];
+        for(int xx = 0; xx < mapSizeX; ++xx)
         {
-            int nbTiles = 0;
-            for(int xx = 0; xx < getMapSizeX(); ++xx)
+            for(int yy = 0; yy < mapSizeY; ++yy)
             {
-                Tile* tile = getTile(xx, yy);
-                if(doFloodFill(rogueSeat, tile))
-                    ++nbTiles;
-            }
+                uint32_t label = typeLabels[static_cast<uint32_t>(xx * mapSizeY + yy)];
+                if(label == 0)
+                    continue;
 
-            // For optimization purposes, if a tile has changed, we go on the other side
-            if(nbTiles > 0)
-            {
-                for(int xx = getMapSizeX() - 1; xx >= 0; --xx)
-                {
-                    Tile* tile = getTile(xx, yy);
-                    if(doFloodFill(rogueSeat, tile))
-                        ++nbTiles;
-                }
+                getTile(xx, yy)->replaceFloodFill(rogueSeat, type, firstColor + label);
             }
-
-            // If at least one tile as been changed, we go back to the previous line
-            if((nbTiles > 0) && (yy > 0))
-                --yy;
-            else
-                ++yy;
         }
     }
 
@@ -2462,27 +2614,28 @@ void GameMap::processActiveObjectsChanges()
     if(!isServerGameMap())
         return;
 
-    // We add the queued active objects
-    while (!mActiveObjectsToAdd.empty())
-    {
-        GameEntity* ge = mActiveObjectsToAdd.front();
-        mActiveObjectsToAdd.pop_front();
-        mActiveObjects.push_back(ge);
-    }
-
-    // We remove the queued active objects
+    // We remove the queued active objects. Objects added and removed during the same turn are not in the
+    // list yet (see removeActiveObject). We remove before adding so that an object removed then added
+    // again stays in the list
     while (!mActiveObjectsToRemove.empty())
     {
         GameEntity* ge = mActiveObjectsToRemove.front();
         mActiveObjectsToRemove.pop_front();
-        std::vector<GameEntity*>::iterator it = std::find(mActiveObjects.begin(), mActiveObjects.end(), ge);
-        if(it == mActiveObjects.end())
-        {
+        if(!mActiveObjects.remove(ge))
             OD_LOG_ERR("name=" + ge->getName());
+    }
+    mActiveObjects.compact();
+
+    // We add the queued active objects
+    for(GameEntity* ge : mActiveObjectsToAdd.getSlots())
+    {
+        if(ge == nullptr)
             continue;
-        }
-        mActiveObjects.erase(it);
+
+        if(!mActiveObjects.add(ge))
+            OD_LOG_ERR("name=" + ge->getName());
     }
+    mActiveObjectsToAdd.clear();
 }
 
 void GameMap::refreshBorderingTilesOf(const std::vector<Tile*>& affectedTiles)
@@ -2704,6 +2857,46 @@ GameEntity* GameMap::getEntityFromTypeAndName(GameEntityType entityType,
     return nullptr;
 }
 
+GameEntity* GameMap::getEntityFromTypeAndNetworkId(GameEntityType entityType, uint32_t networkId) const
+{
+    MovableGameEntity* entity = getAnimatedObjectFromNetworkId(networkId);
+    if(entity == nullptr)
+        return nullptr;
+
+    if(entity->getObjectType() != entityType)
+        return nullptr;
+
+    return entity;
+}
+
+RenderedMovableEntity* GameMap::getRenderedMovableEntityFromNetworkId(uint32_t networkId) const
+{
+    MovableGameEntity* entity = getAnimatedObjectFromNetworkId(networkId);
+    if(entity == nullptr)
+        return nullptr;
+
+    // Same types as the ones in mRenderedMovableEntities (see getEntityFromTypeAndName)
+    switch(entity->getObjectType())
+    {
+        case GameEntityType::buildingObject:
+        case GameEntityType::chickenEntity:
+        case GameEntityType::craftedTrap:
+        case GameEntityType::missileObject:
+        case GameEntityType::persistentObject:
+        case GameEntityType::smallSpiderEntity:
+        case GameEntityType::trapEntity:
+        case GameEntityType::treasuryObject:
+        case GameEntityType::skillEntity:
+        case GameEntityType::giftBoxEntity:
+            return static_cast<RenderedMovableEntity*>(entity);
+
+        default:
+            break;
+    }
+
+    return nullptr;
+}
+
 void GameMap::logFloodFileTiles()
 {
     for(int yy = 0; yy < getMapSizeY(); ++yy)
@@ -2825,6 +3018,7 @@ void GameMap::addSpell(Spell *spell)
     OD_LOG_INF(serverStr() + "Adding spell " + spell->getName()
         + ",MeshName=" + spell->getMeshName());
     mSpells.push_back(spell);
+    mSpellsByName.add(spell);
 }
 
 void GameMap::removeSpell(Spell *spell)
@@ -2839,16 +3033,12 @@ void GameMap::removeSpell(Spell *spell)
     }
 
     mSpells.erase(it);
+    mSpellsByName.remove(spell);
 }
 
 Spell* GameMap::getSpell(const std::string& name) const
 {
-    for(Spell* spell : mSpells)
-    {
-        if(name.compare(spell->getName()) == 0)
-            return spell;
-    }
-    return nullptr;
+    return mSpellsByName.find(name);
 }
 
 void GameMap::clearSpells()
@@ -2862,6 +3052,7 @@ void GameMap::clearSpells()
     }
 
     mSpells.clear();
+    mSpellsByName.clear();
 }
 
 std::vector<Spell*> GameMap::getSpellsBySeatAndType(Seat* seat, SpellType type) const
@@ -3052,6 +3243,9 @@ void GameMap::clientUpKeep(int64_t turnNumber)
 
 void GameMap::doorLock(Tile* tileDoor, Seat* seat, bool locked)
 {
+    notifyTilePassabilityChanged(tileDoor);
+    notifyTileVisionBlockingChanged(tileDoor);
+
     if(!locked)
     {
         // When a door is unlocked, we check all its neighboors to find a floodfill value for each possible
@@ -3246,32 +3440,16 @@ void GameMap::notifySeatsConfigured()
 void GameMap::fireGameSound(Tile& tile, const std::string& soundFamily)
 {
     std::string sound = "Game/" + soundFamily;
-    for(Seat* seat : tile.getSeatsWithVision())
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        ServerNotification *serverNotification = new ServerNotification(
-            ServerNotificationType::playSpatialSound, seat->getPlayer());
-        serverNotification->mPacket << sound << tile.getX() << tile.getY();
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    ServerNotification *serverNotification = new ServerNotification(
+        ServerNotificationType::playSpatialSound, tile.getSeatsWithVision());
+    serverNotification->mPacket << sound << tile.getX() << tile.getY();
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
 void GameMap::fireRelativeSound(const std::vector<Seat*>& seats, const std::string& soundFamily)
 {
-    for(Seat* seat : seats)
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        ServerNotification *serverNotification = new ServerNotification(
-            ServerNotificationType::playRelativeSound, seat->getPlayer());
-        serverNotification->mPacket << soundFamily;
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    ServerNotification *serverNotification = new ServerNotification(
+        ServerNotificationType::playRelativeSound, seats);
+    serverNotification->mPacket << soundFamily;
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
@@ -18,6 +18,13 @@
 #ifndef GAMEMAP_H
 #define GAMEMAP_H
 
+#include "gamemap/AstarNodePool.h"
+#include "gamemap/FloodFillAliases.h"
+#include "gamemap/DistanceFieldCache.h"
+#include "gamemap/EntityNameIndex.h"
+#include "gamemap/EntitySlotList.h"
+#include "gamemap/PathClusterGraph.h"
+#include "gamemap/SpatialGrid.h"
 #include "gamemap/TileContainer.h"
 
 #include "ai/AIManager.h"
@@ -32,11 +39,13 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include <OgreVector3.h>
 
 class Building;
 class Tile;
+class TileBitmap;
 class Creature;
 class GameEntity;
 class Player;
@@ -51,6 +60,7 @@ class CreatureMood;
 class RenderedMovableEntity;
 class Room;
 class Spell;
+class ThreadPool;
 class TileSet;
 class TileSetValue;
 
@@ -154,6 +164,10 @@ public:
     //! nullptr if it is not found
     Creature* getCreature(const std::string& cName) const;
 
+    //! \brief Changes the name of the given creature. Should be used instead of setName once the creature
+    //! may be on the gamemap so that it can still be found by name
+    void setCreatureName(Creature* creature, const std::string& name);
+
     inline bool getIsFOWActivated() const
     { return mIsFOWActivated; }
 
@@ -172,6 +186,9 @@ public:
     void removeAnimatedObject(MovableGameEntity *a);
     MovableGameEntity* getAnimatedObject(const std::string& name) const;
 
+    //! \brief Returns the animated object with the given network id (see GameEntity::getNetworkId)
+    MovableGameEntity* getAnimatedObjectFromNetworkId(uint32_t networkId) const;
+
     void addClientUpkeepEntity(GameEntity* entity);
     void removeClientUpkeepEntity(GameEntity* entity);
 
@@ -346,14 +363,17 @@ public:
     //! \brief Tells whether a path exists between two tiles for the given creature.
     bool pathExists(const Creature* creature, Tile* tileStart, Tile* tileEnd);
 
+    //! \brief Returns the floodfill type used to check if the given creature can go from a tile to another.
+    static FloodFillType getFloodFillTypeForCreature(const Creature* creature);
+
     /*! \brief Calculates the walkable path between tileStart and one of the possibleDests. This function
      * will choose the closest tile in possibleDests and return the path between tileStart and it.
      * If a path is found, it is returned and chosenTile is set to the chosen tile. If no path is found,
      * an empty list will be returned and chosenTile will be set to nullptr
-     * Note that this function will use some magic numbers to avoid computing paths that are likely to be
-     * further
+     * All the reachable destinations are searched at the same time with a single A* search that stops
+     * on the first destination reached. So the chosen tile is the closest one in walking time.
      */
-    std::list<Tile*> findBestPath(const Creature* creature, Tile* tileStart, const std::vector<Tile*> possibleDests,
+    std::list<Tile*> findBestPath(const Creature* creature, Tile* tileStart, const std::vector<Tile*>& possibleDests,
         Tile*& chosenTile);
 
     /*! \brief Calculates the walkable path between tiles (x1, y1) and (x2, y2).
@@ -367,6 +387,9 @@ public:
      * if the creature can go through the 4 tiles.
      * \param seat The seat is used when searching a diggable path to know
      * what tile actually diggable for the given team.
+     * On big maps, if PathClusterSize is set in the global config, long paths are first
+     * searched on a graph of tile clusters (see PathClusterGraph) and refined on short
+     * segments. If that fails, the whole path is searched tile by tile.
      */
     std::list<Tile*> path(int x1, int y1, int x2, int y2, const Creature* creature, Seat* seat, bool throughDiggableTiles = false);
     std::list<Tile*> path(Creature *c1, Creature *c2, const Creature* creature, Seat* seat, bool throughDiggableTiles = false);
@@ -382,14 +405,23 @@ public:
     //! (or if enemyCreatures is true, is not allied)
     std::vector<GameEntity*> getVisibleCreatures(const std::vector<Tile*>& visibleTiles, Seat* seat, bool enemyCreatures);
 
+    //! \brief Same as getVisibleForce but the visible tiles are given as a bitmap. Only the entities indexed around
+    //! the bitmap area are checked instead of every tile
+    std::vector<GameEntity*> getVisibleForce(const TileBitmap& visibleTiles, Seat* seat, bool enemyForce);
+
+    //! \brief Same as getVisibleCreatures but the visible tiles are given as a bitmap
+    std::vector<GameEntity*> getVisibleCreatures(const TileBitmap& visibleTiles, Seat* seat, bool enemyCreatures);
+
     //! \brief Loops over the given tiles and returns any carryable entity in those tiles
     std::vector<GameEntity*> getCarryableEntities(Creature* carrier, const std::vector<Tile*>& tiles);
 
-    //! \brief Checks the neighboor tiles to see if the floodfill can be used. Floodfill consists on tagging all contiguous tiles
-    //! to be able to know before computing it if a path exists between 2 tiles. We do that to avoid computing paths when we
-    //! already know that no path exists.
-    bool doFloodFill(Seat* seat, Tile* tile);
+    //! \brief Updates the floodfill of the given tile and merges the areas around it after it has been dug. Floodfill
+    //! consists on tagging all contiguous tiles to be able to know before computing it if a path exists between 2 tiles.
+    //! We do that to avoid computing paths when we already know that no path exists.
     void refreshFloodFill(Seat* seat, Tile* tile);
+
+    //! \brief Every tile with the floodfill color colorOld for the given seat will have colorNew. Tiles are not
+    //! changed: colorOld becomes an alias of colorNew (see FloodFillAliases)
     void replaceFloodFill(Seat* seat, FloodFillType floodFillType, uint32_t colorOld, uint32_t colorNew);
 
     //! \brief Temporarily disables the flood fill computations on this game map.
@@ -466,6 +498,10 @@ public:
     inline uint32_t nextUniqueFloodFillValue()
     { return ++mUniqueFloodFillValue; }
 
+    //! \brief Floodfill colors merged since the floodfill was computed. Tiles resolve their colors through it
+    inline FloodFillAliases& getFloodFillAliases()
+    { return mFloodFillAliases; }
+
     void addRenderedMovableEntity(RenderedMovableEntity *obj);
     void removeRenderedMovableEntity(RenderedMovableEntity *obj);
     RenderedMovableEntity* getRenderedMovableEntity(const std::string& name);
@@ -473,6 +509,14 @@ public:
     GameEntity* getEntityFromTypeAndName(GameEntityType entityType,
         const std::string& entityName);
 
+    //! \brief Returns the entity with the given network id if it has the given type. Network ids are
+    //! given to the animated objects only
+    GameEntity* getEntityFromTypeAndNetworkId(GameEntityType entityType, uint32_t networkId) const;
+
+    //! \brief Returns the rendered movable entity with the given network id. Returns nullptr if the
+    //! entity with this id is not a rendered movable entity
+    RenderedMovableEntity* getRenderedMovableEntityFromNetworkId(uint32_t networkId) const;
+
     //! brief Functions to add/remove/get Spells
     inline const std::vector<Spell*>& getSpells() const
     { return mSpells; }
@@ -522,6 +566,36 @@ public:
     //! allowed to go through tile
     void doorLock(Tile* tileDoor, Seat* seat, bool locked);
 
+    //! \brief Should be called each time the given tile may have changed its passability (dug, claimed,
+    //! building added or removed, door locked, ...). The path cluster graph will repair the clusters
+    //! containing this tile before the next long path is searched and the distance fields going through
+    //! this tile will be recomputed
+    void notifyTilePassabilityChanged(Tile* tile);
+
+    //! \brief Should be called each time the given tile may start or stop blocking vision (dug, door locked, ...).
+    //! The viewers around will compute their visible tiles again at the next upkeep
+    void notifyTileVisionBlockingChanged(Tile* tile);
+
+    //! \brief Returns true if a tile blocking vision changed within the given radius since the last upkeep
+    bool isVisionBlockingChangedAround(int x, int y, int radius) const;
+
+    //! \brief Should be called when an entity is added to/removed from the given tile to keep
+    //! the creatures spatial index up to date
+    void notifyEntityAddedOnTile(GameEntity* entity, Tile* tile);
+    void notifyEntityRemovedFromTile(GameEntity* entity, Tile* tile);
+
+    //! \brief Should be called when the building covering the given tile changes to keep
+    //! the buildings spatial index up to date
+    void notifyCoveringBuildingChanged(Tile* tile, Building* oldBuilding, Building* newBuilding);
+
+    /*! \brief Returns the path from tileStart to the closest tile covered by the given building. Instead of
+     * searching the path, it follows a distance field computed from the building tiles and cached for the
+     * creature seat and floodfill type. That is meant for buildings many creatures walk to (dungeon temple,
+     * portal, ...). Distances are counted in tiles so the creature speed on water or lava is not taken into
+     * account. If the building cannot be reached, an empty list is returned.
+     */
+    std::list<Tile*> pathToBuilding(const Creature* creature, Tile* tileStart, Building* building);
+
     //! \brief Goes through all tile neighbors from startTile and replaces floodfill for all values in oldColors
     //! by newColors for each value in oldColors != Tile::NO_FLOODFILL
     //! If tileIgnored is not null, this tile won't be processed if found
@@ -560,7 +634,10 @@ private:
     int mUniqueNumberRenderedMovableEntity;
     int mUniqueNumberTrap;
     int mUniqueNumberMapLight;
+    //! \brief Last network id given to an animated object on server side
+    uint32_t mLastNetworkId;
     uint32_t mUniqueFloodFillValue;
+    FloodFillAliases mFloodFillAliases;
 
     //! \brief When paused, the GameMap is not updated.
     bool mIsPaused;
@@ -588,6 +665,20 @@ private:
     //Mutable to allow locking in const functions.
     std::vector<MovableGameEntity*> mAnimatedObjects;
 
+    //! \brief Animated objects by network id. Clients receive the id given by the server with the entity
+    //! so that network messages can refer to entities without sending their names
+    std::unordered_map<uint32_t, MovableGameEntity*> mAnimatedObjectsByNetworkId;
+
+    //! \brief The entities of the lists above and below indexed by name. They are updated when the
+    //! entities are added to or removed from the lists
+    EntityNameIndex<Creature> mCreaturesByName;
+    EntityNameIndex<MovableGameEntity> mAnimatedObjectsByName;
+    EntityNameIndex<RenderedMovableEntity> mRenderedMovableEntitiesByName;
+    EntityNameIndex<Room> mRoomsByName;
+    EntityNameIndex<Trap> mTrapsByName;
+    EntityNameIndex<MapLight> mMapLightsByName;
+    EntityNameIndex<Spell> mSpellsByName;
+
     //! \brief Map Entities
     std::vector<Room*> mRooms;
     std::vector<Trap*> mTraps;
@@ -610,10 +701,11 @@ private:
     //! When true, fog of war will work normally. When false, every connected client will see the whole map
     bool mIsFOWActivated;
 
-    std::vector<GameEntity*> mActiveObjects;
+    //! \brief Entities getting an upkeep each turn, in the order they were added
+    EntitySlotList<GameEntity> mActiveObjects;
 
     //! \brief  active objects that are created are stored here. They will be added after the miscupkeep to avoid changing the list while we use it
-    std::deque<GameEntity*> mActiveObjectsToAdd;
+    EntitySlotList<GameEntity> mActiveObjectsToAdd;
 
     //! \brief  active objects that are removed are stored here. They will be removed after the miscupkeep to avoid changing the list while we use it
     std::deque<GameEntity*> mActiveObjectsToRemove;
@@ -624,6 +716,27 @@ private:
     //! \brief Debug member used to know how many call to pathfinding has been made within the same turn.
     unsigned int mNumCallsTo_path;
 
+    //! \brief Per tile nodes reused by every call to path to avoid allocating during the search.
+    AstarNodePool mAstarNodePool;
+
+    //! \brief Abstract graph used to search long paths. It has one layer per FloodFillType.
+    //! Only used on server side when PathClusterSize is set in the global config
+    PathClusterGraph mPathClusterGraph;
+
+    //! \brief Distance fields used by pathToBuilding. Only used on server side
+    DistanceFieldCache mDistanceFieldCache;
+
+    //! \brief Tiles that may have started or stopped blocking vision since the last upkeep
+    std::vector<Tile*> mTilesVisionBlockingChanged;
+
+    //! \brief Creatures indexed by the tile they are on and buildings indexed by the tiles they cover. Used to
+    //! find the entities around a tile without looking at every tile
+    SpatialGrid<Creature*> mCreatureGrid;
+    SpatialGrid<Building*> mBuildingGrid;
+
+    //! \brief Threads used by perceiveCreatures. Created the first time there are enough creatures
+    std::unique_ptr<ThreadPool> mPerceptionPool;
+
     std::vector<RenderedMovableEntity*> mRenderedMovableEntities;
 
     std::vector<Spell*> mSpells;
@@ -638,11 +751,46 @@ private:
     std::string mTileSetName;
 
     //! \brief Updates different entities states.
-    //! Updates active objects (creatures, rooms, ...), goals, count each team Workers, gold, mana and claimed tiles.
+    //! Updates active objects (creatures, rooms, ...), goals and mana. The workers, fighters, rooms, gold and claimed
+    //! tiles counts of the seats are updated by the entities when they change (see checkSeatCounts)
     unsigned long int doMiscUpkeep(double timeSinceLastTurn);
 
+    //! \brief Perception phase of the turn: calls Creature::perceive for every creature on several threads. The
+    //! creatures only read the map during this phase. They act on what they perceived in the upkeep that follows,
+    //! one after the other like before. If PerceptionThreads is 0 or if there are not enough creatures, there is
+    //! no perception phase and the creatures compute what they see during their upkeep
+    void perceiveCreatures();
+
+    //! \brief The seat counts (claimed tiles, creatures, rooms and gold) are updated by the entities when they
+    //! change. This function recounts them on the whole map and logs an error for each count that differs.
+    //! It is called at each turn in debug builds
+    void checkSeatCounts() const;
+
     //! \brief Resets the unique numbers
     void resetUniqueNumbers();
+
+    //! \brief Searches the path between the 2 given tiles with the A* algorithm on the whole map.
+    //! The given tiles are expected to be valid
+    std::list<Tile*> pathAstar(Tile* start, Tile* destination, const Creature* creature, Seat* seat, bool throughDiggableTiles);
+
+    //! \brief Searches with the A* algorithm the path between start and the closest (in walking time) of the
+    //! nbDestinations tiles in destinations. The heuristic is the distance to the nearest destination. If a path is
+    //! found, reachedTile is set to its last tile. Otherwise, an empty list is returned and reachedTile is set to nullptr
+    std::list<Tile*> pathAstar(Tile* start, Tile* const* destinations, uint32_t nbDestinations, const Creature* creature,
+        Seat* seat, bool throughDiggableTiles, Tile*& reachedTile);
+
+    //! \brief Searches the path between the 2 given tiles on mPathClusterGraph and refines it with pathAstar
+    //! on each segment. Returns false if no path could be found that way
+    bool pathHierarchical(Tile* start, Tile* destination, const Creature* creature, Seat* seat, std::list<Tile*>& returnList);
+
+    //! \brief Returns true if the given tile can be used by a creature walking with the given floodfill type. Closed
+    //! doors are considered as not passable. Used by mPathClusterGraph
+    bool isTilePassableForFloodFill(int x, int y, FloodFillType floodFillType);
+
+    //! \brief Same as isTilePassableForFloodFill except that closed doors are only considered as not passable
+    //! for the seats allied to the door and for the creatures fighting or fleeing. Used by mDistanceFieldCache
+    bool isTilePassableForSeat(int x, int y, FloodFillType floodFillType, const Seat* seat,
+        bool isFightingOrFleeing);
 };
 
 #endif // GAMEMAP_H
@@ -0,0 +1,453 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/PathClusterGraph.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+//! \brief Runs of passable tiles on a cluster border shorter than this get only one entrance
+static const uint32_t ENTRANCE_RUN_LONG = 6;
+
+static inline double abstractHeuristic(int x1, int y1, int x2, int y2)
+{
+    return static_cast<double>(std::abs(x2 - x1) + std::abs(y2 - y1));
+}
+
+PathClusterGraph::PathClusterGraph() :
+    mMapSizeX(0),
+    mMapSizeY(0),
+    mClusterSize(0),
+    mNbClustersX(0),
+    mNbClustersY(0),
+    mNbLayers(0),
+    mNbClustersComputed(0),
+    mBfsMinX(0),
+    mBfsMinY(0),
+    mBfsSizeX(0),
+    mBfsSizeY(0)
+{
+}
+
+void PathClusterGraph::setup(int mapSizeX, int mapSizeY, int clusterSize, uint32_t nbLayers, PassabilityFunction passabilityFunction)
+{
+    clear();
+
+    if((clusterSize <= 0) || (mapSizeX <= 0) || (mapSizeY <= 0) || (nbLayers == 0))
+        return;
+
+    mMapSizeX = mapSizeX;
+    mMapSizeY = mapSizeY;
+    mClusterSize = clusterSize;
+    mNbClustersX = (mapSizeX + clusterSize - 1) / clusterSize;
+    mNbClustersY = (mapSizeY + clusterSize - 1) / clusterSize;
+    mNbLayers = nbLayers;
+    mPassabilityFunction = passabilityFunction;
+
+    uint32_t nbClusters = static_cast<uint32_t>(mNbClustersX * mNbClustersY);
+    mLayers.assign(nbLayers, std::vector<Cluster>(nbClusters));
+    mIsClusterDirty.assign(nbClusters, false);
+    mBfsDist.assign(static_cast<uint32_t>(clusterSize * clusterSize), -1);
+
+    // Every cluster will be computed at the next search
+    for(int clusterX = 0; clusterX < mNbClustersX; ++clusterX)
+    {
+        for(int clusterY = 0; clusterY < mNbClustersY; ++clusterY)
+            markClusterDirty(clusterX, clusterY);
+    }
+}
+
+void PathClusterGraph::clear()
+{
+    mMapSizeX = 0;
+    mMapSizeY = 0;
+    mClusterSize = 0;
+    mNbClustersX = 0;
+    mNbClustersY = 0;
+    mNbLayers = 0;
+    mNbClustersComputed = 0;
+    mPassabilityFunction = nullptr;
+    mLayers.clear();
+    mDirtyClusters.clear();
+    mIsClusterDirty.clear();
+    mBfsDist.clear();
+    mBfsQueue.clear();
+}
+
+void PathClusterGraph::markTileChanged(int x, int y)
+{
+    if(!isEnabled())
+        return;
+
+    if((x < 0) || (x >= mMapSizeX) || (y < 0) || (y >= mMapSizeY))
+        return;
+
+    // Repairing a cluster recomputes its 4 borders so there is no need to mark the neighbours
+    markClusterDirty(x / mClusterSize, y / mClusterSize);
+}
+
+void PathClusterGraph::markClusterDirty(int clusterX, int clusterY)
+{
+    uint32_t clusterIndex = getClusterIndex(clusterX, clusterY);
+    if(mIsClusterDirty[clusterIndex])
+        return;
+
+    mIsClusterDirty[clusterIndex] = true;
+    mDirtyClusters.push_back(clusterIndex);
+}
+
+void PathClusterGraph::repairDirtyClusters()
+{
+    if(mDirtyClusters.empty())
+        return;
+
+    // We recompute the borders of the dirty clusters. Then, as the nodes of the neighbour
+    // clusters may have changed, we recompute their costs as well
+    std::vector<bool> isClusterToCompute(mIsClusterDirty.size(), false);
+    std::vector<uint32_t> clustersToCompute;
+    for(uint32_t clusterIndex : mDirtyClusters)
+    {
+        int clusterX = static_cast<int>(clusterIndex) / mNbClustersY;
+        int clusterY = static_cast<int>(clusterIndex) % mNbClustersY;
+        for(uint32_t layer = 0; layer < mNbLayers; ++layer)
+        {
+            computeEntrancesX(layer, clusterX, clusterY);
+            computeEntrancesY(layer, clusterX, clusterY);
+            if(clusterX > 0)
+                computeEntrancesX(layer, clusterX - 1, clusterY);
+            if(clusterY > 0)
+                computeEntrancesY(layer, clusterX, clusterY - 1);
+        }
+
+        const int neighbours[5][2] = {{0, 0}, {-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        for(const int* neighbour : neighbours)
+        {
+            int neighX = clusterX + neighbour[0];
+            int neighY = clusterY + neighbour[1];
+            if((neighX < 0) || (neighX >= mNbClustersX) || (neighY < 0) || (neighY >= mNbClustersY))
+                continue;
+
+            uint32_t neighIndex = getClusterIndex(neighX, neighY);
+            if(isClusterToCompute[neighIndex])
+                continue;
+
+            isClusterToCompute[neighIndex] = true;
+            clustersToCompute.push_back(neighIndex);
+        }
+    }
+
+    for(uint32_t clusterIndex : clustersToCompute)
+    {
+        int clusterX = static_cast<int>(clusterIndex) / mNbClustersY;
+        int clusterY = static_cast<int>(clusterIndex) % mNbClustersY;
+        for(uint32_t layer = 0; layer < mNbLayers; ++layer)
+            computeCosts(layer, clusterX, clusterY);
+
+        ++mNbClustersComputed;
+    }
+
+    for(uint32_t clusterIndex : mDirtyClusters)
+        mIsClusterDirty[clusterIndex] = false;
+
+    mDirtyClusters.clear();
+}
+
+void PathClusterGraph::computeEntrancesX(uint32_t layer, int clusterX, int clusterY)
+{
+    Cluster& cluster = mLayers[layer][getClusterIndex(clusterX, clusterY)];
+    cluster.mEntrancesX.clear();
+    if(clusterX + 1 >= mNbClustersX)
+        return;
+
+    int x1 = (clusterX + 1) * mClusterSize - 1;
+    int x2 = x1 + 1;
+    int minY = clusterY * mClusterSize;
+    int maxY = std::min(minY + mClusterSize, mMapSizeY);
+    std::vector<Entrance> run;
+    for(int y = minY; y < maxY; ++y)
+    {
+        if(mPassabilityFunction(x1, y, layer) && mPassabilityFunction(x2, y, layer))
+        {
+            run.push_back({getTileIndex(x1, y), getTileIndex(x2, y)});
+            continue;
+        }
+
+        addEntrances(cluster.mEntrancesX, run);
+        run.clear();
+    }
+    addEntrances(cluster.mEntrancesX, run);
+}
+
+void PathClusterGraph::computeEntrancesY(uint32_t layer, int clusterX, int clusterY)
+{
+    Cluster& cluster = mLayers[layer][getClusterIndex(clusterX, clusterY)];
+    cluster.mEntrancesY.clear();
+    if(clusterY + 1 >= mNbClustersY)
+        return;
+
+    int y1 = (clusterY + 1) * mClusterSize - 1;
+    int y2 = y1 + 1;
+    int minX = clusterX * mClusterSize;
+    int maxX = std::min(minX + mClusterSize, mMapSizeX);
+    std::vector<Entrance> run;
+    for(int x = minX; x < maxX; ++x)
+    {
+        if(mPassabilityFunction(x, y1, layer) && mPassabilityFunction(x, y2, layer))
+        {
+            run.push_back({getTileIndex(x, y1), getTileIndex(x, y2)});
+            continue;
+        }
+
+        addEntrances(cluster.mEntrancesY, run);
+        run.clear();
+    }
+    addEntrances(cluster.mEntrancesY, run);
+}
+
+void PathClusterGraph::addEntrances(std::vector<Entrance>& entrances, const std::vector<Entrance>& run)
+{
+    if(run.empty())
+        return;
+
+    if(run.size() < ENTRANCE_RUN_LONG)
+    {
+        entrances.push_back(run[run.size() / 2]);
+        return;
+    }
+
+    entrances.push_back(run.front());
+    entrances.push_back(run.back());
+}
+
+void PathClusterGraph::computeCosts(uint32_t layer, int clusterX, int clusterY)
+{
+    Cluster& cluster = mLayers[layer][getClusterIndex(clusterX, clusterY)];
+    cluster.mNodes.clear();
+    cluster.mLinks.clear();
+
+    // A tile in a corner can be an entrance on 2 borders. In this case, it is only one node with 2 links
+    auto addNode = [&cluster](uint32_t tile, uint32_t linkedTile)
+    {
+        int pos = getNodePosition(cluster, tile);
+        if(pos < 0)
+        {
+            pos = static_cast<int>(cluster.mNodes.size());
+            cluster.mNodes.push_back(tile);
+            cluster.mLinks.emplace_back();
+        }
+        cluster.mLinks[pos].push_back(linkedTile);
+    };
+
+    for(const Entrance& entrance : cluster.mEntrancesX)
+        addNode(entrance.mTile1, entrance.mTile2);
+    for(const Entrance& entrance : cluster.mEntrancesY)
+        addNode(entrance.mTile1, entrance.mTile2);
+    if(clusterX > 0)
+    {
+        for(const Entrance& entrance : mLayers[layer][getClusterIndex(clusterX - 1, clusterY)].mEntrancesX)
+            addNode(entrance.mTile2, entrance.mTile1);
+    }
+    if(clusterY > 0)
+    {
+        for(const Entrance& entrance : mLayers[layer][getClusterIndex(clusterX, clusterY - 1)].mEntrancesY)
+            addNode(entrance.mTile2, entrance.mTile1);
+    }
+
+    uint32_t nbNodes = static_cast<uint32_t>(cluster.mNodes.size());
+    cluster.mCosts.assign(nbNodes * nbNodes, -1);
+    for(uint32_t i = 0; i < nbNodes; ++i)
+    {
+        computeDistancesInCluster(layer, static_cast<int>(cluster.mNodes[i]) / mMapSizeY,
+            static_cast<int>(cluster.mNodes[i]) % mMapSizeY);
+        for(uint32_t j = 0; j < nbNodes; ++j)
+            cluster.mCosts[i * nbNodes + j] = getDistanceInCluster(cluster.mNodes[j]);
+    }
+}
+
+void PathClusterGraph::computeDistancesInCluster(uint32_t layer, int x, int y)
+{
+    mBfsMinX = (x / mClusterSize) * mClusterSize;
+    mBfsMinY = (y / mClusterSize) * mClusterSize;
+    mBfsSizeX = std::min(mClusterSize, mMapSizeX - mBfsMinX);
+    mBfsSizeY = std::min(mClusterSize, mMapSizeY - mBfsMinY);
+    std::fill(mBfsDist.begin(), mBfsDist.end(), -1);
+    mBfsQueue.clear();
+
+    uint32_t startIndex = static_cast<uint32_t>((x - mBfsMinX) * mBfsSizeY + (y - mBfsMinY));
+    mBfsDist[startIndex] = 0;
+    mBfsQueue.push_back(startIndex);
+    for(uint32_t head = 0; head < mBfsQueue.size(); ++head)
+    {
+        uint32_t index = mBfsQueue[head];
+        int localX = static_cast<int>(index) / mBfsSizeY;
+        int localY = static_cast<int>(index) % mBfsSizeY;
+        int dist = mBfsDist[index];
+        const int neighbours[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        for(const int* neighbour : neighbours)
+        {
+            int neighX = localX + neighbour[0];
+            int neighY = localY + neighbour[1];
+            if((neighX < 0) || (neighX >= mBfsSizeX) || (neighY < 0) || (neighY >= mBfsSizeY))
+                continue;
+
+            uint32_t neighIndex = static_cast<uint32_t>(neighX * mBfsSizeY + neighY);
+            if(mBfsDist[neighIndex] >= 0)
+                continue;
+
+            if(!mPassabilityFunction(mBfsMinX + neighX, mBfsMinY + neighY, layer))
+                continue;
+
+            mBfsDist[neighIndex] = dist + 1;
+            mBfsQueue.push_back(neighIndex);
+        }
+    }
+}
+
+int PathClusterGraph::getDistanceInCluster(uint32_t tileIndex) const
+{
+    int localX = static_cast<int>(tileIndex) / mMapSizeY - mBfsMinX;
+    int localY = static_cast<int>(tileIndex) % mMapSizeY - mBfsMinY;
+    if((localX < 0) || (localX >= mBfsSizeX) || (localY < 0) || (localY >= mBfsSizeY))
+        return -1;
+
+    return mBfsDist[localX * mBfsSizeY + localY];
+}
+
+int PathClusterGraph::getNodePosition(const Cluster& cluster, uint32_t tileIndex)
+{
+    for(uint32_t i = 0; i < cluster.mNodes.size(); ++i)
+    {
+        if(cluster.mNodes[i] == tileIndex)
+            return static_cast<int>(i);
+    }
+
+    return -1;
+}
+
+bool PathClusterGraph::findPath(int x1, int y1, int x2, int y2, uint32_t layer, std::vector<std::pair<int, int>>& waypoints)
+{
+    waypoints.clear();
+    if(!isEnabled() || (layer >= mNbLayers))
+        return false;
+
+    if((x1 < 0) || (x1 >= mMapSizeX) || (y1 < 0) || (y1 >= mMapSizeY))
+        return false;
+
+    if((x2 < 0) || (x2 >= mMapSizeX) || (y2 < 0) || (y2 >= mMapSizeY))
+        return false;
+
+    if(!mPassabilityFunction(x2, y2, layer))
+        return false;
+
+    repairDirtyClusters();
+
+    const std::vector<Cluster>& clusters = mLayers[layer];
+    uint32_t startTile = getTileIndex(x1, y1);
+    uint32_t goalTile = getTileIndex(x2, y2);
+    uint32_t startClusterIndex = getClusterIndexFromTile(startTile);
+    uint32_t goalClusterIndex = getClusterIndexFromTile(goalTile);
+    const Cluster& startCluster = clusters[startClusterIndex];
+    const Cluster& goalCluster = clusters[goalClusterIndex];
+
+    // The start and goal tiles are temporarily linked to the nodes of their clusters
+    computeDistancesInCluster(layer, x1, y1);
+    mStartCosts.resize(startCluster.mNodes.size());
+    for(uint32_t i = 0; i < startCluster.mNodes.size(); ++i)
+        mStartCosts[i] = getDistanceInCluster(startCluster.mNodes[i]);
+
+    int directCost = -1;
+    if(startClusterIndex == goalClusterIndex)
+        directCost = getDistanceInCluster(goalTile);
+
+    computeDistancesInCluster(layer, x2, y2);
+    mGoalCosts.resize(goalCluster.mNodes.size());
+    for(uint32_t i = 0; i < goalCluster.mNodes.size(); ++i)
+        mGoalCosts[i] = getDistanceInCluster(goalCluster.mNodes[i]);
+
+    mNodePool.startSearch(mMapSizeX, mMapSizeY);
+    mNodePool.pushOpen(startTile, 0.0, abstractHeuristic(x1, y1, x2, y2), AstarNodePool::NO_NODE);
+    bool goalFound = false;
+    while(!mNodePool.isOpenEmpty())
+    {
+        uint32_t current = mNodePool.popOpen();
+        if(current == goalTile)
+        {
+            goalFound = true;
+            break;
+        }
+
+        double currentG = mNodePool.getG(current);
+        auto processNeighbor = [this, current, currentG, x2, y2](uint32_t tile, int cost)
+        {
+            if(cost < 0)
+                return;
+
+            if(mNodePool.isClosed(tile))
+                return;
+
+            double g = currentG + static_cast<double>(cost);
+            if(!mNodePool.isOpen(tile))
+            {
+                mNodePool.pushOpen(tile, g,
+                    abstractHeuristic(mNodePool.getX(tile), mNodePool.getY(tile), x2, y2), current);
+            }
+            else if(g < mNodePool.getG(tile))
+            {
+                mNodePool.decreaseG(tile, g, current);
+            }
+        };
+
+        if(current == startTile)
+        {
+            for(uint32_t i = 0; i < startCluster.mNodes.size(); ++i)
+                processNeighbor(startCluster.mNodes[i], mStartCosts[i]);
+
+            processNeighbor(goalTile, directCost);
+        }
+
+        uint32_t clusterIndex = getClusterIndexFromTile(current);
+        const Cluster& cluster = clusters[clusterIndex];
+        int pos = getNodePosition(cluster, current);
+        if(pos < 0)
+            continue;
+
+        uint32_t nbNodes = static_cast<uint32_t>(cluster.mNodes.size());
+        uint32_t row = static_cast<uint32_t>(pos) * nbNodes;
+        for(uint32_t i = 0; i < nbNodes; ++i)
+        {
+            if(i == static_cast<uint32_t>(pos))
+                continue;
+
+            processNeighbor(cluster.mNodes[i], cluster.mCosts[row + i]);
+        }
+
+        for(uint32_t linkedTile : cluster.mLinks[pos])
+            processNeighbor(linkedTile, 1);
+
+        if(clusterIndex == goalClusterIndex)
+            processNeighbor(goalTile, mGoalCosts[pos]);
+    }
+
+    if(!goalFound)
+        return false;
+
+    for(uint32_t index = goalTile; index != AstarNodePool::NO_NODE; index = mNodePool.getParent(index))
+        waypoints.push_back(std::make_pair(mNodePool.getX(index), mNodePool.getY(index)));
+
+    std::reverse(waypoints.begin(), waypoints.end());
+    return true;
+}
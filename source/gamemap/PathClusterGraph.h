@@ -0,0 +1,176 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PATHCLUSTERGRAPH_H
+#define PATHCLUSTERGRAPH_H
+
+#include "gamemap/AstarNodePool.h"
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+/*! \brief Abstract graph used for hierarchical pathfinding (HPA*) on big maps.
+ *
+ * The map is split in square clusters of fixed size. On each border between 2 clusters,
+ * entrances are placed on the passable tiles. Inside a cluster, the walking cost between
+ * its entrances is computed once and cached. A long path can then be searched on this small
+ * graph and refined tile by tile afterwards on short segments only.
+ *
+ * There is one graph per layer (GameMap uses one layer per FloodFillType). Tile passability is
+ * given by a callback so that this class does not depend on the tiles themselves.
+ * When a tile passability may have changed, markTileChanged should be called. Only the clusters
+ * touching that tile will be repaired (lazily, at the next search).
+ *
+ * The costs are the 4-neighbour walking distance which is what GameMap::path computes for a creature
+ * with an uniform speed (diagonals cost as much as 2 straight moves). The abstract path is not
+ * guaranteed to be the shortest one.
+ */
+class PathClusterGraph
+{
+public:
+    //! \brief Should return true if the tile at the given position is passable for the given layer
+    typedef std::function<bool(int x, int y, uint32_t layer)> PassabilityFunction;
+
+    PathClusterGraph();
+
+    //! \brief Initializes the graph. All the clusters will be computed at the next search.
+    //! If clusterSize is 0, the graph is disabled
+    void setup(int mapSizeX, int mapSizeY, int clusterSize, uint32_t nbLayers, PassabilityFunction passabilityFunction);
+
+    //! \brief Disables the graph and releases the memory
+    void clear();
+
+    inline bool isEnabled() const
+    { return mClusterSize > 0; }
+
+    inline int getClusterSize() const
+    { return mClusterSize; }
+
+    //! \brief Marks the clusters containing the given tile as needing a repair. That should be
+    //! called each time a tile passability may have changed (dug, claimed, door locked, ...)
+    void markTileChanged(int x, int y);
+
+    //! \brief Searches a path on the abstract graph from (x1,y1) to (x2,y2). The start tile is considered
+    //! passable. If a path is found, returns true and fills waypoints with the tiles (start and goal
+    //! included) the path goes through. Consecutive waypoints are either in the same cluster or next
+    //! to each other.
+    bool findPath(int x1, int y1, int x2, int y2, uint32_t layer, std::vector<std::pair<int, int>>& waypoints);
+
+    //! \brief Returns the number of clusters repaired since the graph was set up. Used for tests
+    inline uint32_t getNbClustersComputed() const
+    { return mNbClustersComputed; }
+
+private:
+    //! \brief Entrance between 2 neighbour clusters. mTile1 is in the cluster with the lowest
+    //! coordinates and mTile2 in the other one. Tiles are stored as map indexes
+    struct Entrance
+    {
+        uint32_t mTile1;
+        uint32_t mTile2;
+    };
+
+    struct Cluster
+    {
+        //! \brief Entrances on the border with the cluster at x + 1
+        std::vector<Entrance> mEntrancesX;
+        //! \brief Entrances on the border with the cluster at y + 1
+        std::vector<Entrance> mEntrancesY;
+        //! \brief Tiles of this cluster used as abstract nodes
+        std::vector<uint32_t> mNodes;
+        //! \brief For each node, the tiles in the neighbour clusters it is linked to
+        std::vector<std::vector<uint32_t>> mLinks;
+        //! \brief Walking cost between nodes (mNodes.size() * mNodes.size()). -1 if not reachable
+        std::vector<int> mCosts;
+    };
+
+    int mMapSizeX;
+    int mMapSizeY;
+    int mClusterSize;
+    int mNbClustersX;
+    int mNbClustersY;
+    uint32_t mNbLayers;
+    PassabilityFunction mPassabilityFunction;
+
+    //! \brief Clusters for each layer: mLayers[layer][clusterX * mNbClustersY + clusterY]
+    std::vector<std::vector<Cluster>> mLayers;
+
+    //! \brief Clusters to repair (for all layers) and a flag to avoid duplicates. When a cluster is
+    //! repaired, its 4 borders are recomputed and so are its neighbours costs
+    std::vector<uint32_t> mDirtyClusters;
+    std::vector<bool> mIsClusterDirty;
+
+    uint32_t mNbClustersComputed;
+
+    //! \brief Used for searches on the abstract graph
+    AstarNodePool mNodePool;
+
+    //! \brief Scratch buffers for the searches inside clusters
+    std::vector<int> mBfsDist;
+    int mBfsMinX;
+    int mBfsMinY;
+    int mBfsSizeX;
+    int mBfsSizeY;
+    std::vector<uint32_t> mBfsQueue;
+    std::vector<int> mStartCosts;
+    std::vector<int> mGoalCosts;
+
+    inline uint32_t getTileIndex(int x, int y) const
+    { return static_cast<uint32_t>(x * mMapSizeY + y); }
+
+    inline uint32_t getClusterIndex(int clusterX, int clusterY) const
+    { return static_cast<uint32_t>(clusterX * mNbClustersY + clusterY); }
+
+    inline uint32_t getClusterIndexFromTile(uint32_t tileIndex) const
+    {
+        int x = static_cast<int>(tileIndex) / mMapSizeY;
+        int y = static_cast<int>(tileIndex) % mMapSizeY;
+        return getClusterIndex(x / mClusterSize, y / mClusterSize);
+    }
+
+    void markClusterDirty(int clusterX, int clusterY);
+
+    //! \brief Repairs the clusters marked as dirty and their neighbours
+    void repairDirtyClusters();
+
+    //! \brief Computes the entrances on the border with the cluster at x + 1
+    void computeEntrancesX(uint32_t layer, int clusterX, int clusterY);
+
+    //! \brief Computes the entrances on the border with the cluster at y + 1
+    void computeEntrancesY(uint32_t layer, int clusterX, int clusterY);
+
+    //! \brief Adds entrances for a run of passable tile pairs along a border. Short runs get one entrance in
+    //! the middle, long ones get one on each end
+    static void addEntrances(std::vector<Entrance>& entrances, const std::vector<Entrance>& run);
+
+    //! \brief Computes the nodes of the cluster and the walking costs between them
+    void computeCosts(uint32_t layer, int clusterX, int clusterY);
+
+    //! \brief Computes the walking distance from (x,y) to every tile of the cluster it belongs to.
+    //! The start tile is considered passable. Results are in mBfsDist (-1 if not reachable)
+    void computeDistancesInCluster(uint32_t layer, int x, int y);
+
+    //! \brief Returns the distance computed by the last call to computeDistancesInCluster to the given
+    //! tile or -1 if it is not reachable or not in the cluster
+    int getDistanceInCluster(uint32_t tileIndex) const;
+
+    //! \brief Returns the position of the given tile in the cluster nodes or -1 if it is not a node
+    static int getNodePosition(const Cluster& cluster, uint32_t tileIndex);
+};
+
+#endif // PATHCLUSTERGRAPH_H
@@ -42,6 +42,13 @@ namespace Pathfinding
     {
         return squaredDistance(ent1.getX(), ent2.getX(), ent1.getY(), ent2.getY());
     }
+
+    //! \brief Returns true if a creature can go through a closed door. Closed doors block the creatures allied
+    //! to the door owner. Enemy creatures can go through them unless they are fighting or fleeing
+    inline bool isClosedDoorPassable(bool isAlliedToDoor, bool isFightingOrFleeing)
+    {
+        return !isAlliedToDoor && !isFightingOrFleeing;
+    }
 }
 
 #endif // PATHFINDING_H
@@ -0,0 +1,298 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/ShadowCastingTable.h"
+
+#include <algorithm>
+
+const int ShadowCastingTable::OCTANT_TRANSFORMS[8][4] =
+{
+    { 1,  0,  0,  1},
+    { 0,  1, -1,  0},
+    {-1,  0,  0, -1},
+    { 0, -1,  1,  0},
+    { 0,  1,  1,  0},
+    { 1,  0,  0, -1},
+    { 0, -1, -1,  0},
+    {-1,  0,  0,  1}
+};
+
+static void computeHiddenTile(const ShadowCastingTable::Entry& hider, double coefNorth, double coefSouth,
+    const ShadowCastingTable::Entry& tileDistance, uint32_t indexTileDistance,
+    std::vector<ShadowCastingTable::HiddenTile>& hiddenNorth, std::vector<ShadowCastingTable::HiddenTile>& hiddenSouth)
+{
+    // A tile can only hide tiles behind (x > tile.x and y > tile.y)
+    if(tileDistance.mDiffX < hider.mDiffX)
+        return;
+    if(tileDistance.mDiffY < hider.mDiffY)
+        return;
+
+    // We don't want a tile to hide itself
+    if((tileDistance.mDiffX == hider.mDiffX) &&
+       (tileDistance.mDiffY == hider.mDiffY))
+    {
+        return;
+    }
+
+    if(hider.mType == ShadowCastingTable::EntryType::Horizontal)
+    {
+        // For horizontal tiles, we hide following tiles (x > tile.x). But we process
+        // north tiles normally
+        if(tileDistance.mType == ShadowCastingTable::EntryType::Horizontal)
+        {
+            hiddenSouth.push_back({indexTileDistance, 1.0});
+            return;
+        }
+
+        double xTileDeb = static_cast<double>(tileDistance.mDiffX) - 0.5;
+        double xTileEnd = xTileDeb + 1.0;
+        double yTileDeb = static_cast<double>(tileDistance.mDiffY) - 0.5;
+        double yTileEnd = yTileDeb + 1.0;
+        double yHideDebNorth = coefNorth * xTileDeb;
+        double yHideEndNorth = coefNorth * xTileEnd;
+
+        // If the tile is over the North ray, it is not hidden
+        if(yHideEndNorth <= yTileDeb)
+            return;
+
+        // We check which part of the tile is hidden
+        if((yHideDebNorth >= yTileDeb) &&
+           (yHideEndNorth <= yTileEnd))
+        {
+            // The ray hits the left side of the tile and the right side.
+            // The south part is partially hidden
+            double hiddenArea = (yHideEndNorth - yHideDebNorth) / 2.0;
+            hiddenArea += yHideDebNorth - yTileDeb;
+            hiddenSouth.push_back({indexTileDistance, hiddenArea});
+        }
+        else if((yHideDebNorth < yTileDeb) &&
+                (yHideEndNorth > yTileDeb))
+        {
+            // The ray hits the bottom side of the tile but hits the right side. We compute
+            // the south visible part
+            double xHit = yTileDeb / coefNorth;
+            double hiddenArea = (yHideEndNorth - yTileDeb) * (xTileEnd - xHit) / 2.0;
+            hiddenSouth.push_back({indexTileDistance, hiddenArea});
+        }
+        else if((yHideDebNorth < yTileEnd) &&
+                (yHideEndNorth > yTileEnd))
+        {
+            // The ray hits the left side of the tile but is over the right side. We compute
+            // the hidden part on north.
+            double xHit = yTileEnd / coefNorth;
+            double visibleArea = (yTileEnd - yHideDebNorth) * (xHit - xTileDeb) / 2.0;
+            hiddenSouth.push_back({indexTileDistance, 1.0 - visibleArea});
+        }
+        else
+        {
+            // The entire tile is hidden
+            hiddenSouth.push_back({indexTileDistance, 1.0});
+        }
+
+        return;
+    }
+
+    double xTileDeb = static_cast<double>(tileDistance.mDiffX) - 0.5;
+    double xTileEnd = xTileDeb + 1.0;
+    double yTileDeb = static_cast<double>(tileDistance.mDiffY) - 0.5;
+    double yTileEnd = yTileDeb + 1.0;
+
+    // We check if the current tile is hidden by the tile. To consider that the
+    // tile is hidden by the south, as we know the angle will be between 0 and 45 degrees,
+    // we consider that the tile has to be hit by the ray passing through the hiding tile
+    // on the left side of the tile (otherwise, the hidden part will be too small).
+    double yHideDebSouth = coefSouth * xTileDeb;
+    double yHideEndSouth = coefSouth * xTileEnd;
+    double yHideDebNorth = coefNorth * xTileDeb;
+    double yHideEndNorth = coefNorth * xTileEnd;
+    // We check if at least a part of the tile is hidden
+    if((yHideDebSouth < yTileEnd) &&
+       (yHideEndNorth > yTileDeb))
+    {
+        // At least a part of this tile is hidden
+        if((yHideDebSouth >= yTileDeb) &&
+           (yHideEndSouth <= yTileEnd))
+        {
+            // The ray hits the left side of the tile and the right side.
+            // The south part is partially hidden
+            // The visible part is composed from a square between the tile inferior part and
+            // the triangle made by the ray
+            double visibleArea = (yHideEndSouth - yHideDebSouth) / 2.0;
+            visibleArea += yHideDebSouth - yTileDeb;
+            hiddenNorth.push_back({indexTileDistance, 1.0 - visibleArea});
+        }
+        else if((yHideDebSouth < yTileDeb) &&
+                (yHideEndSouth > yTileDeb))
+        {
+            // The ray hits the bottom side of the tile but hits the right side. We compute
+            // the south visible part
+            double xHit = yTileDeb / coefSouth;
+            double visibleArea = (yHideEndSouth - yTileDeb) * (xTileEnd - xHit) / 2.0;
+            hiddenNorth.push_back({indexTileDistance, 1.0 - visibleArea});
+        }
+        else if((yHideDebSouth < yTileEnd) &&
+                (yHideEndSouth > yTileEnd))
+        {
+            // The ray hits the left side of the tile but is over the right side. We compute
+            // the hidden part on north.
+            double xHit = yTileEnd / coefSouth;
+            double hiddenArea = (yTileEnd - yHideDebSouth) * (xHit - xTileDeb) / 2.0;
+            hiddenNorth.push_back({indexTileDistance, hiddenArea});
+
+        }
+        else if((yHideDebNorth >= yTileDeb) &&
+           (yHideEndNorth <= yTileEnd))
+        {
+            double hiddenArea = (yHideEndNorth - yHideDebNorth) / 2.0;
+            hiddenArea += yHideDebNorth - yTileDeb;
+            hiddenSouth.push_back({indexTileDistance, hiddenArea});
+        }
+        else if((yHideDebNorth < yTileDeb) &&
+                (yHideEndNorth > yTileDeb))
+        {
+            // The ray hits the bottom side of the tile but hits the right side. We compute
+            // the south visible part
+            double xHit = yTileDeb / coefNorth;
+            double hiddenArea = (yHideEndNorth - yTileDeb) * (xTileEnd - xHit) / 2.0;
+            hiddenSouth.push_back({indexTileDistance, hiddenArea});
+        }
+        else if((yHideDebNorth < yTileEnd) &&
+                (yHideEndNorth > yTileEnd))
+        {
+            // The ray hits the left side of the tile but is over the right side. We compute
+            // the hidden part on north.
+            double xHit = yTileEnd / coefNorth;
+            double visibleArea = (yTileEnd - yHideDebNorth) * (xHit - xTileDeb) / 2.0;
+            hiddenSouth.push_back({indexTileDistance, 1.0 - visibleArea});
+        }
+        else
+        {
+            // The entire tile is hidden
+            hiddenSouth.push_back({indexTileDistance, 1.0});
+        }
+    }
+}
+
+static bool sortByDistSquared(const ShadowCastingTable::Entry& entry1, const ShadowCastingTable::Entry& entry2)
+{
+    return entry1.mDistSquared < entry2.mDistSquared;
+}
+
+void ShadowCastingTable::build(int radius)
+{
+    if(mRadiusComputed >= radius)
+        return;
+
+    // We want to be able to fill a vector of tiles sorted beginning with the closest tile. If we look a grid (each letter
+    // represents a tile at the same distance from the center: a):
+    // jihghij
+    // ifedefi
+    // hecbceh
+    // gdbabdg
+    // hecbceh
+    // ifedefi
+    // jihghij
+    // We can see that there are 3 kind of tiles:
+    // - Vertical/Horizontal tiles (abdg): at each distance, there are 4 of them
+    // - Diagonal tiles (acfj): at each distance, there are 4 of them
+    // - Other tiles (ehi...): at each distance, there are 8 of them
+    // Moreover, we can see a symmetry. We can compute all tiles by computing only 1/8 tiles:
+    //    j
+    //   fi
+    //  ceh
+    // abdg
+
+    // If we compute only the minimum tiles needed, we have no vertical tiles (since each of them can be deduced from the horizontal)
+    // To compute tiles easily, we will compute the 1/8 tiles until distance. Then, we will sort the tiles to begin with
+    // closest distance until farthest
+    mEntries.clear();
+    for(int y = 0; y <= radius; ++y)
+    {
+        for(int x = y; x <= radius; ++x)
+        {
+            EntryType type;
+            if(y == 0)
+                type = EntryType::Horizontal;
+            else if(x == y)
+                type = EntryType::Diagonal;
+            else
+                type = EntryType::Other;
+
+            mEntries.push_back({x, y, type, x * x + y * y, 0, 0, 0, 0});
+        }
+    }
+
+    std::sort(mEntries.begin(), mEntries.end(), sortByDistSquared);
+
+    // We have filled the entries. Now, we fill how each tile hides the other ones when they mask vision
+    // to help calculate visible tiles. The hidden entries are stored contiguously to be processed quickly
+    mHiddenTiles.clear();
+    std::vector<HiddenTile> hiddenNorth;
+    std::vector<HiddenTile> hiddenSouth;
+    for(Entry& entry : mEntries)
+    {
+        uint32_t begin = static_cast<uint32_t>(mHiddenTiles.size());
+        entry.mHiddenNorthBegin = begin;
+        entry.mHiddenNorthEnd = begin;
+        entry.mHiddenSouthBegin = begin;
+        entry.mHiddenSouthEnd = begin;
+
+        // We don't process the first tile
+        if(entry.mDiffX == 0 && entry.mDiffY == 0)
+            continue;
+
+        // Other tiles can hide with their down side and their up side other tiles
+        // or diagonal tiles (but not Horizontal tiles)
+        // We compute the tiles hidden from the south. In this case, only tiles with
+        // x > tile.x can be hidden
+        double coefNorth = (static_cast<double>(entry.mDiffY) + 0.5) / (static_cast<double>(entry.mDiffX) - 0.5);
+        double coefSouth = (static_cast<double>(entry.mDiffY) - 0.5) / (static_cast<double>(entry.mDiffX) + 0.5);
+        hiddenNorth.clear();
+        hiddenSouth.clear();
+        for(uint32_t index = 0; index < mEntries.size(); ++index)
+            computeHiddenTile(entry, coefNorth, coefSouth, mEntries[index], index, hiddenNorth, hiddenSouth);
+
+        mHiddenTiles.insert(mHiddenTiles.end(), hiddenNorth.begin(), hiddenNorth.end());
+        entry.mHiddenNorthEnd = static_cast<uint32_t>(mHiddenTiles.size());
+        entry.mHiddenSouthBegin = entry.mHiddenNorthEnd;
+        mHiddenTiles.insert(mHiddenTiles.end(), hiddenSouth.begin(), hiddenSouth.end());
+        entry.mHiddenSouthEnd = static_cast<uint32_t>(mHiddenTiles.size());
+    }
+
+    mNbEntriesByRadius.assign(radius + 1, 0);
+    uint32_t nbEntries = 0;
+    for(int r = 0; r <= radius; ++r)
+    {
+        while((nbEntries < mEntries.size()) && (mEntries[nbEntries].mDistSquared <= r * r))
+            ++nbEntries;
+
+        mNbEntriesByRadius[r] = nbEntries;
+    }
+
+    mRadiusComputed = radius;
+}
+
+uint32_t ShadowCastingTable::getNbEntries(int radius) const
+{
+    if((radius < 0) || (mRadiusComputed < 0))
+        return 0;
+
+    if(radius > mRadiusComputed)
+        radius = mRadiusComputed;
+
+    return mNbEntriesByRadius[radius];
+}
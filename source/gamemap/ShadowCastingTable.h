@@ -0,0 +1,217 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHADOWCASTINGTABLE_H
+#define SHADOWCASTINGTABLE_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Precomputed tables used to compute the tiles within a radius and the ones visible from a tile.
+ *
+ * The table contains the 1/8 of the disc with diffX >= diffY >= 0 sorted by distance to the center (more
+ * explanation can be found in ShadowCastingTable::build). For each entry, we also store the entries it hides
+ * when it blocks vision, north and south of the ray going through it. The other octants are deduced by symmetry.
+ * The table only depends on the radius: it is built once and shared by all the requests.
+ */
+class ShadowCastingTable
+{
+public:
+    enum class EntryType
+    {
+        Horizontal,
+        Diagonal,
+        Other
+    };
+
+    struct Entry
+    {
+        int mDiffX;
+        int mDiffY;
+        EntryType mType;
+        int mDistSquared;
+        //! \brief Range in mHiddenTiles of the entries this one hides from the north
+        uint32_t mHiddenNorthBegin;
+        uint32_t mHiddenNorthEnd;
+        //! \brief Range in mHiddenTiles of the entries this one hides from the south
+        uint32_t mHiddenSouthBegin;
+        uint32_t mHiddenSouthEnd;
+    };
+
+    struct HiddenTile
+    {
+        //! \brief Index of the hidden entry
+        uint32_t mIndex;
+        //! \brief Part of the hidden entry covered by the shadow
+        double mHiddenValue;
+    };
+
+    //! \brief Working state of an entry while computing visible tiles. It is given by the caller so
+    //! that the buffer can be reused from a call to the other
+    template<typename T>
+    struct ProcessState
+    {
+        T mElement;
+        double mHiddenNorth;
+        double mHiddenSouth;
+    };
+
+    ShadowCastingTable() :
+        mRadiusComputed(-1)
+    {}
+
+    //! \brief Builds the table up to the given radius. Does nothing if a bigger radius has already been built
+    void build(int radius);
+
+    inline int getRadiusComputed() const
+    { return mRadiusComputed; }
+
+    inline const std::vector<Entry>& getEntries() const
+    { return mEntries; }
+
+    inline const std::vector<HiddenTile>& getHiddenTiles() const
+    { return mHiddenTiles; }
+
+    //! \brief Returns the number of entries within the given radius. Because entries are sorted by distance, they
+    //! are the first ones in getEntries(). The radius is clamped to the computed one
+    uint32_t getNbEntries(int radius) const;
+
+    /*! \brief Fills visible with the elements visible from the center within radius, sorted from the closest to the
+     * furthest. The table must have been built for at least radius.
+     * T is a pointer like type where a null value means there is nothing at the given position (out of the map).
+     * \param getElement getElement(diffX, diffY) returns the element at the given position from the center
+     * \param isOpaque isOpaque(element) returns true if the given (not null) element blocks vision
+     * \param states Buffer used for the computation. Once it is big enough, no memory is allocated
+     */
+    template<typename T, typename GetElement, typename IsOpaque>
+    void computeVisible(int radius, GetElement getElement, IsOpaque isOpaque,
+        std::vector<T>& visible, std::vector<ProcessState<T>>& states) const;
+
+private:
+    //! \brief Coefficients (a, b, c, d) such as the octant k tile is at (a * diffX + b * diffY, c * diffX + d * diffY).
+    //! Octants are, in this order (c being the center):
+    //! 514
+    //! 2c0
+    //! 637
+    //! Octants k and k + 4 are symmetric with respect to the diagonal
+    static const int OCTANT_TRANSFORMS[8][4];
+
+    std::vector<Entry> mEntries;
+
+    std::vector<HiddenTile> mHiddenTiles;
+
+    //! \brief mNbEntriesByRadius[r] is the number of entries with distSquared <= r * r
+    std::vector<uint32_t> mNbEntriesByRadius;
+
+    int mRadiusComputed;
+};
+
+template<typename T, typename GetElement, typename IsOpaque>
+void ShadowCastingTable::computeVisible(int radius, GetElement getElement, IsOpaque isOpaque,
+    std::vector<T>& visible, std::vector<ProcessState<T>>& states) const
+{
+    visible.clear();
+    uint32_t nbEntries = getNbEntries(radius);
+    if(nbEntries == 0)
+        return;
+
+    // We process the table 8 times, once per octant. Because we want the indexes to be the same as in the table,
+    // we keep the null elements
+    states.resize(8 * nbEntries);
+    for(uint32_t k = 0; k < 8; ++k)
+    {
+        const int* transform = OCTANT_TRANSFORMS[k];
+        ProcessState<T>* octant = states.data() + k * nbEntries;
+        for(uint32_t i = 0; i < nbEntries; ++i)
+        {
+            const Entry& entry = mEntries[i];
+            ProcessState<T>& state = octant[i];
+            state.mElement = getElement(transform[0] * entry.mDiffX + transform[1] * entry.mDiffY,
+                transform[2] * entry.mDiffX + transform[3] * entry.mDiffY);
+            state.mHiddenNorth = 0.0;
+            state.mHiddenSouth = 0.0;
+        }
+    }
+
+    // Now, we apply the shadows of the elements blocking vision. We only keep the highest value
+    for(uint32_t k = 0; k < 8; ++k)
+    {
+        ProcessState<T>* octant = states.data() + k * nbEntries;
+        for(uint32_t i = 0; i < nbEntries; ++i)
+        {
+            if(!octant[i].mElement)
+                continue;
+
+            if(!isOpaque(octant[i].mElement))
+                continue;
+
+            const Entry& entry = mEntries[i];
+            // The table might be bigger than the radius asked. We skip the hidden entries outside
+            for(uint32_t h = entry.mHiddenNorthBegin; h < entry.mHiddenNorthEnd; ++h)
+            {
+                const HiddenTile& hidden = mHiddenTiles[h];
+                if((hidden.mIndex < nbEntries) && (hidden.mHiddenValue > octant[hidden.mIndex].mHiddenNorth))
+                    octant[hidden.mIndex].mHiddenNorth = hidden.mHiddenValue;
+            }
+            for(uint32_t h = entry.mHiddenSouthBegin; h < entry.mHiddenSouthEnd; ++h)
+            {
+                const HiddenTile& hidden = mHiddenTiles[h];
+                if((hidden.mIndex < nbEntries) && (hidden.mHiddenValue > octant[hidden.mIndex].mHiddenSouth))
+                    octant[hidden.mIndex].mHiddenSouth = hidden.mHiddenValue;
+            }
+        }
+    }
+
+    // Horizontal entries are common to octants k and k + 4 and diagonal ones have to be merged (south hiding and
+    // north hiding are not computed within the same octant). Both are processed for k < 4 only
+    for(uint32_t i = 0; i < nbEntries; ++i)
+    {
+        const Entry& entry = mEntries[i];
+        for(uint32_t k = 0; k < 8; ++k)
+        {
+            ProcessState<T>& state = states[k * nbEntries + i];
+            if(!state.mElement)
+                continue;
+
+            // We avoid adding several times the center
+            if((k > 0) && (entry.mDistSquared == 0))
+                continue;
+
+            if((k > 3) && (entry.mType != EntryType::Other))
+                continue;
+
+            double hiddenNorth = state.mHiddenNorth;
+            double hiddenSouth = state.mHiddenSouth;
+            if(entry.mType == EntryType::Diagonal)
+            {
+                // Because diagonal octants are inverted, south hidden value becomes north and vice-versa
+                const ProcessState<T>& state2 = states[(k + 4) * nbEntries + i];
+                if(state2.mHiddenSouth > hiddenNorth)
+                    hiddenNorth = state2.mHiddenSouth;
+                if(state2.mHiddenNorth > hiddenSouth)
+                    hiddenSouth = state2.mHiddenNorth;
+            }
+
+            if((hiddenNorth + hiddenSouth) > 0.5)
+                continue;
+
+            visible.push_back(state.mElement);
+        }
+    }
+}
+
+#endif // SHADOWCASTINGTABLE_H
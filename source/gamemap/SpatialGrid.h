@@ -0,0 +1,152 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*! \brief Uniform grid storing elements by the tiles they are on. The map is split in square cells of
+ * CELL_SIZE tiles and each cell stores the (element, tile) pairs within it. That allows to find the elements
+ * around a tile by looking only at the few cells around instead of at every tile.
+ * An element covering several tiles (like a room) is added once per tile.
+ */
+template<typename T>
+class SpatialGrid
+{
+public:
+    static const int CELL_SIZE = 8;
+
+    struct Entry
+    {
+        T mElement;
+        int mX;
+        int mY;
+    };
+
+    SpatialGrid() :
+        mMapSizeX(0),
+        mMapSizeY(0),
+        mNbCellsX(0),
+        mNbCellsY(0),
+        mNbEntries(0)
+    {}
+
+    //! \brief Sets the map size and removes all the elements
+    void reset(int mapSizeX, int mapSizeY)
+    {
+        mMapSizeX = std::max(0, mapSizeX);
+        mMapSizeY = std::max(0, mapSizeY);
+        mNbCellsX = (mMapSizeX + CELL_SIZE - 1) / CELL_SIZE;
+        mNbCellsY = (mMapSizeY + CELL_SIZE - 1) / CELL_SIZE;
+        mCells.clear();
+        mCells.resize(static_cast<uint32_t>(mNbCellsX * mNbCellsY));
+        mNbEntries = 0;
+    }
+
+    //! \brief Removes all the elements without changing the map size
+    void clear()
+    {
+        for(std::vector<Entry>& cell : mCells)
+            cell.clear();
+        mNbEntries = 0;
+    }
+
+    //! \brief Adds the element on the given tile. Tiles out of the map are ignored
+    void add(T element, int x, int y)
+    {
+        std::vector<Entry>* cell = getCell(x, y);
+        if(cell == nullptr)
+            return;
+
+        cell->push_back({element, x, y});
+        ++mNbEntries;
+    }
+
+    //! \brief Removes the element from the given tile. Returns false if it was not there
+    bool remove(T element, int x, int y)
+    {
+        std::vector<Entry>* cell = getCell(x, y);
+        if(cell == nullptr)
+            return false;
+
+        for(Entry& entry : *cell)
+        {
+            if((entry.mElement != element) || (entry.mX != x) || (entry.mY != y))
+                continue;
+
+            // The order within a cell does not matter
+            entry = cell->back();
+            cell->pop_back();
+            --mNbEntries;
+            return true;
+        }
+
+        return false;
+    }
+
+    //! \brief Calls func(element, x, y) for each element on a tile within the given rectangle (bounds included)
+    template<typename Func>
+    void forEachInRect(int xMin, int yMin, int xMax, int yMax, Func func) const
+    {
+        if(mNbEntries == 0)
+            return;
+
+        int cellXMin = std::max(0, xMin / CELL_SIZE);
+        int cellYMin = std::max(0, yMin / CELL_SIZE);
+        int cellXMax = std::min(mNbCellsX - 1, xMax / CELL_SIZE);
+        int cellYMax = std::min(mNbCellsY - 1, yMax / CELL_SIZE);
+        for(int cellX = cellXMin; cellX <= cellXMax; ++cellX)
+        {
+            for(int cellY = cellYMin; cellY <= cellYMax; ++cellY)
+            {
+                const std::vector<Entry>& cell = mCells[static_cast<uint32_t>(cellX * mNbCellsY + cellY)];
+                for(const Entry& entry : cell)
+                {
+                    if((entry.mX < xMin) || (entry.mX > xMax) || (entry.mY < yMin) || (entry.mY > yMax))
+                        continue;
+
+                    func(entry.mElement, entry.mX, entry.mY);
+                }
+            }
+        }
+    }
+
+    inline uint32_t getNbEntries() const
+    { return mNbEntries; }
+
+private:
+    std::vector<Entry>* getCell(int x, int y)
+    {
+        if((x < 0) || (y < 0) || (x >= mMapSizeX) || (y >= mMapSizeY))
+            return nullptr;
+
+        return &mCells[static_cast<uint32_t>((x / CELL_SIZE) * mNbCellsY + y / CELL_SIZE)];
+    }
+
+    int mMapSizeX;
+    int mMapSizeY;
+    int mNbCellsX;
+    int mNbCellsY;
+    //! \brief Cells indexed by cellX * mNbCellsY + cellY
+    std::vector<std::vector<Entry>> mCells;
+    uint32_t mNbEntries;
+};
+
+#endif // SPATIALGRID_H
@@ -0,0 +1,100 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gamemap/TileBitmap.h"
+
+TileBitmap::TileBitmap() :
+    mOriginX(0),
+    mOriginY(0),
+    mSizeX(0),
+    mSizeY(0),
+    mWordsPerRow(0)
+{
+}
+
+void TileBitmap::reset(int originX, int originY, int sizeX, int sizeY)
+{
+    if(sizeX < 0)
+        sizeX = 0;
+    if(sizeY < 0)
+        sizeY = 0;
+
+    mOriginX = originX;
+    mOriginY = originY;
+    mSizeX = sizeX;
+    mSizeY = sizeY;
+    mWordsPerRow = (static_cast<uint32_t>(sizeY) + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    mWords.assign(static_cast<uint32_t>(sizeX) * mWordsPerRow, 0);
+}
+
+void TileBitmap::clearAll()
+{
+    mWords.assign(mWords.size(), 0);
+}
+
+bool TileBitmap::isSameArea(const TileBitmap& other) const
+{
+    return (mOriginX == other.mOriginX) &&
+        (mOriginY == other.mOriginY) &&
+        (mSizeX == other.mSizeX) &&
+        (mSizeY == other.mSizeY);
+}
+
+void TileBitmap::orWith(const TileBitmap& other)
+{
+    if(!isSameArea(other))
+        return;
+
+    uint64_t* words = mWords.data();
+    const uint64_t* otherWords = other.mWords.data();
+    uint32_t nbWords = static_cast<uint32_t>(mWords.size());
+    for(uint32_t i = 0; i < nbWords; ++i)
+        words[i] |= otherWords[i];
+}
+
+void TileBitmap::andNot(const TileBitmap& bitmap1, const TileBitmap& bitmap2, TileBitmap& result)
+{
+    if(!result.isSameArea(bitmap1))
+        result.reset(bitmap1.mOriginX, bitmap1.mOriginY, bitmap1.mSizeX, bitmap1.mSizeY);
+
+    if(!bitmap1.isSameArea(bitmap2))
+    {
+        result.mWords = bitmap1.mWords;
+        return;
+    }
+
+    uint64_t* words = result.mWords.data();
+    const uint64_t* words1 = bitmap1.mWords.data();
+    const uint64_t* words2 = bitmap2.mWords.data();
+    uint32_t nbWords = static_cast<uint32_t>(result.mWords.size());
+    for(uint32_t i = 0; i < nbWords; ++i)
+        words[i] = words1[i] & ~words2[i];
+}
+
+uint32_t TileBitmap::count() const
+{
+    uint32_t nbBits = 0;
+    for(uint64_t word : mWords)
+    {
+        while(word != 0)
+        {
+            word &= word - 1;
+            ++nbBits;
+        }
+    }
+    return nbBits;
+}
@@ -0,0 +1,156 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILEBITMAP_H
+#define TILEBITMAP_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief One bit per tile on a rectangular area of the map. It can cover the whole map (seat vision) or only
+ * the surroundings of a tile (creature sight).
+ * Bits are stored by rows of constant x, each row starting on a new word so that operations between 2 bitmaps
+ * covering the same area are simple loops over the words that the compiler can vectorize.
+ */
+class TileBitmap
+{
+public:
+    TileBitmap();
+
+    //! \brief Sets the covered area (in map coordinates) and clears all the bits. The memory is kept
+    //! if it is big enough
+    void reset(int originX, int originY, int sizeX, int sizeY);
+
+    //! \brief Clears all the bits without changing the covered area
+    void clearAll();
+
+    //! \brief Returns true if the bit of the tile at the given map coordinates is set. Tiles out of the
+    //! covered area are never set
+    inline bool test(int x, int y) const
+    {
+        x -= mOriginX;
+        y -= mOriginY;
+        if((x < 0) || (y < 0) || (x >= mSizeX) || (y >= mSizeY))
+            return false;
+
+        return (mWords[wordIndex(x, y)] & bitMask(y)) != 0;
+    }
+
+    //! \brief Sets the bit of the tile at the given map coordinates. Tiles out of the covered area are ignored
+    inline void set(int x, int y)
+    {
+        x -= mOriginX;
+        y -= mOriginY;
+        if((x < 0) || (y < 0) || (x >= mSizeX) || (y >= mSizeY))
+            return;
+
+        mWords[wordIndex(x, y)] |= bitMask(y);
+    }
+
+    //! \brief Clears the bit of the tile at the given map coordinates. Tiles out of the covered area are ignored
+    inline void unset(int x, int y)
+    {
+        x -= mOriginX;
+        y -= mOriginY;
+        if((x < 0) || (y < 0) || (x >= mSizeX) || (y >= mSizeY))
+            return;
+
+        mWords[wordIndex(x, y)] &= ~bitMask(y);
+    }
+
+    //! \brief Returns true if both bitmaps cover the same area. Operations between 2 bitmaps require it
+    bool isSameArea(const TileBitmap& other) const;
+
+    //! \brief Sets the bits set in other. Both bitmaps must cover the same area
+    void orWith(const TileBitmap& other);
+
+    //! \brief Sets result to bitmap1 & ~bitmap2, that is the tiles set in bitmap1 but not in bitmap2.
+    //! Both bitmaps must cover the same area. result is reset to this area if needed
+    static void andNot(const TileBitmap& bitmap1, const TileBitmap& bitmap2, TileBitmap& result);
+
+    //! \brief Returns the number of bits set
+    uint32_t count() const;
+
+    //! \brief Calls func(x, y) with the map coordinates of each tile set, by increasing x then y
+    template<typename Func>
+    void forEachSet(Func func) const;
+
+    inline int getOriginX() const
+    { return mOriginX; }
+
+    inline int getOriginY() const
+    { return mOriginY; }
+
+    inline int getSizeX() const
+    { return mSizeX; }
+
+    inline int getSizeY() const
+    { return mSizeY; }
+
+private:
+    static const uint32_t BITS_PER_WORD = 64;
+
+    inline uint32_t wordIndex(int x, int y) const
+    { return static_cast<uint32_t>(x) * mWordsPerRow + static_cast<uint32_t>(y) / BITS_PER_WORD; }
+
+    static inline uint64_t bitMask(int y)
+    { return static_cast<uint64_t>(1) << (static_cast<uint32_t>(y) % BITS_PER_WORD); }
+
+    //! \brief Returns the index of the lowest bit set. word must not be 0
+    static inline uint32_t lowestBit(uint64_t word)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<uint32_t>(__builtin_ctzll(word));
+#else
+        uint32_t index = 0;
+        while((word & 1) == 0)
+        {
+            word >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    int mOriginX;
+    int mOriginY;
+    int mSizeX;
+    int mSizeY;
+    uint32_t mWordsPerRow;
+    std::vector<uint64_t> mWords;
+};
+
+template<typename Func>
+void TileBitmap::forEachSet(Func func) const
+{
+    for(int x = 0; x < mSizeX; ++x)
+    {
+        const uint64_t* row = mWords.data() + static_cast<uint32_t>(x) * mWordsPerRow;
+        for(uint32_t w = 0; w < mWordsPerRow; ++w)
+        {
+            uint64_t word = row[w];
+            while(word != 0)
+            {
+                uint32_t bit = lowestBit(word);
+                word &= word - 1;
+                func(mOriginX + x, mOriginY + static_cast<int>(w * BITS_PER_WORD + bit));
+            }
+        }
+    }
+}
+
+#endif // TILEBITMAP_H
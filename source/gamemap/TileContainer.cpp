@@ -20,320 +20,19 @@
 #include "entities/Tile.h"
 
 #include "network/ODPacket.h"
+#include "network/TilePacket.h"
 #include "utils/Helper.h"
 #include "utils/LogManager.h"
 
-const std::vector<Tile*> EMPTY_TILES;
-
-class TileDistance
-{
-public:
-    enum TileDistanceType
-    {
-        Horizontal,
-        Diagonal,
-        Other
-    };
-
-    TileDistance(int diffX, int diffY, TileDistanceType type, int distSquared):
-        mDiffX(diffX),
-        mDiffY(diffY),
-        mType(type),
-        mDistSquared(distSquared)
-    {
-    }
-
-    inline int getDiffX() const
-    { return mDiffX; }
-
-    inline int getDiffY() const
-    { return mDiffY; }
-
-    inline TileDistanceType getType() const
-    { return mType; }
-
-    inline int getDistSquared() const
-    { return mDistSquared; }
-
-    void computeTileDistances(double coefNorth, double coefSouth, const TileDistance& tileDistance,
-        uint32_t indexTileDistance)
-    {
-        // A tile can only hide tiles behind (x > tile.x and y > tile.y)
-        if(tileDistance.getDiffX() < getDiffX())
-            return;
-        if(tileDistance.getDiffY() < getDiffY())
-            return;
-
-        // We don't want a tile to hide itself
-        if((tileDistance.getDiffX() == getDiffX()) &&
-           (tileDistance.getDiffY() == getDiffY()))
-        {
-            return;
-        }
-
-        if(getType() == TileDistance::TileDistanceType::Horizontal)
-        {
-            // For horizontal tiles, we hide following tiles (x > tile.x). But we process
-            // north tiles normally
-            if(tileDistance.getType() == TileDistance::TileDistanceType::Horizontal)
-            {
-                addHiddenTileSouth(indexTileDistance, 1.0);
-                return;
-            }
-
-            double xTileDeb = static_cast<double>(tileDistance.getDiffX()) - 0.5;
-            double xTileEnd = xTileDeb + 1.0;
-            double yTileDeb = static_cast<double>(tileDistance.getDiffY()) - 0.5;
-            double yTileEnd = yTileDeb + 1.0;
-            double yHideDebNorth = coefNorth * xTileDeb;
-            double yHideEndNorth = coefNorth * xTileEnd;
-
-            // If the tile is over the North ray, it is not hidden
-            if(yHideEndNorth <= yTileDeb)
-                return;
-
-            // We check which part of the tile is hidden
-            if((yHideDebNorth >= yTileDeb) &&
-               (yHideEndNorth <= yTileEnd))
-            {
-                // The ray hits the left side of the tile and the right side.
-                // The south part is partially hidden
-                double hiddenArea = (yHideEndNorth - yHideDebNorth) / 2.0;
-                hiddenArea += yHideDebNorth - yTileDeb;
-                addHiddenTileSouth(indexTileDistance, hiddenArea);
-            }
-            else if((yHideDebNorth < yTileDeb) &&
-                    (yHideEndNorth > yTileDeb))
-            {
-                // The ray hits the bottom side of the tile but hits the right side. We compute
-                // the south visible part
-                double xHit = yTileDeb / coefNorth;
-                double hiddenArea = (yHideEndNorth - yTileDeb) * (xTileEnd - xHit) / 2.0;
-                addHiddenTileSouth(indexTileDistance, hiddenArea);
-            }
-            else if((yHideDebNorth < yTileEnd) &&
-                    (yHideEndNorth > yTileEnd))
-            {
-                // The ray hits the left side of the tile but is over the right side. We compute
-                // the hidden part on north.
-                double xHit = yTileEnd / coefNorth;
-                double visibleArea = (yTileEnd - yHideDebNorth) * (xHit - xTileDeb) / 2.0;
-                addHiddenTileSouth(indexTileDistance, 1.0 - visibleArea);
-            }
-            else
-            {
-                // The entire tile is hidden
-                addHiddenTileSouth(indexTileDistance, 1.0);
-            }
-
-            return;
-        }
-
-        double xTileDeb = static_cast<double>(tileDistance.getDiffX()) - 0.5;
-        double xTileEnd = xTileDeb + 1.0;
-        double yTileDeb = static_cast<double>(tileDistance.getDiffY()) - 0.5;
-        double yTileEnd = yTileDeb + 1.0;
-
-        // We check if the current tile is hidden by the tile. To consider that the
-        // tile is hidden by the south, as we know the angle will be between 0 and 45 degrees,
-        // we consider that the tile has to be hit by the ray passing through the hiding tile
-        // on the left side of the tile (otherwise, the hidden part will be too small).
-        double yHideDebSouth = coefSouth * xTileDeb;
-        double yHideEndSouth = coefSouth * xTileEnd;
-        double yHideDebNorth = coefNorth * xTileDeb;
-        double yHideEndNorth = coefNorth * xTileEnd;
-        // We check if at least a part of the tile is hidden
-        if((yHideDebSouth < yTileEnd) &&
-           (yHideEndNorth > yTileDeb))
-        {
-            // At least a part of this tile is hidden
-            if((yHideDebSouth >= yTileDeb) &&
-               (yHideEndSouth <= yTileEnd))
-            {
-                // The ray hits the left side of the tile and the right side.
-                // The south part is partially hidden
-                // The visible part is composed from a square between the tile inferior part and
-                // the triangle made by the ray
-                double visibleArea = (yHideEndSouth - yHideDebSouth) / 2.0;
-                visibleArea += yHideDebSouth - yTileDeb;
-                addHiddenTileNorth(indexTileDistance, 1.0 - visibleArea);
-            }
-            else if((yHideDebSouth < yTileDeb) &&
-                    (yHideEndSouth > yTileDeb))
-            {
-                // The ray hits the bottom side of the tile but hits the right side. We compute
-                // the south visible part
-                double xHit = yTileDeb / coefSouth;
-                double visibleArea = (yHideEndSouth - yTileDeb) * (xTileEnd - xHit) / 2.0;
-                addHiddenTileNorth(indexTileDistance, 1.0 - visibleArea);
-            }
-            else if((yHideDebSouth < yTileEnd) &&
-                    (yHideEndSouth > yTileEnd))
-            {
-                // The ray hits the left side of the tile but is over the right side. We compute
-                // the hidden part on north.
-                double xHit = yTileEnd / coefSouth;
-                double hiddenArea = (yTileEnd - yHideDebSouth) * (xHit - xTileDeb) / 2.0;
-                addHiddenTileNorth(indexTileDistance, hiddenArea);
-
-            }
-            else if((yHideDebNorth >= yTileDeb) &&
-               (yHideEndNorth <= yTileEnd))
-            {
-                double hiddenArea = (yHideEndNorth - yHideDebNorth) / 2.0;
-                hiddenArea += yHideDebNorth - yTileDeb;
-                addHiddenTileSouth(indexTileDistance, hiddenArea);
-            }
-            else if((yHideDebNorth < yTileDeb) &&
-                    (yHideEndNorth > yTileDeb))
-            {
-                // The ray hits the bottom side of the tile but hits the right side. We compute
-                // the south visible part
-                double xHit = yTileDeb / coefNorth;
-                double hiddenArea = (yHideEndNorth - yTileDeb) * (xTileEnd - xHit) / 2.0;
-                addHiddenTileSouth(indexTileDistance, hiddenArea);
-            }
-            else if((yHideDebNorth < yTileEnd) &&
-                    (yHideEndNorth > yTileEnd))
-            {
-                // The ray hits the left side of the tile but is over the right side. We compute
-                // the hidden part on north.
-                double xHit = yTileEnd / coefNorth;
-                double visibleArea = (yTileEnd - yHideDebNorth) * (xHit - xTileDeb) / 2.0;
-                addHiddenTileSouth(indexTileDistance, 1.0 - visibleArea);
-            }
-            else
-            {
-                // The entire tile is hidden
-                addHiddenTileSouth(indexTileDistance, 1.0);
-            }
-        }
-    }
-
-    void print(const std::vector<TileDistance>& tileDistance)
-    {
-        std::string log = "TileDistance x=" + Helper::toString(getDiffX())
-            + ", y=" + Helper::toString(getDiffY())
-            + ", squared=" + Helper::toString(getDistSquared());
-        for(const std::pair<uint32_t, double>& p : mHiddenTilesNorth)
-        {
-            const TileDistance& tile = tileDistance[p.first];
-            log += ", TileDistanceNorth x=" + Helper::toString(tile.getDiffX())
-                + ", y=" + Helper::toString(tile.getDiffY())
-                + ", val=" + Helper::toString(p.second);
-        }
-        for(const std::pair<uint32_t, double>& p : mHiddenTilesSouth)
-        {
-            const TileDistance& tile = tileDistance[p.first];
-            log += ", TileDistanceSouth x=" + Helper::toString(tile.getDiffX())
-                + ", y=" + Helper::toString(tile.getDiffY())
-                + ", val=" + Helper::toString(p.second);
-        }
+#include <algorithm>
 
-        OD_LOG_INF(log);
-    }
-
-    const std::vector<std::pair<uint32_t, double>>& getHiddenTilesNorth() const
-    {
-        return mHiddenTilesNorth;
-    }
-
-    const std::vector<std::pair<uint32_t, double>>& getHiddenTilesSouth() const
-    {
-        return mHiddenTilesSouth;
-    }
-
-private:
-    void addHiddenTileNorth(uint32_t indexTile, double hiddenPercent)
-    {
-        mHiddenTilesNorth.push_back(std::pair<uint32_t, double>(indexTile, hiddenPercent));
-    }
-
-    void addHiddenTileSouth(uint32_t indexTile, double hiddenPercent)
-    {
-        mHiddenTilesSouth.push_back(std::pair<uint32_t, double>(indexTile, hiddenPercent));
-    }
-
-    int mDiffX;
-    int mDiffY;
-    TileDistanceType mType;
-    int mDistSquared;
-    std::vector<std::pair<uint32_t, double>> mHiddenTilesNorth;
-    std::vector<std::pair<uint32_t, double>> mHiddenTilesSouth;
-};
-
-class TileDistanceProcess
-{
-public:
-    TileDistanceProcess(const TileDistance& tileDistance, Tile* tile):
-        mTileDistance(tileDistance),
-        mTile(tile),
-        mHiddenValueNorth(0.0),
-        mHiddenValueSouth(0.0)
-    {
-    }
-
-    inline const TileDistance& getTileDistance() const
-    {
-        return mTileDistance;
-    }
-
-    void addHiddenValueNorth(double val)
-    {
-        // We only add the highest value
-        if(val <= mHiddenValueNorth)
-            return;
-
-        mHiddenValueNorth = val;
-    }
-
-    void addHiddenValueSouth(double val)
-    {
-        // We only add the highest value
-        if(val <= mHiddenValueSouth)
-            return;
-
-        mHiddenValueSouth = val;
-    }
-
-    inline bool isTileVisible() const
-    {
-        return (mHiddenValueNorth + mHiddenValueSouth) <= 0.5;
-    }
-
-    inline double getHiddenValueNorth() const
-    {
-        return mHiddenValueNorth;
-    }
-
-    inline double getHiddenValueSouth() const
-    {
-        return mHiddenValueSouth;
-    }
-
-    inline Tile* getTile() const
-    {
-        return mTile;
-    }
-
-private:
-    const TileDistance& mTileDistance;
-    Tile* mTile;
-    double mHiddenValueNorth;
-    double mHiddenValueSouth;
-};
-
-bool sortByDistSquared(const TileDistance& tileDist1, const TileDistance& tileDist2)
-{
-    return tileDist1.getDistSquared() < tileDist2.getDistSquared();
-}
+const std::vector<Tile*> EMPTY_TILES;
 
 TileContainer::TileContainer(int initTileDistance):
     mMapSizeX(0),
     mMapSizeY(0),
     mRr(0),
-    mTiles(nullptr),
-    mTileDistanceComputed(0)
+    mTiles(nullptr)
 {
     buildTileDistance(initTileDistance);
 }
@@ -432,6 +131,59 @@ Tile* TileContainer::tileFromPacket(ODPacket& packet) const
     return tile;
 }
 
+void TileContainer::tilesToPacket(ODPacket& packet, const std::vector<Tile*>& tiles,
+        const std::function<void(Tile*)>& exportTile) const
+{
+    // The lists given may come in any order and contain the same tile several times (for example when
+    // it is refreshed for 2 reasons)
+    std::vector<Tile*> sortedTiles(tiles);
+    std::sort(sortedTiles.begin(), sortedTiles.end(), [](const Tile* tile1, const Tile* tile2)
+    {
+        if(tile1->getX() != tile2->getX())
+            return tile1->getX() < tile2->getX();
+
+        return tile1->getY() < tile2->getY();
+    });
+    sortedTiles.erase(std::unique(sortedTiles.begin(), sortedTiles.end()), sortedTiles.end());
+
+    std::vector<uint32_t> indexes;
+    indexes.reserve(sortedTiles.size());
+    for(Tile* tile : sortedTiles)
+        indexes.push_back(static_cast<uint32_t>(tile->getX() * getMapSizeY() + tile->getY()));
+
+    TilePacket::exportTileIndexes(packet, indexes);
+
+    if(exportTile == nullptr)
+        return;
+
+    for(Tile* tile : sortedTiles)
+        exportTile(tile);
+}
+
+bool TileContainer::tilesFromPacket(ODPacket& packet, std::vector<Tile*>& tiles) const
+{
+    tiles.clear();
+    std::vector<uint32_t> indexes;
+    if(!TilePacket::importTileIndexes(packet, indexes))
+    {
+        OD_LOG_ERR("Cannot read tiles");
+        return false;
+    }
+
+    uint32_t nbTiles = static_cast<uint32_t>(getMapSizeX() * getMapSizeY());
+    for(uint32_t index : indexes)
+    {
+        if(index >= nbTiles)
+        {
+            OD_LOG_ERR("index=" + Helper::toString(index) + ", nbTiles=" + Helper::toString(nbTiles));
+            return false;
+        }
+
+        tiles.push_back(getTile(static_cast<int>(index) / getMapSizeY(), static_cast<int>(index) % getMapSizeY()));
+    }
+    return true;
+}
+
 bool TileContainer::allocateMapMemory(int xSize, int ySize)
 {
     if (xSize <= 0 || ySize <= 0)
@@ -502,25 +254,30 @@ std::vector<Tile*> TileContainer::rectangularRegion(int x1, int y1, int x2, int
 
 std::vector<Tile*> TileContainer::circularRegion(int x, int y, int radius)
 {
-    // To compute the tiles within this region, we use the symmetry of the square. That's why we mix tile x/y coordinate
-    // with tileDist diffX/diffY. More explanation can be found in the buildTileDistance function
     std::vector<Tile*> returnList;
+    circularRegion(x, y, radius, returnList);
+    return returnList;
+}
 
-    if(radius > mTileDistanceComputed)
-        buildTileDistance(radius);
+void TileContainer::circularRegion(int x, int y, int radius, std::vector<Tile*>& returnList)
+{
+    // To compute the tiles within this region, we use the symmetry of the square. That's why we mix tile x/y coordinate
+    // with tileDist diffX/diffY. More explanation can be found in ShadowCastingTable::build
+    returnList.clear();
 
-    int radiusSquared = radius * radius;
-    for(const TileDistance& tileDist : mTileDistance)
-    {
-        if(tileDist.getDistSquared() > radiusSquared)
-            break;
+    buildTileDistance(radius);
 
-        switch(tileDist.getType())
+    const std::vector<ShadowCastingTable::Entry>& entries = mShadowCastingTable.getEntries();
+    uint32_t nbEntries = mShadowCastingTable.getNbEntries(radius);
+    for(uint32_t i = 0; i < nbEntries; ++i)
+    {
+        const ShadowCastingTable::Entry& tileDist = entries[i];
+        switch(tileDist.mType)
         {
-            case TileDistance::TileDistanceType::Horizontal:
+            case ShadowCastingTable::EntryType::Horizontal:
             {
                 // We take the 4 tiles at this distance
-                if(tileDist.getDiffX() == 0)
+                if(tileDist.mDiffX == 0)
                 {
                     // We only add the current tile
                     Tile* tile = getTile(x, y);
@@ -532,69 +289,69 @@ std::vector<Tile*> TileContainer::circularRegion(int x, int y, int radius)
 
                 // We add the 4 tiles
                 Tile* tile;
-                tile = getTile(x + tileDist.getDiffX(), y);
+                tile = getTile(x + tileDist.mDiffX, y);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y);
+                tile = getTile(x - tileDist.mDiffX, y);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x, y + tileDist.getDiffX());
+                tile = getTile(x, y + tileDist.mDiffX);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x, y - tileDist.getDiffX());
+                tile = getTile(x, y - tileDist.mDiffX);
                 if(tile != nullptr)
                     returnList.push_back(tile);
 
                 break;
             }
 
-            case TileDistance::TileDistanceType::Diagonal:
+            case ShadowCastingTable::EntryType::Diagonal:
             {
                 // We add the 4 tiles
                 Tile* tile;
-                tile = getTile(x + tileDist.getDiffX(), y + tileDist.getDiffY());
+                tile = getTile(x + tileDist.mDiffX, y + tileDist.mDiffY);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x + tileDist.getDiffX(), y - tileDist.getDiffY());
+                tile = getTile(x + tileDist.mDiffX, y - tileDist.mDiffY);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y + tileDist.getDiffY());
+                tile = getTile(x - tileDist.mDiffX, y + tileDist.mDiffY);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y - tileDist.getDiffY());
+                tile = getTile(x - tileDist.mDiffX, y - tileDist.mDiffY);
                 if(tile != nullptr)
                     returnList.push_back(tile);
 
                 break;
             }
 
-            case TileDistance::TileDistanceType::Other:
+            case ShadowCastingTable::EntryType::Other:
             default:
             {
                 // We add the 8 tiles
                 Tile* tile;
-                tile = getTile(x + tileDist.getDiffX(), y + tileDist.getDiffY());
+                tile = getTile(x + tileDist.mDiffX, y + tileDist.mDiffY);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x + tileDist.getDiffX(), y - tileDist.getDiffY());
+                tile = getTile(x + tileDist.mDiffX, y - tileDist.mDiffY);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y + tileDist.getDiffY());
+                tile = getTile(x - tileDist.mDiffX, y + tileDist.mDiffY);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffX(), y - tileDist.getDiffY());
+                tile = getTile(x - tileDist.mDiffX, y - tileDist.mDiffY);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x + tileDist.getDiffY(), y + tileDist.getDiffX());
+                tile = getTile(x + tileDist.mDiffY, y + tileDist.mDiffX);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x + tileDist.getDiffY(), y - tileDist.getDiffX());
+                tile = getTile(x + tileDist.mDiffY, y - tileDist.mDiffX);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffY(), y + tileDist.getDiffX());
+                tile = getTile(x - tileDist.mDiffY, y + tileDist.mDiffX);
                 if(tile != nullptr)
                     returnList.push_back(tile);
-                tile = getTile(x - tileDist.getDiffY(), y - tileDist.getDiffX());
+                tile = getTile(x - tileDist.mDiffY, y - tileDist.mDiffX);
                 if(tile != nullptr)
                     returnList.push_back(tile);
 
@@ -602,8 +359,6 @@ std::vector<Tile*> TileContainer::circularRegion(int x, int y, int radius)
             }
         }
     }
-
-    return returnList;
 }
 
 std::vector<Tile*> TileContainer::tilesBorderedByRegion(const std::vector<Tile*> &region)
@@ -644,78 +399,7 @@ const std::vector<Tile*>& TileContainer::neighborTiles(int x, int y) const
 
 void TileContainer::buildTileDistance(int distance)
 {
-    if(mTileDistanceComputed >= distance)
-        return;
-
-    // We want to be able to fill a vector of tiles sorted beginning with the closest tile. If we look a grid (each letter
-    // represents a tile at the same distance from the center: a):
-    // jihghij
-    // ifedefi
-    // hecbceh
-    // gdbabdg
-    // hecbceh
-    // ifedefi
-    // jihghij
-    // We can see that there are 3 kind of tiles:
-    // - Vertical/Horizontal tiles (abdg): at each distance, there are 4 of them
-    // - Diagonal tiles (acfj): at each distance, there are 4 of them
-    // - Other tiles (ehi...): at each distance, there are 8 of them
-    // Moreover, we can see a symmetry. We can compute all tiles by computing only 1/8 tiles:
-    //    j
-    //   fi
-    //  ceh
-    // abdg
-
-    // If we compute only the minimum tiles needed, we have no vertical tiles (since each of them can be deduced from the horizontal)
-    // To compute tiles easily, we will compute the 1/8 tiles until distance. Then, we will sort the tiles to begin with
-    // closest distance until farthest
-    mTileDistance.clear();
-    for(int y = 0; y <= distance; ++y)
-    {
-        for(int x = y; x <= distance; ++x)
-        {
-            TileDistance::TileDistanceType type;
-            if(y == 0)
-            {
-                type = TileDistance::TileDistanceType::Horizontal;
-            }
-            else if(x == y)
-            {
-                type = TileDistance::TileDistanceType::Diagonal;
-            }
-            else
-            {
-                type = TileDistance::TileDistanceType::Other;
-            }
-            int distSquared = x * x + y * y;
-            mTileDistance.push_back(TileDistance(x, y, type, distSquared));
-        }
-    }
-
-    std::sort(mTileDistance.begin(), mTileDistance.end(), sortByDistSquared);
-
-    // We have filled the tile distance vector. Now, we fill how each tile hides the
-    // other ones when they mask vision to help calculate visible tiles
-    for(TileDistance& tileDistance : mTileDistance)
-    {
-        // We don't process the first tile
-        if(tileDistance.getDiffX() == 0 && tileDistance.getDiffY() == 0)
-            continue;
-
-        // Other tiles can hide with their down side and their up side other tiles
-        // or diagonal tiles (but not Horizontal tiles)
-        // We compute the tiles hidden from the south. In this case, only tiles with
-        // x > tile.x can be hidden
-        double coefNorth = (static_cast<double>(tileDistance.getDiffY()) + 0.5) / (static_cast<double>(tileDistance.getDiffX()) - 0.5);
-        double coefSouth = (static_cast<double>(tileDistance.getDiffY()) - 0.5) / (static_cast<double>(tileDistance.getDiffX()) + 0.5);
-        for(uint32_t index = 0; index < mTileDistance.size(); ++index)
-        {
-            const TileDistance& tileDistance2 = mTileDistance[index];
-            tileDistance.computeTileDistances(coefNorth, coefSouth, tileDistance2, index);
-        }
-    }
-
-    mTileDistanceComputed = distance;
+    mShadowCastingTable.build(distance);
 }
 
 std::list<Tile*> TileContainer::tilesBetween(int x1, int y1, int x2, int y2) const
@@ -810,162 +494,29 @@ std::list<Tile*> TileContainer::tilesBetween(int x1, int y1, int x2, int y2) con
 
 std::vector<Tile*> TileContainer::visibleTiles(int x, int y, int radius)
 {
-    // To compute the tiles within this region, we use the symmetry of the square. That's why we mix tile x/y coordinate
-    // with tileDist diffX/diffY. More explanation can be found in the buildTileDistance function
     std::vector<Tile*> returnList;
+    visibleTiles(x, y, radius, returnList);
+    return returnList;
+}
 
-    if(radius > mTileDistanceComputed)
-        buildTileDistance(radius);
-
-    int radiusSquared = radius * radius;
-
-    // To have all the tiles around, we process mTileDistance 8 times.
-    // We will process in, this order (c being the starting tile):
-    // 514
-    // 2c0
-    // 637
-    // Then, we will have to merge diagonal/horizontal tiles
-    // Because we want the index to be correct, we will add tiles even when null in tilesProcess
-    std::vector<TileDistanceProcess> tilesProcess[8];
-    for(uint32_t k = 0; k < 8; ++k)
-    {
-        for(const TileDistance& tileDist : mTileDistance)
-        {
-            if(tileDist.getDistSquared() > radiusSquared)
-                break;
+void TileContainer::visibleTiles(int x, int y, int radius, std::vector<Tile*>& tiles)
+{
+    visibleTiles(x, y, radius, tiles, mVisibleTilesStates);
+}
 
-            switch(k)
-            {
-                case 0:
-                {
-                    Tile* tile = getTile(x + tileDist.getDiffX(), y + tileDist.getDiffY());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 1:
-                {
-                    Tile* tile = getTile(x + tileDist.getDiffY(), y - tileDist.getDiffX());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 2:
-                {
-                    Tile* tile = getTile(x - tileDist.getDiffX(), y - tileDist.getDiffY());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 3:
-                {
-                    Tile* tile = getTile(x - tileDist.getDiffY(), y + tileDist.getDiffX());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 4:
-                {
-                    Tile* tile = getTile(x + tileDist.getDiffY(), y + tileDist.getDiffX());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 5:
-                {
-                    Tile* tile = getTile(x + tileDist.getDiffX(), y - tileDist.getDiffY());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 6:
-                {
-                    Tile* tile = getTile(x - tileDist.getDiffY(), y - tileDist.getDiffX());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                case 7:
-                {
-                    Tile* tile = getTile(x - tileDist.getDiffX(), y + tileDist.getDiffY());
-                    tilesProcess[k].push_back(TileDistanceProcess(tileDist, tile));
-                    break;
-                }
-                default:
-                    break;
-            }
-        }
-    }
+void TileContainer::visibleTiles(int x, int y, int radius, std::vector<Tile*>& tiles,
+    std::vector<ShadowCastingTable::ProcessState<Tile*>>& states)
+{
+    buildTileDistance(radius);
 
-    // The array of tiles is filled. Now, we apply the visibility.
-    for(uint32_t k = 0; k < 8; ++k)
-    {
-        for(TileDistanceProcess& tileDistanceProcess : tilesProcess[k])
+    mShadowCastingTable.computeVisible(radius,
+        [this, x, y](int diffX, int diffY)
         {
-            if(tileDistanceProcess.getTile() == nullptr)
-                continue;
-
-            if(tileDistanceProcess.getTile()->permitsVision())
-                continue;
-
-            // The tile hides vision. We process tiles it hides
-            for(const std::pair<uint32_t, double>& p : tileDistanceProcess.getTileDistance().getHiddenTilesNorth())
-            {
-                // mTileDistance might be bigger than the actual vector because it can include tiles
-                // farther than the ones currently computed (for example if sight < computedSight)
-                if(p.first >= tilesProcess[k].size())
-                    continue;
-
-                tilesProcess[k][p.first].addHiddenValueNorth(p.second);
-            }
-            for(const std::pair<uint32_t, double>& p : tileDistanceProcess.getTileDistance().getHiddenTilesSouth())
-            {
-                // mTileDistance might be bigger than the actual vector because it can include tiles
-                // farther than the ones currently computed (for example if sight < computedSight)
-                if(p.first >= tilesProcess[k].size())
-                    continue;
-
-                tilesProcess[k][p.first].addHiddenValueSouth(p.second);
-            }
-        }
-    }
-
-    // Now, we process all the tiles. Note that horizontal tiles are common for 2 consecutive
-    // vectors in tilesProcess and that diagonal tiles should be merged.
-    // The 8 vectors have the same size
-    for(uint32_t i = 0; i < tilesProcess[0].size(); ++i)
-    {
-        for(uint32_t k = 0; k < 8; ++k)
+            return getTile(x + diffX, y + diffY);
+        },
+        [](Tile* tile)
         {
-            TileDistanceProcess& tileDistanceProcess = tilesProcess[k][i];
-            if(tileDistanceProcess.getTile() == nullptr)
-                continue;
-
-            // We avoid adding several times the center tile
-            if((k > 0) && (tileDistanceProcess.getTileDistance().getDistSquared() == 0))
-                continue;
-
-            // Because horizontal tiles are common, we don't process them for the 4 last vectors
-            if((tileDistanceProcess.getTileDistance().getType() == TileDistance::TileDistanceType::Horizontal) &&
-               (k > 3))
-            {
-                continue;
-            }
-
-            // Diagonal tiles need to be merged (because south hiding and north hiding are not
-            // computed within the same array). They will be processed for k < 4
-            if((tileDistanceProcess.getTileDistance().getType() == TileDistance::TileDistanceType::Diagonal) &&
-               (k > 3))
-            {
-                continue;
-            }
-
-            if(tileDistanceProcess.getTileDistance().getType() == TileDistance::TileDistanceType::Diagonal)
-            {
-                // We merge diagonal tiles. Because they are inverted, south hidden value becomes north and vice-versa
-                TileDistanceProcess& tileDistanceProcess2 = tilesProcess[k + 4][i];
-                tileDistanceProcess.addHiddenValueNorth(tileDistanceProcess2.getHiddenValueSouth());
-                tileDistanceProcess.addHiddenValueSouth(tileDistanceProcess2.getHiddenValueNorth());
-            }
-
-            if(!tileDistanceProcess.isTileVisible())
-                continue;
-
-            returnList.push_back(tileDistanceProcess.getTile());
-        }
-    }
-    return returnList;
+            return !tile->permitsVision();
+        },
+        tiles, states);
 }
@@ -18,12 +18,14 @@
 #ifndef TILECONTAINER_H
 #define TILECONTAINER_H
 
+#include "gamemap/ShadowCastingTable.h"
+
 #include <cassert>
+#include <functional>
 #include <list>
 #include <vector>
 
 class ODPacket;
-class TileDistance;
 class Tile;
 
 enum class TileType;
@@ -62,6 +64,16 @@ public:
     void tileToPacket(ODPacket& packet, Tile* tile) const;
     Tile* tileFromPacket(ODPacket& packet) const;
 
+    //! \brief Exports the given tiles as runs of consecutive tiles, which is much smaller than their coordinates
+    //! when many tiles are sent. The tiles are sorted by x then y and the duplicates removed, which is the order
+    //! tilesFromPacket will give them. If exportTile is set, it is then called for each of these tiles so that the
+    //! data written for each tile matches the tiles read
+    void tilesToPacket(ODPacket& packet, const std::vector<Tile*>& tiles,
+        const std::function<void(Tile*)>& exportTile = nullptr) const;
+    //! \brief Reads the tiles exported by tilesToPacket (after clearing the given vector). Returns false if the
+    //! packet is invalid
+    bool tilesFromPacket(ODPacket& packet, std::vector<Tile*>& tiles) const;
+
     //! \brief Returns all the valid tiles in the rectangular region specified by the two corner points given.
     std::vector<Tile*> rectangularRegion(int x1, int y1, int x2, int y2);
 
@@ -69,6 +81,9 @@ public:
     //! surrounding the given point and extending outward to the specified radius.
     std::vector<Tile*> circularRegion(int x, int y, int radius);
 
+    //! \brief Same as circularRegion but fills the given vector (after clearing it) so that its memory can be reused
+    void circularRegion(int x, int y, int radius, std::vector<Tile*>& tiles);
+
     //! \brief Returns a vector of all the valid tiles which are a neighbor
     //! to one or more tiles in the specified region,
     //! i.e. the "perimeter" of the region extended out one tile.
@@ -97,6 +112,21 @@ public:
     //! the furthest
     std::vector<Tile*> visibleTiles(int x, int y, int radius);
 
+    //! \brief Same as visibleTiles but fills the given vector (after clearing it). Once the vector and the internal
+    //! buffers are big enough, no memory is allocated. Should be preferred for computations done often
+    void visibleTiles(int x, int y, int radius, std::vector<Tile*>& tiles);
+
+    //! \brief Same as visibleTiles but uses the given working buffer instead of the internal one. It can be called
+    //! from several threads at once (each with its own buffer) as long as the map is not modified and reserveTileDistance
+    //! has been called with a radius at least as big. The same goes for circularRegion
+    void visibleTiles(int x, int y, int radius, std::vector<Tile*>& tiles,
+        std::vector<ShadowCastingTable::ProcessState<Tile*>>& states);
+
+    //! \brief Builds the tables used by circularRegion and visibleTiles up to the given radius so that calls with a smaller
+    //! radius do not modify them
+    inline void reserveTileDistance(int radius)
+    { buildTileDistance(radius); }
+
 protected:
     //! \brief The map size
     int mMapSizeX;
@@ -109,15 +139,15 @@ protected:
 private:
     Tile*** mTiles;
 
-    //! \brief Fills mTileDistance that will help to compute a vector with sorted Tiles more efficiently
+    //! \brief Builds mShadowCastingTable up to the given distance if it is not already
     void buildTileDistance(int distance);
 
-    //! \brief Helper to compute tile distances more efficiently
-    std::vector<TileDistance> mTileDistance;
+    //! \brief Helper to compute tile distances and visible tiles more efficiently. If a bigger distance than the
+    //! computed one is asked, it will have to be updated by calling buildTileDistance with the higher distance
+    ShadowCastingTable mShadowCastingTable;
 
-    //! \brief Stores the highest distance computed. If a bigger distance is asked, mTileDistance will have to be updated by
-    //! calling buildTileDistance with the higher distance
-    int mTileDistanceComputed;
+    //! \brief Buffer used by visibleTiles. It is kept to avoid allocating memory at each call
+    std::vector<ShadowCastingTable::ProcessState<Tile*>> mVisibleTilesStates;
 };
 
 #endif //TILECONTAINER_H
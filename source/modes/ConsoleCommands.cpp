@@ -132,6 +132,25 @@ Command::Result cAmbientLight(const Command::ArgumentList_t& args, ConsoleInterf
     return Command::Result::SUCCESS;
 }
 
+Command::Result cReplaySeek(const Command::ArgumentList_t& args, ConsoleInterface& c, AbstractModeManager&)
+{
+    if(args.size() < 2)
+    {
+        c.print("Give the turn to go to");
+        return Command::Result::INVALID_ARGUMENT;
+    }
+
+    int64_t turn = Helper::toInt(args[1]);
+    if(!ODClient::getSingleton().seekReplay(turn))
+    {
+        c.print("Cannot go to turn " + args[1] + ". Only turns after the current one in a replay can be reached");
+        return Command::Result::FAILED;
+    }
+
+    c.print("Going to turn " + args[1]);
+    return Command::Result::SUCCESS;
+}
+
 Command::Result cFPS(const Command::ArgumentList_t& args, ConsoleInterface& c, AbstractModeManager&)
 {
     if(args.size() < 2)
@@ -649,6 +668,12 @@ void addConsoleCommands(ConsoleInterface& cl)
                    cSendCmdToServer,
                    cSrvUnlockSkills,
                    {AbstractModeManager::ModeType::GAME});
+    cl.addCommand("replayseek",
+                   "When watching a replay, goes to the given turn. Only turns after the current one can be reached\n"
+                   "replayseek 100",
+                   cReplaySeek,
+                   Command::cStubServer,
+                   {AbstractModeManager::ModeType::GAME});
 
 }
 
@@ -25,6 +25,7 @@
 #include "render/ODFrameListener.h"
 #include "network/ODServer.h"
 #include "network/ODClient.h"
+#include "network/ReplayFile.h"
 #include "network/ServerNotification.h"
 #include "ODApplication.h"
 #include "utils/LogManager.h"
@@ -218,23 +219,25 @@ bool MenuModeReplay::listReplaysClicked(const CEGUI::EventArgs&)
 bool MenuModeReplay::checkReplayValid(const std::string& replayFileName, std::string& mapDescription, std::string& errorMsg)
 {
     // We open the replay to get the level file name
-    std::ifstream is(replayFileName, std::ios::in | std::ios::binary);
+    ReplayReader reader;
+    if(!reader.open(replayFileName))
+    {
+        errorMsg = "Invalid replay file";
+        return false;
+    }
+
     ODPacket packet;
     ServerNotificationType type;
     do
     {
-        packet.readPacket(is);
+        if(reader.readPacket(packet) < 0)
+        {
+            errorMsg = "Invalid replay file";
+            return false;
+        }
         OD_ASSERT_TRUE(packet >> type);
-        if(is.eof())
-            break;
     } while(type != ServerNotificationType::loadLevel);
 
-    if(is.eof())
-    {
-        errorMsg = "Invalid replay file";
-        return false;
-    }
-
     std::string odVersion;
     std::string tmpStr;
     int32_t tmpInt;
@@ -255,5 +258,15 @@ bool MenuModeReplay::checkReplayValid(const std::string& replayFileName, std::st
         return false;
     }
 
+    // The index gives the replay length without reading it
+    const std::vector<ReplayTurnIndex>& turns = reader.getTurnIndex();
+    if(!turns.empty())
+    {
+        int32_t durationSec = turns.back().mTimestamp / 1000;
+        mapDescription += "\n\nTurns: " + Helper::toString(turns.back().mTurn)
+            + ", duration: " + Helper::toString(durationSec / 60) + "m"
+            + Helper::toString(durationSec % 60) + "s";
+    }
+
     return true;
 }
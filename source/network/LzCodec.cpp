@@ -0,0 +1,217 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/LzCodec.h"
+
+#include <algorithm>
+
+//! \brief Number of bits of the hashes
+const uint32_t HASH_BITS = 15;
+//! \brief Maximum number of previous positions tested to find a match
+const uint32_t MAX_CHAIN_DEPTH = 32;
+//! \brief Used in the hash tables when there is no position
+const uint32_t NO_POSITION = 0xFFFFFFFF;
+//! \brief Once the stream position reaches that value, we restart from 0 to avoid overflows
+const uint32_t MAX_HISTORY_BASE = 0x80000000;
+
+//! \brief The history is trimmed to WINDOW_SIZE bytes once it reaches that size. That way, the
+//! beginning of the vector is not moved each time a buffer is compressed
+const uint32_t MAX_HISTORY_SIZE = 2 * LzCodec::WINDOW_SIZE;
+
+LzEncoder::LzEncoder() :
+    mHistoryBase(0),
+    mHashHeads(1 << HASH_BITS, NO_POSITION),
+    mHashChain(LzCodec::WINDOW_SIZE, NO_POSITION)
+{
+}
+
+uint32_t LzEncoder::hash(uint32_t index) const
+{
+    const uint8_t* bytes = &mHistory[index];
+    uint32_t value = static_cast<uint32_t>(bytes[0]) |
+        (static_cast<uint32_t>(bytes[1]) << 8) |
+        (static_cast<uint32_t>(bytes[2]) << 16) |
+        (static_cast<uint32_t>(bytes[3]) << 24);
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void LzEncoder::insertPosition(uint32_t index)
+{
+    if(index + LzCodec::MIN_MATCH > mHistory.size())
+        return;
+
+    uint32_t position = mHistoryBase + index;
+    uint32_t& head = mHashHeads[hash(index)];
+    mHashChain[position & (LzCodec::WINDOW_SIZE - 1)] = head;
+    head = position;
+}
+
+void LzEncoder::compress(const uint8_t* data, uint32_t size, std::vector<uint8_t>& output)
+{
+    output.clear();
+    uint32_t index = static_cast<uint32_t>(mHistory.size());
+    mHistory.insert(mHistory.end(), data, data + size);
+    uint32_t end = static_cast<uint32_t>(mHistory.size());
+
+    uint32_t flagIndex = 0;
+    uint32_t nbItems = 8;
+    while(index < end)
+    {
+        if(nbItems >= 8)
+        {
+            flagIndex = static_cast<uint32_t>(output.size());
+            output.push_back(0);
+            nbItems = 0;
+        }
+
+        uint32_t bestLength = 0;
+        uint32_t bestOffset = 0;
+        if(end - index >= LzCodec::MIN_MATCH)
+        {
+            uint32_t maxLength = std::min(end - index, LzCodec::MAX_MATCH);
+            uint32_t position = mHistoryBase + index;
+            uint32_t candidate = mHashHeads[hash(index)];
+            for(uint32_t depth = 0; depth < MAX_CHAIN_DEPTH; ++depth)
+            {
+                // The chain may contain positions overwritten since (or dropped from the history). We
+                // stop when they are not valid anymore. Hash collisions are handled by comparing the bytes
+                if((candidate >= position) ||
+                   (candidate < mHistoryBase) ||
+                   (position - candidate > LzCodec::WINDOW_SIZE))
+                {
+                    break;
+                }
+
+                const uint8_t* match = &mHistory[candidate - mHistoryBase];
+                const uint8_t* current = &mHistory[index];
+                uint32_t length = 0;
+                while((length < maxLength) && (match[length] == current[length]))
+                    ++length;
+
+                if(length > bestLength)
+                {
+                    bestLength = length;
+                    bestOffset = position - candidate;
+                    if(length >= maxLength)
+                        break;
+                }
+
+                uint32_t next = mHashChain[candidate & (LzCodec::WINDOW_SIZE - 1)];
+                if(next >= candidate)
+                    break;
+
+                candidate = next;
+            }
+        }
+
+        if(bestLength >= LzCodec::MIN_MATCH)
+        {
+            output[flagIndex] |= static_cast<uint8_t>(1 << nbItems);
+            uint32_t offset = bestOffset - 1;
+            output.push_back(static_cast<uint8_t>(offset & 0xFF));
+            output.push_back(static_cast<uint8_t>(offset >> 8));
+            output.push_back(static_cast<uint8_t>(bestLength - LzCodec::MIN_MATCH));
+            for(uint32_t i = 0; i < bestLength; ++i)
+                insertPosition(index + i);
+
+            index += bestLength;
+        }
+        else
+        {
+            output.push_back(mHistory[index]);
+            insertPosition(index);
+            ++index;
+        }
+        ++nbItems;
+    }
+
+    if(mHistory.size() < MAX_HISTORY_SIZE)
+        return;
+
+    uint32_t nbDropped = static_cast<uint32_t>(mHistory.size()) - LzCodec::WINDOW_SIZE;
+    mHistory.erase(mHistory.begin(), mHistory.begin() + nbDropped);
+    mHistoryBase += nbDropped;
+    if(mHistoryBase < MAX_HISTORY_BASE)
+        return;
+
+    // The positions known are forgotten. That only means the next buffer will not be
+    // compressed as well as it could have been
+    mHistoryBase = 0;
+    std::fill(mHashHeads.begin(), mHashHeads.end(), NO_POSITION);
+    std::fill(mHashChain.begin(), mHashChain.end(), NO_POSITION);
+}
+
+LzDecoder::LzDecoder()
+{
+}
+
+bool LzDecoder::uncompress(const uint8_t* data, uint32_t size, uint32_t uncompressedSize, std::vector<uint8_t>& output)
+{
+    output.clear();
+    uint32_t start = static_cast<uint32_t>(mHistory.size());
+    uint32_t end = start + uncompressedSize;
+    mHistory.reserve(end);
+
+    uint32_t index = 0;
+    while(index < size)
+    {
+        uint8_t flags = data[index];
+        ++index;
+        for(uint32_t item = 0; (item < 8) && (index < size); ++item)
+        {
+            if((flags & (1 << item)) == 0)
+            {
+                mHistory.push_back(data[index]);
+                ++index;
+                continue;
+            }
+
+            if(index + 3 > size)
+                return false;
+
+            uint32_t offset = (static_cast<uint32_t>(data[index]) |
+                (static_cast<uint32_t>(data[index + 1]) << 8)) + 1;
+            uint32_t length = static_cast<uint32_t>(data[index + 2]) + LzCodec::MIN_MATCH;
+            index += 3;
+
+            uint32_t current = static_cast<uint32_t>(mHistory.size());
+            if((offset > current) || (current + length > end))
+                return false;
+
+            // The match may overlap the bytes it produces so we copy one byte at a time
+            uint32_t matchIndex = current - offset;
+            for(uint32_t i = 0; i < length; ++i)
+            {
+                uint8_t byte = mHistory[matchIndex + i];
+                mHistory.push_back(byte);
+            }
+        }
+
+        if(mHistory.size() > end)
+            return false;
+    }
+
+    if(mHistory.size() != end)
+        return false;
+
+    output.assign(mHistory.begin() + start, mHistory.end());
+
+    if(mHistory.size() >= MAX_HISTORY_SIZE)
+        mHistory.erase(mHistory.begin(), mHistory.end() - LzCodec::WINDOW_SIZE);
+
+    return true;
+}
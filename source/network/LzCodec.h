@@ -0,0 +1,86 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LZCODEC_H
+#define LZCODEC_H
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief LZ77 compression of a stream of buffers. Matches can refer to the data of the
+ * previous buffers (up to LzCodec::WINDOW_SIZE bytes back) so that the messages the server
+ * sends many times (tile refreshes, entity creations, ...) are only a few bytes once compressed.
+ * The decoder must receive every buffer compressed by the encoder, in the same order.
+ *
+ * Compressed data is a sequence of groups made of 1 flag byte followed by up to 8 items. If the
+ * corresponding bit of the flag byte (starting from the lowest one) is set, the item is a match:
+ * uint16 (little endian) offset - 1 and uint8 length - LzCodec::MIN_MATCH. Otherwise, it is 1
+ * literal byte.
+ */
+namespace LzCodec
+{
+    const uint32_t WINDOW_SIZE = 65536;
+    const uint32_t MIN_MATCH = 4;
+    const uint32_t MAX_MATCH = MIN_MATCH + 255;
+}
+
+class LzEncoder
+{
+public:
+    LzEncoder();
+
+    //! \brief Compresses the given buffer in output (after clearing it). The buffer is added
+    //! to the dictionary used to compress the next ones
+    void compress(const uint8_t* data, uint32_t size, std::vector<uint8_t>& output);
+
+private:
+    //! \brief Hash of the MIN_MATCH bytes at the given index in mHistory
+    uint32_t hash(uint32_t index) const;
+
+    //! \brief Makes the bytes at the given index in mHistory available for the next matches
+    void insertPosition(uint32_t index);
+
+    //! \brief The last bytes compressed
+    std::vector<uint8_t> mHistory;
+
+    //! \brief Stream position of mHistory[0]. Positions are used in the hash tables so that
+    //! they stay valid when the beginning of mHistory is dropped
+    uint32_t mHistoryBase;
+
+    //! \brief Last stream position having the given hash
+    std::vector<uint32_t> mHashHeads;
+
+    //! \brief Previous stream position having the same hash as the given one (modulo WINDOW_SIZE)
+    std::vector<uint32_t> mHashChain;
+};
+
+class LzDecoder
+{
+public:
+    LzDecoder();
+
+    //! \brief Uncompresses the given buffer in output (after clearing it). Returns false if the
+    //! buffer is invalid or if it does not uncompress to uncompressedSize bytes. In that case,
+    //! the stream cannot be used anymore
+    bool uncompress(const uint8_t* data, uint32_t size, uint32_t uncompressedSize, std::vector<uint8_t>& output);
+
+private:
+    //! \brief The last bytes uncompressed
+    std::vector<uint8_t> mHistory;
+};
+
+#endif // LZCODEC_H
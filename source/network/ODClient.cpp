@@ -434,12 +434,12 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
         case ServerNotificationType::removeEntity:
         {
             GameEntityType entityType;
-            std::string entityName;
-            OD_ASSERT_TRUE(packetReceived >> entityType >> entityName);
-            GameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
+            uint32_t networkId;
+            OD_ASSERT_TRUE(packetReceived >> entityType >> networkId);
+            GameEntity* entity = gameMap->getEntityFromTypeAndNetworkId(entityType, networkId);
             if(entity == nullptr)
             {
-                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", networkId=" + Helper::toString(networkId));
                 break;
             }
 
@@ -456,6 +456,7 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
             OD_LOG_INF("Client (" + getPlayer()->getNick() + ") received turnStarted="
                 + boost::lexical_cast<std::string>(turnNum));
 
+            notifyReplayTurnStarted(turnNum);
             gameMap->clientUpKeep(turnNum);
             // We acknowledge the new turn to the server so that he knows we are
             // ready for next one
@@ -473,19 +474,19 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::animatedObjectSetWalkPath:
         {
-            std::string objName;
+            uint32_t networkId;
             std::string walkAnim;
             std::string endAnim;
             bool loopEndAnim;
             bool playIdleWhenAnimationEnds;
             uint32_t nbDest;
-            OD_ASSERT_TRUE(packetReceived >> objName >> walkAnim >> endAnim);
+            OD_ASSERT_TRUE(packetReceived >> networkId >> walkAnim >> endAnim);
             OD_ASSERT_TRUE(packetReceived >> loopEndAnim >> playIdleWhenAnimationEnds >> nbDest);
 
-            MovableGameEntity *tempAnimatedObject = gameMap->getAnimatedObject(objName);
+            MovableGameEntity *tempAnimatedObject = gameMap->getAnimatedObjectFromNetworkId(networkId);
             if(tempAnimatedObject == nullptr)
             {
-                OD_LOG_ERR("objName=" + objName);
+                OD_LOG_ERR("networkId=" + Helper::toString(networkId));
                 break;
             }
 
@@ -506,8 +507,8 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
         {
             int seatId;
             GameEntityType entityType;
-            std::string entityName;
-            OD_ASSERT_TRUE(packetReceived >> seatId >> entityType >> entityName);
+            uint32_t networkId;
+            OD_ASSERT_TRUE(packetReceived >> seatId >> entityType >> networkId);
             Player *tempPlayer = gameMap->getPlayerBySeatId(seatId);
             if(tempPlayer == nullptr)
             {
@@ -515,10 +516,10 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
                 break;
             }
 
-            GameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
+            GameEntity* entity = gameMap->getEntityFromTypeAndNetworkId(entityType, networkId);
             if(entity == nullptr)
             {
-                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", networkId=" + Helper::toString(networkId));
                 break;
             }
 
@@ -552,17 +553,17 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::setObjectAnimationState:
         {
-            std::string objName;
+            uint32_t networkId;
             std::string animState;
             bool loop;
             bool playIdleWhenAnimationEnds;
             bool shouldSetWalkDirection;
-            OD_ASSERT_TRUE(packetReceived >> objName >> animState
+            OD_ASSERT_TRUE(packetReceived >> networkId >> animState
                 >> loop >> playIdleWhenAnimationEnds >> shouldSetWalkDirection);
-            MovableGameEntity *obj = gameMap->getAnimatedObject(objName);
+            MovableGameEntity *obj = gameMap->getAnimatedObjectFromNetworkId(networkId);
             if (obj == nullptr)
             {
-                OD_LOG_ERR("objName=" + objName + ", state=" + animState);
+                OD_LOG_ERR("networkId=" + Helper::toString(networkId) + ", state=" + animState);
                 break;
             }
 
@@ -591,17 +592,17 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
         {
             uint32_t nbEntities;
             GameEntityType entityType;
-            std::string entityName;
+            uint32_t networkId;
             OD_ASSERT_TRUE(packetReceived >> nbEntities);
             while(nbEntities > 0)
             {
                 --nbEntities;
                 OD_ASSERT_TRUE(packetReceived >> entityType);
-                OD_ASSERT_TRUE(packetReceived >> entityName);
-                GameEntity* entity = gameMap->getEntityFromTypeAndName(entityType, entityName);
+                OD_ASSERT_TRUE(packetReceived >> networkId);
+                GameEntity* entity = gameMap->getEntityFromTypeAndNetworkId(entityType, networkId);
                 if(entity == nullptr)
                 {
-                    OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", entityName=" + entityName);
+                    OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", networkId=" + Helper::toString(networkId));
                     break;
                 }
 
@@ -638,14 +639,14 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::setEntityOpacity:
         {
-            std::string entityName;
+            uint32_t networkId;
             float opacity;
-            OD_ASSERT_TRUE(packetReceived >> entityName >> opacity);
+            OD_ASSERT_TRUE(packetReceived >> networkId >> opacity);
 
-            RenderedMovableEntity* entity = gameMap->getRenderedMovableEntity(entityName);
+            RenderedMovableEntity* entity = gameMap->getRenderedMovableEntityFromNetworkId(networkId);
             if(entity == nullptr)
             {
-                OD_LOG_ERR("entityName=" + entityName);
+                OD_LOG_ERR("networkId=" + Helper::toString(networkId));
                 break;
             }
 
@@ -757,28 +758,18 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::refreshVisibleTiles:
         {
-            uint32_t nbTiles;
+            std::vector<Tile*> tiles;
             // Tiles we gained vision
-            OD_ASSERT_TRUE(packetReceived >> nbTiles);
-            while(nbTiles > 0)
+            OD_ASSERT_TRUE(gameMap->tilesFromPacket(packetReceived, tiles));
+            for(Tile* tile : tiles)
             {
-                --nbTiles;
-                Tile* tile = gameMap->tileFromPacket(packetReceived);
-                if(tile == nullptr)
-                    continue;
-
                 tile->setLocalPlayerHasVision(true);
                 tile->refreshMesh();
             }
             // Tiles we lost vision
-            OD_ASSERT_TRUE(packetReceived >> nbTiles);
-            while(nbTiles > 0)
+            OD_ASSERT_TRUE(gameMap->tilesFromPacket(packetReceived, tiles));
+            for(Tile* tile : tiles)
             {
-                --nbTiles;
-                Tile* tile = gameMap->tileFromPacket(packetReceived);
-                if(tile == nullptr)
-                    continue;
-
                 tile->setLocalPlayerHasVision(false);
                 tile->refreshMesh();
             }
@@ -787,19 +778,11 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::refreshTiles:
         {
-            uint32_t nbTiles;
-            OD_ASSERT_TRUE(packetReceived >> nbTiles);
             std::vector<Tile*> tiles;
-            while(nbTiles > 0)
-            {
-                --nbTiles;
-                Tile* gameTile = gameMap->tileFromPacket(packetReceived);
-                if(gameTile == nullptr)
-                    continue;
-
+            OD_ASSERT_TRUE(gameMap->tilesFromPacket(packetReceived, tiles));
+            for(Tile* gameTile : tiles)
                 gameTile->updateFromPacket(packetReceived);
-                tiles.push_back(gameTile);
-            }
+
             gameMap->refreshBorderingTilesOf(tiles);
             break;
         }
@@ -828,21 +811,22 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::carryEntity:
         {
-            std::string carrierName;
+            uint32_t carrierId;
             GameEntityType entityType;
-            std::string carriedName;
-            OD_ASSERT_TRUE(packetReceived >> carrierName >> entityType >> carriedName);
-            Creature* carrier = gameMap->getCreature(carrierName);
-            if(carrier == nullptr)
+            uint32_t carriedId;
+            OD_ASSERT_TRUE(packetReceived >> carrierId >> entityType >> carriedId);
+            GameEntity* carrierEntity = gameMap->getEntityFromTypeAndNetworkId(GameEntityType::creature, carrierId);
+            if(carrierEntity == nullptr)
             {
-                OD_LOG_ERR("carrierName=" + carrierName);
+                OD_LOG_ERR("carrierId=" + Helper::toString(carrierId));
                 break;
             }
+            Creature* carrier = static_cast<Creature*>(carrierEntity);
 
-            GameEntity* carried = gameMap->getEntityFromTypeAndName(entityType, carriedName);
+            GameEntity* carried = gameMap->getEntityFromTypeAndNetworkId(entityType, carriedId);
             if(carried == nullptr)
             {
-                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", carriedName=" + carriedName);
+                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", carriedId=" + Helper::toString(carriedId));
                 break;
             }
 
@@ -854,22 +838,23 @@ bool ODClient::processMessage(ServerNotificationType cmd, ODPacket& packetReceiv
 
         case ServerNotificationType::releaseCarriedEntity:
         {
-            std::string carrierName;
+            uint32_t carrierId;
             GameEntityType entityType;
-            std::string carriedName;
+            uint32_t carriedId;
             Ogre::Vector3 pos;
-            OD_ASSERT_TRUE(packetReceived >> carrierName >> entityType >> carriedName >> pos);
-            Creature* carrier = gameMap->getCreature(carrierName);
-            if(carrier == nullptr)
+            OD_ASSERT_TRUE(packetReceived >> carrierId >> entityType >> carriedId >> pos);
+            GameEntity* carrierEntity = gameMap->getEntityFromTypeAndNetworkId(GameEntityType::creature, carrierId);
+            if(carrierEntity == nullptr)
             {
-                OD_LOG_ERR("carrierName=" + carrierName);
+                OD_LOG_ERR("carrierId=" + Helper::toString(carrierId));
                 break;
             }
+            Creature* carrier = static_cast<Creature*>(carrierEntity);
 
-            GameEntity* carried = gameMap->getEntityFromTypeAndName(entityType, carriedName);
+            GameEntity* carried = gameMap->getEntityFromTypeAndNetworkId(entityType, carriedId);
             if(carried == nullptr)
             {
-                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", carriedName=" + carriedName);
+                OD_LOG_ERR("entityType=" + Helper::toString(static_cast<int32_t>(entityType)) + ", carriedId=" + Helper::toString(carriedId));
                 break;
             }
 
@@ -1029,10 +1014,14 @@ bool ODClient::connect(const std::string& host, const int port, uint32_t timeout
     if(!ODSocketClient::connect(host, port, timeout, outputReplayFilename))
         return false;
 
-    // Send a hello request to start the conversation with the server
+    // Send a hello request to start the conversation with the server. We tell it we can
+    // read compressed messages
+    enableUncompression();
+    bool isCompressionSupported = true;
     ODPacket packSend;
     packSend << ClientNotificationType::hello
-        << std::string("OpenDungeons V ") + ODApplication::VERSION;
+        << std::string("OpenDungeons V ") + ODApplication::VERSION
+        << isCompressionSupported;
     send(packSend);
 
     return true;
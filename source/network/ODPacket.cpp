@@ -243,6 +243,11 @@ void ODPacket::clear()
     mPacket.clear();
 }
 
+uint32_t ODPacket::getDataSize() const
+{
+    return static_cast<uint32_t>(mPacket.getDataSize());
+}
+
 void ODPacket::writePacket(int32_t timestamp, std::ofstream& os)
 {
     int32_t bufferSize = mPacket.getDataSize();
@@ -252,6 +257,25 @@ void ODPacket::writePacket(int32_t timestamp, std::ofstream& os)
     os.write(buffer, bufferSize);
 }
 
+void ODPacket::appendPacket(const ODPacket& packet)
+{
+    // Same format as a string so that it can be read back without knowing the read position
+    uint32_t size = static_cast<uint32_t>(packet.mPacket.getDataSize());
+    mPacket << size;
+    mPacket.append(packet.mPacket.getData(), size);
+}
+
+bool ODPacket::extractPacket(ODPacket& packet)
+{
+    std::string data;
+    if(!(mPacket >> data))
+        return false;
+
+    packet.mPacket.clear();
+    packet.mPacket.append(data.data(), data.size());
+    return true;
+}
+
 int32_t ODPacket::readPacket(std::ifstream& is)
 {
     int32_t timestamp;
@@ -66,6 +66,8 @@
 class ODPacket
 {
     friend class ODSocketClient;
+    friend class ReplayReader;
+    friend class ReplayWriter;
 
     public:
         ODPacket()
@@ -125,6 +127,10 @@ class ODPacket
          */
         void clear();
 
+        /*! \brief Returns the size of the packet content in bytes.
+         */
+        uint32_t getDataSize() const;
+
         /*! \brief Writes the packet content to the given ofstream.
          */
         void writePacket(int32_t timestamp, std::ofstream& os);
@@ -135,6 +141,15 @@ class ODPacket
          */
         int32_t readPacket(std::ifstream& is);
 
+        /*! \brief Appends the content of the given packet as a length prefixed buffer. Used to send
+         *         several packets at once. It can be read with extractPacket.
+         */
+        void appendPacket(const ODPacket& packet);
+
+        /*! \brief Reads a packet written by appendPacket. Returns false if there is none.
+         */
+        bool extractPacket(ODPacket& packet);
+
         /*! \brief Template function to put arguments in a packet, used for in-place construction.
          */
         template<typename FirstArg, typename ...Args>
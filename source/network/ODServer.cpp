@@ -234,7 +234,7 @@ bool ODServer::startServer(const std::string& creator, const std::string& levelF
 
 void ODServer::queueServerNotification(ServerNotification* n)
 {
-    if ((n == nullptr) || (!isConnected()))
+    if ((n == nullptr) || (!isConnected()) || (!n->hasConcernedPlayers()))
     {
         delete n;
         return;
@@ -244,7 +244,14 @@ void ODServer::queueServerNotification(ServerNotification* n)
 
 void ODServer::sendAsyncMsg(ServerNotification& notif)
 {
-    sendMsg(notif.mConcernedPlayer, notif.mPacket);
+    if(!notif.mIsForPlayerList)
+    {
+        sendMsg(notif.mConcernedPlayer, notif.mPacket);
+        return;
+    }
+
+    for(Player* player : notif.mConcernedPlayers)
+        sendMsg(player, notif.mPacket);
 }
 
 void ODServer::sendMsg(Player* player, ODPacket& packet)
@@ -273,6 +280,58 @@ void ODServer::sendMsg(Player* player, ODPacket& packet)
         client->send(packet);
 }
 
+void ODServer::addMsgToBatch(Player* player, ODPacket& packet)
+{
+    if(player == nullptr)
+    {
+        // If player is nullptr, we send the message to every connected player
+        for (ODSocketClient* client : mSockClients)
+            mBatchedPackets[client].push_back(&packet);
+
+        return;
+    }
+
+    ODSocketClient* client = getClientFromPlayer(player);
+    if((client == nullptr) &&
+       (std::find(mDisconnectedPlayers.begin(), mDisconnectedPlayers.end(), player) == mDisconnectedPlayers.end()))
+    {
+        ServerNotificationType type;
+        OD_ASSERT_TRUE(packet >> type);
+        OD_ASSERT_TRUE_MSG(client != nullptr, "player=" + player->getNick()
+            + ", ServerNotificationType=" + ServerNotification::typeString(type));
+        return;
+    }
+
+    if(client != nullptr)
+        mBatchedPackets[client].push_back(&packet);
+}
+
+void ODServer::sendBatchedMsgs()
+{
+    for(std::pair<ODSocketClient* const, std::vector<ODPacket*>>& p : mBatchedPackets)
+    {
+        ODSocketClient* client = p.first;
+        std::vector<ODPacket*>& packets = p.second;
+        // No need to wrap a single message
+        if(packets.size() == 1)
+        {
+            client->send(*packets.front());
+            continue;
+        }
+
+        ODPacket packetBatch;
+        uint32_t nbMessages = static_cast<uint32_t>(packets.size());
+        packetBatch << ServerNotificationType::batch << nbMessages;
+        for(ODPacket* packet : packets)
+            packetBatch.appendPacket(*packet);
+
+        client->send(packetBatch);
+    }
+
+    // Clients may disconnect before the next call so we do not keep them
+    mBatchedPackets.clear();
+}
+
 void ODServer::handleConsoleCommand(Player* player, GameMap* gameMap, const std::vector<std::string>& args)
 {
     if(args.empty())
@@ -306,13 +365,10 @@ void ODServer::startNewTurn(double timeSinceLastTurn)
     GameMap* gameMap = mGameMap;
     int64_t turn = gameMap->getTurnNumber();
 
-    // We wait until every client acknowledge the turn to start the next one. This way, we ensure
+    // We wait until the clients are not too late to start the next one. This way, we ensure
     // synchronisation is not too bad
-    for (ODSocketClient* client : mSockClients)
-    {
-        if(client->getLastTurnAck() != turn)
-            return;
-    }
+    if(!checkClientsTurnLag(turn))
+        return;
 
     gameMap->setTurnNumber(++turn);
 
@@ -390,6 +446,74 @@ void ODServer::startNewTurn(double timeSinceLastTurn)
     gameMap->processDeletionQueues();
 }
 
+bool ODServer::checkClientsTurnLag(int64_t turn)
+{
+    const ConfigManager& config = ConfigManager::getSingleton();
+    int64_t maxTurnsLag = config.getMaxTurnsLag();
+    int64_t maxTurnsLagDisconnect = config.getMaxTurnsLagDisconnect();
+    bool canStartTurn = true;
+    std::vector<ODSocketClient*> clientsToDisconnect;
+    for (ODSocketClient* client : mSockClients)
+    {
+        client->updateTurnLag(turn);
+        int64_t turnLag = client->getTurnLag();
+        // Without lag allowed, every client has to acknowledge the turn
+        if(maxTurnsLag <= 0)
+        {
+            if(turnLag > 0)
+                canStartTurn = false;
+
+            continue;
+        }
+
+        if(client->isResyncing())
+        {
+            if((maxTurnsLagDisconnect > 0) && (turnLag > maxTurnsLagDisconnect))
+            {
+                clientsToDisconnect.push_back(client);
+                continue;
+            }
+
+            // We wait until the client is well within the limit to avoid switching at each turn
+            if(turnLag * 2 <= maxTurnsLag)
+            {
+                OD_LOG_INF("Client caught up, turnLag=" + Helper::toString(turnLag));
+                client->setResyncing(false);
+            }
+            continue;
+        }
+
+        if(turnLag < maxTurnsLag)
+        {
+            client->setNbTurnsStalled(0);
+            continue;
+        }
+
+        // The client is too late. We wait for it for a few turns. If it does not catch up, we stop waiting
+        // for it so that the other players are not frozen. Its messages are queued until it processes them
+        client->setNbTurnsStalled(client->getNbTurnsStalled() + 1);
+        if(client->getNbTurnsStalled() <= maxTurnsLag)
+        {
+            canStartTurn = false;
+            continue;
+        }
+
+        OD_LOG_WRN("Client too late, not waiting for it anymore, turnLag=" + Helper::toString(turnLag)
+            + ", nbResyncs=" + Helper::toString(client->getNbResyncs()));
+        client->setNbTurnsStalled(0);
+        client->setResyncing(true);
+    }
+
+    for(ODSocketClient* client : clientsToDisconnect)
+    {
+        OD_LOG_WRN("Disconnecting client too late, turnLag=" + Helper::toString(client->getTurnLag()));
+        clientDisconnecting(client);
+        disconnectClient(client);
+    }
+
+    return canStartTurn;
+}
+
 void ODServer::serverThread()
 {
     GameMap* gameMap = mGameMap;
@@ -466,7 +590,7 @@ void ODServer::serverThread()
                         {
                             for (int ii = 0; ii < gameMap->getMapSizeX(); ++ii)
                             {
-                                gameMap->getTile(ii,jj)->notifyVision(seat);
+                                gameMap->getTile(ii,jj)->addVision(seat);
                             }
                         }
 
@@ -482,8 +606,8 @@ void ODServer::serverThread()
                     if(seat->getPlayer() == nullptr)
                         continue;
 
-                    if(seat->getGold() > 0)
-                        gameMap->addGoldToSeat(seat->getGold(), seat->getId());
+                    if(seat->getStartingGold() > 0)
+                        gameMap->addGoldToSeat(seat->getStartingGold(), seat->getId());
                 }
             }
             else
@@ -528,6 +652,9 @@ void ODServer::processServerNotifications()
 
     bool running = true;
 
+    // The packets are sent in batches after the queue is processed. Until then, the processed events are kept
+    std::vector<ServerNotification*> processedEvents;
+
     while (running)
     {
         // If the queue is empty, let's get out of the loop.
@@ -550,40 +677,53 @@ void ODServer::processServerNotifications()
             case ServerNotificationType::turnStarted:
                 OD_LOG_INF("Server sends newturn="
                     + boost::lexical_cast<std::string>(gameMap->getTurnNumber()));
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                addMsgToBatch(event->mConcernedPlayer, event->mPacket);
                 break;
 
             case ServerNotificationType::entityPickedUp:
                 // This message should not be sent by human players (they are notified asynchronously)
                 OD_ASSERT_TRUE_MSG(event->mConcernedPlayer->getIsHuman(), "nick=" + event->mConcernedPlayer->getNick());
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                addMsgToBatch(event->mConcernedPlayer, event->mPacket);
                 break;
 
             case ServerNotificationType::entityDropped:
                 // This message should not be sent by human players (they are notified asynchronously)
                 OD_ASSERT_TRUE_MSG(event->mConcernedPlayer->getIsHuman(), "nick=" + event->mConcernedPlayer->getNick());
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                addMsgToBatch(event->mConcernedPlayer, event->mPacket);
                 break;
 
             case ServerNotificationType::entitySlapped:
                 // This message should not be sent by human players (they are notified asynchronously)
                 OD_ASSERT_TRUE_MSG(!event->mConcernedPlayer->getIsHuman(), "nick=" + event->mConcernedPlayer->getNick());
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                addMsgToBatch(event->mConcernedPlayer, event->mPacket);
                 break;
 
             case ServerNotificationType::exit:
                 running = false;
+                sendBatchedMsgs();
                 stopServer();
                 break;
 
             default:
-                sendMsg(event->mConcernedPlayer, event->mPacket);
+                if(!event->mIsForPlayerList)
+                {
+                    addMsgToBatch(event->mConcernedPlayer, event->mPacket);
+                    break;
+                }
+
+                // The same packet is shared by every concerned player
+                for(Player* player : event->mConcernedPlayers)
+                    addMsgToBatch(player, event->mPacket);
                 break;
         }
 
-        delete event;
-        event = nullptr;
+        processedEvents.push_back(event);
     }
+
+    sendBatchedMsgs();
+
+    for(ServerNotification* event : processedEvents)
+        delete event;
 }
 
 bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
@@ -597,6 +737,11 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
 
     ODSocketClient::ODComStatus status = clientSocket->recv(packetReceived);
 
+    // The client sockets are not blocking (see ODSocketClient::enableAsyncSend). We wait
+    // for the rest of the packet
+    if (status == ODSocketClient::ODComStatus::NotReady)
+        return true;
+
     // If the client closed the connection
     if (status != ODSocketClient::ODComStatus::OK)
     {
@@ -667,6 +812,17 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
                 return false;
             }
 
+            // Compression is only worth it for distant clients
+            bool isCompressionSupported = false;
+            OD_ASSERT_TRUE(packetReceived >> isCompressionSupported);
+            if(isCompressionSupported &&
+               ConfigManager::getSingleton().getNetworkCompression() &&
+               (clientSocket->getSockClient().getRemoteAddress() != sf::IpAddress::LocalHost))
+            {
+                OD_LOG_INF("Compression enabled for client " + clientSocket->getSockClient().getRemoteAddress().toString());
+                clientSocket->enableCompression();
+            }
+
             // Tell the client to load the given map
             OD_LOG_INF("Level sent to client: " + gameMap->getLevelName());
             clientSocket->setState("loadLevel");
@@ -1608,7 +1764,6 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
             }
             if(!affectedTiles.empty())
             {
-                uint32_t nbTiles = affectedTiles.size();
                 const std::vector<Seat*>& seats = gameMap->getSeats();
                 for(Seat* seat : seats)
                 {
@@ -1618,14 +1773,11 @@ bool ODServer::processClientNotifications(ODSocketClient* clientSocket)
                         continue;
 
                     ServerNotification notif(ServerNotificationType::refreshTiles, seat->getPlayer());
-                    notif.mPacket << nbTiles;
-                    for(Tile* tile : affectedTiles)
+                    gameMap->tilesToPacket(notif.mPacket, affectedTiles, [seat, &notif](Tile* tile)
                     {
-                        gameMap->tileToPacket(notif.mPacket, tile);
                         seat->updateTileStateForSeat(tile);
-                        tile->exportToPacketForUpdate(notif.mPacket, seat);
-
-                    }
+                        tile->exportToPacketForAsyncUpdate(notif.mPacket, seat);
+                    });
                     sendAsyncMsg(notif);
                 }
             }
@@ -1869,36 +2021,41 @@ bool ODServer::notifyClientMessage(ODSocketClient *clientSocket)
 {
     bool ret = processClientNotifications(clientSocket);
     if(!ret)
+        clientDisconnecting(clientSocket);
+
+    return ret;
+}
+
+void ODServer::clientDisconnecting(ODSocketClient* clientSocket)
+{
+    std::string nick = clientSocket->getPlayer() ? clientSocket->getPlayer()->getNick() : std::string();
+    std::string message = nick.empty() ?
+                          "Client disconnected state=" + clientSocket->getState() :
+                          "Client (" + nick + ") disconnected state=" + clientSocket->getState();
+    OD_LOG_INF(message);
+    if(std::string("ready").compare(clientSocket->getState()) == 0)
     {
-        std::string nick = clientSocket->getPlayer() ? clientSocket->getPlayer()->getNick() : std::string();
-        std::string message = nick.empty() ?
-                              "Client disconnected state=" + clientSocket->getState() :
-                              "Client (" + nick + ") disconnected state=" + clientSocket->getState();
-        OD_LOG_INF(message);
-        if(std::string("ready").compare(clientSocket->getState()) == 0)
+        for(Player* player : mGameMap->getPlayers())
         {
-            for(Player* player : mGameMap->getPlayers())
-            {
-                if(!player->getIsHuman())
-                    continue;
+            if(!player->getIsHuman())
+                continue;
 
-                ServerNotification *serverNotification = new ServerNotification(
-                    ServerNotificationType::chatServer, player);
-                std::string msg = nick.empty() ?
-                                  "A client disconnected." :
-                                  nick + " disconnected.";
-                serverNotification->mPacket << msg << EventShortNoticeType::genericGameInfo;
-                queueServerNotification(serverNotification);
-            }
+            ServerNotification *serverNotification = new ServerNotification(
+                ServerNotificationType::chatServer, player);
+            std::string msg = nick.empty() ?
+                              "A client disconnected." :
+                              nick + " disconnected.";
+            serverNotification->mPacket << msg << EventShortNoticeType::genericGameInfo;
+            queueServerNotification(serverNotification);
         }
+    }
 
-        if(mSeatsConfigured)
-        {
-            mDisconnectedPlayers.push_back(clientSocket->getPlayer());
-        }
-        // TODO : wait at least 1 minute if the client reconnects if deconnexion happens during game
+    if(mSeatsConfigured)
+    {
+        mDisconnectedPlayers.push_back(clientSocket->getPlayer());
     }
-    return ret;
+    mCreaturesInfoWanted.erase(clientSocket);
+    // TODO : wait at least 1 minute if the client reconnects if deconnexion happens during game
 }
 
 void ODServer::stopServer()
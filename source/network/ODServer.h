@@ -114,6 +114,10 @@ private:
 
     std::map<ODSocketClient*, std::vector<std::string>> mCreaturesInfoWanted;
 
+    //! \brief Packets waiting to be sent to each client by sendBatchedMsgs. They point to the
+    //! notifications processed in processServerNotifications
+    std::map<ODSocketClient*, std::vector<ODPacket*>> mBatchedPackets;
+
     ConsoleInterface mConsoleInterface;
 
     std::string mMasterServerGameId;
@@ -127,6 +131,17 @@ private:
     //! \brief Called when a new turn started.
     void startNewTurn(double timeSinceLastTurn);
 
+    /*! \brief Checks how late the clients are regarding the given turn. Returns true if the next turn
+     * can be started. The server can be up to ConfigManager::getMaxTurnsLag turns ahead of a client.
+     * If a client stays later than that, we stop waiting for it until it catches up. Clients
+     * later than ConfigManager::getMaxTurnsLagDisconnect turns are disconnected.
+     */
+    bool checkClientsTurnLag(int64_t turn);
+
+    //! \brief Tells the other players the given client is disconnecting and remembers its player so that
+    //! messages sent to it are discarded. Called before the client is removed from mSockClients
+    void clientDisconnecting(ODSocketClient* clientSocket);
+
     /*! \brief Monitors mServerNotificationQueue for new events and informs the clients about them.
      *
      * This function is used in server mode and acts as a "consumer" on
@@ -148,6 +163,14 @@ private:
     //! \brief Sends the packet to the given player. If player is nullptr, the packet is sent to every connected player
     void sendMsg(Player* player, ODPacket& packet);
 
+    //! \brief Same as sendMsg but the packet is only stored until sendBatchedMsgs is called. It
+    //! must stay valid until then
+    void addMsgToBatch(Player* player, ODPacket& packet);
+
+    //! \brief Sends the packets stored by addMsgToBatch. When there are several packets for the same
+    //! client, they are sent within a single ServerNotificationType::batch message
+    void sendBatchedMsgs();
+
     void fireSeatConfigurationRefresh();
 
     //! \brief Handles console command. player is the player that launched the command
@@ -17,6 +17,7 @@
 
 #include "ODSocketClient.h"
 #include "network/ODPacket.h"
+#include "network/ODSocketServer.h"
 #include "network/ServerNotification.h"
 
 #include "utils/Helper.h"
@@ -25,6 +26,8 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/filesystem.hpp>
 
+#include <cstring>
+
 bool ODSocketClient::connect(const std::string& host, const int port, uint32_t timeout, const std::string& outputReplayFilename)
 {
     mSource = ODSource::none;
@@ -43,8 +46,13 @@ bool ODSocketClient::connect(const std::string& host, const int port, uint32_t t
 
     mOutputReplayFilename = outputReplayFilename;
 
-    mReplayOutputStream.open(mOutputReplayFilename, std::ios::out | std::ios::binary);
+    // Clients that do not need a replay (like the load test bots) give no filename
+    if(!mOutputReplayFilename.empty() && !mReplayWriter.open(mOutputReplayFilename))
+        OD_LOG_WRN("Could not create replay file " + mOutputReplayFilename);
+    mNbBytesSent = 0;
+    mNbBytesReceived = 0;
     mGameClock.restart();
+    mReplayTimeOffset = 0;
     mSource = ODSource::network;
     return true;
 }
@@ -52,15 +60,54 @@ bool ODSocketClient::connect(const std::string& host, const int port, uint32_t t
 bool ODSocketClient::replay(const std::string& filename)
 {
     OD_LOG_INF("Reading replay from file " + filename);
-    mReplayInputStream.open(filename, std::ios::in | std::ios::binary);
+    if(!mReplayReader.open(filename))
+    {
+        OD_LOG_ERR("Could not read replay file " + filename);
+        return false;
+    }
     mGameClock.restart();
+    mReplayTimeOffset = 0;
     mSource = ODSource::file;
     return true;
 }
 
+bool ODSocketClient::seekReplay(int64_t turn)
+{
+    if(mSource != ODSource::file)
+        return false;
+
+    int32_t timestamp = mReplayReader.getTurnTimestamp(turn);
+    if(timestamp < 0)
+    {
+        OD_LOG_INF("Turn " + Helper::toString(turn) + " not found in replay");
+        return false;
+    }
+
+    // Going back would need to reset the game map
+    int32_t currentTime = getGameTimeMillis();
+    if(timestamp <= currentTime)
+    {
+        OD_LOG_INF("Cannot go back in replay to turn " + Helper::toString(turn));
+        return false;
+    }
+
+    // The messages received before the turn are now late so they will be processed without waiting
+    mReplayTimeOffset += timestamp - currentTime;
+    return true;
+}
+
+void ODSocketClient::notifyReplayTurnStarted(int64_t turn)
+{
+    if(mSource != ODSource::network)
+        return;
+
+    mReplayWriter.notifyTurnStarted(turn);
+}
+
 void ODSocketClient::disconnect(bool keepReplay)
 {
     mPendingTimestamp = -1;
+    mBatchNbRemaining = 0;
     ODSource src = mSource;
     mSource = ODSource::none;
     switch(src)
@@ -76,11 +123,28 @@ void ODSocketClient::disconnect(bool keepReplay)
             // if there is any left.
             mSockSelector.clear();
             mSockClient.disconnect();
+            if(mNbBytesUncompressed > 0)
+            {
+                OD_LOG_INF("Network compression: bytesBefore=" + Helper::toString(mNbBytesUncompressed)
+                    + ", bytesAfter=" + Helper::toString(mNbBytesCompressed)
+                    + ", saved=" + Helper::toString(100.0 - 100.0 * static_cast<double>(mNbBytesCompressed)
+                        / static_cast<double>(mNbBytesUncompressed), 1) + "%");
+            }
+            if(mMaxTurnLag > 0)
+            {
+                OD_LOG_INF("Turn lag: maxTurnLag=" + Helper::toString(mMaxTurnLag)
+                    + ", nbResyncs=" + Helper::toString(mNbResyncs));
+            }
+            // The dictionaries are only valid for the connection
+            mCompressor.reset();
+            mUncompressor.reset();
+            mNbBytesUncompressed = 0;
+            mNbBytesCompressed = 0;
             break;
         }
         case ODSource::file:
         {
-            mReplayInputStream.close();
+            mReplayReader.close();
             return;
         }
         default:
@@ -88,9 +152,9 @@ void ODSocketClient::disconnect(bool keepReplay)
             break;
     }
 
-    mReplayOutputStream.close();
+    mReplayWriter.close();
     // Delete the replay newly created if asked to.
-    if (!keepReplay)
+    if (!keepReplay && !mOutputReplayFilename.empty())
         boost::filesystem::remove(mOutputReplayFilename);
     mOutputReplayFilename.clear();
 }
@@ -113,16 +177,13 @@ bool ODSocketClient::isDataAvailable()
         }
         case ODSource::file:
         {
-            if(mReplayInputStream.eof())
-                return false;
-
             if(mPendingTimestamp == -1)
-                mPendingTimestamp = mPendingPacket.readPacket(mReplayInputStream);
+                mPendingTimestamp = mReplayReader.readPacket(mPendingPacket);
 
             if(mPendingTimestamp < 0)
                 return false;
 
-            if(mPendingTimestamp < mGameClock.getElapsedTime().asMilliseconds())
+            if(mPendingTimestamp < getGameTimeMillis())
                 return true;
 
             return false;
@@ -135,11 +196,200 @@ bool ODSocketClient::isDataAvailable()
     return false;
 }
 
+//! \brief Number of packets that can be queued for a client before using the overflow queue
+const uint32_t SEND_QUEUE_CAPACITY = 1024;
+//! \brief Number of packets waiting for a client from which we report it is too slow
+const uint32_t SEND_QUEUE_HIGH_WATER_MARK = 768;
+//! \brief Packets smaller than that are not worth compressing
+const uint32_t COMPRESSION_MIN_SIZE = 32;
+
+ODSocketClient::~ODSocketClient()
+{
+    if(mSendQueue != nullptr)
+    {
+        while(ODPacket** packet = mSendQueue->front())
+        {
+            delete *packet;
+            mSendQueue->pop();
+        }
+    }
+
+    for(ODPacket* packet : mSendOverflow)
+        delete packet;
+
+    delete mSendingPacket;
+}
+
+void ODSocketClient::enableAsyncSend(ODSocketServer* server)
+{
+    mAsyncSendServer = server;
+    mSockClient.setBlocking(false);
+    if(mSendQueue == nullptr)
+        mSendQueue.reset(new SpscRingBuffer<ODPacket*>(SEND_QUEUE_CAPACITY));
+}
+
+bool ODSocketClient::flushSendOverflow()
+{
+    bool isQueued = false;
+    while(!mSendOverflow.empty())
+    {
+        if(!mSendQueue->push(mSendOverflow.front()))
+            break;
+
+        mSendOverflow.pop_front();
+        isQueued = true;
+    }
+    return isQueued;
+}
+
+bool ODSocketClient::sendQueuedPackets()
+{
+    while(true)
+    {
+        if(mSendingPacket == nullptr)
+        {
+            ODPacket** front = mSendQueue->front();
+            if(front == nullptr)
+                return false;
+
+            mSendingPacket = *front;
+            mSendQueue->pop();
+        }
+
+        // If a packet could not be sent, the client is likely disconnected. We drop the
+        // remaining packets. The game thread will notice the disconnection while receiving
+        if(!mIsSendFailed)
+        {
+            // The socket is not blocking. If it could not take the whole packet, we will send
+            // the same one again (sfml keeps track of what has been sent)
+            sf::Socket::Status status = mSockClient.send(mSendingPacket->mPacket);
+            if((status == sf::Socket::Partial) || (status == sf::Socket::NotReady))
+                return true;
+
+            if(status != sf::Socket::Done)
+            {
+                OD_LOG_ERR("Could not send queued data to client status=" + Helper::toString(status));
+                mIsSendFailed = true;
+            }
+        }
+
+        delete mSendingPacket;
+        mSendingPacket = nullptr;
+    }
+}
+
+void ODSocketClient::updateTurnLag(int64_t turn)
+{
+    mTurnLag = turn - mLastTurnAck;
+    if(mTurnLag > mMaxTurnLag)
+        mMaxTurnLag = mTurnLag;
+}
+
+void ODSocketClient::setResyncing(bool isResyncing)
+{
+    if(isResyncing && !mIsResyncing)
+        ++mNbResyncs;
+
+    mIsResyncing = isResyncing;
+}
+
+void ODSocketClient::enableCompression()
+{
+    if(mCompressor == nullptr)
+        mCompressor.reset(new LzEncoder);
+}
+
+void ODSocketClient::enableUncompression()
+{
+    if(mUncompressor == nullptr)
+        mUncompressor.reset(new LzDecoder);
+}
+
+void ODSocketClient::compressPacket(const ODPacket& packet, ODPacket& compressedPacket)
+{
+    uint32_t size = packet.getDataSize();
+    mCompressor->compress(static_cast<const uint8_t*>(packet.mPacket.getData()), size, mCompressionBuffer);
+    compressedPacket << ServerNotificationType::compressed << size;
+    compressedPacket.mPacket.append(mCompressionBuffer.data(), mCompressionBuffer.size());
+    mNbBytesUncompressed += size;
+    mNbBytesCompressed += compressedPacket.getDataSize();
+}
+
+bool ODSocketClient::uncompressPacket(ODPacket& packet)
+{
+    // We check the raw data to know if the packet is compressed so that the other ones
+    // are left untouched
+    ODPacket header;
+    header << ServerNotificationType::compressed;
+    uint32_t headerSize = header.getDataSize();
+    uint32_t packetSize = packet.getDataSize();
+    if((packetSize < headerSize) ||
+       (std::memcmp(packet.mPacket.getData(), header.mPacket.getData(), headerSize) != 0))
+    {
+        return true;
+    }
+
+    ServerNotificationType type;
+    uint32_t size;
+    if(!(packet >> type >> size))
+        return false;
+
+    uint32_t dataOffset = headerSize + sizeof(uint32_t);
+    const uint8_t* data = static_cast<const uint8_t*>(packet.mPacket.getData()) + dataOffset;
+    if(!mUncompressor->uncompress(data, packetSize - dataOffset, size, mCompressionBuffer))
+        return false;
+
+    packet.mPacket.clear();
+    packet.mPacket.append(mCompressionBuffer.data(), mCompressionBuffer.size());
+    mNbBytesUncompressed += size;
+    mNbBytesCompressed += packetSize;
+    return true;
+}
+
 ODSocketClient::ODComStatus ODSocketClient::send(ODPacket& s)
 {
     if(mSource != ODSource::network)
         return ODComStatus::OK;
 
+    // Small packets are sent as they are. The client knows the compressed ones from their header
+    if((mCompressor != nullptr) && (s.getDataSize() >= COMPRESSION_MIN_SIZE))
+    {
+        ODPacket compressedPacket;
+        compressPacket(s, compressedPacket);
+        return sendPacket(compressedPacket);
+    }
+
+    return sendPacket(s);
+}
+
+ODSocketClient::ODComStatus ODSocketClient::sendPacket(ODPacket& s)
+{
+    mNbBytesSent += s.getDataSize();
+    if(mAsyncSendServer != nullptr)
+    {
+        // We keep the order of the packets: if some are waiting in the overflow queue, the new one
+        // has to wait as well
+        flushSendOverflow();
+        ODPacket* packet = new ODPacket(s);
+        if(!mSendOverflow.empty() || !mSendQueue->push(packet))
+            mSendOverflow.push_back(packet);
+
+        uint32_t nbPending = mSendQueue->size() + static_cast<uint32_t>(mSendOverflow.size());
+        if(!mSendHighWaterReported && (nbPending >= SEND_QUEUE_HIGH_WATER_MARK))
+        {
+            mSendHighWaterReported = true;
+            OD_LOG_WRN("Client is not reading fast enough, nbPendingPackets=" + Helper::toString(nbPending));
+        }
+        else if(mSendHighWaterReported && (nbPending < SEND_QUEUE_HIGH_WATER_MARK / 2))
+        {
+            mSendHighWaterReported = false;
+            OD_LOG_INF("Client caught up, nbPendingPackets=" + Helper::toString(nbPending));
+        }
+
+        mAsyncSendServer->notifyPacketsToSend();
+        return ODComStatus::OK;
+    }
+
     sf::Socket::Status status = mSockClient.send(s.mPacket);
     if (status == sf::Socket::Done)
         return ODComStatus::OK;
@@ -164,8 +414,15 @@ ODSocketClient::ODComStatus ODSocketClient::recv(ODPacket& s)
             sf::Socket::Status status = mSockClient.receive(s.mPacket);
             if (status == sf::Socket::Done)
             {
-                s.writePacket(mGameClock.getElapsedTime().asMilliseconds(),
-                    mReplayOutputStream);
+                mNbBytesReceived += s.getDataSize();
+                // Replays are written uncompressed so that they can be read without the
+                // previous packets
+                if((mUncompressor != nullptr) && !uncompressPacket(s))
+                {
+                    OD_LOG_ERR("Invalid compressed data received");
+                    return ODComStatus::Error;
+                }
+                mReplayWriter.writePacket(mGameClock.getElapsedTime().asMilliseconds(), s);
                 return ODComStatus::OK;
             }
 
@@ -211,6 +468,9 @@ void ODSocketClient::processClientSocketMessages()
 
 bool ODSocketClient::processOneClientSocketMessage()
 {
+    if(mBatchNbRemaining > 0)
+        return processOneBatchMessage();
+
     if(!isDataAvailable())
         return false;
 
@@ -227,5 +487,28 @@ bool ODSocketClient::processOneClientSocketMessage()
     ServerNotificationType serverCommand;
     OD_ASSERT_TRUE(packetReceived >> serverCommand);
 
-    return processMessage(serverCommand, packetReceived);
+    if(serverCommand != ServerNotificationType::batch)
+        return processMessage(serverCommand, packetReceived);
+
+    // The server sent several messages at once. They are processed one by one like if they had been
+    // received separately so that processing can be stopped in the middle of the batch
+    OD_ASSERT_TRUE(packetReceived >> mBatchNbRemaining);
+    mBatchPacket = packetReceived;
+    return processOneBatchMessage();
+}
+
+bool ODSocketClient::processOneBatchMessage()
+{
+    --mBatchNbRemaining;
+    ODPacket packetMessage;
+    if(!mBatchPacket.extractPacket(packetMessage))
+    {
+        OD_LOG_ERR("Invalid batch message, remaining=" + Helper::toString(mBatchNbRemaining));
+        mBatchNbRemaining = 0;
+        return false;
+    }
+
+    ServerNotificationType serverCommand;
+    OD_ASSERT_TRUE(packetMessage >> serverCommand);
+    return processMessage(serverCommand, packetMessage);
 }
@@ -18,14 +18,20 @@
 #ifndef ODSOCKETCLIENT_H
 #define ODSOCKETCLIENT_H
 
+#include "network/LzCodec.h"
 #include "network/ODPacket.h"
+#include "network/ReplayFile.h"
+#include "utils/SpscRingBuffer.h"
 
 #include <SFML/Network.hpp>
 
 #include <string>
 #include <cstdint>
-#include <fstream>
+#include <deque>
+#include <memory>
+#include <vector>
 
+class ODSocketServer;
 class Player;
 
 enum class ServerNotificationType;
@@ -49,11 +55,25 @@ class ODSocketClient
             mSource(ODSource::none),
             mPlayer(nullptr),
             mLastTurnAck(-1),
-            mPendingTimestamp(-1)
+            mTurnLag(0),
+            mMaxTurnLag(0),
+            mNbTurnsStalled(0),
+            mIsResyncing(false),
+            mNbResyncs(0),
+            mReplayTimeOffset(0),
+            mPendingTimestamp(-1),
+            mBatchNbRemaining(0),
+            mAsyncSendServer(nullptr),
+            mSendingPacket(nullptr),
+            mIsSendFailed(false),
+            mSendHighWaterReported(false),
+            mNbBytesUncompressed(0),
+            mNbBytesCompressed(0),
+            mNbBytesSent(0),
+            mNbBytesReceived(0)
         {}
 
-        virtual ~ODSocketClient()
-        {}
+        virtual ~ODSocketClient();
 
         // Client initialization
         bool isConnected();
@@ -69,10 +89,28 @@ class ODSocketClient
         void setPlayer(Player* player) { mPlayer = player; }
         int64_t getLastTurnAck() { return mLastTurnAck; }
         void setLastTurnAck(int64_t lastTurnAck) { mLastTurnAck = lastTurnAck; }
+
+        //! \brief Updates the lag metrics with the turn the server is about to start. Used on server side only
+        void updateTurnLag(int64_t turn);
+        //! \brief Number of turns the client has not acknowledged yet
+        int64_t getTurnLag() const { return mTurnLag; }
+        int64_t getMaxTurnLag() const { return mMaxTurnLag; }
+        //! \brief Number of turns in a row the server waited for this client
+        uint32_t getNbTurnsStalled() const { return mNbTurnsStalled; }
+        void setNbTurnsStalled(uint32_t nbTurnsStalled) { mNbTurnsStalled = nbTurnsStalled; }
+        //! \brief true if the client is too late and the server does not wait for it until it catches up
+        bool isResyncing() const { return mIsResyncing; }
+        void setResyncing(bool isResyncing);
+        uint32_t getNbResyncs() const { return mNbResyncs; }
         const std::string& getState() {return mState;}
         bool isDataAvailable();
         int32_t getGameTimeMillis()
-        { return mGameClock.getElapsedTime().asMilliseconds(); }
+        { return mGameClock.getElapsedTime().asMilliseconds() + mReplayTimeOffset; }
+
+        /*! \brief When watching a replay, processes every message until the given turn without waiting.
+         * Only works forward. Returns false if the turn cannot be reached
+         */
+        bool seekReplay(int64_t turn);
 
         void setState(const std::string& state) {mState = state;}
 
@@ -90,6 +128,52 @@ class ODSocketClient
          */
         ODComStatus send(ODPacket& s);
 
+        /*! \brief Once called, send will only queue the packets. They will be sent by the network
+         * thread of the given server (see ODSocketServer::sendThread). The socket is set as non blocking
+         * so that a slow client cannot block the game nor the other clients. Used on server side only
+         */
+        void enableAsyncSend(ODSocketServer* server);
+
+        /*! \brief Sends the packets queued by send as long as the socket accepts data. Called from the
+         * network thread only. Returns true if some packets are still waiting because the socket was
+         * not ready. If a packet cannot be sent, the client is likely disconnected and the queued
+         * packets are dropped
+         */
+        bool sendQueuedPackets();
+
+        /*! \brief Queues the packets that did not fit in the send queue while there is room.
+         * Called from the game thread. Returns true if at least one packet has been queued
+         */
+        bool flushSendOverflow();
+
+        //! \brief true if packets did not fit in the send queue yet. Called from the game thread
+        inline bool isSendOverflowEmpty() const
+        { return mSendOverflow.empty(); }
+
+        /*! \brief Once called, the packets sent are compressed with a stream dictionary kept for the
+         * whole connection (see LzCodec). Should only be called on server side for clients that told
+         * they support it
+         */
+        void enableCompression();
+
+        /*! \brief Once called, the packets received are checked for compression. Should only be called on client
+         * side, when telling the server that compression is supported. The messages the server receives are never
+         * checked so that a ClientNotificationType value cannot be taken for ServerNotificationType::compressed
+         */
+        void enableUncompression();
+
+        //! \brief Number of bytes sent (or received) in compressed packets, before and after compression
+        inline uint64_t getNbBytesUncompressed() const
+        { return mNbBytesUncompressed; }
+        inline uint64_t getNbBytesCompressed() const
+        { return mNbBytesCompressed; }
+
+        //! \brief Number of bytes sent and received through the socket since the connection
+        inline uint64_t getNbBytesSent() const
+        { return mNbBytesSent; }
+        inline uint64_t getNbBytesReceived() const
+        { return mNbBytesReceived; }
+
         /*! \brief Receives a packet through the network
          * ODPacket should preserve integrity. That means that if an ODSocketClient
          * sends an ODPacket, the server should receive exactly 1 similar ODPacket (same data,
@@ -108,22 +192,77 @@ class ODSocketClient
         virtual void playerDisconnected()
         {}
 
+        //! \brief Tells that the last packet received started the given turn. Used to index the replay
+        void notifyReplayTurnStarted(int64_t turn);
+
     private :
         bool processOneClientSocketMessage();
+        //! \brief Processes the next message of mBatchPacket
+        bool processOneBatchMessage();
+
+        //! \brief Sends the given packet without compressing it
+        ODComStatus sendPacket(ODPacket& s);
+
+        //! \brief Writes in compressedPacket a ServerNotificationType::compressed message with the
+        //! content of the given packet
+        void compressPacket(const ODPacket& packet, ODPacket& compressedPacket);
+
+        //! \brief If the given packet is a ServerNotificationType::compressed message, replaces it by
+        //! the uncompressed one. Returns false if the compressed data is invalid
+        bool uncompressPacket(ODPacket& packet);
 
         ODSource mSource;
         sf::SocketSelector mSockSelector;
         sf::TcpSocket mSockClient;
         Player* mPlayer;
         int64_t mLastTurnAck;
+        int64_t mTurnLag;
+        int64_t mMaxTurnLag;
+        uint32_t mNbTurnsStalled;
+        bool mIsResyncing;
+        uint32_t mNbResyncs;
         std::string mState;
 
         sf::Clock mGameClock;
-        std::ifstream mReplayInputStream;
-        std::ofstream mReplayOutputStream;
+        //! \brief Added to mGameClock when seeking in a replay
+        int32_t mReplayTimeOffset;
+        ReplayReader mReplayReader;
+        ReplayWriter mReplayWriter;
         ODPacket mPendingPacket;
         int32_t mPendingTimestamp;
 
+        //! \brief Batch received from the server (see ServerNotificationType::batch) and the number of
+        //! messages in it not processed yet
+        ODPacket mBatchPacket;
+        uint32_t mBatchNbRemaining;
+
+        //! \brief Server to wake up when packets are queued. nullptr if send is synchronous
+        ODSocketServer* mAsyncSendServer;
+        //! \brief Packets waiting to be sent by the network thread. The game thread pushes and the
+        //! network thread pops
+        std::unique_ptr<SpscRingBuffer<ODPacket*>> mSendQueue;
+        //! \brief Packets that did not fit in mSendQueue. Only used by the game thread
+        std::deque<ODPacket*> mSendOverflow;
+        //! \brief Packet popped from mSendQueue that the socket did not fully take yet. Only used
+        //! by the network thread
+        ODPacket* mSendingPacket;
+        //! \brief Set by the network thread when a packet could not be sent
+        bool mIsSendFailed;
+        //! \brief true if we warned that the client does not read its messages fast enough. Reset
+        //! once the queue is emptied enough
+        bool mSendHighWaterReported;
+
+        //! \brief Compression of the packets sent. nullptr if not enabled
+        std::unique_ptr<LzEncoder> mCompressor;
+        //! \brief Uncompression of the packets received. nullptr if not enabled
+        std::unique_ptr<LzDecoder> mUncompressor;
+        //! \brief Used by compressPacket and uncompressPacket to avoid allocating a buffer each time
+        std::vector<uint8_t> mCompressionBuffer;
+        uint64_t mNbBytesUncompressed;
+        uint64_t mNbBytesCompressed;
+        uint64_t mNbBytesSent;
+        uint64_t mNbBytesReceived;
+
         //! \brief the replay filename being written. Used to later optionally delete it
         //! if asked to.
         std::string mOutputReplayFilename;
@@ -24,9 +24,19 @@
 
 #include <SFML/System.hpp>
 
+#include <algorithm>
+#include <chrono>
+
+//! \brief When a client socket cannot take more data, the network thread tries again after that time
+const int32_t SEND_RETRY_DELAY_MS = 5;
+//! \brief Time given to send the remaining packets when the server stops
+const int32_t STOP_SEND_TIMEOUT_MS = 2000;
+
 ODSocketServer::ODSocketServer():
     mThread(nullptr),
-    mIsConnected(false)
+    mIsConnected(false),
+    mSendThread(nullptr),
+    mHasPacketsToSend(false)
 {
 }
 
@@ -52,6 +62,8 @@ bool ODSocketServer::createServer(int listeningPort)
     mSockSelector.add(mSockListener);
     mIsConnected = true;
     OD_LOG_INF("Server connected and listening");
+    mSendThread = new sf::Thread(&ODSocketServer::sendThread, this);
+    mSendThread->launch();
     mThread = new sf::Thread(&ODSocketServer::serverThread, this);
     mThread->launch();
 
@@ -63,12 +75,62 @@ bool ODSocketServer::isConnected()
     return mIsConnected;
 }
 
+void ODSocketServer::notifyPacketsToSend()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSendMutex);
+        mHasPacketsToSend = true;
+    }
+    mSendCondition.notify_one();
+}
+
+void ODSocketServer::sendThread()
+{
+    bool isWaitingSocket = false;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mSendMutex);
+            // If a client socket could not take all its packets, we try again a bit later
+            if(isWaitingSocket)
+                mSendCondition.wait_for(lock, std::chrono::milliseconds(SEND_RETRY_DELAY_MS), [this]() { return mHasPacketsToSend; });
+            else
+                mSendCondition.wait(lock, [this]() { return mHasPacketsToSend; });
+
+            mHasPacketsToSend = false;
+            // The remaining packets are sent by stopServer
+            if(!mIsConnected)
+                return;
+        }
+
+        // The sockets are not blocking so we only keep the lock while copying data to them. A slow
+        // client delays neither the game thread nor the other clients
+        isWaitingSocket = false;
+        sf::Lock lock(mSockClientsMutex);
+        for(ODSocketClient* client : mSockClients)
+        {
+            if(client->sendQueuedPackets())
+                isWaitingSocket = true;
+        }
+    }
+}
+
 void ODSocketServer::doTask(int timeoutMs)
 {
     mClockMainTask.restart();
     while((timeoutMs == 0) ||
           (timeoutMs > mClockMainTask.getElapsedTime().asMilliseconds()))
     {
+        // Packets may be waiting because the send queue of a client was full
+        bool isPacketQueued = false;
+        for(ODSocketClient* client : mSockClients)
+        {
+            if(client->flushSendOverflow())
+                isPacketQueued = true;
+        }
+        if(isPacketQueued)
+            notifyPacketsToSend();
+
         bool isSockReady;
         if(timeoutMs != 0)
         {
@@ -96,7 +158,9 @@ void ODSocketServer::doTask(int timeoutMs)
                 OD_LOG_INF("New client connected.");
                 // The server wants to keep the client
                 newClient->setSource(ODSocketClient::ODSource::network);
+                newClient->enableAsyncSend(this);
                 mSockSelector.add(newClient->getSockClient());
+                sf::Lock lock(mSockClientsMutex);
                 mSockClients.push_back(newClient);
             }
         }
@@ -110,10 +174,9 @@ void ODSocketServer::doTask(int timeoutMs)
                     (!notifyClientMessage(client)))
                 {
                     // The server wants to remove the client
+                    sf::Lock lock(mSockClientsMutex);
                     it = mSockClients.erase(it);
-                    mSockSelector.remove(client->getSockClient());
-                    client->disconnect();
-                    delete client;
+                    deleteClient(client);
                 }
                 else
                 {
@@ -124,14 +187,71 @@ void ODSocketServer::doTask(int timeoutMs)
     }
 }
 
+void ODSocketServer::disconnectClient(ODSocketClient* client)
+{
+    sf::Lock lock(mSockClientsMutex);
+    std::vector<ODSocketClient*>::iterator it = std::find(mSockClients.begin(), mSockClients.end(), client);
+    if(it == mSockClients.end())
+    {
+        OD_LOG_ERR("Unknown client");
+        return;
+    }
+
+    mSockClients.erase(it);
+    deleteClient(client);
+}
+
+void ODSocketServer::deleteClient(ODSocketClient* client)
+{
+    mSockSelector.remove(client->getSockClient());
+    client->disconnect();
+    delete client;
+}
+
 void ODSocketServer::stopServer()
 {
-    mIsConnected = false;
+    {
+        std::lock_guard<std::mutex> lock(mSendMutex);
+        mIsConnected = false;
+    }
     if(mThread != nullptr)
         delete mThread; // Delete waits for the thread to finish
     mThread = nullptr;
+
+    notifyPacketsToSend();
+    if(mSendThread != nullptr)
+        delete mSendThread;
+    mSendThread = nullptr;
+
+    // We send the remaining packets (including the ones waiting in the overflow queues). As a client
+    // may not be reading anymore, we give up after some time
+    sf::Clock clock;
+    bool isWaitingSocket = true;
+    while(isWaitingSocket)
+    {
+        isWaitingSocket = false;
+        for(ODSocketClient* client : mSockClients)
+        {
+            client->flushSendOverflow();
+            if(client->sendQueuedPackets() || !client->isSendOverflowEmpty())
+                isWaitingSocket = true;
+        }
+
+        if(!isWaitingSocket)
+            break;
+
+        if(clock.getElapsedTime().asMilliseconds() > STOP_SEND_TIMEOUT_MS)
+        {
+            OD_LOG_WRN("Some clients did not receive all their packets before the server stopped");
+            break;
+        }
+
+        sf::sleep(sf::milliseconds(SEND_RETRY_DELAY_MS));
+    }
+
     mSockSelector.clear();
     mSockListener.close();
+    sf::Lock lock(mSockClientsMutex);
     for (std::vector<ODSocketClient*>::iterator it = mSockClients.begin(); it != mSockClients.end(); ++it)
     {
         ODSocketClient* client = *it;
@@ -22,6 +22,8 @@
 
 #include <SFML/Network.hpp>
 
+#include <condition_variable>
+#include <mutex>
 #include <string>
 
 class ODPacket;
@@ -38,6 +40,9 @@ class ODSocketServer
         virtual bool createServer(int listeningPort);
         virtual void stopServer();
 
+        //! \brief Wakes up the network thread. Called by the clients when packets are queued
+        void notifyPacketsToSend();
+
     protected:
         /*! \brief Function called when a new client connects. If the server returns an ODSocketClient,
          *! it will be added to the client list
@@ -64,15 +69,40 @@ class ODSocketServer
          * timeoutMs milliseconds, even if new clients connected or clients are sending messages.
          */
         void doTask(int timeoutMs);
+
+        //! \brief Removes the given client from the client list and deletes it. Must not be called
+        //! while iterating over mSockClients
+        void disconnectClient(ODSocketClient* client);
+
         std::vector<ODSocketClient*> mSockClients;
         virtual void serverThread() = 0;
         sf::Thread* mThread;
 
     private:
+        //! \brief Closes the connection with a client removed from mSockClients and deletes it
+        void deleteClient(ODSocketClient* client);
+
         sf::TcpListener mSockListener;
         sf::SocketSelector mSockSelector;
         sf::Clock mClockMainTask;
         bool mIsConnected;
+
+        /*! \brief Network thread function. Sends the packets queued by the clients (see
+         * ODSocketClient::enableAsyncSend) so that a slow client does not block the game thread.
+         * The client sockets are not blocking: when one cannot take more data, the thread goes on
+         * with the others and tries again later.
+         * Receiving is still done by doTask on the game thread, between the turns. Moving it here would need
+         * a selector on the client sockets, which this thread could not wait on together with mSendCondition
+         */
+        void sendThread();
+        sf::Thread* mSendThread;
+        //! \brief Locked by the game thread when it adds or removes clients and by the network thread
+        //! while it goes through mSockClients. As sends do not block, it is only held for a short time
+        sf::Mutex mSockClientsMutex;
+        std::mutex mSendMutex;
+        std::condition_variable mSendCondition;
+        //! \brief Set when packets are queued or when the server stops. Protected by mSendMutex
+        bool mHasPacketsToSend;
 };
 
 #endif // ODSOCKETSERVER_H
@@ -0,0 +1,433 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/ReplayFile.h"
+
+#include "network/LzCodec.h"
+#include "network/ODPacket.h"
+
+#include <algorithm>
+#include <cstring>
+
+//! \brief Beginning of the replay files
+const char REPLAY_MAGIC[] = "ODREPLAY";
+//! \brief End of the replay files, after the offset of the index
+const char REPLAY_INDEX_MAGIC[] = "ODRINDEX";
+const uint32_t REPLAY_MAGIC_SIZE = 8;
+const uint32_t REPLAY_VERSION = 1;
+//! \brief Size of the header (magic + version)
+const uint64_t REPLAY_HEADER_SIZE = REPLAY_MAGIC_SIZE + sizeof(uint32_t);
+//! \brief Size of the footer (index offset + magic)
+const uint64_t REPLAY_FOOTER_SIZE = sizeof(uint64_t) + REPLAY_MAGIC_SIZE;
+
+//! \brief A new chunk is started when the current one has that many turns or is bigger than
+//! REPLAY_CHUNK_MAX_SIZE (checked when a turn starts)
+const uint32_t REPLAY_CHUNK_TURNS = 10;
+const uint32_t REPLAY_CHUNK_MAX_SIZE = 256 * 1024;
+
+namespace
+{
+    // Numbers are written in little endian whatever the platform
+    void appendUInt32(std::vector<uint8_t>& buffer, uint32_t value)
+    {
+        for(uint32_t i = 0; i < 4; ++i)
+            buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void appendUInt64(std::vector<uint8_t>& buffer, uint64_t value)
+    {
+        for(uint32_t i = 0; i < 8; ++i)
+            buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    uint32_t getUInt32(const uint8_t* data)
+    {
+        uint32_t value = 0;
+        for(uint32_t i = 0; i < 4; ++i)
+            value |= static_cast<uint32_t>(data[i]) << (8 * i);
+        return value;
+    }
+
+    uint64_t getUInt64(const uint8_t* data)
+    {
+        uint64_t value = 0;
+        for(uint32_t i = 0; i < 8; ++i)
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+        return value;
+    }
+
+    void writeBuffer(std::ofstream& os, const std::vector<uint8_t>& buffer)
+    {
+        os.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    }
+
+    bool readBuffer(std::ifstream& is, std::vector<uint8_t>& buffer, uint64_t size)
+    {
+        buffer.resize(size);
+        if(size == 0)
+            return true;
+
+        is.read(reinterpret_cast<char*>(buffer.data()), size);
+        return static_cast<uint64_t>(is.gcount()) == size;
+    }
+
+    //! \brief Reads the header of the chunk at the current position. The turns are added to
+    //! turns. Returns false if there is no valid chunk
+    bool readChunkHeader(std::ifstream& is, uint64_t chunkOffset, std::vector<ReplayTurnIndex>& turns,
+        uint32_t& rawSize, uint32_t& storedSize, bool& isCompressed)
+    {
+        std::vector<uint8_t> buffer;
+        if(!readBuffer(is, buffer, sizeof(uint32_t)))
+            return false;
+
+        uint32_t nbTurns = getUInt32(buffer.data());
+        const uint32_t turnSize = sizeof(int64_t) + sizeof(int32_t);
+        if(!readBuffer(is, buffer, static_cast<uint64_t>(nbTurns) * turnSize + 2 * sizeof(uint32_t) + 1))
+            return false;
+
+        const uint8_t* data = buffer.data();
+        for(uint32_t i = 0; i < nbTurns; ++i)
+        {
+            int64_t turn = static_cast<int64_t>(getUInt64(data));
+            int32_t timestamp = static_cast<int32_t>(getUInt32(data + sizeof(int64_t)));
+            turns.push_back(ReplayTurnIndex(turn, timestamp, chunkOffset));
+            data += turnSize;
+        }
+        rawSize = getUInt32(data);
+        storedSize = getUInt32(data + sizeof(uint32_t));
+        isCompressed = data[2 * sizeof(uint32_t)] != 0;
+        return true;
+    }
+}
+
+ReplayWriter::ReplayWriter() :
+    mIsCompressed(true),
+    mLastTimestamp(0)
+{
+}
+
+ReplayWriter::~ReplayWriter()
+{
+    close();
+}
+
+bool ReplayWriter::open(const std::string& filename, bool isCompressed)
+{
+    close();
+    mStream.open(filename, std::ios::out | std::ios::binary);
+    if(!mStream.is_open())
+        return false;
+
+    mIsCompressed = isCompressed;
+    mLastTimestamp = 0;
+    std::vector<uint8_t> header(REPLAY_MAGIC, REPLAY_MAGIC + REPLAY_MAGIC_SIZE);
+    appendUInt32(header, REPLAY_VERSION);
+    writeBuffer(mStream, header);
+    return true;
+}
+
+void ReplayWriter::close()
+{
+    if(!mStream.is_open())
+        return;
+
+    flushChunk();
+
+    uint64_t indexOffset = static_cast<uint64_t>(mStream.tellp());
+    std::vector<uint8_t> index;
+    appendUInt32(index, static_cast<uint32_t>(mTurnIndex.size()));
+    for(const ReplayTurnIndex& entry : mTurnIndex)
+    {
+        appendUInt64(index, static_cast<uint64_t>(entry.mTurn));
+        appendUInt32(index, static_cast<uint32_t>(entry.mTimestamp));
+        appendUInt64(index, entry.mChunkOffset);
+    }
+    appendUInt64(index, indexOffset);
+    index.insert(index.end(), REPLAY_INDEX_MAGIC, REPLAY_INDEX_MAGIC + REPLAY_MAGIC_SIZE);
+    writeBuffer(mStream, index);
+    mStream.close();
+    mTurnIndex.clear();
+}
+
+void ReplayWriter::writePacket(int32_t timestamp, const ODPacket& packet)
+{
+    if(!mStream.is_open())
+        return;
+
+    uint32_t size = packet.getDataSize();
+    appendUInt32(mChunk, static_cast<uint32_t>(timestamp));
+    appendUInt32(mChunk, size);
+    const uint8_t* data = static_cast<const uint8_t*>(packet.mPacket.getData());
+    mChunk.insert(mChunk.end(), data, data + size);
+    mLastTimestamp = timestamp;
+}
+
+void ReplayWriter::notifyTurnStarted(int64_t turn)
+{
+    if(!mStream.is_open())
+        return;
+
+    // The offset will be known when the chunk is written
+    mChunkTurns.push_back(ReplayTurnIndex(turn, mLastTimestamp, 0));
+    if((mChunkTurns.size() >= REPLAY_CHUNK_TURNS) ||
+       (mChunk.size() >= REPLAY_CHUNK_MAX_SIZE))
+    {
+        flushChunk();
+    }
+}
+
+void ReplayWriter::flushChunk()
+{
+    if(mChunk.empty() && mChunkTurns.empty())
+        return;
+
+    uint64_t chunkOffset = static_cast<uint64_t>(mStream.tellp());
+    std::vector<uint8_t> header;
+    appendUInt32(header, static_cast<uint32_t>(mChunkTurns.size()));
+    for(ReplayTurnIndex& entry : mChunkTurns)
+    {
+        entry.mChunkOffset = chunkOffset;
+        appendUInt64(header, static_cast<uint64_t>(entry.mTurn));
+        appendUInt32(header, static_cast<uint32_t>(entry.mTimestamp));
+        mTurnIndex.push_back(entry);
+    }
+    mChunkTurns.clear();
+
+    // Each chunk has its own dictionary so that it can be read without the previous ones. If
+    // compressing does not help, the chunk is stored as it is
+    std::vector<uint8_t> compressed;
+    if(mIsCompressed)
+    {
+        LzEncoder encoder;
+        encoder.compress(mChunk.data(), static_cast<uint32_t>(mChunk.size()), compressed);
+    }
+    bool isCompressed = mIsCompressed && (compressed.size() < mChunk.size());
+    const std::vector<uint8_t>& stored = isCompressed ? compressed : mChunk;
+    appendUInt32(header, static_cast<uint32_t>(mChunk.size()));
+    appendUInt32(header, static_cast<uint32_t>(stored.size()));
+    header.push_back(isCompressed ? 1 : 0);
+    writeBuffer(mStream, header);
+    writeBuffer(mStream, stored);
+    // We flush so that the chunks are not lost if the game crashes
+    mStream.flush();
+    mChunk.clear();
+}
+
+ReplayReader::ReplayReader() :
+    mIsLegacy(false),
+    mChunksBegin(0),
+    mChunksEnd(0),
+    mChunkPosition(0)
+{
+}
+
+bool ReplayReader::open(const std::string& filename)
+{
+    close();
+    mStream.open(filename, std::ios::in | std::ios::binary);
+    if(!mStream.is_open())
+        return false;
+
+    std::vector<uint8_t> header;
+    if(!readBuffer(mStream, header, REPLAY_HEADER_SIZE) ||
+       (std::memcmp(header.data(), REPLAY_MAGIC, REPLAY_MAGIC_SIZE) != 0))
+    {
+        // Replay written with the old format: packets are read one after the other
+        mIsLegacy = true;
+        mStream.clear();
+        mStream.seekg(0);
+        return true;
+    }
+
+    if(getUInt32(header.data() + REPLAY_MAGIC_SIZE) != REPLAY_VERSION)
+        return false;
+
+    mStream.seekg(0, std::ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(mStream.tellg());
+    mChunksBegin = REPLAY_HEADER_SIZE;
+    mChunksEnd = fileSize;
+
+    // We read the index from the end of the file. If it is not there (the game stopped before it
+    // was written), we rebuild it
+    bool isIndexOk = false;
+    std::vector<uint8_t> buffer;
+    if(fileSize >= REPLAY_HEADER_SIZE + REPLAY_FOOTER_SIZE)
+    {
+        mStream.seekg(fileSize - REPLAY_FOOTER_SIZE);
+        if(readBuffer(mStream, buffer, REPLAY_FOOTER_SIZE) &&
+           (std::memcmp(buffer.data() + sizeof(uint64_t), REPLAY_INDEX_MAGIC, REPLAY_MAGIC_SIZE) == 0))
+        {
+            uint64_t indexOffset = getUInt64(buffer.data());
+            const uint64_t entrySize = sizeof(int64_t) + sizeof(int32_t) + sizeof(uint64_t);
+            mStream.seekg(indexOffset);
+            if((indexOffset >= mChunksBegin) &&
+               readBuffer(mStream, buffer, sizeof(uint32_t)))
+            {
+                uint64_t nbEntries = getUInt32(buffer.data());
+                if((indexOffset + sizeof(uint32_t) + nbEntries * entrySize + REPLAY_FOOTER_SIZE == fileSize) &&
+                   readBuffer(mStream, buffer, nbEntries * entrySize))
+                {
+                    const uint8_t* data = buffer.data();
+                    for(uint64_t i = 0; i < nbEntries; ++i)
+                    {
+                        mTurnIndex.push_back(ReplayTurnIndex(static_cast<int64_t>(getUInt64(data)),
+                            static_cast<int32_t>(getUInt32(data + sizeof(int64_t))),
+                            getUInt64(data + sizeof(int64_t) + sizeof(int32_t))));
+                        data += entrySize;
+                    }
+                    mChunksEnd = indexOffset;
+                    isIndexOk = true;
+                }
+            }
+        }
+    }
+
+    mStream.clear();
+    if(!isIndexOk)
+    {
+        mTurnIndex.clear();
+        rebuildTurnIndex();
+    }
+
+    mStream.clear();
+    mStream.seekg(mChunksBegin);
+    return true;
+}
+
+void ReplayReader::close()
+{
+    mStream.close();
+    mStream.clear();
+    mIsLegacy = false;
+    mChunksBegin = 0;
+    mChunksEnd = 0;
+    mChunk.clear();
+    mChunkPosition = 0;
+    mTurnIndex.clear();
+}
+
+void ReplayReader::rebuildTurnIndex()
+{
+    mStream.seekg(mChunksBegin);
+    uint64_t chunkOffset = mChunksBegin;
+    while(true)
+    {
+        std::vector<ReplayTurnIndex> turns;
+        uint32_t rawSize;
+        uint32_t storedSize;
+        bool isCompressed;
+        if(!readChunkHeader(mStream, chunkOffset, turns, rawSize, storedSize, isCompressed))
+            break;
+
+        uint64_t chunkEnd = static_cast<uint64_t>(mStream.tellg()) + storedSize;
+        if(chunkEnd > mChunksEnd)
+            break;
+
+        mTurnIndex.insert(mTurnIndex.end(), turns.begin(), turns.end());
+        mStream.seekg(chunkEnd);
+        chunkOffset = chunkEnd;
+    }
+
+    // The last chunk may have been partially written
+    mChunksEnd = chunkOffset;
+}
+
+bool ReplayReader::readChunk()
+{
+    mChunk.clear();
+    mChunkPosition = 0;
+    uint64_t chunkOffset = static_cast<uint64_t>(mStream.tellg());
+    if(chunkOffset >= mChunksEnd)
+        return false;
+
+    std::vector<ReplayTurnIndex> turns;
+    uint32_t rawSize;
+    uint32_t storedSize;
+    bool isCompressed;
+    if(!readChunkHeader(mStream, chunkOffset, turns, rawSize, storedSize, isCompressed))
+        return false;
+
+    if(!isCompressed)
+        return readBuffer(mStream, mChunk, storedSize) && (storedSize == rawSize);
+
+    std::vector<uint8_t> stored;
+    if(!readBuffer(mStream, stored, storedSize))
+        return false;
+
+    LzDecoder decoder;
+    return decoder.uncompress(stored.data(), storedSize, rawSize, mChunk);
+}
+
+int32_t ReplayReader::readPacket(ODPacket& packet)
+{
+    if(!mStream.is_open())
+        return -1;
+
+    if(mIsLegacy)
+    {
+        if(mStream.eof())
+            return -1;
+
+        return packet.readPacket(mStream);
+    }
+
+    // Some chunks may not have any packet
+    const uint32_t recordHeaderSize = 2 * sizeof(uint32_t);
+    while(mChunkPosition + recordHeaderSize > mChunk.size())
+    {
+        if(!readChunk())
+            return -1;
+    }
+
+    const uint8_t* data = mChunk.data() + mChunkPosition;
+    int32_t timestamp = static_cast<int32_t>(getUInt32(data));
+    uint32_t size = getUInt32(data + sizeof(uint32_t));
+    mChunkPosition += recordHeaderSize;
+    if(mChunkPosition + size > mChunk.size())
+    {
+        mChunk.clear();
+        mChunkPosition = 0;
+        return -1;
+    }
+
+    packet.mPacket.clear();
+    packet.mPacket.append(mChunk.data() + mChunkPosition, size);
+    mChunkPosition += size;
+    return timestamp;
+}
+
+int32_t ReplayReader::getTurnTimestamp(int64_t turn) const
+{
+    if(mTurnIndex.empty())
+        return -1;
+
+    // Turns are consecutive so the entry can usually be found directly
+    int64_t index = turn - mTurnIndex.front().mTurn;
+    if((index >= 0) &&
+       (index < static_cast<int64_t>(mTurnIndex.size())) &&
+       (mTurnIndex[index].mTurn == turn))
+    {
+        return mTurnIndex[index].mTimestamp;
+    }
+
+    auto it = std::lower_bound(mTurnIndex.begin(), mTurnIndex.end(), turn,
+        [](const ReplayTurnIndex& entry, int64_t value) { return entry.mTurn < value; });
+    if((it == mTurnIndex.end()) || (it->mTurn != turn))
+        return -1;
+
+    return it->mTimestamp;
+}
@@ -0,0 +1,127 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef REPLAYFILE_H
+#define REPLAYFILE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class ODPacket;
+
+//! \brief Entry of the replay index
+struct ReplayTurnIndex
+{
+    ReplayTurnIndex(int64_t turn, int32_t timestamp, uint64_t chunkOffset) :
+        mTurn(turn),
+        mTimestamp(timestamp),
+        mChunkOffset(chunkOffset)
+    {}
+
+    int64_t mTurn;
+    //! \brief Time at which the turn started (in ms since the beginning of the replay)
+    int32_t mTimestamp;
+    //! \brief Offset in the file of the chunk holding the packet that started the turn
+    uint64_t mChunkOffset;
+};
+
+/*! \brief Replays are made of the packets received by the client. The file starts with a header
+ * followed by chunks of packets. Each chunk is compressed on its own (see LzCodec) and starts
+ * with the list of the turns started in it. The file ends with the index of every turn so that
+ * it can be used without reading the whole file.
+ * If the game stops before the index is written, it is rebuilt from the chunks when reading.
+ */
+class ReplayWriter
+{
+public:
+    ReplayWriter();
+    ~ReplayWriter();
+
+    //! \brief Creates the given replay file. If isCompressed is false, chunks are stored as they are
+    bool open(const std::string& filename, bool isCompressed = true);
+
+    //! \brief Writes the remaining packets and the index. Called when destroyed if needed
+    void close();
+
+    inline bool isOpen() const
+    { return mStream.is_open(); }
+
+    //! \brief Adds a packet received at the given time
+    void writePacket(int32_t timestamp, const ODPacket& packet);
+
+    //! \brief Tells that the last packet written started the given turn
+    void notifyTurnStarted(int64_t turn);
+
+private:
+    //! \brief Writes the current chunk to the file
+    void flushChunk();
+
+    std::ofstream mStream;
+    bool mIsCompressed;
+
+    //! \brief Packets of the current chunk and the turns started in it
+    std::vector<uint8_t> mChunk;
+    std::vector<ReplayTurnIndex> mChunkTurns;
+    int32_t mLastTimestamp;
+
+    std::vector<ReplayTurnIndex> mTurnIndex;
+};
+
+//! \brief Reads the replays written by ReplayWriter. Replays written before (a sequence of
+//! ODPacket::writePacket records) can still be read but they have no index
+class ReplayReader
+{
+public:
+    ReplayReader();
+
+    //! \brief Opens the given replay and reads its index. Returns false if it cannot be read
+    bool open(const std::string& filename);
+    void close();
+
+    //! \brief Reads the next packet. Returns its timestamp or -1 if there is no more packet
+    int32_t readPacket(ODPacket& packet);
+
+    //! \brief Every turn of the replay, in order. Empty for replays using the old format
+    inline const std::vector<ReplayTurnIndex>& getTurnIndex() const
+    { return mTurnIndex; }
+
+    //! \brief Returns the time at which the given turn started or -1 if it is not in the replay
+    int32_t getTurnTimestamp(int64_t turn) const;
+
+private:
+    //! \brief Reads the chunk at the current position of mStream in mChunk. Returns false if there is none
+    bool readChunk();
+
+    //! \brief Reads the turns of every chunk. Used if the index could not be read
+    void rebuildTurnIndex();
+
+    std::ifstream mStream;
+    //! \brief true if the replay has been written before the chunks were used
+    bool mIsLegacy;
+    //! \brief Offset of the first chunk and of the end of the chunks
+    uint64_t mChunksBegin;
+    uint64_t mChunksEnd;
+
+    std::vector<uint8_t> mChunk;
+    uint32_t mChunkPosition;
+
+    std::vector<ReplayTurnIndex> mTurnIndex;
+};
+
+#endif // REPLAYFILE_H
@@ -17,17 +17,39 @@
 
 #include "network/ServerNotification.h"
 
+#include "game/Player.h"
+#include "game/Seat.h"
 #include "utils/Helper.h"
 #include "utils/LogManager.h"
 
 ServerNotification::ServerNotification(ServerNotificationType type,
     Player* concernedPlayer) :
         mType(type),
-        mConcernedPlayer(concernedPlayer)
+        mConcernedPlayer(concernedPlayer),
+        mIsForPlayerList(false)
 {
     mPacket << type;
 }
 
+ServerNotification::ServerNotification(ServerNotificationType type,
+    const std::vector<Seat*>& seats) :
+        mType(type),
+        mConcernedPlayer(nullptr),
+        mIsForPlayerList(true)
+{
+    for(Seat* seat : seats)
+    {
+        Player* player = seat->getPlayer();
+        if(player == nullptr)
+            continue;
+        if(!player->getIsHuman())
+            continue;
+
+        mConcernedPlayers.push_back(player);
+    }
+    mPacket << type;
+}
+
 std::string ServerNotification::typeString(ServerNotificationType type)
 {
     switch(type)
@@ -114,6 +136,10 @@ std::string ServerNotification::typeString(ServerNotificationType type)
             return "setSpellCooldown";
         case ServerNotificationType::playerEvents:
             return "playerEvents";
+        case ServerNotificationType::batch:
+            return "batch";
+        case ServerNotificationType::compressed:
+            return "compressed";
         case ServerNotificationType::exit:
             return "exit";
         default:
@@ -22,12 +22,14 @@
 
 #include <deque>
 #include <string>
+#include <vector>
 #include <OgreVector3.h>
 
 class Tile;
 class Creature;
 class MovableGameEntity;
 class Player;
+class Seat;
 
 enum class ServerNotificationType
 {
@@ -87,6 +89,9 @@ enum class ServerNotificationType
 
     playerEvents,
 
+    batch, // Several messages sent at once: uint32 number of messages then each message written with ODPacket::appendPacket
+    compressed, // Message compressed by the server (see ODSocketClient::enableCompression): uint32 uncompressed size then the LzCodec data
+
     exit
 };
 
@@ -103,9 +108,20 @@ class ServerNotification
          *         every connected player.
          */
         ServerNotification(ServerNotificationType type, Player* concernedPlayer);
+
+        /*! \brief Creates a message to be sent to the human players of the given seats. The packet is serialized
+         *         once and the same data is sent to all of them. If there is no such player, the message is
+         *         not sent
+         */
+        ServerNotification(ServerNotificationType type, const std::vector<Seat*>& seats);
+
         virtual ~ServerNotification()
         {}
 
+        //! \brief Returns false if the message has been created for a list of seats without human players
+        inline bool hasConcernedPlayers() const
+        { return !mIsForPlayerList || !mConcernedPlayers.empty(); }
+
         ODPacket mPacket;
 
         static std::string typeString(ServerNotificationType type);
@@ -113,6 +129,10 @@ class ServerNotification
     private:
         ServerNotificationType mType;
         Player *mConcernedPlayer;
+        //! \brief true if the message has been created for a list of seats. In that case, it is sent to
+        //! mConcernedPlayers and mConcernedPlayer is not used
+        bool mIsForPlayerList;
+        std::vector<Player*> mConcernedPlayers;
 };
 
 #endif // SERVERNOTIFICATION_H
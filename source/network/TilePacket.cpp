@@ -0,0 +1,284 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "network/TilePacket.h"
+
+#include "network/ODPacket.h"
+
+#include <cassert>
+
+TileMeshNames::TileMeshNames()
+{
+    // Most tiles have no mesh. The empty name is known by both sides from the start
+    mNames.push_back(std::string());
+    mIndexes[std::string()] = 0;
+}
+
+void TileMeshNames::exportToPacket(ODPacket& os, const std::string& meshName, bool isInline)
+{
+    // 0 means the name follows and should not be stored. Otherwise, we send the index + 1. If the client
+    // does not know this index yet, the name follows.
+    // Inline names cannot refer to an index: the packet defining it may still be queued. Only the empty
+    // name, known by both sides from the start, is sent by index
+    if(isInline && !meshName.empty())
+    {
+        TilePacket::exportVarUInt(os, 0);
+        os << meshName;
+        return;
+    }
+
+    auto it = mIndexes.find(meshName);
+    if(it != mIndexes.end())
+    {
+        TilePacket::exportVarUInt(os, it->second + 1);
+        return;
+    }
+
+    uint32_t index = static_cast<uint32_t>(mNames.size());
+    mNames.push_back(meshName);
+    mIndexes[meshName] = index;
+    TilePacket::exportVarUInt(os, index + 1);
+    os << meshName;
+}
+
+bool TileMeshNames::importFromPacket(ODPacket& is, std::string& meshName)
+{
+    uint32_t value;
+    if(!TilePacket::importVarUInt(is, value))
+        return false;
+
+    if(value == 0)
+        return static_cast<bool>(is >> meshName);
+
+    uint32_t index = value - 1;
+    if(index < mNames.size())
+    {
+        meshName = mNames[index];
+        return true;
+    }
+
+    // A new name can only be the next index
+    if(index != mNames.size())
+        return false;
+
+    if(!(is >> meshName))
+        return false;
+
+    mNames.push_back(meshName);
+    return true;
+}
+
+TileRefreshState::TileRefreshState() :
+    mIsSent(false),
+    mIsRoom(false),
+    mIsTrap(false),
+    mRefundPriceRoom(0),
+    mRefundPriceTrap(0),
+    mDisplayTileMesh(true),
+    mColorCustomMesh(false),
+    mHasBridge(false),
+    mSeatId(-1),
+    // TileVisual::nullTileVisual
+    mTileVisual(static_cast<TileVisual>(0))
+{
+}
+
+void TileRefreshState::exportToPacket(ODPacket& os, TileRefreshState& stateSent, bool isFull, TileMeshNames& meshNames) const
+{
+    bool isAllFields = isFull || !stateSent.mIsSent;
+    uint8_t fields = 0;
+    if(isAllFields ||
+       (stateSent.mIsRoom != mIsRoom) ||
+       (stateSent.mIsTrap != mIsTrap) ||
+       (stateSent.mDisplayTileMesh != mDisplayTileMesh) ||
+       (stateSent.mColorCustomMesh != mColorCustomMesh) ||
+       (stateSent.mHasBridge != mHasBridge))
+    {
+        fields |= TileRefreshField::TileRefreshFlags;
+    }
+    if(isAllFields || (stateSent.mRefundPriceRoom != mRefundPriceRoom))
+        fields |= TileRefreshField::TileRefreshRefundPriceRoom;
+    if(isAllFields || (stateSent.mRefundPriceTrap != mRefundPriceTrap))
+        fields |= TileRefreshField::TileRefreshRefundPriceTrap;
+    if(isAllFields || (stateSent.mSeatId != mSeatId))
+        fields |= TileRefreshField::TileRefreshSeatId;
+    if(isAllFields || (stateSent.mMeshName != mMeshName))
+        fields |= TileRefreshField::TileRefreshMeshName;
+    if(isAllFields || (stateSent.mTileVisual != mTileVisual))
+        fields |= TileRefreshField::TileRefreshTileVisual;
+
+    os << fields;
+    if((fields & TileRefreshField::TileRefreshFlags) != 0)
+    {
+        uint8_t flags = 0;
+        if(mIsRoom)
+            flags |= TileRefreshFlag::TileFlagIsRoom;
+        if(mIsTrap)
+            flags |= TileRefreshFlag::TileFlagIsTrap;
+        if(mDisplayTileMesh)
+            flags |= TileRefreshFlag::TileFlagDisplayTileMesh;
+        if(mColorCustomMesh)
+            flags |= TileRefreshFlag::TileFlagColorCustomMesh;
+        if(mHasBridge)
+            flags |= TileRefreshFlag::TileFlagHasBridge;
+        os << flags;
+    }
+    if((fields & TileRefreshField::TileRefreshRefundPriceRoom) != 0)
+        TilePacket::exportVarUInt(os, mRefundPriceRoom);
+    if((fields & TileRefreshField::TileRefreshRefundPriceTrap) != 0)
+        TilePacket::exportVarUInt(os, mRefundPriceTrap);
+    // Seat ids start at -1 (no seat)
+    if((fields & TileRefreshField::TileRefreshSeatId) != 0)
+        TilePacket::exportVarUInt(os, static_cast<uint32_t>(mSeatId + 1));
+    if((fields & TileRefreshField::TileRefreshMeshName) != 0)
+        meshNames.exportToPacket(os, mMeshName, isFull);
+    if((fields & TileRefreshField::TileRefreshTileVisual) != 0)
+    {
+        uint8_t tileVisual = static_cast<uint8_t>(mTileVisual);
+        os << tileVisual;
+    }
+
+    stateSent = *this;
+    stateSent.mIsSent = true;
+}
+
+uint8_t TileRefreshState::importFromPacket(ODPacket& is, TileMeshNames& meshNames)
+{
+    uint8_t fields;
+    if(!(is >> fields))
+        return 0;
+
+    if((fields & TileRefreshField::TileRefreshFlags) != 0)
+    {
+        uint8_t flags = 0;
+        is >> flags;
+        mIsRoom = (flags & TileRefreshFlag::TileFlagIsRoom) != 0;
+        mIsTrap = (flags & TileRefreshFlag::TileFlagIsTrap) != 0;
+        mDisplayTileMesh = (flags & TileRefreshFlag::TileFlagDisplayTileMesh) != 0;
+        mColorCustomMesh = (flags & TileRefreshFlag::TileFlagColorCustomMesh) != 0;
+        mHasBridge = (flags & TileRefreshFlag::TileFlagHasBridge) != 0;
+    }
+    if((fields & TileRefreshField::TileRefreshRefundPriceRoom) != 0)
+        TilePacket::importVarUInt(is, mRefundPriceRoom);
+    if((fields & TileRefreshField::TileRefreshRefundPriceTrap) != 0)
+        TilePacket::importVarUInt(is, mRefundPriceTrap);
+    if((fields & TileRefreshField::TileRefreshSeatId) != 0)
+    {
+        uint32_t seatId = 0;
+        TilePacket::importVarUInt(is, seatId);
+        mSeatId = static_cast<int>(seatId) - 1;
+    }
+    if(((fields & TileRefreshField::TileRefreshMeshName) != 0) &&
+       !meshNames.importFromPacket(is, mMeshName))
+    {
+        return 0;
+    }
+    if((fields & TileRefreshField::TileRefreshTileVisual) != 0)
+    {
+        uint8_t tileVisual = 0;
+        is >> tileVisual;
+        mTileVisual = static_cast<TileVisual>(tileVisual);
+    }
+
+    if(!is)
+        return 0;
+
+    return fields;
+}
+
+namespace TilePacket
+{
+    void exportVarUInt(ODPacket& os, uint32_t value)
+    {
+        while(value >= 0x80)
+        {
+            uint8_t byte = static_cast<uint8_t>((value & 0x7F) | 0x80);
+            os << byte;
+            value >>= 7;
+        }
+        uint8_t byte = static_cast<uint8_t>(value);
+        os << byte;
+    }
+
+    bool importVarUInt(ODPacket& is, uint32_t& value)
+    {
+        value = 0;
+        for(uint32_t shift = 0; shift < 35; shift += 7)
+        {
+            uint8_t byte;
+            if(!(is >> byte))
+                return false;
+
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if((byte & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    void exportTileIndexes(ODPacket& os, const std::vector<uint32_t>& indexes)
+    {
+        // Each run is sent as the gap since the end of the previous run and its length - 1
+        std::vector<std::pair<uint32_t, uint32_t>> runs;
+        for(uint32_t index : indexes)
+        {
+            if(!runs.empty() && (index == runs.back().first + runs.back().second))
+            {
+                ++runs.back().second;
+                continue;
+            }
+
+            // The reader gets one index per written index. Duplicated or unsorted indexes would not be kept
+            assert(runs.empty() || (index > runs.back().first + runs.back().second));
+
+            runs.push_back(std::pair<uint32_t, uint32_t>(index, 1));
+        }
+
+        exportVarUInt(os, static_cast<uint32_t>(runs.size()));
+        uint32_t end = 0;
+        for(const std::pair<uint32_t, uint32_t>& run : runs)
+        {
+            exportVarUInt(os, run.first - end);
+            exportVarUInt(os, run.second - 1);
+            end = run.first + run.second;
+        }
+    }
+
+    bool importTileIndexes(ODPacket& is, std::vector<uint32_t>& indexes)
+    {
+        indexes.clear();
+        uint32_t nbRuns;
+        if(!importVarUInt(is, nbRuns))
+            return false;
+
+        uint32_t end = 0;
+        while(nbRuns > 0)
+        {
+            --nbRuns;
+            uint32_t gap;
+            uint32_t length;
+            if(!importVarUInt(is, gap) || !importVarUInt(is, length))
+                return false;
+
+            uint32_t index = end + gap;
+            end = index + length + 1;
+            for(; index < end; ++index)
+                indexes.push_back(index);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,122 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILEPACKET_H
+#define TILEPACKET_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+class ODPacket;
+
+enum class TileVisual;
+
+//! Fields of a tile refresh. Only the ones that changed since the last refresh sent to the seat
+//! are sent (see TileRefreshState::exportToPacket)
+enum TileRefreshField
+{
+    TileRefreshFlags = 0x01,
+    TileRefreshRefundPriceRoom = 0x02,
+    TileRefreshRefundPriceTrap = 0x04,
+    TileRefreshSeatId = 0x08,
+    TileRefreshMeshName = 0x10,
+    TileRefreshTileVisual = 0x20
+};
+
+//! Boolean fields of a tile refresh. They are sent together in one byte
+enum TileRefreshFlag
+{
+    TileFlagIsRoom = 0x01,
+    TileFlagIsTrap = 0x02,
+    TileFlagDisplayTileMesh = 0x04,
+    TileFlagColorCustomMesh = 0x08,
+    TileFlagHasBridge = 0x10
+};
+
+//! Mesh names of the tiles sent to a player. A name is sent once with its index and then only the
+//! index is sent. The server keeps one for each player and the client one for the local player.
+class TileMeshNames
+{
+public:
+    TileMeshNames();
+
+    //! \brief Writes the given mesh name. If isInline is true, the name is written even if it was already
+    //! sent and it is not added to the known names. That is needed for packets that may reach the client
+    //! before the ones already queued. The empty name is always sent by index as the client knows it from
+    //! the start
+    void exportToPacket(ODPacket& os, const std::string& meshName, bool isInline);
+
+    //! \brief Reads a mesh name written by exportToPacket. Returns false if the packet is invalid
+    bool importFromPacket(ODPacket& is, std::string& meshName);
+
+    inline uint32_t getNbNames() const
+    { return static_cast<uint32_t>(mNames.size()); }
+
+private:
+    std::vector<std::string> mNames;
+    //! \brief Index in mNames of each name. Only used on server side
+    std::map<std::string, uint32_t> mIndexes;
+};
+
+//! Tile data sent to the clients (see Seat::exportTileToPacket). The server keeps the last state sent to
+//! each seat so that only the fields that changed are sent.
+class TileRefreshState
+{
+public:
+    TileRefreshState();
+
+    //! \brief Writes the fields that differ from stateSent (or every field if isFull is true or if stateSent
+    //! was not sent yet) and copies this state to stateSent. Mesh names are written inline if isFull is true
+    void exportToPacket(ODPacket& os, TileRefreshState& stateSent, bool isFull, TileMeshNames& meshNames) const;
+
+    //! \brief Reads the fields written by exportToPacket and returns the TileRefreshField mask of the fields
+    //! read. The other fields are left unchanged
+    uint8_t importFromPacket(ODPacket& is, TileMeshNames& meshNames);
+
+    //! \brief false if no refresh was sent yet or if the next one has to be complete
+    bool mIsSent;
+    bool mIsRoom;
+    bool mIsTrap;
+    uint32_t mRefundPriceRoom;
+    uint32_t mRefundPriceTrap;
+    bool mDisplayTileMesh;
+    bool mColorCustomMesh;
+    bool mHasBridge;
+    int mSeatId;
+    std::string mMeshName;
+    TileVisual mTileVisual;
+};
+
+namespace TilePacket
+{
+    //! \brief Writes value on 1 byte if it is lower than 128 and on up to 5 bytes otherwise
+    void exportVarUInt(ODPacket& os, uint32_t value);
+    bool importVarUInt(ODPacket& is, uint32_t& value);
+
+    //! \brief Writes the given tile indexes (x * mapSizeY + y) as runs of consecutive indexes. Big regions
+    //! like the vision gained at game start only take a few bytes per map row. indexes must be sorted and
+    //! without duplicates
+    void exportTileIndexes(ODPacket& os, const std::vector<uint32_t>& indexes);
+
+    //! \brief Reads the indexes written by exportTileIndexes (after clearing the given vector). Returns
+    //! false if the packet is invalid
+    bool importTileIndexes(ODPacket& is, std::vector<uint32_t>& indexes);
+}
+
+#endif // TILEPACKET_H
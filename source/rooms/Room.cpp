@@ -42,7 +42,12 @@
 
 Room::Room(GameMap* gameMap):
     Building(gameMap),
-    mNumActiveSpots(0)
+    mNumActiveSpots(0),
+    mIsSeatCounted(false),
+    mCountedSeat(nullptr),
+    mIsCountedAlive(false),
+    mCountedGold(0),
+    mCountedGoldMax(0)
 {
 }
 
@@ -130,6 +135,8 @@ void Room::absorbRoom(Room *r)
 
     r->mCoveredTilesDestroyed.insert(r->mCoveredTilesDestroyed.end(), r->mCoveredTiles.begin(), r->mCoveredTiles.end());
     r->mCoveredTiles.clear();
+    updateSeatCounts();
+    r->updateSeatCounts();
 
     // We fire the dead event so that if there are creatures heading for this room or
     // whatever, we release them before the remove from gamemap event
@@ -591,13 +598,10 @@ void Room::restoreInitialEntityState()
         ServerNotification *serverNotification = new ServerNotification(
             ServerNotificationType::refreshTiles, p.first->getPlayer());
         std::vector<Tile*>& tilesRefresh = p.second;
-        uint32_t nbTiles = tilesRefresh.size();
-        serverNotification->mPacket << nbTiles;
-        for(Tile* tile : tilesRefresh)
+        getGameMap()->tilesToPacket(serverNotification->mPacket, tilesRefresh, [&p, serverNotification](Tile* tile)
         {
-            getGameMap()->tileToPacket(serverNotification->mPacket, tile);
             tile->exportToPacketForUpdate(serverNotification->mPacket, p.first);
-        }
+        });
         ODServer::getSingleton().queueServerNotification(serverNotification);
     }
 }
@@ -673,6 +677,7 @@ void Room::repairRoom()
         tile->setCoveringBuilding(this);
     }
 
+    updateSeatCounts();
     updateActiveSpots();
 }
 
@@ -693,18 +698,10 @@ bool Room::sortForMapSave(Room* r1, Room* r2)
 void Room::fireRoomSound(Tile& tile, const std::string& soundFamily)
 {
     std::string sound = "Rooms/" + soundFamily;
-    for(Seat* seat : tile.getSeatsWithVision())
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        ServerNotification *serverNotification = new ServerNotification(
-            ServerNotificationType::playSpatialSound, seat->getPlayer());
-        serverNotification->mPacket << sound << tile.getX() << tile.getY();
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    ServerNotification *serverNotification = new ServerNotification(
+        ServerNotificationType::playSpatialSound, tile.getSeatsWithVision());
+    serverNotification->mPacket << sound << tile.getX() << tile.getY();
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
 bool Room::importRoomFromStream(Room& room, std::istream& is)
@@ -716,3 +713,54 @@ void Room::creatureDropped(Creature& creature)
 {
     creature.pushAction(Utils::make_unique<CreatureActionSearchJob>(creature, true));
 }
+
+void Room::setSeatCounted(bool counted)
+{
+    mIsSeatCounted = counted;
+    updateSeatCounts();
+}
+
+void Room::updateSeatCounts()
+{
+    if(!getIsOnServerMap())
+        return;
+
+    Seat* seat = mIsSeatCounted ? getSeat() : nullptr;
+    bool isAlive = false;
+    int gold = 0;
+    int goldMax = 0;
+    if(seat != nullptr)
+    {
+        isAlive = (getHP(nullptr) > 0.0);
+        gold = getTotalGoldStored();
+        goldMax = getTotalGoldStorage();
+    }
+
+    if((seat == mCountedSeat) && (isAlive == mIsCountedAlive) &&
+       (gold == mCountedGold) && (goldMax == mCountedGoldMax))
+    {
+        return;
+    }
+
+    // We remove what was counted for the previous state and count the new one
+    if(mCountedSeat != nullptr)
+    {
+        if(mIsCountedAlive)
+            mCountedSeat->addNbRooms(getType(), -1);
+
+        mCountedSeat->addGold(-mCountedGold, -mCountedGoldMax);
+    }
+
+    if(seat != nullptr)
+    {
+        if(isAlive)
+            seat->addNbRooms(getType(), 1);
+
+        seat->addGold(gold, goldMax);
+    }
+
+    mCountedSeat = seat;
+    mIsCountedAlive = isAlive;
+    mCountedGold = gold;
+    mCountedGoldMax = goldMax;
+}
@@ -133,6 +133,12 @@ public:
 
     static bool importRoomFromStream(Room& room, std::istream& is);
 
+    //! \brief Called by the GameMap when the room is added (true) or removed (false) from its room list.
+    //! Only rooms in the list are counted in the rooms/gold counts of their seat
+    void setSeatCounted(bool counted);
+
+    virtual void updateSeatCounts() override;
+
 protected:
     static void fireRoomSound(Tile& tile, const std::string& soundFamily);
 
@@ -172,6 +178,14 @@ private :
     void activeSpotCheckChange(ActiveSpotPlace place, const std::vector<Tile*>& originalSpotTiles,
         const std::vector<Tile*>& newSpotTiles);
 
+    //! \brief true if the room is in the GameMap room list. The other members are what was last
+    //! added to the counts of mCountedSeat (nullptr if the room is not counted)
+    bool mIsSeatCounted;
+    Seat* mCountedSeat;
+    bool mIsCountedAlive;
+    int mCountedGold;
+    int mCountedGoldMax;
+
 };
 
 #endif // ROOM_H
@@ -351,6 +351,7 @@ void RoomBridge::claimForSeat(Seat* seat, Tile* tile, double danceRate)
 
     mClaimedValue = static_cast<double>(numCoveredTiles());
     setSeat(seat);
+    updateSeatCounts();
 
     for(Tile* tile : mCoveredTiles)
         tile->claimTile(seat);
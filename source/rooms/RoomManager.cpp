@@ -209,18 +209,15 @@ bool RoomFactory::buildRoomDefault(GameMap* gameMap, Room* room, Seat* seat, con
             }
         }
 
-        for(const std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
+        for(std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
         {
-            uint32_t nbTiles = p.second.size();
             ServerNotification serverNotification(
                 ServerNotificationType::refreshTiles, p.first->getPlayer());
-            serverNotification.mPacket << nbTiles;
-            for(Tile* tile : p.second)
+            gameMap->tilesToPacket(serverNotification.mPacket, p.second, [&p, &serverNotification](Tile* tile)
             {
-                gameMap->tileToPacket(serverNotification.mPacket, tile);
                 p.first->updateTileStateForSeat(tile);
-                tile->exportToPacketForUpdate(serverNotification.mPacket, p.first);
-            }
+                tile->exportToPacketForAsyncUpdate(serverNotification.mPacket, p.first);
+            });
             ODServer::getSingleton().sendAsyncMsg(serverNotification);
         }
     }
@@ -604,18 +601,15 @@ void RoomManager::sellRoomTiles(GameMap* gameMap, Player* player, ODPacket& pack
         }
     }
 
-    for(const std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
+    for(std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
     {
-        uint32_t nbTiles = p.second.size();
         ServerNotification serverNotification(
             ServerNotificationType::refreshTiles, p.first->getPlayer());
-        serverNotification.mPacket << nbTiles;
-        for(Tile* tile : p.second)
+        gameMap->tilesToPacket(serverNotification.mPacket, p.second, [&p, &serverNotification](Tile* tile)
         {
-            gameMap->tileToPacket(serverNotification.mPacket, tile);
             p.first->updateTileStateForSeat(tile);
-            tile->exportToPacketForUpdate(serverNotification.mPacket, p.first);
-        }
+            tile->exportToPacketForAsyncUpdate(serverNotification.mPacket, p.first);
+        });
         ODServer::getSingleton().sendAsyncMsg(serverNotification);
     }
 
@@ -730,18 +724,15 @@ void RoomManager::sellRoomTilesEditor(GameMap* gameMap, ODPacket& packet)
         }
     }
 
-    for(const std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
+    for(std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
     {
-        uint32_t nbTiles = p.second.size();
         ServerNotification serverNotification(
             ServerNotificationType::refreshTiles, p.first->getPlayer());
-        serverNotification.mPacket << nbTiles;
-        for(Tile* tile : p.second)
+        gameMap->tilesToPacket(serverNotification.mPacket, p.second, [&p, &serverNotification](Tile* tile)
         {
-            gameMap->tileToPacket(serverNotification.mPacket, tile);
             p.first->updateTileStateForSeat(tile);
-            tile->exportToPacketForUpdate(serverNotification.mPacket, p.first);
-        }
+            tile->exportToPacketForAsyncUpdate(serverNotification.mPacket, p.first);
+        });
         ODServer::getSingleton().sendAsyncMsg(serverNotification);
     }
 
@@ -146,6 +146,7 @@ void RoomPortal::claimForSeat(Seat* seat, Tile* tile, double danceRate)
 
     mClaimedValue = static_cast<double>(numCoveredTiles());
     setSeat(seat);
+    updateSeatCounts();
 
     for(Tile* tile : mCoveredTiles)
         tile->claimTile(seat);
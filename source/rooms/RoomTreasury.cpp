@@ -163,18 +163,15 @@ class RoomTreasuryFactory : public RoomFactory
                 }
             }
 
-            for(const std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
+            for(std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
             {
-                uint32_t nbTiles = p.second.size();
                 ServerNotification serverNotification(
                     ServerNotificationType::refreshTiles, p.first->getPlayer());
-                serverNotification.mPacket << nbTiles;
-                for(Tile* tile : p.second)
+                gameMap->tilesToPacket(serverNotification.mPacket, p.second, [&p, &serverNotification](Tile* tile)
                 {
-                    gameMap->tileToPacket(serverNotification.mPacket, tile);
                     p.first->updateTileStateForSeat(tile);
-                    tile->exportToPacketForUpdate(serverNotification.mPacket, p.first);
-                }
+                    tile->exportToPacketForAsyncUpdate(serverNotification.mPacket, p.first);
+                });
                 ODServer::getSingleton().sendAsyncMsg(serverNotification);
             }
         }
@@ -344,6 +341,7 @@ int RoomTreasury::depositGold(int gold, Tile *tile)
         return wasDeposited;
 
     mGoldChanged = true;
+    updateSeatCounts();
 
     // Tells the client to play a deposit gold sound. For now, we only send it to the players
     // with vision on tile
@@ -377,6 +375,7 @@ int RoomTreasury::withdrawGold(int gold)
         }
     }
 
+    updateSeatCounts();
     return withdrawlAmount;
 }
 
@@ -38,7 +38,8 @@
 Spell::Spell(GameMap* gameMap, const std::string& baseName, const std::string& meshName, Ogre::Real rotationAngle,
         int32_t nbTurns) :
     RenderedMovableEntity(gameMap, baseName, meshName, rotationAngle, false, 1.0f),
-        mNbTurns(nbTurns)
+        mNbTurns(nbTurns),
+        mVisionGivenSeat(nullptr)
 {
 }
 
@@ -85,11 +86,35 @@ void Spell::removeFromGameMap()
     if(!getIsOnServerMap())
         return;
 
+    setVisionGivenTiles(std::vector<Tile*>());
     fireRemoveEntityToSeatsWithVision();
 
     getGameMap()->removeActiveObject(this);
 }
 
+void Spell::setVisionGivenTiles(const std::vector<Tile*>& tiles)
+{
+    // We give the new vision before removing the old one so that tiles seen by both are not lost
+    std::vector<Tile*> oldTiles;
+    oldTiles.swap(mVisionGivenTiles);
+    Seat* oldSeat = mVisionGivenSeat;
+
+    mVisionGivenSeat = tiles.empty() ? nullptr : getSeat();
+    if(mVisionGivenSeat != nullptr)
+    {
+        for(Tile* tile : tiles)
+            tile->addVision(mVisionGivenSeat);
+
+        mVisionGivenTiles = tiles;
+    }
+
+    if(oldSeat != nullptr)
+    {
+        for(Tile* tile : oldTiles)
+            tile->removeVision(oldSeat);
+    }
+}
+
 void Spell::notifySeatsWithVision(const std::vector<Seat*>& seats)
 {
     // For spells, we want the caster and his allies to always have vision even if they
@@ -186,18 +211,10 @@ std::string Spell::formatCastSpell(SpellType type, uint32_t price)
 void Spell::fireSpellSound(Tile& tile, const std::string& soundFamily)
 {
     std::string sound = "Spells/" + soundFamily;
-    for(Seat* seat : tile.getSeatsWithVision())
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        ServerNotification *serverNotification = new ServerNotification(
-            ServerNotificationType::playSpatialSound, seat->getPlayer());
-        serverNotification->mPacket << sound << tile.getX() << tile.getY();
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    ServerNotification *serverNotification = new ServerNotification(
+        ServerNotificationType::playSpatialSound, tile.getSeatsWithVision());
+    serverNotification->mPacket << sound << tile.getX() << tile.getY();
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
 void Spell::exportHeadersToStream(std::ostream& os) const
@@ -72,10 +72,24 @@ protected:
 
     static std::string formatCastSpell(SpellType type, uint32_t price);
 
+    //! \brief Gives vision on the given tiles to the spell seat (see Tile::addVision) and removes it from
+    //! the tiles vision was given before
+    void setVisionGivenTiles(const std::vector<Tile*>& tiles);
+
+    inline const std::vector<Tile*>& getVisionGivenTiles() const
+    { return mVisionGivenTiles; }
+
+    inline Seat* getVisionGivenSeat() const
+    { return mVisionGivenSeat; }
+
 private:
     //! \brief Number of turns the spell should be displayed before automatic deletion.
     //! If < 0, the Spell will not be removed automatically
     int32_t mNbTurns;
+
+    //! \brief Tiles this spell gives vision on and the seat vision is given to
+    std::vector<Tile*> mVisionGivenTiles;
+    Seat* mVisionGivenSeat;
 };
 
 #endif // SPELL_H
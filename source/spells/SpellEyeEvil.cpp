@@ -90,9 +90,11 @@ void SpellEyeEvil::computeVisibleTiles()
         return;
     }
 
-    std::vector<Tile*> tiles = getGameMap()->circularRegion(posTile->getX(), posTile->getY(), radius);
-    for(Tile* tile : tiles)
-        tile->notifyVision(getSeat());
+    // The eye does not move and sees through walls. We only have to give vision once
+    if((getVisionGivenSeat() == getSeat()) && !getVisionGivenTiles().empty())
+        return;
+
+    setVisionGivenTiles(getGameMap()->circularRegion(posTile->getX(), posTile->getY(), radius));
 }
 
 void SpellEyeEvil::checkSpellCast(GameMap* gameMap, const InputManager& inputManager, InputCommand& inputCommand)
@@ -0,0 +1,246 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LegacyFloodFill.h"
+
+namespace
+{
+// Values from TileType
+const int TILE_DIRT = 1;
+const int TILE_GOLD = 2;
+const int TILE_ROCK = 3;
+const int TILE_WATER = 4;
+const int TILE_LAVA = 5;
+
+// Same order as FloodFillType
+const uint32_t TYPE_GROUND = 0;
+const uint32_t TYPE_GROUND_WATER = 1;
+const uint32_t TYPE_GROUND_LAVA = 2;
+const uint32_t TYPE_GROUND_WATER_LAVA = 3;
+
+bool isGround(const LevelTile& tile)
+{
+    return (tile.mType == TILE_DIRT) || (tile.mType == TILE_GOLD) || (tile.mType == TILE_ROCK);
+}
+}
+
+const uint32_t LegacyFloodFill::NB_TYPES;
+
+void computePassables(const Level& level, std::vector<std::vector<uint8_t>>& passables)
+{
+    passables.assign(LegacyFloodFill::NB_TYPES, std::vector<uint8_t>(level.mTiles.size(), 0));
+    for(uint32_t index = 0; index < level.mTiles.size(); ++index)
+    {
+        const LevelTile& tile = level.mTiles[index];
+        if(tile.mIsFull)
+            continue;
+
+        switch(tile.mType)
+        {
+            case TILE_DIRT:
+            case TILE_GOLD:
+            case TILE_ROCK:
+                for(uint32_t type = 0; type < LegacyFloodFill::NB_TYPES; ++type)
+                    passables[type][index] = 1;
+                break;
+            case TILE_WATER:
+                passables[TYPE_GROUND_WATER][index] = 1;
+                passables[TYPE_GROUND_WATER_LAVA][index] = 1;
+                break;
+            case TILE_LAVA:
+                passables[TYPE_GROUND_LAVA][index] = 1;
+                passables[TYPE_GROUND_WATER_LAVA][index] = 1;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+LegacyFloodFill::LegacyFloodFill(const Level& level) :
+    mLevel(level),
+    mColors(level.mTiles.size() * NB_TYPES, 0),
+    mNextColor(0)
+{
+}
+
+void LegacyFloodFill::run()
+{
+    const int sizeX = mLevel.mSizeX;
+    const int sizeY = mLevel.mSizeY;
+    uint32_t currentType = TYPE_GROUND;
+    while(true)
+    {
+        int yy = 0;
+        bool isTileFound = false;
+        while(!isTileFound && (yy < sizeY))
+        {
+            for(int xx = 0; xx < sizeX; ++xx)
+            {
+                uint32_t index = getIndex(xx, yy);
+                const LevelTile& tile = mLevel.mTiles[index];
+                if(tile.mIsFull)
+                    continue;
+
+                if(currentType == TYPE_GROUND)
+                {
+                    if(isGround(tile) && (getColor(index, TYPE_GROUND) == 0))
+                    {
+                        isTileFound = true;
+                        for(uint32_t type = 0; type < NB_TYPES; ++type)
+                            setNewColorIfNone(index, type);
+                        break;
+                    }
+                }
+                else if(currentType == TYPE_GROUND_WATER)
+                {
+                    if((tile.mType == TILE_WATER) && (getColor(index, TYPE_GROUND_WATER) == 0))
+                    {
+                        isTileFound = true;
+                        setNewColorIfNone(index, TYPE_GROUND_WATER);
+                        setNewColorIfNone(index, TYPE_GROUND_WATER_LAVA);
+                        break;
+                    }
+                }
+                else if(currentType == TYPE_GROUND_LAVA)
+                {
+                    if((tile.mType == TILE_LAVA) && (getColor(index, TYPE_GROUND_LAVA) == 0))
+                    {
+                        isTileFound = true;
+                        setNewColorIfNone(index, TYPE_GROUND_LAVA);
+                        setNewColorIfNone(index, TYPE_GROUND_WATER_LAVA);
+                        break;
+                    }
+                }
+            }
+
+            if(!isTileFound)
+                ++yy;
+        }
+
+        if(!isTileFound)
+        {
+            if(currentType == TYPE_GROUND_LAVA)
+                break;
+
+            currentType = (currentType == TYPE_GROUND) ? TYPE_GROUND_WATER : TYPE_GROUND_LAVA;
+            continue;
+        }
+
+        while(yy < sizeY)
+        {
+            int nbTiles = 0;
+            for(int xx = 0; xx < sizeX; ++xx)
+            {
+                if(doFloodFill(xx, yy))
+                    ++nbTiles;
+            }
+
+            if(nbTiles > 0)
+            {
+                for(int xx = sizeX - 1; xx >= 0; --xx)
+                {
+                    if(doFloodFill(xx, yy))
+                        ++nbTiles;
+                }
+            }
+
+            if((nbTiles > 0) && (yy > 0))
+                --yy;
+            else
+                ++yy;
+        }
+    }
+}
+
+void LegacyFloodFill::setNewColorIfNone(uint32_t index, uint32_t type)
+{
+    if(getColor(index, type) == 0)
+        mColors[index * NB_TYPES + type] = ++mNextColor;
+}
+
+bool LegacyFloodFill::isFilled(uint32_t index) const
+{
+    const LevelTile& tile = mLevel.mTiles[index];
+    if(tile.mIsFull)
+        return true;
+
+    if(isGround(tile))
+    {
+        for(uint32_t type = 0; type < NB_TYPES; ++type)
+        {
+            if(getColor(index, type) == 0)
+                return false;
+        }
+        return true;
+    }
+    if(tile.mType == TILE_WATER)
+        return (getColor(index, TYPE_GROUND_WATER) != 0) && (getColor(index, TYPE_GROUND_WATER_LAVA) != 0);
+    if(tile.mType == TILE_LAVA)
+        return (getColor(index, TYPE_GROUND_LAVA) != 0) && (getColor(index, TYPE_GROUND_WATER_LAVA) != 0);
+
+    return true;
+}
+
+bool LegacyFloodFill::updateFromTile(uint32_t index, uint32_t type, uint32_t neighIndex)
+{
+    if((getColor(index, type) != 0) || (getColor(neighIndex, type) == 0))
+        return false;
+
+    mColors[index * NB_TYPES + type] = getColor(neighIndex, type);
+    return true;
+}
+
+bool LegacyFloodFill::doFloodFill(int x, int y)
+{
+    uint32_t index = getIndex(x, y);
+    if(isFilled(index))
+        return false;
+
+    bool hasChanged = false;
+    const int neighbours[4][2] = {{-1, 0}, {0, -1}, {1, 0}, {0, 1}};
+    for(const int* neighbour : neighbours)
+    {
+        int neighX = x + neighbour[0];
+        int neighY = y + neighbour[1];
+        if((neighX < 0) || (neighX >= mLevel.mSizeX) || (neighY < 0) || (neighY >= mLevel.mSizeY))
+            continue;
+
+        uint32_t neighIndex = getIndex(neighX, neighY);
+        const LevelTile& tile = mLevel.mTiles[index];
+        if(isGround(tile))
+        {
+            for(uint32_t type = 0; type < NB_TYPES; ++type)
+                hasChanged |= updateFromTile(index, type, neighIndex);
+        }
+        else if(tile.mType == TILE_WATER)
+        {
+            hasChanged |= updateFromTile(index, TYPE_GROUND_WATER, neighIndex);
+            hasChanged |= updateFromTile(index, TYPE_GROUND_WATER_LAVA, neighIndex);
+        }
+        else if(tile.mType == TILE_LAVA)
+        {
+            hasChanged |= updateFromTile(index, TYPE_GROUND_LAVA, neighIndex);
+            hasChanged |= updateFromTile(index, TYPE_GROUND_WATER_LAVA, neighIndex);
+        }
+
+        if(isFilled(index))
+            return true;
+    }
+
+    return hasChanged;
+}
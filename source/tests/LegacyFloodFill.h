@@ -0,0 +1,66 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LEGACYFLOODFILL_H
+#define LEGACYFLOODFILL_H
+
+#include "LevelTiles.h"
+
+#include <cstdint>
+#include <vector>
+
+/*! \brief Builds the passability grids for each floodfill type like GameMap::enableFloodFill.
+ * passables[type][index] is 1 if the tile can be walked for the given type
+ */
+void computePassables(const Level& level, std::vector<std::vector<uint8_t>>& passables);
+
+/*! \brief Former GameMap::enableFloodFill algorithm (seeds found by scanning rows from the top and
+ * propagation by sweeping rows back and forth) applied on a level. Used as reference for the labelling
+ * by test_FloodFill and the benchmark.
+ * colors[index * NB_TYPES + type] is the color of the tile for the given type (0 if none).
+ */
+class LegacyFloodFill
+{
+public:
+    //! \brief Number of floodfill types, in the same order as FloodFillType
+    static const uint32_t NB_TYPES = 4;
+
+    explicit LegacyFloodFill(const Level& level);
+
+    const std::vector<uint32_t>& getColors() const
+    { return mColors; }
+
+    void run();
+
+private:
+    const Level& mLevel;
+    std::vector<uint32_t> mColors;
+    uint32_t mNextColor;
+
+    uint32_t getIndex(int x, int y) const
+    { return static_cast<uint32_t>(x * mLevel.mSizeY + y); }
+
+    uint32_t getColor(uint32_t index, uint32_t type) const
+    { return mColors[index * NB_TYPES + type]; }
+
+    void setNewColorIfNone(uint32_t index, uint32_t type);
+    bool isFilled(uint32_t index) const;
+    bool updateFromTile(uint32_t index, uint32_t type, uint32_t neighIndex);
+    bool doFloodFill(int x, int y);
+};
+
+#endif // LEGACYFLOODFILL_H
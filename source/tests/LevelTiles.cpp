@@ -0,0 +1,91 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LevelTiles.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#ifndef OD_LEVELS_DIR
+#define OD_LEVELS_DIR "levels"
+#endif
+
+namespace
+{
+// Values from TileType
+const int TILE_DIRT = 1;
+const int TILE_WATER = 4;
+const int TILE_LAVA = 5;
+}
+
+bool loadLevelTiles(const std::string& levelName, Level& level)
+{
+    std::ifstream file(std::string(OD_LEVELS_DIR) + "/" + levelName);
+    if(!file.good())
+        return false;
+
+    std::string line;
+    while(std::getline(file, line))
+    {
+        if(line.compare(0, 7, "[Tiles]") == 0)
+            break;
+    }
+
+    std::vector<int> sizes;
+    while((sizes.size() < 2) && std::getline(file, line))
+    {
+        if(line.empty() || (line[0] == '#'))
+            continue;
+
+        sizes.push_back(std::atoi(line.c_str()));
+    }
+    if(sizes.size() < 2)
+        return false;
+
+    level.mSizeX = sizes[0];
+    level.mSizeY = sizes[1];
+    level.mTiles.assign(static_cast<uint32_t>(level.mSizeX * level.mSizeY), LevelTile{TILE_DIRT, true, -1});
+    while(std::getline(file, line))
+    {
+        if(line.compare(0, 8, "[/Tiles]") == 0)
+            return true;
+
+        if(line.empty() || (line[0] == '#'))
+            continue;
+
+        std::istringstream ss(line);
+        int x;
+        int y;
+        int type;
+        double fullness;
+        if(!(ss >> x >> y >> type >> fullness))
+            continue;
+
+        if((x < 0) || (x >= level.mSizeX) || (y < 0) || (y >= level.mSizeY))
+            continue;
+
+        int seatId = -1;
+        ss >> seatId;
+        // Like in Tile::loadFromLine, fullness is ignored for water and lava
+        bool isFull = (fullness > 0.0) && (type != TILE_WATER) && (type != TILE_LAVA);
+        level.mTiles[static_cast<uint32_t>(x * level.mSizeY + y)] = LevelTile{type, isFull, seatId};
+    }
+
+    return false;
+}
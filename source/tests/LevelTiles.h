@@ -0,0 +1,47 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LEVELTILES_H
+#define LEVELTILES_H
+
+#include <string>
+#include <vector>
+
+//! \brief Tile read from a level file by loadLevelTiles. mType is a TileType value
+struct LevelTile
+{
+    int mType;
+    bool mIsFull;
+    int mSeatId;
+};
+
+//! \brief Tiles of a level file. Used by the tests working on the shipped levels without a GameMap
+struct Level
+{
+    int mSizeX;
+    int mSizeY;
+    //! Tiles indexed by x * mSizeY + y
+    std::vector<LevelTile> mTiles;
+};
+
+/*! \brief Reads the tiles of the given level (path relative to the levels directory, given by the
+ * OD_LEVELS_DIR define). Tiles not in the file are full dirt like in MapHandler. Returns false if
+ * the file cannot be read
+ */
+bool loadLevelTiles(const std::string& levelName, Level& level);
+
+#endif // LEVELTILES_H
@@ -0,0 +1,54 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAMEDENTITY_H
+#define NAMEDENTITY_H
+
+#include <string>
+#include <vector>
+
+//! \brief Smallest entity that can be stored in an EntityNameIndex
+class NamedEntity
+{
+public:
+    NamedEntity(const std::string& name) :
+        mName(name)
+    {}
+
+    inline const std::string& getName() const
+    { return mName; }
+
+    inline void setName(const std::string& name)
+    { mName = name; }
+
+private:
+    std::string mName;
+};
+
+//! \brief Lookup by name as GameMap did before the indexes. Used as reference by test_EntityNameIndex
+//! and the benchmark
+inline NamedEntity* findLinear(const std::vector<NamedEntity*>& entities, const std::string& name)
+{
+    for(NamedEntity* entity : entities)
+    {
+        if(entity->getName().compare(name) == 0)
+            return entity;
+    }
+    return nullptr;
+}
+
+#endif // NAMEDENTITY_H
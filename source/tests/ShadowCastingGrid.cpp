@@ -0,0 +1,112 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ShadowCastingGrid.h"
+
+std::vector<const Cell*> legacyVisibleCells(const ShadowCastingTable& table, const Grid& grid, int x, int y, int radius)
+{
+    struct LegacyProcess
+    {
+        const ShadowCastingTable::Entry& mEntry;
+        const Cell* mCell;
+        double mHiddenNorth;
+        double mHiddenSouth;
+    };
+
+    std::vector<const Cell*> returnList;
+    int radiusSquared = radius * radius;
+    std::vector<LegacyProcess> tilesProcess[8];
+    for(uint32_t k = 0; k < 8; ++k)
+    {
+        for(const ShadowCastingTable::Entry& entry : table.getEntries())
+        {
+            if(entry.mDistSquared > radiusSquared)
+                break;
+
+            const Cell* cell = nullptr;
+            switch(k)
+            {
+                case 0: cell = grid.getCell(x + entry.mDiffX, y + entry.mDiffY); break;
+                case 1: cell = grid.getCell(x + entry.mDiffY, y - entry.mDiffX); break;
+                case 2: cell = grid.getCell(x - entry.mDiffX, y - entry.mDiffY); break;
+                case 3: cell = grid.getCell(x - entry.mDiffY, y + entry.mDiffX); break;
+                case 4: cell = grid.getCell(x + entry.mDiffY, y + entry.mDiffX); break;
+                case 5: cell = grid.getCell(x + entry.mDiffX, y - entry.mDiffY); break;
+                case 6: cell = grid.getCell(x - entry.mDiffY, y - entry.mDiffX); break;
+                case 7: cell = grid.getCell(x - entry.mDiffX, y + entry.mDiffY); break;
+                default: break;
+            }
+            tilesProcess[k].push_back({entry, cell, 0.0, 0.0});
+        }
+    }
+
+    const std::vector<ShadowCastingTable::HiddenTile>& hiddenTiles = table.getHiddenTiles();
+    for(uint32_t k = 0; k < 8; ++k)
+    {
+        for(LegacyProcess& process : tilesProcess[k])
+        {
+            if((process.mCell == nullptr) || !process.mCell->mIsOpaque)
+                continue;
+
+            for(uint32_t h = process.mEntry.mHiddenNorthBegin; h < process.mEntry.mHiddenNorthEnd; ++h)
+            {
+                if(hiddenTiles[h].mIndex >= tilesProcess[k].size())
+                    continue;
+                LegacyProcess& hidden = tilesProcess[k][hiddenTiles[h].mIndex];
+                if(hiddenTiles[h].mHiddenValue > hidden.mHiddenNorth)
+                    hidden.mHiddenNorth = hiddenTiles[h].mHiddenValue;
+            }
+            for(uint32_t h = process.mEntry.mHiddenSouthBegin; h < process.mEntry.mHiddenSouthEnd; ++h)
+            {
+                if(hiddenTiles[h].mIndex >= tilesProcess[k].size())
+                    continue;
+                LegacyProcess& hidden = tilesProcess[k][hiddenTiles[h].mIndex];
+                if(hiddenTiles[h].mHiddenValue > hidden.mHiddenSouth)
+                    hidden.mHiddenSouth = hiddenTiles[h].mHiddenValue;
+            }
+        }
+    }
+
+    for(uint32_t i = 0; i < tilesProcess[0].size(); ++i)
+    {
+        for(uint32_t k = 0; k < 8; ++k)
+        {
+            LegacyProcess& process = tilesProcess[k][i];
+            if(process.mCell == nullptr)
+                continue;
+            if((k > 0) && (process.mEntry.mDistSquared == 0))
+                continue;
+            if((k > 3) && (process.mEntry.mType != ShadowCastingTable::EntryType::Other))
+                continue;
+
+            if(process.mEntry.mType == ShadowCastingTable::EntryType::Diagonal)
+            {
+                LegacyProcess& process2 = tilesProcess[k + 4][i];
+                if(process2.mHiddenSouth > process.mHiddenNorth)
+                    process.mHiddenNorth = process2.mHiddenSouth;
+                if(process2.mHiddenNorth > process.mHiddenSouth)
+                    process.mHiddenSouth = process2.mHiddenNorth;
+            }
+
+            if((process.mHiddenNorth + process.mHiddenSouth) > 0.5)
+                continue;
+
+            returnList.push_back(process.mCell);
+        }
+    }
+    return returnList;
+}
@@ -0,0 +1,82 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHADOWCASTINGGRID_H
+#define SHADOWCASTINGGRID_H
+
+#include "gamemap/ShadowCastingTable.h"
+
+#include <cstdint>
+#include <vector>
+
+//! \brief Cell of Grid. Opaque cells hide the ones behind them
+struct Cell
+{
+    int mX;
+    int mY;
+    bool mIsOpaque;
+};
+
+//! \brief Grid where the cells are indexed by x * mSizeY + y. Used instead of a GameMap to test
+//! ShadowCastingTable
+class Grid
+{
+public:
+    Grid(int sizeX, int sizeY) :
+        mSizeX(sizeX),
+        mSizeY(sizeY)
+    {
+        for(int x = 0; x < sizeX; ++x)
+        {
+            for(int y = 0; y < sizeY; ++y)
+                mCells.push_back({x, y, false});
+        }
+    }
+
+    const Cell* getCell(int x, int y) const
+    {
+        if((x < 0) || (y < 0) || (x >= mSizeX) || (y >= mSizeY))
+            return nullptr;
+
+        return &mCells[static_cast<uint32_t>(x * mSizeY + y)];
+    }
+
+    void setOpaque(int x, int y)
+    {
+        mCells[static_cast<uint32_t>(x * mSizeY + y)].mIsOpaque = true;
+    }
+
+    void visibleCells(const ShadowCastingTable& table, int x, int y, int radius, std::vector<const Cell*>& cells,
+        std::vector<ShadowCastingTable::ProcessState<const Cell*>>& states) const
+    {
+        table.computeVisible(radius,
+            [this, x, y](int diffX, int diffY) { return getCell(x + diffX, y + diffY); },
+            [](const Cell* cell) { return cell->mIsOpaque; },
+            cells, states);
+    }
+
+    int mSizeX;
+    int mSizeY;
+    std::vector<Cell> mCells;
+};
+
+/*! \brief The way TileContainer::visibleTiles used to work: 8 vectors allocated at each call. Used as
+ * reference by test_ShadowCasting and the benchmark
+ */
+std::vector<const Cell*> legacyVisibleCells(const ShadowCastingTable& table, const Grid& grid, int x, int y, int radius);
+
+#endif // SHADOWCASTINGGRID_H
@@ -0,0 +1,79 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmark.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+
+double measureMs(const std::function<void()>& function, uint32_t nbRuns)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(uint32_t run = 0; run < nbRuns; ++run)
+        function();
+
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    return duration.count() / static_cast<double>(nbRuns);
+}
+
+void printTimings(const std::string& caseName, const std::vector<std::pair<std::string, double>>& timings)
+{
+    std::cout << caseName << ":";
+    for(const std::pair<std::string, double>& timing : timings)
+        std::cout << " " << timing.first << "=" << timing.second << "ms";
+
+    std::cout << std::endl;
+}
+
+//! \brief Compares the speed of the algorithms used now with the former ones. The results depend on the
+//! machine, so this is not one of the unit tests (which check that both give the same results). Build in
+//! release and give the names of the benchmarks to run, or nothing to run them all
+int main(int argc, char** argv)
+{
+    const std::map<std::string, std::function<void()>> benchmarks = {
+        { "entitynameindex", benchmarkEntityNameIndex },
+        { "entityslotlist", benchmarkEntitySlotList },
+        { "floodfill", benchmarkFloodFill },
+        { "shadowcasting", benchmarkShadowCasting }
+    };
+
+    std::vector<std::string> names;
+    for(int i = 1; i < argc; ++i)
+        names.push_back(argv[i]);
+
+    if(names.empty())
+    {
+        for(const std::pair<const std::string, std::function<void()>>& benchmark : benchmarks)
+            names.push_back(benchmark.first);
+    }
+
+    for(const std::string& name : names)
+    {
+        auto it = benchmarks.find(name);
+        if(it == benchmarks.end())
+        {
+            std::cerr << "Unknown benchmark " << name << std::endl;
+            return 1;
+        }
+
+        std::cout << "== " << name << std::endl;
+        it->second();
+    }
+
+    return 0;
+}
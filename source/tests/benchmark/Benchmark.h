@@ -0,0 +1,45 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+//! \brief Calls the given function nbRuns times and returns the mean duration of a call in milliseconds
+double measureMs(const std::function<void()>& function, uint32_t nbRuns);
+
+//! \brief Prints the timings (name and duration in milliseconds) measured for the given case
+void printTimings(const std::string& caseName, const std::vector<std::pair<std::string, double>>& timings);
+
+//! \brief Compares the former initial floodfill with the labelling on the biggest shipped levels
+void benchmarkFloodFill();
+
+//! \brief Compares the former visibleTiles, allocating its vectors at each call, with the buffered one
+void benchmarkShadowCasting();
+
+//! \brief Compares the lookup of entities by name in a list with EntityNameIndex
+void benchmarkEntityNameIndex();
+
+//! \brief Compares removing and adding entities in a vector (find + erase) with EntitySlotList
+void benchmarkEntitySlotList();
+
+#endif // BENCHMARK_H
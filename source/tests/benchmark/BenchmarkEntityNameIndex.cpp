@@ -0,0 +1,78 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmark.h"
+
+#include "tests/NamedEntity.h"
+
+#include "gamemap/EntityNameIndex.h"
+
+#include <memory>
+
+void benchmarkEntityNameIndex()
+{
+    // 2000 entities named like the creatures. Every entity is looked for a few times, like when each one
+    // is refreshed by a network message
+    const uint32_t nbEntities = 2000;
+    const uint32_t nbRounds = 5;
+    std::vector<std::unique_ptr<NamedEntity>> entities;
+    std::vector<NamedEntity*> list;
+    EntityNameIndex<NamedEntity> index;
+    for(uint32_t i = 0; i < nbEntities; ++i)
+    {
+        entities.push_back(std::unique_ptr<NamedEntity>(new NamedEntity("Creature" + std::to_string(i))));
+        list.push_back(entities.back().get());
+        index.add(entities.back().get());
+    }
+
+    std::vector<std::string> names;
+    for(uint32_t round = 0; round < nbRounds; ++round)
+    {
+        for(uint32_t i = 0; i < nbEntities; ++i)
+            names.push_back("Creature" + std::to_string((i * 7919) % nbEntities));
+    }
+    // Names not found go through the whole list
+    names.push_back("Unknown");
+
+    // The number of entities found is printed so that the lookups are not optimized away
+    const uint32_t nbRuns = 5;
+    uint32_t nbFoundLinear = 0;
+    double linearMs = measureMs([&list, &names, &nbFoundLinear]()
+    {
+        for(const std::string& name : names)
+        {
+            if(findLinear(list, name) != nullptr)
+                ++nbFoundLinear;
+        }
+    }, nbRuns);
+
+    uint32_t nbFoundIndex = 0;
+    double indexMs = measureMs([&index, &names, &nbFoundIndex]()
+    {
+        for(const std::string& name : names)
+        {
+            if(index.find(name) != nullptr)
+                ++nbFoundIndex;
+        }
+    }, nbRuns);
+
+    printTimings("lookups by name entities=" + std::to_string(nbEntities) + " lookups=" + std::to_string(names.size())
+        + " found=" + std::to_string(nbFoundLinear / nbRuns) + "/" + std::to_string(nbFoundIndex / nbRuns), {
+        { "linear", linearMs },
+        { "indexed", indexMs }
+    });
+}
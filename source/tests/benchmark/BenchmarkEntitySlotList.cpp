@@ -0,0 +1,81 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmark.h"
+
+#include "gamemap/EntitySlotList.h"
+
+#include <algorithm>
+
+namespace
+{
+struct Entity
+{
+    uint32_t mId;
+};
+}
+
+void benchmarkEntitySlotList()
+{
+    // Many entities are removed then added again in the same turns, like the active objects during
+    // a big fight
+    const uint32_t nbEntities = 5000;
+    const uint32_t nbTurns = 20;
+    const uint32_t nbChangesPerTurn = 1000;
+    std::vector<Entity> entities(nbEntities);
+    std::vector<Entity*> vect;
+    EntitySlotList<Entity> list;
+    for(uint32_t i = 0; i < nbEntities; ++i)
+    {
+        entities[i].mId = i;
+        vect.push_back(&entities[i]);
+        list.add(&entities[i]);
+    }
+
+    double vectorMs = measureMs([&entities, &vect]()
+    {
+        for(uint32_t turn = 0; turn < nbTurns; ++turn)
+        {
+            for(uint32_t i = 0; i < nbChangesPerTurn; ++i)
+            {
+                Entity* entity = &entities[(turn * 7919 + i * 13) % nbEntities];
+                vect.erase(std::find(vect.begin(), vect.end(), entity));
+            }
+            for(uint32_t i = 0; i < nbChangesPerTurn; ++i)
+                vect.push_back(&entities[(turn * 7919 + i * 13) % nbEntities]);
+        }
+    }, 1);
+
+    double listMs = measureMs([&entities, &list]()
+    {
+        for(uint32_t turn = 0; turn < nbTurns; ++turn)
+        {
+            for(uint32_t i = 0; i < nbChangesPerTurn; ++i)
+                list.remove(&entities[(turn * 7919 + i * 13) % nbEntities]);
+            list.compact();
+            for(uint32_t i = 0; i < nbChangesPerTurn; ++i)
+                list.add(&entities[(turn * 7919 + i * 13) % nbEntities]);
+        }
+    }, 1);
+
+    printTimings("active objects entities=" + std::to_string(nbEntities) + " changes="
+        + std::to_string(nbTurns * nbChangesPerTurn) + " size=" + std::to_string(vect.size()) + "/"
+        + std::to_string(list.size()), {
+        { "vector", vectorMs },
+        { "slotList", listMs }
+    });
+}
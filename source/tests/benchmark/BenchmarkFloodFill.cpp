@@ -0,0 +1,104 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmark.h"
+
+#include "tests/LegacyFloodFill.h"
+#include "tests/LevelTiles.h"
+
+#include "gamemap/FloodFillLabeling.h"
+
+#include <iostream>
+#include <map>
+
+void benchmarkFloodFill()
+{
+    const std::vector<std::string> levels = {
+        "multiplayer/TestBigMap.level",
+        "skirmish/TestLegacy.level",
+        "skirmish/StoneKeep.level",
+        "multiplayer/Angel.level",
+        "skirmish/DuelToDeath.level"
+    };
+    const uint32_t nbRuns = 5;
+
+    for(const std::string& levelName : levels)
+    {
+        Level level;
+        if(!loadLevelTiles(levelName, level))
+        {
+            std::cerr << "Cannot load level " << levelName << std::endl;
+            continue;
+        }
+
+        std::vector<std::vector<uint8_t>> passables;
+        computePassables(level, passables);
+
+        std::vector<uint32_t> legacyColors;
+        double legacyMs = measureMs([&level, &legacyColors]()
+        {
+            LegacyFloodFill legacy(level);
+            legacy.run();
+            legacyColors = legacy.getColors();
+        }, nbRuns);
+
+        std::vector<std::vector<uint32_t>> labels(LegacyFloodFill::NB_TYPES);
+        double sequentialMs = measureMs([&level, &passables, &labels]()
+        {
+            for(uint32_t type = 0; type < LegacyFloodFill::NB_TYPES; ++type)
+                FloodFillLabeling::labelConnectedTiles(level.mSizeX, level.mSizeY, passables[type], labels[type]);
+        }, nbRuns);
+
+        std::vector<std::vector<uint32_t>> labelsParallel;
+        std::vector<uint32_t> nbLabels;
+        double parallelMs = measureMs([&level, &passables, &labelsParallel, &nbLabels]()
+        {
+            FloodFillLabeling::labelConnectedTilesParallel(level.mSizeX, level.mSizeY, passables,
+                labelsParallel, nbLabels);
+        }, nbRuns);
+
+        // The former algorithm could give 2 colors to the same area if it was reached from 2 seeds. We count
+        // these areas (test_FloodFill checks that the colors never merge 2 areas)
+        uint32_t nbAreasSplit = 0;
+        for(uint32_t type = 0; type < LegacyFloodFill::NB_TYPES; ++type)
+        {
+            std::map<uint32_t, uint32_t> labelToLegacy;
+            std::vector<bool> isLabelSplit(nbLabels[type] + 1, false);
+            for(uint32_t index = 0; index < level.mTiles.size(); ++index)
+            {
+                uint32_t label = labels[type][index];
+                if(label == 0)
+                    continue;
+
+                uint32_t legacyColor = legacyColors[index * LegacyFloodFill::NB_TYPES + type];
+                auto itLabel = labelToLegacy.emplace(label, legacyColor).first;
+                if((itLabel->second != legacyColor) && !isLabelSplit[label])
+                {
+                    isLabelSplit[label] = true;
+                    ++nbAreasSplit;
+                }
+            }
+        }
+
+        printTimings(levelName + " (" + std::to_string(level.mSizeX) + "x" + std::to_string(level.mSizeY) + ")", {
+            { "former floodfill", legacyMs },
+            { "labelling", sequentialMs },
+            { "parallel labelling", parallelMs }
+        });
+        std::cout << "    areas split by the former floodfill: " << nbAreasSplit << std::endl;
+    }
+}
@@ -0,0 +1,67 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Benchmark.h"
+
+#include "tests/ShadowCastingGrid.h"
+
+#include <cstdlib>
+
+void benchmarkShadowCasting()
+{
+    // Random map where a tile out of 4 is opaque
+    const int sizeX = 100;
+    const int sizeY = 100;
+    const int radius = 15;
+    Grid grid(sizeX, sizeY);
+    std::srand(42);
+    for(int x = 0; x < sizeX; ++x)
+    {
+        for(int y = 0; y < sizeY; ++y)
+        {
+            if((std::rand() % 4) == 0)
+                grid.setOpaque(x, y);
+        }
+    }
+
+    ShadowCastingTable table;
+    table.build(radius);
+
+    std::vector<std::pair<int, int>> centers;
+    for(int i = 0; i < 2000; ++i)
+        centers.push_back(std::make_pair(std::rand() % sizeX, std::rand() % sizeY));
+
+    const uint32_t nbRuns = 5;
+    double legacyMs = measureMs([&table, &grid, &centers]()
+    {
+        for(const std::pair<int, int>& center : centers)
+            legacyVisibleCells(table, grid, center.first, center.second, radius);
+    }, nbRuns);
+
+    std::vector<const Cell*> cells;
+    std::vector<ShadowCastingTable::ProcessState<const Cell*>> states;
+    double bufferedMs = measureMs([&table, &grid, &centers, &cells, &states]()
+    {
+        for(const std::pair<int, int>& center : centers)
+            grid.visibleCells(table, center.first, center.second, radius, cells, states);
+    }, nbRuns);
+
+    printTimings("visibleTiles radius=" + std::to_string(radius) + " calls=" + std::to_string(centers.size()), {
+        { "former", legacyMs },
+        { "buffered", bufferedMs }
+    });
+}
@@ -0,0 +1,293 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*! \brief Load test of a dedicated server. Connects several headless bots (see ODClientBot) to a
+ * server launched with --server and reports, for each bot, the time between turns, the number of
+ * turns not acknowledged yet and the bytes exchanged. Every bot runs in its own thread so that the
+ * tool can be used on the same machine as the server (over loopback).
+ * See scripts/unix/run_load_test.sh
+ */
+
+#include "ODClientBot.h"
+
+#include "utils/Helper.h"
+#include "utils/LogManager.h"
+#include "utils/LogSinkConsole.h"
+#include "utils/LogSinkFile.h"
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+//! \brief A turn is counted as late if it started that much later than expected
+const double LATE_TURN_RATIO = 1.5;
+
+struct SampleStats
+{
+    SampleStats() :
+        mAverage(0.0),
+        mPercentile95(0),
+        mMax(0)
+    {}
+
+    double mAverage;
+    int64_t mPercentile95;
+    int64_t mMax;
+};
+
+static SampleStats computeStats(std::vector<int64_t>& values)
+{
+    SampleStats stats;
+    if(values.empty())
+        return stats;
+
+    std::sort(values.begin(), values.end());
+    int64_t sum = 0;
+    for(int64_t value : values)
+        sum += value;
+
+    stats.mAverage = static_cast<double>(sum) / static_cast<double>(values.size());
+    stats.mPercentile95 = values[(values.size() * 95) / 100];
+    stats.mMax = values.back();
+    return stats;
+}
+
+//! \brief Adds the turn samples of the given bot to the given lists
+static void collectSamples(const ODClientBot& bot, std::vector<int64_t>& intervals,
+    std::vector<int64_t>& ackLags, uint32_t& nbLateTurns)
+{
+    double lateThreshold = bot.getTurnPeriodMs() * LATE_TURN_RATIO;
+    for(const ClientBotTurnSample& sample : bot.getTurnSamples())
+    {
+        ackLags.push_back(sample.mAckLag);
+        if(sample.mTurnIntervalMs < 0)
+            continue;
+
+        intervals.push_back(sample.mTurnIntervalMs);
+        if(sample.mTurnIntervalMs > lateThreshold)
+            ++nbLateTurns;
+    }
+}
+
+static double bytesPerSecond(uint64_t nbBytes, int32_t timeMs)
+{
+    if(timeMs <= 0)
+        return 0.0;
+
+    return static_cast<double>(nbBytes) * 1000.0 / static_cast<double>(timeMs);
+}
+
+static void printReportLine(const std::string& name, const std::string& seat, size_t nbTurns,
+    uint32_t nbActions, std::vector<int64_t>& intervals, std::vector<int64_t>& ackLags,
+    uint32_t nbLateTurns, double bytesSentPerSecond, double bytesReceivedPerSecond)
+{
+    SampleStats intervalStats = computeStats(intervals);
+    SampleStats ackLagStats = computeStats(ackLags);
+    std::cout << std::left << std::setw(8) << name
+        << std::right << std::setw(5) << seat
+        << std::setw(7) << nbTurns
+        << std::setw(8) << nbActions
+        << std::setw(9) << Helper::toString(intervalStats.mAverage, 1)
+        << std::setw(7) << intervalStats.mPercentile95
+        << std::setw(7) << intervalStats.mMax
+        << std::setw(6) << nbLateTurns
+        << std::setw(8) << Helper::toString(ackLagStats.mAverage, 2)
+        << std::setw(5) << ackLagStats.mMax
+        << std::setw(10) << Helper::toString(bytesSentPerSecond / 1024.0, 2)
+        << std::setw(10) << Helper::toString(bytesReceivedPerSecond / 1024.0, 2)
+        << "\n";
+}
+
+int main(int argc, char** argv)
+{
+    boost::program_options::options_description desc("Allowed options");
+    desc.add_options()
+        ("help", "produce help message")
+        ("host", boost::program_options::value<std::string>()->default_value("localhost"), "Address of the server")
+        ("port", boost::program_options::value<int>()->default_value(32222), "Port of the server")
+        ("clients", boost::program_options::value<uint32_t>()->default_value(2), "Number of bots. The level should have as many human seats")
+        ("duration", boost::program_options::value<int32_t>()->default_value(60), "Time played once the game is launched (in seconds)")
+        ("ackdelay", boost::program_options::value<int32_t>()->default_value(0), "Time the bots wait before acknowledging a turn (in ms)")
+        ("actions", boost::program_options::value<double>()->default_value(0.5), "Average number of actions sent per turn by each bot")
+        ("seed", boost::program_options::value<uint32_t>()->default_value(0), "Seed of the actions sent by the bots")
+        ("csv", boost::program_options::value<std::string>(), "Writes the metrics of every turn in the given file")
+        ("log", boost::program_options::value<std::string>(), "Writes the logs in the given file instead of the console")
+    ;
+
+    boost::program_options::variables_map options;
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv).options(desc).run(), options);
+        boost::program_options::notify(options);
+    }
+    catch(const boost::program_options::error& e)
+    {
+        std::cerr << e.what() << "\n" << desc << "\n";
+        return 1;
+    }
+
+    if(options.count("help"))
+    {
+        std::cout << desc << "\n";
+        return 0;
+    }
+
+    LogManager logMgr;
+    if(options.count("log"))
+    {
+        logMgr.addSink(std::unique_ptr<LogSink>(new LogSinkFile(options["log"].as<std::string>())));
+    }
+    else
+    {
+        // The bots log every connection step. On the console, we only keep the problems
+        logMgr.addSink(std::unique_ptr<LogSink>(new LogSinkConsole()));
+        logMgr.setLevel(LogMessageLevel::WARNING);
+    }
+
+    const std::string host = options["host"].as<std::string>();
+    const int port = options["port"].as<int>();
+    const uint32_t seed = options["seed"].as<uint32_t>();
+    ClientBotSettings settings;
+    settings.mNbClients = std::max(1u, options["clients"].as<uint32_t>());
+    settings.mGameDurationMs = options["duration"].as<int32_t>() * 1000;
+    settings.mAckDelayMs = options["ackdelay"].as<int32_t>();
+    settings.mActionsPerTurn = options["actions"].as<double>();
+
+    std::vector<std::unique_ptr<ODClientBot>> bots;
+    for(uint32_t i = 0; i < settings.mNbClients; ++i)
+        bots.push_back(std::unique_ptr<ODClientBot>(new ODClientBot(i, settings, seed + i)));
+
+    // Each bot processes its messages like a game client would
+    std::vector<uint8_t> results(bots.size(), 0);
+    std::vector<std::thread> threads;
+    for(uint32_t i = 0; i < bots.size(); ++i)
+    {
+        threads.push_back(std::thread([&bots, &results, &host, port, i]()
+        {
+            ODClientBot& bot = *bots[i];
+            if(!bot.connect(host, port, 5000, ""))
+            {
+                OD_LOG_ERR(bot.getNick() + " could not connect to " + host + ":" + Helper::toString(port));
+                return;
+            }
+            results[i] = bot.run() ? 1 : 0;
+        }));
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    std::cout << "\nLoad test: server=" << host << ":" << port
+        << ", nbClients=" << settings.mNbClients
+        << ", ackDelay=" << settings.mAckDelayMs << "ms"
+        << ", actionsPerTurn=" << settings.mActionsPerTurn;
+    for(const std::unique_ptr<ODClientBot>& bot : bots)
+    {
+        if(bot->getTurnPeriodMs() <= 0.0)
+            continue;
+
+        std::cout << ", expectedTurnInterval=" << Helper::toString(bot->getTurnPeriodMs(), 1) << "ms";
+        break;
+    }
+    std::cout << "\n\n";
+    std::cout << std::left << std::setw(8) << "client"
+        << std::right << std::setw(5) << "seat"
+        << std::setw(7) << "turns"
+        << std::setw(8) << "actions"
+        << std::setw(9) << "avgIntv"
+        << std::setw(7) << "p95"
+        << std::setw(7) << "max"
+        << std::setw(6) << "late"
+        << std::setw(8) << "avgLag"
+        << std::setw(5) << "max"
+        << std::setw(10) << "sentKB/s"
+        << std::setw(10) << "recvKB/s"
+        << "\n";
+
+    std::vector<int64_t> allIntervals;
+    std::vector<int64_t> allAckLags;
+    uint32_t allNbLateTurns = 0;
+    size_t allNbTurns = 0;
+    uint32_t allNbActions = 0;
+    uint64_t allBytesSent = 0;
+    uint64_t allBytesReceived = 0;
+    int32_t maxGameTimeMs = 0;
+    uint32_t nbFailed = 0;
+    for(uint32_t i = 0; i < bots.size(); ++i)
+    {
+        const ODClientBot& bot = *bots[i];
+        if(results[i] == 0)
+        {
+            ++nbFailed;
+            std::cout << std::left << std::setw(8) << bot.getNick()
+                << (bot.isRejected() ? " rejected (not enough human seats)" : " failed (see logs)") << "\n";
+            continue;
+        }
+
+        std::vector<int64_t> intervals;
+        std::vector<int64_t> ackLags;
+        uint32_t nbLateTurns = 0;
+        collectSamples(bot, intervals, ackLags, nbLateTurns);
+        allIntervals.insert(allIntervals.end(), intervals.begin(), intervals.end());
+        allAckLags.insert(allAckLags.end(), ackLags.begin(), ackLags.end());
+        allNbLateTurns += nbLateTurns;
+        allNbTurns += bot.getTurnSamples().size();
+        allNbActions += bot.getNbActionsSent();
+        allBytesSent += bot.getGameBytesSent();
+        allBytesReceived += bot.getGameBytesReceived();
+        maxGameTimeMs = std::max(maxGameTimeMs, bot.getGameTimeMs());
+
+        printReportLine(bot.getNick(), Helper::toString(bot.getSeatId()), bot.getTurnSamples().size(),
+            bot.getNbActionsSent(), intervals, ackLags, nbLateTurns,
+            bytesPerSecond(bot.getGameBytesSent(), bot.getGameTimeMs()),
+            bytesPerSecond(bot.getGameBytesReceived(), bot.getGameTimeMs()));
+    }
+
+    if(nbFailed < bots.size())
+    {
+        // The rates are given per client
+        uint32_t nbPlayed = static_cast<uint32_t>(bots.size()) - nbFailed;
+        printReportLine("all", "-", allNbTurns, allNbActions, allIntervals, allAckLags, allNbLateTurns,
+            bytesPerSecond(allBytesSent / nbPlayed, maxGameTimeMs),
+            bytesPerSecond(allBytesReceived / nbPlayed, maxGameTimeMs));
+        std::cout << "\nServer output for all clients: " << Helper::toString(bytesPerSecond(allBytesReceived, maxGameTimeMs) / 1024.0, 2)
+            << " KB/s\n";
+    }
+
+    if(options.count("csv"))
+    {
+        std::ofstream csv(options["csv"].as<std::string>());
+        csv << "client,turn,intervalMs,ackLag,bytesReceived\n";
+        for(const std::unique_ptr<ODClientBot>& bot : bots)
+        {
+            for(const ClientBotTurnSample& sample : bot->getTurnSamples())
+            {
+                csv << bot->getNick() << "," << sample.mTurn << "," << sample.mTurnIntervalMs
+                    << "," << sample.mAckLag << "," << sample.mBytesReceived << "\n";
+            }
+        }
+    }
+
+    return (nbFailed == 0) ? 0 : 2;
+}
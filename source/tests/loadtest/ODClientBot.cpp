@@ -0,0 +1,549 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ODClientBot.h"
+
+#include "entities/GameEntityType.h"
+#include "game/SeatData.h"
+#include "network/ClientNotification.h"
+#include "network/ServerMode.h"
+#include "network/ServerNotification.h"
+#include "rooms/RoomType.h"
+#include "utils/Helper.h"
+#include "utils/LogManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef OD_VERSION
+static const std::string OD_VERSION_STR = OD_VERSION;
+#else
+static const std::string OD_VERSION_STR = "undefined";
+#endif
+
+//! \brief Player id given to the seats not used by a bot (see Seat::PLAYER_TYPE_INACTIVE_ID)
+const int32_t INACTIVE_PLAYER_ID = 0;
+//! \brief The bots retry to connect while the server starts
+const uint32_t NB_CONNECTION_TRIES = 10;
+//! \brief Time allowed to configure and launch the game
+const int32_t GAME_START_TIMEOUT_MS = 60000;
+
+ODClientBot::ODClientBot(uint32_t index, const ClientBotSettings& settings, uint32_t seed) :
+    mSettings(settings),
+    mRandomGenerator(seed),
+    mNick("Bot" + Helper::toString(index)),
+    mIsConfigPlayer(false),
+    mIsLaunchSent(false),
+    mIsRejected(false),
+    mIsGameStarted(false),
+    mIsDisconnected(false),
+    mNbPlayersConnected(0),
+    mMapSizeX(0),
+    mMapSizeY(0),
+    mSeatId(-1),
+    mSeat(nullptr),
+    mTurnPeriodMs(0.0),
+    mNbEntitiesInHand(0),
+    mLastTurnAcked(-1),
+    mActionCredit(0.0),
+    mNbActionsSent(0),
+    mFirstTurnTimeMs(0),
+    mLastTurnTimeMs(0),
+    mStartBytesSent(0),
+    mStartBytesReceived(0),
+    mGameBytesSent(0),
+    mGameBytesReceived(0),
+    mLastTurnBytesReceived(0)
+{
+}
+
+ODClientBot::~ODClientBot()
+{
+    for(SeatData* seat : mSeats)
+        delete seat;
+
+    mSeats.clear();
+}
+
+bool ODClientBot::connect(const std::string& host, const int port, uint32_t timeout, const std::string& outputReplayFilename)
+{
+    uint32_t nbTries = 0;
+    while(!ODSocketClient::connect(host, port, timeout, outputReplayFilename))
+    {
+        ++nbTries;
+        if(nbTries >= NB_CONNECTION_TRIES)
+            return false;
+
+        OD_LOG_INF(mNick + " couldn't connect to server. Sleeping a bit before retry");
+        sf::sleep(sf::milliseconds(1000));
+    }
+
+    // We tell we support compression like the game client does
+    enableUncompression();
+    ODPacket packSend;
+    packSend << ClientNotificationType::hello
+        << std::string("OpenDungeons V ") + OD_VERSION_STR << true;
+    send(packSend);
+
+    return true;
+}
+
+bool ODClientBot::run()
+{
+    int32_t startTime = mClock.getElapsedTime().asMilliseconds();
+    while(!mIsDisconnected && !mIsRejected && isConnected())
+    {
+        processClientSocketMessages();
+        sendDueAcks();
+
+        int32_t now = mClock.getElapsedTime().asMilliseconds();
+        if(!mIsGameStarted && (now - startTime > GAME_START_TIMEOUT_MS))
+        {
+            OD_LOG_ERR(mNick + " timed out while waiting for the game to start");
+            break;
+        }
+
+        if(mIsGameStarted && (now - mFirstTurnTimeMs >= mSettings.mGameDurationMs))
+            break;
+    }
+
+    if(mIsGameStarted)
+    {
+        mGameBytesSent = getNbBytesSent() - mStartBytesSent;
+        mGameBytesReceived = getNbBytesReceived() - mStartBytesReceived;
+    }
+
+    disconnect(false);
+    return mIsGameStarted && !mIsDisconnected;
+}
+
+void ODClientBot::playerDisconnected()
+{
+    OD_LOG_WRN(mNick + " has been disconnected by the server");
+    mIsDisconnected = true;
+}
+
+bool ODClientBot::processMessage(ServerNotificationType cmd, ODPacket& packetReceived)
+{
+    switch(cmd)
+    {
+        case ServerNotificationType::loadLevel:
+        {
+            std::string str;
+            OD_ASSERT_TRUE(packetReceived >> str);
+            OD_ASSERT_TRUE(packetReceived >> mMapSizeX >> mMapSizeY);
+
+            // Level filename, description, musics and tileset
+            for(uint32_t i = 0; i < 5; ++i)
+            {
+                OD_ASSERT_TRUE(packetReceived >> str);
+            }
+
+            uint32_t nb;
+            OD_ASSERT_TRUE(packetReceived >> nb);
+            while(nb > 0)
+            {
+                --nb;
+                SeatData* seat = new SeatData;
+                seat->importFromPacket(packetReceived);
+                mSeats.push_back(seat);
+            }
+
+            // Like the unit tests, we do not read the entities of the level
+            ODPacket packSend;
+            packSend << ClientNotificationType::levelOK;
+            send(packSend);
+            break;
+        }
+
+        case ServerNotificationType::pickNick:
+        {
+            ServerMode serverMode;
+            OD_ASSERT_TRUE(packetReceived >> serverMode);
+
+            ODPacket packSend;
+            packSend << ClientNotificationType::setNick << mNick;
+            send(packSend);
+
+            packSend.clear();
+            packSend << ClientNotificationType::readyForSeatConfiguration;
+            send(packSend);
+            break;
+        }
+
+        case ServerNotificationType::playerConfigChange:
+        {
+            OD_LOG_INF(mNick + " configures the game");
+            mIsConfigPlayer = true;
+            break;
+        }
+
+        case ServerNotificationType::addPlayers:
+        {
+            uint32_t nbPlayers;
+            OD_ASSERT_TRUE(packetReceived >> nbPlayers);
+            for(uint32_t i = 0; i < nbPlayers; ++i)
+            {
+                std::string nick;
+                int32_t id;
+                OD_ASSERT_TRUE(packetReceived >> nick >> id);
+            }
+            mNbPlayersConnected += nbPlayers;
+            break;
+        }
+
+        case ServerNotificationType::removePlayers:
+        {
+            uint32_t nbPlayers;
+            OD_ASSERT_TRUE(packetReceived >> nbPlayers);
+            mNbPlayersConnected -= std::min(nbPlayers, mNbPlayersConnected);
+            break;
+        }
+
+        case ServerNotificationType::seatConfigurationRefresh:
+        {
+            if(mIsConfigPlayer)
+                configureSeats(packetReceived);
+            break;
+        }
+
+        case ServerNotificationType::clientAccepted:
+        {
+            double turnsPerSecond;
+            OD_ASSERT_TRUE(packetReceived >> turnsPerSecond);
+            if(turnsPerSecond > 0.0)
+                mTurnPeriodMs = 1000.0 / turnsPerSecond;
+            break;
+        }
+
+        case ServerNotificationType::clientRejected:
+        {
+            OD_LOG_WRN(mNick + " has been rejected. The level does not have enough human seats");
+            mIsRejected = true;
+            return false;
+        }
+
+        case ServerNotificationType::startGameMode:
+        {
+            OD_ASSERT_TRUE(packetReceived >> mSeatId);
+            for(SeatData* seat : mSeats)
+            {
+                if(seat->getId() != mSeatId)
+                    continue;
+
+                mSeat = seat;
+                break;
+            }
+            OD_LOG_INF(mNick + " plays on seat " + Helper::toString(mSeatId));
+            break;
+        }
+
+        case ServerNotificationType::turnStarted:
+        {
+            int64_t turnNum;
+            OD_ASSERT_TRUE(packetReceived >> turnNum);
+            handleTurnStarted(turnNum);
+            break;
+        }
+
+        case ServerNotificationType::addEntity:
+        {
+            // We only keep our creatures. They start with the GameEntity data
+            int32_t entityType;
+            OD_ASSERT_TRUE(packetReceived >> entityType);
+            if(entityType != static_cast<int32_t>(GameEntityType::creature))
+                break;
+
+            int32_t seatId;
+            CreatureInfo creature;
+            uint32_t networkId;
+            std::string meshName;
+            Ogre::Vector3 position;
+            OD_ASSERT_TRUE(packetReceived >> seatId >> creature.mName >> networkId >> meshName >> position);
+            if(seatId != mSeatId)
+                break;
+
+            creature.mTileX = static_cast<int32_t>(std::round(position.x));
+            creature.mTileY = static_cast<int32_t>(std::round(position.y));
+            mCreatures[networkId] = creature;
+            break;
+        }
+
+        case ServerNotificationType::removeEntity:
+        {
+            int32_t entityType;
+            uint32_t networkId;
+            OD_ASSERT_TRUE(packetReceived >> entityType >> networkId);
+            if(entityType == static_cast<int32_t>(GameEntityType::creature))
+                mCreatures.erase(networkId);
+            break;
+        }
+
+        case ServerNotificationType::entityPickedUp:
+        {
+            int seatId;
+            OD_ASSERT_TRUE(packetReceived >> seatId);
+            if(seatId == mSeatId)
+                ++mNbEntitiesInHand;
+            break;
+        }
+
+        case ServerNotificationType::entityDropped:
+        {
+            int seatId;
+            OD_ASSERT_TRUE(packetReceived >> seatId);
+            if((seatId == mSeatId) && (mNbEntitiesInHand > 0))
+                --mNbEntitiesInHand;
+            break;
+        }
+
+        default:
+        {
+            // The other messages are only needed to display the game
+            break;
+        }
+    }
+    return true;
+}
+
+void ODClientBot::configureSeats(ODPacket& packetReceived)
+{
+    struct SeatConfig
+    {
+        int mSeatId;
+        int32_t mFactionIndex;
+        int32_t mPlayerId;
+        int32_t mTeamId;
+    };
+
+    // The server sends every seat but the rogue one
+    std::vector<SeatConfig> configs;
+    bool isConfigured = true;
+    for(SeatData* seat : mSeats)
+    {
+        if(seat->getId() == 0)
+            continue;
+
+        SeatConfig config;
+        config.mFactionIndex = -1;
+        config.mPlayerId = -1;
+        config.mTeamId = -1;
+        bool isSet;
+        OD_ASSERT_TRUE(packetReceived >> config.mSeatId);
+        OD_ASSERT_TRUE(packetReceived >> isSet);
+        if(isSet)
+        {
+            OD_ASSERT_TRUE(packetReceived >> config.mFactionIndex);
+        }
+
+        OD_ASSERT_TRUE(packetReceived >> isSet);
+        if(isSet)
+        {
+            OD_ASSERT_TRUE(packetReceived >> config.mPlayerId);
+        }
+
+        OD_ASSERT_TRUE(packetReceived >> isSet);
+        if(isSet)
+        {
+            OD_ASSERT_TRUE(packetReceived >> config.mTeamId);
+        }
+
+        isConfigured &= (config.mFactionIndex != -1) && (config.mPlayerId != -1) && (config.mTeamId != -1);
+        configs.push_back(config);
+    }
+
+    if(isConfigured)
+    {
+        if(mIsLaunchSent)
+            return;
+
+        OD_LOG_INF(mNick + " launches the game with nbPlayers=" + Helper::toString(mNbPlayersConnected));
+        mIsLaunchSent = true;
+        ODPacket packSend;
+        packSend << ClientNotificationType::seatConfigurationSet;
+        send(packSend);
+        return;
+    }
+
+    // The server puts the players in the free human seats when they connect. We wait for every bot
+    // before configuring the other seats
+    if(mNbPlayersConnected < mSettings.mNbClients)
+        return;
+
+    ODPacket packSend;
+    packSend << ClientNotificationType::seatConfigurationRefresh;
+    for(const SeatConfig& config : configs)
+    {
+        int32_t factionIndex = (config.mFactionIndex != -1) ? config.mFactionIndex : 0;
+        int32_t playerId = (config.mPlayerId != -1) ? config.mPlayerId : INACTIVE_PLAYER_ID;
+        int32_t teamId = config.mTeamId;
+        if(teamId == -1)
+        {
+            teamId = config.mSeatId;
+            for(SeatData* seat : mSeats)
+            {
+                if((seat->getId() != config.mSeatId) || seat->getAvailableTeamIds().empty())
+                    continue;
+
+                teamId = seat->getAvailableTeamIds().front();
+                break;
+            }
+        }
+
+        packSend << config.mSeatId;
+        packSend << true << factionIndex;
+        packSend << true << playerId;
+        packSend << true << teamId;
+    }
+    send(packSend);
+}
+
+void ODClientBot::handleTurnStarted(int64_t turnNum)
+{
+    int32_t now = mClock.getElapsedTime().asMilliseconds();
+    uint64_t bytesReceived = getNbBytesReceived();
+    if(!mIsGameStarted)
+    {
+        mIsGameStarted = true;
+        mFirstTurnTimeMs = now;
+        mLastTurnTimeMs = now;
+        mStartBytesSent = getNbBytesSent();
+        mStartBytesReceived = bytesReceived;
+        mLastTurnBytesReceived = bytesReceived;
+        mLastTurnAcked = turnNum - 1;
+    }
+
+    ClientBotTurnSample sample;
+    sample.mTurn = turnNum;
+    sample.mTurnIntervalMs = mTurnSamples.empty() ? -1 : now - mLastTurnTimeMs;
+    sample.mAckLag = turnNum - mLastTurnAcked;
+    sample.mBytesReceived = bytesReceived - mLastTurnBytesReceived;
+    mTurnSamples.push_back(sample);
+    mLastTurnTimeMs = now;
+    mLastTurnBytesReceived = bytesReceived;
+
+    mPendingAcks.push_back(std::make_pair(turnNum, now));
+    sendDueAcks();
+
+    if(mSeat == nullptr)
+        return;
+
+    mActionCredit += mSettings.mActionsPerTurn;
+    while(mActionCredit >= 1.0)
+    {
+        mActionCredit -= 1.0;
+        sendRandomAction();
+    }
+}
+
+void ODClientBot::sendDueAcks()
+{
+    int32_t now = mClock.getElapsedTime().asMilliseconds();
+    while(!mPendingAcks.empty() &&
+          (now - mPendingAcks.front().second >= mSettings.mAckDelayMs))
+    {
+        int64_t turnNum = mPendingAcks.front().first;
+        mPendingAcks.pop_front();
+
+        ODPacket packSend;
+        packSend << ClientNotificationType::ackNewTurn << turnNum;
+        send(packSend);
+        mLastTurnAcked = turnNum;
+    }
+}
+
+void ODClientBot::sendRandomAction()
+{
+    ODPacket packSend;
+    int32_t x;
+    int32_t y;
+    int32_t action = randomInt(0, 9);
+    if((action >= 8) && mCreatures.empty())
+        action = 0;
+
+    if(action < 4)
+    {
+        // Digging marks
+        randomTileNearDungeon(8, x, y);
+        int32_t x2 = std::min(x + randomInt(0, 2), mMapSizeX - 1);
+        int32_t y2 = std::min(y + randomInt(0, 2), mMapSizeY - 1);
+        packSend << ClientNotificationType::askMarkTiles << x << y << x2 << y2 << true;
+    }
+    else if(action < 6)
+    {
+        // Small room. The server refuses the tiles that cannot be built
+        RoomType type = (randomInt(0, 1) == 0) ? RoomType::dormitory : RoomType::treasury;
+        randomTileNearDungeon(6, x, y);
+        int32_t x2 = std::min(x + 1, mMapSizeX - 1);
+        int32_t y2 = std::min(y + 1, mMapSizeY - 1);
+        uint32_t nb = static_cast<uint32_t>((x2 - x + 1) * (y2 - y + 1));
+        packSend << ClientNotificationType::askBuildRoom << type << nb;
+        for(int32_t xx = x; xx <= x2; ++xx)
+        {
+            for(int32_t yy = y; yy <= y2; ++yy)
+                packSend << xx << yy;
+        }
+    }
+    else if(action < 8)
+    {
+        if(mNbEntitiesInHand > 0)
+        {
+            randomTileNearDungeon(2, x, y);
+            packSend << ClientNotificationType::askHandDrop << x << y;
+        }
+        else if(randomInt(0, 1) == 0)
+        {
+            packSend << ClientNotificationType::askPickupWorker;
+        }
+        else
+        {
+            packSend << ClientNotificationType::askPickupFighter;
+        }
+    }
+    else
+    {
+        auto it = mCreatures.begin();
+        std::advance(it, randomInt(0, static_cast<int32_t>(mCreatures.size()) - 1));
+        packSend << ClientNotificationType::askSlapEntity << GameEntityType::creature << it->second.mName;
+    }
+
+    send(packSend);
+    ++mNbActionsSent;
+}
+
+void ODClientBot::randomTileNearDungeon(int32_t maxDistance, int32_t& x, int32_t& y)
+{
+    // Half of the time, we use the place where one of our creatures has been seen
+    x = mSeat->getStartingX();
+    y = mSeat->getStartingY();
+    if(!mCreatures.empty() && (randomInt(0, 1) == 0))
+    {
+        auto it = mCreatures.begin();
+        std::advance(it, randomInt(0, static_cast<int32_t>(mCreatures.size()) - 1));
+        x = it->second.mTileX;
+        y = it->second.mTileY;
+    }
+
+    x = std::max(0, std::min(x + randomInt(-maxDistance, maxDistance), mMapSizeX - 1));
+    y = std::max(0, std::min(y + randomInt(-maxDistance, maxDistance), mMapSizeY - 1));
+}
+
+int32_t ODClientBot::randomInt(int32_t min, int32_t max)
+{
+    std::uniform_int_distribution<int32_t> distribution(min, max);
+    return distribution(mRandomGenerator);
+}
@@ -0,0 +1,188 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ODCLIENTBOT_H
+#define ODCLIENTBOT_H
+
+#include "network/ODSocketClient.h"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+class SeatData;
+
+//! \brief Parameters shared by every bot of a load test
+struct ClientBotSettings
+{
+    ClientBotSettings() :
+        mNbClients(1),
+        mGameDurationMs(60000),
+        mAckDelayMs(0),
+        mActionsPerTurn(0.5)
+    {}
+
+    //! \brief Number of bots connecting to the server. The bot configuring the game waits for all of
+    //! them before launching it
+    uint32_t mNbClients;
+    //! \brief Time the bots play once the game is launched
+    int32_t mGameDurationMs;
+    //! \brief Time waited before acknowledging a turn. Allows to simulate slow clients
+    int32_t mAckDelayMs;
+    //! \brief Average number of player actions (digging, building, pickup/drop, slap) sent each turn
+    double mActionsPerTurn;
+};
+
+//! \brief Metrics recorded by a bot for each turn started by the server
+struct ClientBotTurnSample
+{
+    int64_t mTurn;
+    //! \brief Time elapsed since the previous turn was received. -1 for the first one
+    int32_t mTurnIntervalMs;
+    //! \brief Number of turns started by the server (including this one) that the bot has not
+    //! acknowledged yet. 1 if the bot keeps up
+    int64_t mAckLag;
+    //! \brief Bytes received from the server since the previous turn
+    uint64_t mBytesReceived;
+};
+
+/*! \brief Headless client used to load test a dedicated server (launched with --server). It plays
+ * the connection sequence like ODClientTest but without checking the data received so that it works
+ * with any level. Once the game is launched, it sends random player actions near its dungeon and
+ * records the metrics of every turn.
+ * The bot that is given the game configuration waits until every bot is connected, then puts the
+ * bots in the human seats and launches the game. Seats left are inactive.
+ */
+class ODClientBot : public ODSocketClient
+{
+public:
+    ODClientBot(uint32_t index, const ClientBotSettings& settings, uint32_t seed);
+
+    virtual ~ODClientBot();
+
+    //! \brief Connects to the server, retrying while it starts. Bots do not write replays so
+    //! outputReplayFilename should be empty
+    bool connect(const std::string& host, const int port, uint32_t timeout, const std::string& outputReplayFilename) override;
+
+    /*! \brief Processes the server messages until the game has been played for the wanted duration
+     * or the bot is disconnected. Returns true if the game has been played
+     */
+    bool run();
+
+    inline const std::string& getNick() const
+    { return mNick; }
+
+    inline int getSeatId() const
+    { return mSeatId; }
+
+    inline bool isRejected() const
+    { return mIsRejected; }
+
+    //! \brief Turn length expected by the server
+    inline double getTurnPeriodMs() const
+    { return mTurnPeriodMs; }
+
+    inline uint32_t getNbActionsSent() const
+    { return mNbActionsSent; }
+
+    //! \brief Bytes exchanged with the server during the game (the connection sequence is not counted)
+    inline uint64_t getGameBytesSent() const
+    { return mGameBytesSent; }
+    inline uint64_t getGameBytesReceived() const
+    { return mGameBytesReceived; }
+
+    //! \brief Time between the first and the last turn received
+    inline int32_t getGameTimeMs() const
+    { return mLastTurnTimeMs - mFirstTurnTimeMs; }
+
+    inline const std::vector<ClientBotTurnSample>& getTurnSamples() const
+    { return mTurnSamples; }
+
+protected:
+    bool processMessage(ServerNotificationType cmd, ODPacket& packetReceived) override;
+    void playerDisconnected() override;
+
+private:
+    //! \brief Own creature known by the bot. Used to pick the targets of the actions
+    struct CreatureInfo
+    {
+        std::string mName;
+        int32_t mTileX;
+        int32_t mTileY;
+    };
+
+    //! \brief Called by the bot that configures the game. Sends the seat configuration once every bot
+    //! is connected and launches the game once the server has it
+    void configureSeats(ODPacket& packetReceived);
+
+    void handleTurnStarted(int64_t turnNum);
+
+    //! \brief Acknowledges the turns received for at least mAckDelayMs
+    void sendDueAcks();
+
+    //! \brief Sends a random player action
+    void sendRandomAction();
+
+    //! \brief Random tile near the dungeon (or near a creature of the bot). The tile is inside the map
+    void randomTileNearDungeon(int32_t maxDistance, int32_t& x, int32_t& y);
+
+    int32_t randomInt(int32_t min, int32_t max);
+
+    const ClientBotSettings& mSettings;
+    std::mt19937 mRandomGenerator;
+    std::string mNick;
+
+    bool mIsConfigPlayer;
+    bool mIsLaunchSent;
+    bool mIsRejected;
+    bool mIsGameStarted;
+    bool mIsDisconnected;
+    uint32_t mNbPlayersConnected;
+
+    int32_t mMapSizeX;
+    int32_t mMapSizeY;
+    std::vector<SeatData*> mSeats;
+    int mSeatId;
+    SeatData* mSeat;
+    double mTurnPeriodMs;
+
+    //! \brief Creatures of the bot by network id
+    std::map<uint32_t, CreatureInfo> mCreatures;
+    //! \brief Number of entities in the keeper hand
+    uint32_t mNbEntitiesInHand;
+
+    //! \brief Turns not acknowledged yet with the time they were received
+    std::deque<std::pair<int64_t, int32_t>> mPendingAcks;
+    int64_t mLastTurnAcked;
+    double mActionCredit;
+    uint32_t mNbActionsSent;
+
+    sf::Clock mClock;
+    int32_t mFirstTurnTimeMs;
+    int32_t mLastTurnTimeMs;
+    uint64_t mStartBytesSent;
+    uint64_t mStartBytesReceived;
+    uint64_t mGameBytesSent;
+    uint64_t mGameBytesReceived;
+    uint64_t mLastTurnBytesReceived;
+    std::vector<ClientBotTurnSample> mTurnSamples;
+};
+
+#endif // ODCLIENTBOT_H
@@ -17,6 +17,7 @@
 
 #include "ODClientTest.h"
 
+#include "entities/GameEntityType.h"
 #include "game/SeatData.h"
 #include "network/ClientNotification.h"
 #include "network/ServerMode.h"
@@ -66,10 +67,12 @@ bool ODClientTest::connect(const std::string& host, const int port, uint32_t tim
             return false;
     }
 
-    // Send a hello request to start the conversation with the server
+    // Send a hello request to start the conversation with the server. ODSocketClient
+    // uncompresses the messages so we can tell we support compression
+    enableUncompression();
     ODPacket packSend;
     packSend << ClientNotificationType::hello
-        << std::string("OpenDungeons V ") + OD_VERSION_STR;
+        << std::string("OpenDungeons V ") + OD_VERSION_STR << true;
     send(packSend);
 
     return true;
@@ -394,15 +397,31 @@ bool ODClientTest::processMessage(ServerNotificationType cmd, ODPacket& packetRe
             BOOST_CHECK(packetReceived >> mPlayers[mLocalPlayerIndex].mGoals);
             break;
         }
+        case ServerNotificationType::addEntity:
+        {
+            // We only keep the creature names to report the animations played. Creatures
+            // start with the GameEntity data
+            int32_t entityType;
+            BOOST_CHECK(packetReceived >> entityType);
+            if(entityType != static_cast<int32_t>(GameEntityType::creature))
+                break;
+
+            int32_t seatId;
+            std::string name;
+            uint32_t networkId;
+            BOOST_CHECK(packetReceived >> seatId >> name >> networkId);
+            mCreatureNames[networkId] = name;
+            break;
+        }
         case ServerNotificationType::setObjectAnimationState:
         {
-            std::string entityName;
+            uint32_t networkId;
             std::string animState;
             bool loop;
             bool playIdleWhenAnimationEnds;
             bool shouldSetWalkDirection;
             Ogre::Vector3 walkDirection(0, 0, 0);
-            BOOST_CHECK(packetReceived >> entityName >> animState
+            BOOST_CHECK(packetReceived >> networkId >> animState
                 >> loop >> playIdleWhenAnimationEnds >> shouldSetWalkDirection);
 
             if(shouldSetWalkDirection)
@@ -410,18 +429,18 @@ bool ODClientTest::processMessage(ServerNotificationType cmd, ODPacket& packetRe
                 BOOST_CHECK(packetReceived >> walkDirection);
             }
 
-            animationPlayed(entityName, animState, loop, playIdleWhenAnimationEnds, shouldSetWalkDirection, walkDirection);
+            animationPlayed(getCreatureName(networkId), animState, loop, playIdleWhenAnimationEnds, shouldSetWalkDirection, walkDirection);
             break;
         }
         case ServerNotificationType::animatedObjectSetWalkPath:
         {
-            std::string entityName;
+            uint32_t networkId;
             std::string walkAnim;
             std::string endAnim;
             bool loopEndAnim;
             bool playIdleWhenAnimationEnds;
             uint32_t nbDest;
-            BOOST_CHECK(packetReceived >> entityName >> walkAnim >> endAnim);
+            BOOST_CHECK(packetReceived >> networkId >> walkAnim >> endAnim);
             BOOST_CHECK(packetReceived >> loopEndAnim >> playIdleWhenAnimationEnds >> nbDest);
             std::vector<Ogre::Vector3> path;
             while(nbDest)
@@ -433,6 +452,7 @@ bool ODClientTest::processMessage(ServerNotificationType cmd, ODPacket& packetRe
             }
 
             //! We want to make sure animationPlayed is played for both animations (if required)
+            const std::string entityName = getCreatureName(networkId);
             if(!walkAnim.empty())
                 animationPlayed(entityName, walkAnim, true, false, false, Ogre::Vector3::ZERO);
             if(!endAnim.empty())
@@ -447,6 +467,15 @@ bool ODClientTest::processMessage(ServerNotificationType cmd, ODPacket& packetRe
     return false;
 }
 
+std::string ODClientTest::getCreatureName(uint32_t networkId) const
+{
+    auto it = mCreatureNames.find(networkId);
+    if(it == mCreatureNames.end())
+        return std::string();
+
+    return it->second;
+}
+
 SeatData* ODClientTest::getLocalSeat() const
 {
     if(mLocalPlayerIndex >= mPlayers.size())
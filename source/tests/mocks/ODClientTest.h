@@ -21,6 +21,7 @@
 
 #include "network/ODSocketClient.h"
 
+#include <map>
 #include <string>
 
 class SeatData;
@@ -90,6 +91,10 @@ private:
     std::vector<PlayerInfo> mPlayers;
     std::vector<SeatData*> mSeats;
     uint32_t mLocalPlayerIndex;
+    //! \brief Creature names by network id. Server messages refer to entities by network id
+    std::map<uint32_t, std::string> mCreatureNames;
+
+    std::string getCreatureName(uint32_t networkId) const;
 };
 
 #endif // ODCLIENTTEST_H
@@ -0,0 +1,105 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE EntityNameIndex
+#include "BoostTestTargetConfig.h"
+
+#include "NamedEntity.h"
+
+#include "gamemap/EntityNameIndex.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(test_entityNameIndex)
+{
+    NamedEntity kobold1("Kobold1");
+    NamedEntity kobold2("Kobold2");
+    EntityNameIndex<NamedEntity> index;
+    BOOST_CHECK(index.find("Kobold1") == nullptr);
+
+    index.add(&kobold1);
+    index.add(&kobold2);
+    BOOST_CHECK(index.size() == 2);
+    BOOST_CHECK(index.find("Kobold1") == &kobold1);
+    BOOST_CHECK(index.find("Kobold2") == &kobold2);
+    BOOST_CHECK(index.find("Kobold3") == nullptr);
+
+    // Removing an entity that is not indexed does nothing
+    NamedEntity other("Kobold1");
+    BOOST_CHECK(!index.remove(&other));
+    BOOST_CHECK(index.find("Kobold1") == &kobold1);
+
+    BOOST_CHECK(index.remove(&kobold1));
+    BOOST_CHECK(index.find("Kobold1") == nullptr);
+    BOOST_CHECK(index.size() == 1);
+
+    index.clear();
+    BOOST_CHECK(index.find("Kobold2") == nullptr);
+    BOOST_CHECK(index.size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_entityNameIndexSameName)
+{
+    // Entities loaded with the same name are all indexed until they are renamed
+    NamedEntity creature1("autoname");
+    NamedEntity creature2("autoname");
+    EntityNameIndex<NamedEntity> index;
+    index.add(&creature1);
+    index.add(&creature2);
+    BOOST_CHECK(index.find("autoname") != nullptr);
+
+    // Renaming is done by removing the entity with its former name
+    BOOST_CHECK(index.remove(&creature1, "autoname"));
+    creature1.setName("Troll1");
+    index.add(&creature1);
+    BOOST_CHECK(index.find("Troll1") == &creature1);
+    BOOST_CHECK(index.find("autoname") == &creature2);
+
+    BOOST_CHECK(index.remove(&creature2));
+    BOOST_CHECK(index.find("autoname") == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(test_entityNameIndexLikeLinear)
+{
+    // The index finds the same entities as the linear search for 2000 entities named like the creatures
+    const uint32_t nbEntities = 2000;
+    std::vector<std::unique_ptr<NamedEntity>> entities;
+    std::vector<NamedEntity*> list;
+    EntityNameIndex<NamedEntity> index;
+    for(uint32_t i = 0; i < nbEntities; ++i)
+    {
+        entities.push_back(std::unique_ptr<NamedEntity>(new NamedEntity("Creature" + std::to_string(i))));
+        list.push_back(entities.back().get());
+        index.add(entities.back().get());
+    }
+
+    std::vector<std::string> names;
+    for(uint32_t i = 0; i < nbEntities; ++i)
+        names.push_back("Creature" + std::to_string((i * 7919) % nbEntities));
+    names.push_back("Unknown");
+
+    bool isSame = true;
+    for(const std::string& name : names)
+    {
+        if(index.find(name) != findLinear(list, name))
+            isSame = false;
+    }
+    BOOST_CHECK(isSame);
+    BOOST_CHECK(index.find("Unknown") == nullptr);
+}
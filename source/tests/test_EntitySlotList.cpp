@@ -0,0 +1,134 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE EntitySlotList
+#include "BoostTestTargetConfig.h"
+
+#include "gamemap/EntitySlotList.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+struct Entity
+{
+    uint32_t mId;
+};
+
+//! \brief Entities in the list, in iteration order
+std::vector<Entity*> listEntities(const EntitySlotList<Entity>& list)
+{
+    std::vector<Entity*> entities;
+    for(Entity* entity : list.getSlots())
+    {
+        if(entity != nullptr)
+            entities.push_back(entity);
+    }
+    return entities;
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_entitySlotList)
+{
+    Entity entities[4] = { {0}, {1}, {2}, {3} };
+    EntitySlotList<Entity> list;
+    BOOST_CHECK(list.empty());
+
+    for(Entity& entity : entities)
+        BOOST_CHECK(list.add(&entity));
+
+    // An entity can only be added once
+    BOOST_CHECK(!list.add(&entities[2]));
+    BOOST_CHECK(list.size() == 4);
+    BOOST_CHECK(list.contains(&entities[3]));
+
+    // Removed entities leave an empty slot until the list is compacted
+    BOOST_CHECK(list.remove(&entities[1]));
+    BOOST_CHECK(!list.remove(&entities[1]));
+    BOOST_CHECK(!list.contains(&entities[1]));
+    BOOST_CHECK(list.size() == 3);
+    BOOST_CHECK(list.getSlots().size() == 4);
+    BOOST_CHECK(list.getSlots()[1] == nullptr);
+
+    std::vector<Entity*> expected = { &entities[0], &entities[2], &entities[3] };
+    BOOST_CHECK(listEntities(list) == expected);
+
+    // Not enough empty slots to compact
+    list.compact();
+    BOOST_CHECK(list.getSlots().size() == 4);
+
+    // Entities added again go at the end
+    BOOST_CHECK(list.add(&entities[1]));
+    expected = { &entities[0], &entities[2], &entities[3], &entities[1] };
+    BOOST_CHECK(listEntities(list) == expected);
+
+    BOOST_CHECK(list.remove(&entities[0]));
+    BOOST_CHECK(list.remove(&entities[3]));
+    BOOST_CHECK(list.remove(&entities[2]));
+    list.compact();
+    BOOST_CHECK(list.getSlots().size() == 1);
+    BOOST_CHECK(list.getSlots()[0] == &entities[1]);
+
+    // The indexes are still right after compacting
+    BOOST_CHECK(list.remove(&entities[1]));
+    BOOST_CHECK(list.empty());
+    list.compact();
+    BOOST_CHECK(list.getSlots().empty());
+
+    list.add(&entities[0]);
+    list.clear();
+    BOOST_CHECK(list.empty());
+    BOOST_CHECK(list.getSlots().empty());
+    BOOST_CHECK(!list.contains(&entities[0]));
+}
+
+BOOST_AUTO_TEST_CASE(test_entitySlotListOrder)
+{
+    // Adds and removes entities like the active objects are during a fight and checks the order is
+    // the same as with a vector
+    const uint32_t nbEntities = 500;
+    std::vector<Entity> entities(nbEntities);
+    for(uint32_t i = 0; i < nbEntities; ++i)
+        entities[i].mId = i;
+
+    std::vector<Entity*> vect;
+    EntitySlotList<Entity> list;
+    for(uint32_t turn = 0; turn < 200; ++turn)
+    {
+        for(uint32_t i = 0; i < 10; ++i)
+        {
+            Entity* entity = &entities[(turn * 37 + i * 101) % nbEntities];
+            auto it = std::find(vect.begin(), vect.end(), entity);
+            if(it == vect.end())
+            {
+                vect.push_back(entity);
+                BOOST_CHECK(list.add(entity));
+            }
+            else
+            {
+                vect.erase(it);
+                BOOST_CHECK(list.remove(entity));
+            }
+        }
+        list.compact();
+        BOOST_CHECK(list.getSlots().size() <= 2 * list.size());
+    }
+
+    BOOST_CHECK(listEntities(list) == vect);
+}
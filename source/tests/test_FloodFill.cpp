@@ -0,0 +1,141 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE FloodFill
+#include "BoostTestTargetConfig.h"
+
+#include "LegacyFloodFill.h"
+#include "LevelTiles.h"
+
+#include "gamemap/FloodFillLabeling.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(test_labelConnectedTiles)
+{
+    // 5x4 map given by rows so that passable[x * 4 + y] = rows[y][x]
+    const std::vector<std::string> rows = {
+        "..#..",
+        ".##.#",
+        "...#.",
+        "##.#."
+    };
+    std::vector<uint8_t> passable(20, 0);
+    for(int y = 0; y < 4; ++y)
+    {
+        for(int x = 0; x < 5; ++x)
+            passable[static_cast<uint32_t>(x * 4 + y)] = (rows[y][x] == '.') ? 1 : 0;
+    }
+
+    std::vector<uint32_t> labels;
+    uint32_t nbLabels = FloodFillLabeling::labelConnectedTiles(5, 4, passable, labels);
+    BOOST_CHECK(nbLabels == 3);
+    BOOST_CHECK(labels.size() == 20);
+    auto label = [&labels](int x, int y) { return labels[static_cast<uint32_t>(x * 4 + y)]; };
+    // Not passable tiles are not labelled
+    BOOST_CHECK(label(2, 0) == 0);
+    // The left area goes around the walls
+    BOOST_CHECK(label(0, 0) != 0);
+    BOOST_CHECK(label(0, 0) == label(1, 0));
+    BOOST_CHECK(label(0, 0) == label(2, 3));
+    // The top right area is reachable from the left area only through diagonals so it is different
+    BOOST_CHECK(label(3, 0) == label(4, 0));
+    BOOST_CHECK(label(3, 0) == label(3, 1));
+    BOOST_CHECK(label(3, 0) != label(0, 0));
+    BOOST_CHECK(label(4, 2) == label(4, 3));
+    BOOST_CHECK(label(4, 2) != label(3, 0));
+    BOOST_CHECK(label(4, 2) != label(0, 0));
+
+    // The parallel version gives the same result for each grid
+    std::vector<std::vector<uint8_t>> passables(3, passable);
+    passables[1].assign(20, 1);
+    std::vector<std::vector<uint32_t>> labelsParallel;
+    std::vector<uint32_t> nbLabelsParallel;
+    FloodFillLabeling::labelConnectedTilesParallel(5, 4, passables, labelsParallel, nbLabelsParallel);
+    BOOST_CHECK(nbLabelsParallel.size() == 3);
+    BOOST_CHECK(nbLabelsParallel[0] == 3);
+    BOOST_CHECK(nbLabelsParallel[1] == 1);
+    BOOST_CHECK(labelsParallel[0] == labels);
+    BOOST_CHECK(labelsParallel[2] == labels);
+}
+
+BOOST_AUTO_TEST_CASE(test_shippedLevels)
+{
+    // Compares the former initial floodfill with the labelling used now on the biggest shipped levels
+    const std::vector<std::string> levels = {
+        "multiplayer/TestBigMap.level",
+        "skirmish/TestLegacy.level",
+        "skirmish/StoneKeep.level",
+        "multiplayer/Angel.level",
+        "skirmish/DuelToDeath.level"
+    };
+
+    for(const std::string& levelName : levels)
+    {
+        Level level;
+        bool isLoaded = loadLevelTiles(levelName, level);
+        BOOST_CHECK_MESSAGE(isLoaded, "Cannot load level " + levelName);
+        if(!isLoaded)
+            continue;
+
+        std::vector<std::vector<uint8_t>> passables;
+        computePassables(level, passables);
+
+        LegacyFloodFill legacy(level);
+        legacy.run();
+
+        std::vector<std::vector<uint32_t>> labels(LegacyFloodFill::NB_TYPES);
+        for(uint32_t type = 0; type < LegacyFloodFill::NB_TYPES; ++type)
+            FloodFillLabeling::labelConnectedTiles(level.mSizeX, level.mSizeY, passables[type], labels[type]);
+
+        std::vector<std::vector<uint32_t>> labelsParallel;
+        std::vector<uint32_t> nbLabels;
+        FloodFillLabeling::labelConnectedTilesParallel(level.mSizeX, level.mSizeY, passables, labelsParallel, nbLabels);
+
+        BOOST_CHECK(labelsParallel == labels);
+
+        // A color from the former algorithm must never be given to 2 different areas. However, the former
+        // algorithm could give 2 colors to the same area if it was reached from 2 seeds (that happens on
+        // StoneKeep). That made pathExists wrongly return false, so we only check that the colors map
+        // to a single label
+        const std::vector<uint32_t>& legacyColors = legacy.getColors();
+        bool isSameAreas = true;
+        for(uint32_t type = 0; type < LegacyFloodFill::NB_TYPES; ++type)
+        {
+            std::map<uint32_t, uint32_t> legacyToLabel;
+            for(uint32_t index = 0; index < level.mTiles.size(); ++index)
+            {
+                uint32_t legacyColor = legacyColors[index * LegacyFloodFill::NB_TYPES + type];
+                uint32_t label = labels[type][index];
+                if((legacyColor == 0) != (label == 0))
+                {
+                    isSameAreas = false;
+                    continue;
+                }
+                if(label == 0)
+                    continue;
+
+                auto itLegacy = legacyToLabel.emplace(legacyColor, label).first;
+                if(itLegacy->second != label)
+                    isSameAreas = false;
+            }
+        }
+        BOOST_CHECK_MESSAGE(isSameAreas, "Different areas in level " + levelName);
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE LzCodec
+#include "BoostTestTargetConfig.h"
+
+#include "network/LzCodec.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+//! \brief Compresses the given buffer and checks it is uncompressed as it was. Returns the compressed size
+static uint32_t roundTrip(LzEncoder& encoder, LzDecoder& decoder, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> compressed;
+    encoder.compress(data.data(), static_cast<uint32_t>(data.size()), compressed);
+    std::vector<uint8_t> uncompressed;
+    BOOST_REQUIRE(decoder.uncompress(compressed.data(), static_cast<uint32_t>(compressed.size()),
+        static_cast<uint32_t>(data.size()), uncompressed));
+    BOOST_CHECK(uncompressed == data);
+    return static_cast<uint32_t>(compressed.size());
+}
+
+static std::vector<uint8_t> toBuffer(const std::string& text)
+{
+    return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+BOOST_AUTO_TEST_CASE(test_lzCodecRoundTrip)
+{
+    LzEncoder encoder;
+    LzDecoder decoder;
+
+    roundTrip(encoder, decoder, std::vector<uint8_t>());
+    roundTrip(encoder, decoder, toBuffer("a"));
+
+    // Repeated data is compressed, including matches overlapping the bytes they produce
+    std::vector<uint8_t> repeated(1000, 'x');
+    BOOST_CHECK(roundTrip(encoder, decoder, repeated) < 50);
+
+    // Random data cannot be compressed but should not grow much
+    std::mt19937 random(42);
+    std::vector<uint8_t> noise(5000);
+    for(uint8_t& byte : noise)
+        byte = static_cast<uint8_t>(random());
+    BOOST_CHECK(roundTrip(encoder, decoder, noise) <= noise.size() + noise.size() / 8 + 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_lzCodecStream)
+{
+    // A message similar to a previous one only takes a few bytes thanks to the stream dictionary
+    LzEncoder encoder;
+    LzDecoder decoder;
+    std::vector<uint8_t> message = toBuffer("refreshTiles Dirt_00000000.mesh Claimed_01010101.mesh Gold_11111111.mesh");
+    uint32_t firstSize = roundTrip(encoder, decoder, message);
+    uint32_t secondSize = roundTrip(encoder, decoder, message);
+    BOOST_CHECK(secondSize < firstSize);
+    BOOST_CHECK(secondSize <= 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_lzCodecLongStream)
+{
+    // Sends more data than the window so that the histories are trimmed on both sides
+    LzEncoder encoder;
+    LzDecoder decoder;
+    std::mt19937 random(7);
+    uint64_t nbBytes = 0;
+    uint64_t nbBytesCompressed = 0;
+    for(uint32_t i = 0; i < 400; ++i)
+    {
+        std::vector<uint8_t> data(200 + random() % 2000);
+        for(uint8_t& byte : data)
+            byte = static_cast<uint8_t>('a' + random() % 4);
+
+        nbBytes += data.size();
+        nbBytesCompressed += roundTrip(encoder, decoder, data);
+    }
+    BOOST_CHECK(nbBytes > 4 * LzCodec::WINDOW_SIZE);
+    BOOST_CHECK(nbBytesCompressed < nbBytes);
+}
+
+BOOST_AUTO_TEST_CASE(test_lzCodecInvalid)
+{
+    std::vector<uint8_t> uncompressed;
+
+    // Match referring to data before the beginning of the stream
+    LzDecoder decoder;
+    std::vector<uint8_t> invalidOffset = { 0x01, 0x10, 0x00, 0x00 };
+    BOOST_CHECK(!decoder.uncompress(invalidOffset.data(), static_cast<uint32_t>(invalidOffset.size()), 4, uncompressed));
+
+    // Wrong uncompressed size
+    LzEncoder encoder;
+    LzDecoder decoder2;
+    std::vector<uint8_t> data = toBuffer("some data");
+    std::vector<uint8_t> compressed;
+    encoder.compress(data.data(), static_cast<uint32_t>(data.size()), compressed);
+    BOOST_CHECK(!decoder2.uncompress(compressed.data(), static_cast<uint32_t>(compressed.size()), 5, uncompressed));
+
+    // Truncated match
+    LzDecoder decoder3;
+    std::vector<uint8_t> truncated = { 0x02, 'a', 0x00 };
+    BOOST_CHECK(!decoder3.uncompress(truncated.data(), static_cast<uint32_t>(truncated.size()), 5, uncompressed));
+}
@@ -53,4 +53,36 @@ BOOST_AUTO_TEST_CASE(test_ODPacket)
         BOOST_CHECK(inInt == outInt);
 
     }
+    //Test packets sent in one batch
+    {
+        ODPacket packet1;
+        const int32_t inInt = 0;
+        const std::string inString("test");
+        packet1 << inInt << inString;
+        ODPacket packet2;
+        const double inDouble = 3.5;
+        packet2 << inDouble;
+
+        ODPacket batch;
+        const uint32_t inNb = 2;
+        batch << inNb;
+        batch.appendPacket(packet1);
+        batch.appendPacket(packet2);
+
+        uint32_t outNb;
+        batch >> outNb;
+        BOOST_CHECK(outNb == inNb);
+        ODPacket outPacket;
+        BOOST_CHECK(batch.extractPacket(outPacket));
+        int32_t outInt = -1;
+        std::string outString;
+        outPacket >> outInt >> outString;
+        BOOST_CHECK(outInt == inInt);
+        BOOST_CHECK(outString.compare(inString) == 0);
+        BOOST_CHECK(batch.extractPacket(outPacket));
+        double outDouble = 0.0;
+        outPacket >> outDouble;
+        BOOST_CHECK(outDouble == inDouble);
+        BOOST_CHECK(!batch.extractPacket(outPacket));
+    }
 }
@@ -18,8 +18,15 @@
 #define BOOST_TEST_MODULE Random
 #include "BoostTestTargetConfig.h"
 
+#include "gamemap/AstarNodePool.h"
+#include "gamemap/DistanceFieldCache.h"
+#include "gamemap/FloodFillAliases.h"
+#include "gamemap/PathClusterGraph.h"
 #include "gamemap/Pathfinding.h"
 
+#include <string>
+#include <vector>
+
 struct Point
 {
     int x;
@@ -39,3 +46,247 @@ BOOST_AUTO_TEST_CASE(test_Pathfinding)
     BOOST_CHECK((Pathfinding::distanceTile(a, b) - std::sqrt(128.0f)) < 0.0001f);
     BOOST_CHECK(Pathfinding::squaredDistance(9,1,1,9) == 128);
 }
+
+BOOST_AUTO_TEST_CASE(test_AstarNodePool)
+{
+    AstarNodePool pool;
+    pool.startSearch(3, 4);
+    uint32_t index = pool.getIndex(2, 3);
+    BOOST_CHECK(pool.getX(index) == 2);
+    BOOST_CHECK(pool.getY(index) == 3);
+
+    // Nodes with the same cost are popped in insertion order
+    pool.pushOpen(pool.getIndex(0, 0), 1.0, 2.0, AstarNodePool::NO_NODE);
+    pool.pushOpen(pool.getIndex(1, 0), 2.0, 1.0, pool.getIndex(0, 0));
+    pool.pushOpen(pool.getIndex(2, 0), 0.5, 1.0, pool.getIndex(0, 0));
+    pool.pushOpen(pool.getIndex(0, 1), 3.0, 0.0, pool.getIndex(0, 0));
+    BOOST_CHECK(pool.isOpen(pool.getIndex(1, 0)));
+    BOOST_CHECK(!pool.isClosed(pool.getIndex(1, 0)));
+
+    BOOST_CHECK(pool.popOpen() == pool.getIndex(2, 0));
+    BOOST_CHECK(pool.isClosed(pool.getIndex(2, 0)));
+
+    // Decreasing the cost moves the node before the others and changes its parent
+    pool.decreaseG(pool.getIndex(0, 1), 1.0, pool.getIndex(2, 0));
+    BOOST_CHECK(pool.popOpen() == pool.getIndex(0, 1));
+    BOOST_CHECK(pool.getParent(pool.getIndex(0, 1)) == pool.getIndex(2, 0));
+    BOOST_CHECK(pool.popOpen() == pool.getIndex(0, 0));
+    BOOST_CHECK(pool.popOpen() == pool.getIndex(1, 0));
+    BOOST_CHECK(pool.isOpenEmpty());
+
+    // Destinations are only marked for the current search
+    pool.setGoal(pool.getIndex(1, 2));
+    BOOST_CHECK(pool.isGoal(pool.getIndex(1, 2)));
+    BOOST_CHECK(!pool.isGoal(pool.getIndex(2, 1)));
+
+    // A new search forgets the previous one
+    pool.startSearch(3, 4);
+    BOOST_CHECK(!pool.isClosed(pool.getIndex(2, 0)));
+    BOOST_CHECK(!pool.isOpen(pool.getIndex(2, 0)));
+    BOOST_CHECK(!pool.isGoal(pool.getIndex(1, 2)));
+}
+
+BOOST_AUTO_TEST_CASE(test_PathClusterGraph)
+{
+    // 12x8 map with 4x4 clusters. The wall at x = 5 can only be crossed at y = 7. The map
+    // is given by rows so it is accessed with map[y][x]
+    std::vector<std::string> map = {
+        ".....#......",
+        ".....#......",
+        ".....#......",
+        ".....#......",
+        ".....#......",
+        ".....#......",
+        ".....#......",
+        "............"
+    };
+    PathClusterGraph graph;
+    graph.setup(12, 8, 4, 1, [&map](int x, int y, uint32_t)
+        {
+            return map[y][x] == '.';
+        });
+    BOOST_CHECK(graph.isEnabled());
+
+    std::vector<std::pair<int, int>> waypoints;
+    BOOST_CHECK(graph.findPath(0, 0, 11, 0, 0, waypoints));
+    BOOST_CHECK(waypoints.front() == std::make_pair(0, 0));
+    BOOST_CHECK(waypoints.back() == std::make_pair(11, 0));
+    // The path has to go through the clusters with the hole in the wall
+    bool isHoleUsed = false;
+    for(const std::pair<int, int>& waypoint : waypoints)
+    {
+        if(waypoint.second >= 4)
+            isHoleUsed = true;
+    }
+    BOOST_CHECK(isHoleUsed);
+    uint32_t nbClustersComputed = graph.getNbClustersComputed();
+    BOOST_CHECK(nbClustersComputed == 6);
+
+    // Closing the hole makes the goal unreachable. Only the clusters around the changed tile are repaired
+    map[7][5] = '#';
+    graph.markTileChanged(5, 7);
+    BOOST_CHECK(!graph.findPath(0, 0, 11, 0, 0, waypoints));
+    BOOST_CHECK(waypoints.empty());
+    BOOST_CHECK(graph.getNbClustersComputed() == nbClustersComputed + 4);
+
+    // Opening another hole
+    map[2][5] = '.';
+    graph.markTileChanged(5, 2);
+    BOOST_CHECK(graph.findPath(0, 0, 11, 0, 0, waypoints));
+
+    // A not passable goal cannot be reached
+    BOOST_CHECK(!graph.findPath(0, 0, 5, 5, 0, waypoints));
+
+    graph.clear();
+    BOOST_CHECK(!graph.isEnabled());
+    BOOST_CHECK(!graph.findPath(0, 0, 11, 0, 0, waypoints));
+}
+
+BOOST_AUTO_TEST_CASE(test_FloodFillAliases)
+{
+    FloodFillAliases aliases;
+    // Colors never merged are not changed
+    BOOST_CHECK(aliases.resolve(0, 5) == 5);
+    BOOST_CHECK(aliases.resolve(3, 0) == 0);
+
+    aliases.merge(0, 1, 2);
+    aliases.merge(0, 3, 4);
+    BOOST_CHECK(aliases.resolve(0, 1) == 2);
+    BOOST_CHECK(aliases.resolve(0, 3) == 4);
+
+    // Merging aliases merges the whole areas and the new color is kept
+    aliases.merge(0, 1, 3);
+    BOOST_CHECK(aliases.resolve(0, 1) == 4);
+    BOOST_CHECK(aliases.resolve(0, 2) == 4);
+    BOOST_CHECK(aliases.resolve(0, 4) == 4);
+    aliases.merge(0, 4, 10);
+    BOOST_CHECK(aliases.resolve(0, 1) == 10);
+    BOOST_CHECK(aliases.resolve(0, 10) == 10);
+
+    // Merging colors already merged does nothing
+    aliases.merge(0, 2, 1);
+    BOOST_CHECK(aliases.resolve(0, 2) == 10);
+
+    // Teams are independent and no color can be merged with 0
+    BOOST_CHECK(aliases.resolve(1, 1) == 1);
+    aliases.merge(1, 1, 0);
+    BOOST_CHECK(aliases.resolve(1, 1) == 1);
+
+    // Flattening does not change the resolved colors
+    aliases.merge(0, 20, 21);
+    aliases.merge(0, 21, 22);
+    aliases.flatten();
+    BOOST_CHECK(aliases.resolve(0, 1) == 10);
+    BOOST_CHECK(aliases.resolve(0, 3) == 10);
+    BOOST_CHECK(aliases.resolve(0, 20) == 22);
+    BOOST_CHECK(aliases.resolve(0, 15) == 15);
+
+    aliases.clear();
+    BOOST_CHECK(aliases.resolve(0, 1) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_DistanceFieldCache)
+{
+    // 6x4 map given by rows (map[y][x]). The target is the tile at (5, 0)
+    std::vector<std::string> map = {
+        "..#...",
+        "..#.#.",
+        "..#.#.",
+        "......"
+    };
+    auto passability = [&map](int x, int y)
+        {
+            return map[y][x] == '.';
+        };
+    DistanceFieldCache cache;
+    cache.setup(6, 4, 2);
+    std::vector<uint32_t> targetTiles = {5 * 4 + 0};
+    const std::vector<uint32_t>& field = cache.getField(0, 0, "Temple", targetTiles, passability);
+    BOOST_CHECK(field[5 * 4 + 0] == 0);
+    BOOST_CHECK(field[2 * 4 + 0] == DistanceFieldCache::UNREACHABLE);
+    // From (0, 0), we have to go down, cross at y = 3 and go up again
+    BOOST_CHECK(field[0 * 4 + 0] == 11);
+
+    std::vector<uint32_t> path;
+    BOOST_CHECK(cache.followField(field, 0, 0, path));
+    BOOST_CHECK(path.front() == 0 * 4 + 0);
+    BOOST_CHECK(path.back() == 5 * 4 + 0);
+    // Diagonals are used when possible so the path is shorter than the distance
+    BOOST_CHECK(path.size() < 12);
+    for(uint32_t i = 1; i < path.size(); ++i)
+    {
+        int dx = std::abs(static_cast<int>(path[i] / 4) - static_cast<int>(path[i - 1] / 4));
+        int dy = std::abs(static_cast<int>(path[i] % 4) - static_cast<int>(path[i - 1] % 4));
+        BOOST_CHECK((dx <= 1) && (dy <= 1));
+    }
+
+    // The field is cached until a tile it reaches changes
+    cache.getField(0, 0, "Temple", targetTiles, passability);
+    BOOST_CHECK(cache.getNbFieldsComputed() == 1);
+    map[0][2] = '.';
+    cache.markTileChanged(2, 0);
+    const std::vector<uint32_t>& fieldOpened = cache.getField(0, 0, "Temple", targetTiles, passability);
+    BOOST_CHECK(cache.getNbFieldsComputed() == 2);
+    BOOST_CHECK(fieldOpened[0 * 4 + 0] == 5);
+
+    // Other seats or layers have their own fields. The least recently used one is dropped
+    cache.getField(1, 0, "Temple", targetTiles, passability);
+    cache.getField(0, 1, "Temple", targetTiles, passability);
+    BOOST_CHECK(cache.getNbFieldsComputed() == 4);
+    cache.getField(0, 1, "Temple", targetTiles, passability);
+    BOOST_CHECK(cache.getNbFieldsComputed() == 4);
+    cache.getField(0, 0, "Temple", targetTiles, passability);
+    BOOST_CHECK(cache.getNbFieldsComputed() == 5);
+
+    // A tile that is not reached by the field (or next to a reached tile) does not invalidate it
+    cache.setup(6, 4, 2);
+    auto passabilityRight = [&map](int x, int y)
+        {
+            return (x >= 3) && (map[y][x] == '.');
+        };
+    cache.getField(0, 0, "Temple", targetTiles, passabilityRight);
+    cache.markTileChanged(0, 0);
+    cache.getField(0, 0, "Temple", targetTiles, passabilityRight);
+    BOOST_CHECK(cache.getNbFieldsComputed() == 1);
+    BOOST_CHECK(!cache.followField(cache.getField(0, 0, "Temple", targetTiles, passabilityRight), 0, 0, path));
+}
+
+BOOST_AUTO_TEST_CASE(test_DistanceFieldClosedEnemyDoor)
+{
+    // 5x3 map given by rows (map[y][x]). A closed door 'D' is the only way from the creature at (0, 0)
+    // to its room at (4, 0). Like GameMap::pathToBuilding, creatures fighting or fleeing use their own layer
+    const std::vector<std::string> map = {
+        "..D..",
+        "#####",
+        "#####"
+    };
+    auto passability = [&map](int x, int y, bool isAlliedToDoor, bool isFightingOrFleeing)
+        {
+            if(map[y][x] == 'D')
+                return Pathfinding::isClosedDoorPassable(isAlliedToDoor, isFightingOrFleeing);
+
+            return map[y][x] == '.';
+        };
+    DistanceFieldCache cache;
+    cache.setup(5, 3, 4);
+    std::vector<uint32_t> targetTiles = {4 * 3 + 0};
+    std::vector<uint32_t> path;
+
+    // An enemy creature walking can go through the door
+    const std::vector<uint32_t>& fieldWalking = cache.getField(0, 0, "Temple", targetTiles,
+        [&passability](int x, int y) { return passability(x, y, false, false); });
+    BOOST_CHECK(cache.followField(fieldWalking, 0, 0, path));
+    BOOST_CHECK(path.back() == 4 * 3 + 0);
+
+    // A fleeing enemy creature cannot. It should not be given a path through the door
+    const std::vector<uint32_t>& fieldFleeing = cache.getField(0, 1, "Temple", targetTiles,
+        [&passability](int x, int y) { return passability(x, y, false, true); });
+    BOOST_CHECK(fieldFleeing[0 * 3 + 0] == DistanceFieldCache::UNREACHABLE);
+    BOOST_CHECK(!cache.followField(fieldFleeing, 0, 0, path));
+
+    // Allied creatures cannot go through a closed door
+    const std::vector<uint32_t>& fieldAllied = cache.getField(1, 0, "Temple", targetTiles,
+        [&passability](int x, int y) { return passability(x, y, true, false); });
+    BOOST_CHECK(!cache.followField(fieldAllied, 0, 0, path));
+    BOOST_CHECK(cache.getNbFieldsComputed() == 3);
+}
@@ -0,0 +1,191 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE ReplayFile
+#include "BoostTestTargetConfig.h"
+
+#include "network/ODPacket.h"
+#include "network/ReplayFile.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+const std::string REPLAY_TEST_FILE = "test_ReplayFile.odr";
+const int64_t NB_TURNS = 35;
+const uint32_t NB_PACKETS_PER_TURN = 4;
+
+//! \brief Writes a replay with NB_TURNS turns. Each one has NB_PACKETS_PER_TURN packets, 200 ms apart
+static void writeReplay(ReplayWriter& writer)
+{
+    int32_t timestamp = 0;
+    for(int64_t turn = 0; turn < NB_TURNS; ++turn)
+    {
+        for(uint32_t i = 0; i < NB_PACKETS_PER_TURN; ++i)
+        {
+            ODPacket packet;
+            packet << turn << i << std::string("refreshTiles Dirt_00000000.mesh");
+            writer.writePacket(timestamp, packet);
+            timestamp += 200;
+            if(i == 0)
+                writer.notifyTurnStarted(turn);
+        }
+    }
+}
+
+//! \brief Reads the packets written by writeReplay
+static void checkReplayPackets(ReplayReader& reader)
+{
+    int32_t expectedTimestamp = 0;
+    for(int64_t turn = 0; turn < NB_TURNS; ++turn)
+    {
+        for(uint32_t i = 0; i < NB_PACKETS_PER_TURN; ++i)
+        {
+            ODPacket packet;
+            BOOST_REQUIRE(reader.readPacket(packet) == expectedTimestamp);
+            int64_t packetTurn;
+            uint32_t packetIndex;
+            std::string text;
+            BOOST_REQUIRE(packet >> packetTurn >> packetIndex >> text);
+            BOOST_CHECK(packetTurn == turn);
+            BOOST_CHECK(packetIndex == i);
+            expectedTimestamp += 200;
+        }
+    }
+    ODPacket packet;
+    BOOST_CHECK(reader.readPacket(packet) == -1);
+}
+
+static void checkReplayIndex(ReplayReader& reader)
+{
+    const std::vector<ReplayTurnIndex>& turns = reader.getTurnIndex();
+    BOOST_REQUIRE(turns.size() == static_cast<uint32_t>(NB_TURNS));
+    for(int64_t turn = 0; turn < NB_TURNS; ++turn)
+    {
+        BOOST_CHECK(turns[turn].mTurn == turn);
+        BOOST_CHECK(reader.getTurnTimestamp(turn) == static_cast<int32_t>(turn * NB_PACKETS_PER_TURN * 200));
+    }
+    BOOST_CHECK(reader.getTurnTimestamp(NB_TURNS) == -1);
+
+    // The turns are split in several chunks
+    BOOST_CHECK(turns.front().mChunkOffset != turns.back().mChunkOffset);
+}
+
+BOOST_AUTO_TEST_CASE(test_replayFile)
+{
+    ReplayWriter writer;
+    BOOST_REQUIRE(writer.open(REPLAY_TEST_FILE));
+    writeReplay(writer);
+    writer.close();
+
+    ReplayReader reader;
+    BOOST_REQUIRE(reader.open(REPLAY_TEST_FILE));
+    checkReplayIndex(reader);
+    checkReplayPackets(reader);
+    reader.close();
+
+    // Uncompressed replays can be read the same way but they are bigger
+    std::ifstream compressedFile(REPLAY_TEST_FILE, std::ios::binary | std::ios::ate);
+    std::streamoff compressedSize = compressedFile.tellg();
+    compressedFile.close();
+
+    BOOST_REQUIRE(writer.open(REPLAY_TEST_FILE, false));
+    writeReplay(writer);
+    writer.close();
+
+    std::ifstream uncompressedFile(REPLAY_TEST_FILE, std::ios::binary | std::ios::ate);
+    BOOST_CHECK(compressedSize * 2 < uncompressedFile.tellg());
+    uncompressedFile.close();
+
+    BOOST_REQUIRE(reader.open(REPLAY_TEST_FILE));
+    checkReplayIndex(reader);
+    checkReplayPackets(reader);
+    reader.close();
+
+    std::remove(REPLAY_TEST_FILE.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_replayFileWithoutIndex)
+{
+    // If the game stops before the replay is closed, the index is rebuilt from the chunks written
+    std::vector<char> content;
+    {
+        ReplayWriter writer;
+        BOOST_REQUIRE(writer.open(REPLAY_TEST_FILE));
+        writeReplay(writer);
+        writer.close();
+        std::ifstream is(REPLAY_TEST_FILE, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
+
+    // We remove the index (and a part of the last chunk)
+    ReplayReader reader;
+    BOOST_REQUIRE(reader.open(REPLAY_TEST_FILE));
+    uint64_t lastChunkOffset = reader.getTurnIndex().back().mChunkOffset;
+    reader.close();
+    {
+        std::ofstream os(REPLAY_TEST_FILE, std::ios::binary | std::ios::trunc);
+        os.write(content.data(), lastChunkOffset + 10);
+    }
+
+    BOOST_REQUIRE(reader.open(REPLAY_TEST_FILE));
+    const std::vector<ReplayTurnIndex>& turns = reader.getTurnIndex();
+    BOOST_REQUIRE(!turns.empty());
+    BOOST_CHECK(turns.size() < static_cast<uint32_t>(NB_TURNS));
+    int32_t nbPackets = 0;
+    ODPacket packet;
+    while(reader.readPacket(packet) >= 0)
+        ++nbPackets;
+    // The chunks end with the packet starting their last turn
+    BOOST_CHECK(nbPackets == static_cast<int32_t>((turns.size() - 1) * NB_PACKETS_PER_TURN + 1));
+    reader.close();
+
+    std::remove(REPLAY_TEST_FILE.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(test_replayFileLegacy)
+{
+    // Replays written before the chunks are read packet by packet
+    {
+        std::ofstream os(REPLAY_TEST_FILE, std::ios::binary);
+        for(int32_t i = 0; i < 3; ++i)
+        {
+            ODPacket packet;
+            packet << i;
+            packet.writePacket(i * 100, os);
+        }
+    }
+
+    ReplayReader reader;
+    BOOST_REQUIRE(reader.open(REPLAY_TEST_FILE));
+    BOOST_CHECK(reader.getTurnIndex().empty());
+    for(int32_t i = 0; i < 3; ++i)
+    {
+        ODPacket packet;
+        BOOST_REQUIRE(reader.readPacket(packet) == i * 100);
+        int32_t value;
+        BOOST_REQUIRE(packet >> value);
+        BOOST_CHECK(value == i);
+    }
+    ODPacket packet;
+    BOOST_CHECK(reader.readPacket(packet) == -1);
+    reader.close();
+
+    std::remove(REPLAY_TEST_FILE.c_str());
+}
@@ -0,0 +1,154 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE ShadowCasting
+#include "BoostTestTargetConfig.h"
+
+#include "ShadowCastingGrid.h"
+
+#include "gamemap/ShadowCastingTable.h"
+
+#include <cstdlib>
+#include <set>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(test_tableByRadius)
+{
+    ShadowCastingTable table;
+    table.build(10);
+    BOOST_CHECK(table.getRadiusComputed() == 10);
+    // Asking a smaller radius does not rebuild the table
+    table.build(5);
+    BOOST_CHECK(table.getRadiusComputed() == 10);
+
+    // Entries are sorted by distance and the counts per radius are consistent with it
+    const std::vector<ShadowCastingTable::Entry>& entries = table.getEntries();
+    BOOST_CHECK(table.getNbEntries(0) == 1);
+    BOOST_CHECK(entries[0].mDistSquared == 0);
+    for(int radius = 1; radius <= 10; ++radius)
+    {
+        uint32_t nbEntries = table.getNbEntries(radius);
+        BOOST_CHECK(nbEntries > table.getNbEntries(radius - 1));
+        BOOST_CHECK(entries[nbEntries - 1].mDistSquared <= radius * radius);
+        if(nbEntries < entries.size())
+            BOOST_CHECK(entries[nbEntries].mDistSquared > radius * radius);
+    }
+    // Bigger radius are clamped
+    BOOST_CHECK(table.getNbEntries(20) == table.getNbEntries(10));
+}
+
+BOOST_AUTO_TEST_CASE(test_visibleWithoutWalls)
+{
+    ShadowCastingTable table;
+    table.build(6);
+    Grid grid(20, 20);
+    std::vector<const Cell*> cells;
+    std::vector<ShadowCastingTable::ProcessState<const Cell*>> states;
+    grid.visibleCells(table, 10, 10, 6, cells, states);
+
+    // Every cell within the radius is there once, from the closest to the furthest
+    std::set<const Cell*> uniqueCells(cells.begin(), cells.end());
+    BOOST_CHECK(uniqueCells.size() == cells.size());
+    uint32_t nbExpected = 0;
+    for(const Cell& cell : grid.mCells)
+    {
+        int distSquared = (cell.mX - 10) * (cell.mX - 10) + (cell.mY - 10) * (cell.mY - 10);
+        if(distSquared <= 36)
+            ++nbExpected;
+    }
+    BOOST_CHECK(cells.size() == nbExpected);
+    BOOST_CHECK(cells[0] == grid.getCell(10, 10));
+    int lastDistSquared = 0;
+    for(const Cell* cell : cells)
+    {
+        int distSquared = (cell->mX - 10) * (cell->mX - 10) + (cell->mY - 10) * (cell->mY - 10);
+        BOOST_CHECK(distSquared >= lastDistSquared);
+        lastDistSquared = distSquared;
+    }
+
+    // Cells out of the grid are skipped
+    grid.visibleCells(table, 0, 0, 6, cells, states);
+    for(const Cell* cell : cells)
+        BOOST_CHECK(cell != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(test_visibleWithWalls)
+{
+    ShadowCastingTable table;
+    table.build(8);
+    Grid grid(20, 20);
+    // Wall on the column x = 12 from y = 5 to 15
+    for(int y = 5; y <= 15; ++y)
+        grid.setOpaque(12, y);
+
+    std::vector<const Cell*> cells;
+    std::vector<ShadowCastingTable::ProcessState<const Cell*>> states;
+    grid.visibleCells(table, 10, 10, 8, cells, states);
+    std::set<const Cell*> visible(cells.begin(), cells.end());
+    // The wall itself is visible but not what is behind
+    BOOST_CHECK(visible.count(grid.getCell(12, 10)) == 1);
+    BOOST_CHECK(visible.count(grid.getCell(13, 10)) == 0);
+    BOOST_CHECK(visible.count(grid.getCell(16, 11)) == 0);
+    // The other directions are not hidden
+    BOOST_CHECK(visible.count(grid.getCell(4, 10)) == 1);
+    BOOST_CHECK(visible.count(grid.getCell(10, 3)) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_visibleLikeLegacy)
+{
+    // Compares the former visibleTiles (8 vectors allocated at each call) with the version reusing its buffers on a
+    // random map. Results must be the same
+    const int sizeX = 100;
+    const int sizeY = 100;
+    const int radius = 15;
+    Grid grid(sizeX, sizeY);
+    std::srand(42);
+    for(int x = 0; x < sizeX; ++x)
+    {
+        for(int y = 0; y < sizeY; ++y)
+        {
+            if((std::rand() % 4) == 0)
+                grid.setOpaque(x, y);
+        }
+    }
+
+    ShadowCastingTable table;
+    table.build(radius);
+
+    std::vector<std::pair<int, int>> centers;
+    for(int i = 0; i < 2000; ++i)
+        centers.push_back(std::make_pair(std::rand() % sizeX, std::rand() % sizeY));
+
+    std::vector<const Cell*> cells;
+    std::vector<ShadowCastingTable::ProcessState<const Cell*>> states;
+    bool isSame = true;
+    for(const std::pair<int, int>& center : centers)
+    {
+        grid.visibleCells(table, center.first, center.second, radius, cells, states);
+        if(cells != legacyVisibleCells(table, grid, center.first, center.second, radius))
+            isSame = false;
+    }
+    BOOST_CHECK(isSame);
+
+    // Smaller radius than the table one give the same result too
+    for(uint32_t i = 0; i < 100; ++i)
+    {
+        grid.visibleCells(table, centers[i].first, centers[i].second, 7, cells, states);
+        BOOST_CHECK(cells == legacyVisibleCells(table, grid, centers[i].first, centers[i].second, 7));
+    }
+}
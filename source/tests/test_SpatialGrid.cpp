@@ -0,0 +1,77 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE SpatialGrid
+#include "BoostTestTargetConfig.h"
+
+#include "gamemap/SpatialGrid.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+std::vector<int> elementsInRect(const SpatialGrid<int>& grid, int xMin, int yMin, int xMax, int yMax)
+{
+    std::vector<int> elements;
+    grid.forEachInRect(xMin, yMin, xMax, yMax, [&elements](int element, int, int)
+    {
+        elements.push_back(element);
+    });
+    std::sort(elements.begin(), elements.end());
+    return elements;
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_spatialGrid)
+{
+    SpatialGrid<int> grid;
+    grid.reset(50, 30);
+    grid.add(1, 0, 0);
+    grid.add(2, 7, 7);
+    grid.add(3, 8, 8);
+    grid.add(4, 49, 29);
+    // Out of the map
+    grid.add(5, 50, 0);
+    grid.add(6, -1, 0);
+    BOOST_CHECK(grid.getNbEntries() == 4);
+
+    BOOST_CHECK(elementsInRect(grid, 0, 0, 49, 29) == std::vector<int>({1, 2, 3, 4}));
+    // Elements in the same cell but out of the rectangle are not given
+    BOOST_CHECK(elementsInRect(grid, 1, 1, 7, 7) == std::vector<int>({2}));
+    BOOST_CHECK(elementsInRect(grid, 7, 7, 8, 8) == std::vector<int>({2, 3}));
+    // Rectangles partially out of the map
+    BOOST_CHECK(elementsInRect(grid, -10, -10, 3, 3) == std::vector<int>({1}));
+    BOOST_CHECK(elementsInRect(grid, 45, 25, 60, 60) == std::vector<int>({4}));
+    BOOST_CHECK(elementsInRect(grid, 60, 60, 70, 70).empty());
+
+    // An element on several tiles is given once per tile
+    grid.add(7, 20, 20);
+    grid.add(7, 21, 20);
+    BOOST_CHECK(elementsInRect(grid, 16, 16, 23, 23) == std::vector<int>({7, 7}));
+
+    // An element is only removed from the given tile
+    BOOST_CHECK(grid.remove(7, 20, 20));
+    BOOST_CHECK(!grid.remove(7, 20, 20));
+    BOOST_CHECK(!grid.remove(3, 7, 7));
+    BOOST_CHECK(elementsInRect(grid, 16, 16, 23, 23) == std::vector<int>({7}));
+    BOOST_CHECK(grid.getNbEntries() == 5);
+
+    grid.clear();
+    BOOST_CHECK(grid.getNbEntries() == 0);
+    BOOST_CHECK(elementsInRect(grid, 0, 0, 49, 29).empty());
+}
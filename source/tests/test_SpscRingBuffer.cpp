@@ -0,0 +1,93 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE SpscRingBuffer
+#include "BoostTestTargetConfig.h"
+
+#include "utils/SpscRingBuffer.h"
+
+#include <cstdint>
+#include <thread>
+
+BOOST_AUTO_TEST_CASE(test_spscRingBuffer)
+{
+    SpscRingBuffer<int> buffer(3);
+    BOOST_CHECK(buffer.getCapacity() == 3);
+    BOOST_CHECK(buffer.front() == nullptr);
+    BOOST_CHECK(buffer.size() == 0);
+
+    BOOST_CHECK(buffer.push(1));
+    BOOST_CHECK(buffer.push(2));
+    BOOST_CHECK(buffer.push(3));
+    // The buffer is full
+    BOOST_CHECK(!buffer.push(4));
+    BOOST_CHECK(buffer.size() == 3);
+
+    BOOST_CHECK(*buffer.front() == 1);
+    buffer.pop();
+    BOOST_CHECK(*buffer.front() == 2);
+
+    // Once an element is popped, there is room again. The order is kept when indexes wrap around
+    BOOST_CHECK(buffer.push(4));
+    BOOST_CHECK(buffer.size() == 3);
+    for(int expected = 2; expected <= 4; ++expected)
+    {
+        int* value = buffer.front();
+        BOOST_REQUIRE(value != nullptr);
+        BOOST_CHECK(*value == expected);
+        buffer.pop();
+    }
+    BOOST_CHECK(buffer.front() == nullptr);
+    BOOST_CHECK(buffer.size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_spscRingBufferThreads)
+{
+    // The consumer thread should receive every value, in order
+    const uint32_t nbValues = 100000;
+    SpscRingBuffer<uint32_t> buffer(64);
+    bool isOrderOk = true;
+    std::thread consumer([&buffer, &isOrderOk, nbValues]()
+    {
+        uint32_t expected = 0;
+        while(expected < nbValues)
+        {
+            uint32_t* value = buffer.front();
+            if(value == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            if(*value != expected)
+                isOrderOk = false;
+
+            buffer.pop();
+            ++expected;
+        }
+    });
+
+    for(uint32_t i = 0; i < nbValues; ++i)
+    {
+        while(!buffer.push(i))
+            std::this_thread::yield();
+    }
+
+    consumer.join();
+    BOOST_CHECK(isOrderOk);
+    BOOST_CHECK(buffer.front() == nullptr);
+}
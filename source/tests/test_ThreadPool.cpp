@@ -0,0 +1,69 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE ThreadPool
+#include "BoostTestTargetConfig.h"
+
+#include "utils/ThreadPool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(test_threadPoolParallelFor)
+{
+    // Every task should be run exactly once, whatever the batch size and the number of workers
+    for(uint32_t nbWorkers : {0u, 1u, 3u})
+    {
+        ThreadPool pool(nbWorkers);
+        BOOST_CHECK(pool.getNbWorkers() == nbWorkers);
+        for(uint32_t batchSize : {0u, 1u, 7u, 1000u})
+        {
+            const uint32_t nbTasks = 500;
+            std::vector<uint32_t> counts(nbTasks, 0);
+            pool.parallelFor(nbTasks, batchSize, [&counts](uint32_t index)
+            {
+                ++counts[index];
+            });
+
+            for(uint32_t index = 0; index < nbTasks; ++index)
+                BOOST_CHECK(counts[index] == 1);
+        }
+
+        // Nothing to do
+        pool.parallelFor(0, 1, [](uint32_t)
+        {
+            BOOST_ERROR("No task should be run");
+        });
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_threadPoolReuse)
+{
+    // The pool can be used many times in a row and every job is finished when parallelFor returns
+    ThreadPool pool(3);
+    std::atomic<uint32_t> total(0);
+    for(uint32_t job = 0; job < 200; ++job)
+    {
+        uint32_t before = total.load();
+        pool.parallelFor(64, 4, [&total](uint32_t index)
+        {
+            total.fetch_add(index, std::memory_order_relaxed);
+        });
+        BOOST_CHECK(total.load() == before + (63 * 64) / 2);
+    }
+}
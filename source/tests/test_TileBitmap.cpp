@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE TileBitmap
+#include "BoostTestTargetConfig.h"
+
+#include "gamemap/TileBitmap.h"
+
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_CASE(test_setAndTest)
+{
+    // 130 columns so that rows use several words
+    TileBitmap bitmap;
+    bitmap.reset(0, 0, 3, 130);
+    BOOST_CHECK(bitmap.count() == 0);
+    bitmap.set(0, 0);
+    bitmap.set(1, 63);
+    bitmap.set(1, 64);
+    bitmap.set(2, 129);
+    // Out of the area
+    bitmap.set(3, 0);
+    bitmap.set(-1, 0);
+    bitmap.set(0, 130);
+    BOOST_CHECK(bitmap.count() == 4);
+    BOOST_CHECK(bitmap.test(0, 0));
+    BOOST_CHECK(bitmap.test(1, 63));
+    BOOST_CHECK(bitmap.test(1, 64));
+    BOOST_CHECK(bitmap.test(2, 129));
+    BOOST_CHECK(!bitmap.test(0, 1));
+    BOOST_CHECK(!bitmap.test(2, 64));
+    BOOST_CHECK(!bitmap.test(3, 0));
+    BOOST_CHECK(!bitmap.test(0, 130));
+
+    bitmap.unset(1, 63);
+    BOOST_CHECK(!bitmap.test(1, 63));
+    BOOST_CHECK(bitmap.test(1, 64));
+
+    std::vector<std::pair<int, int>> tiles;
+    bitmap.forEachSet([&tiles](int x, int y) { tiles.push_back(std::make_pair(x, y)); });
+    BOOST_CHECK(tiles.size() == 3);
+    BOOST_CHECK(tiles[0] == std::make_pair(0, 0));
+    BOOST_CHECK(tiles[1] == std::make_pair(1, 64));
+    BOOST_CHECK(tiles[2] == std::make_pair(2, 129));
+
+    bitmap.clearAll();
+    BOOST_CHECK(bitmap.count() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_origin)
+{
+    // Local bitmap like the ones used around creatures
+    TileBitmap bitmap;
+    bitmap.reset(10, 20, 5, 5);
+    bitmap.set(10, 20);
+    bitmap.set(14, 24);
+    bitmap.set(9, 20);
+    BOOST_CHECK(bitmap.count() == 2);
+    BOOST_CHECK(bitmap.test(10, 20));
+    BOOST_CHECK(bitmap.test(14, 24));
+    BOOST_CHECK(!bitmap.test(0, 0));
+
+    std::vector<std::pair<int, int>> tiles;
+    bitmap.forEachSet([&tiles](int x, int y) { tiles.push_back(std::make_pair(x, y)); });
+    BOOST_CHECK(tiles.size() == 2);
+    BOOST_CHECK(tiles[0] == std::make_pair(10, 20));
+    BOOST_CHECK(tiles[1] == std::make_pair(14, 24));
+}
+
+BOOST_AUTO_TEST_CASE(test_gainedAndLost)
+{
+    TileBitmap last;
+    TileBitmap current;
+    last.reset(0, 0, 4, 100);
+    current.reset(0, 0, 4, 100);
+    last.set(0, 0);
+    last.set(1, 70);
+    current.set(1, 70);
+    current.set(3, 99);
+
+    TileBitmap gained;
+    TileBitmap lost;
+    TileBitmap::andNot(current, last, gained);
+    TileBitmap::andNot(last, current, lost);
+    BOOST_CHECK(gained.isSameArea(current));
+    BOOST_CHECK(gained.count() == 1);
+    BOOST_CHECK(gained.test(3, 99));
+    BOOST_CHECK(lost.count() == 1);
+    BOOST_CHECK(lost.test(0, 0));
+
+    last.orWith(current);
+    BOOST_CHECK(last.count() == 3);
+
+    // Copying keeps the area and the bits
+    last = current;
+    TileBitmap::andNot(current, last, gained);
+    BOOST_CHECK(gained.count() == 0);
+}
@@ -0,0 +1,309 @@
+/*
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define BOOST_TEST_MODULE TilePacket
+#include "BoostTestTargetConfig.h"
+
+#include "LevelTiles.h"
+
+#include "entities/TileVisual.h"
+#include "network/ODPacket.h"
+#include "network/TilePacket.h"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+//! \brief Returns the tile visual the client would get (like Tile::computeTileVisual)
+TileVisual levelTileVisual(const LevelTile& tile)
+{
+    // Values from TileType
+    switch(tile.mType)
+    {
+        case 1:
+            if(tile.mSeatId >= 0)
+                return tile.mIsFull ? TileVisual::claimedFull : TileVisual::claimedGround;
+            return tile.mIsFull ? TileVisual::dirtFull : TileVisual::dirtGround;
+        case 2:
+            return tile.mIsFull ? TileVisual::goldFull : TileVisual::goldGround;
+        case 3:
+            return tile.mIsFull ? TileVisual::rockFull : TileVisual::rockGround;
+        case 4:
+            return TileVisual::waterGround;
+        case 5:
+            return TileVisual::lavaGround;
+        case 6:
+            return tile.mIsFull ? TileVisual::gemFull : TileVisual::gemGround;
+        default:
+            return TileVisual::nullTileVisual;
+    }
+}
+
+//! \brief Writes the tiles like refreshVisibleTiles then refreshTiles did before they were compacted
+void exportLegacy(const Level& level, const std::vector<uint32_t>& indexes, ODPacket& visionPacket, ODPacket& refreshPacket)
+{
+    uint32_t nbTiles = static_cast<uint32_t>(indexes.size());
+    uint32_t nbTilesLost = 0;
+    visionPacket << nbTiles;
+    for(uint32_t index : indexes)
+    {
+        int32_t x = static_cast<int32_t>(index) / level.mSizeY;
+        int32_t y = static_cast<int32_t>(index) % level.mSizeY;
+        visionPacket << x << y;
+    }
+    visionPacket << nbTilesLost;
+
+    refreshPacket << nbTiles;
+    for(uint32_t index : indexes)
+    {
+        const LevelTile& tile = level.mTiles[index];
+        int32_t x = static_cast<int32_t>(index) / level.mSizeY;
+        int32_t y = static_cast<int32_t>(index) % level.mSizeY;
+        uint32_t nbEffects = 0;
+        uint32_t refundPrice = 0;
+        int32_t seatId = tile.mSeatId;
+        uint32_t tileVisual = static_cast<uint32_t>(levelTileVisual(tile));
+        refreshPacket << x << y << nbEffects;
+        refreshPacket << false << false << refundPrice << refundPrice;
+        refreshPacket << true << false << false;
+        refreshPacket << seatId << std::string() << tileVisual;
+    }
+}
+
+//! \brief Writes the tiles like Seat::sendVisibleTiles and Seat::notifyChangedVisibleTiles do now
+void exportCompact(const Level& level, const std::vector<uint32_t>& indexes, ODPacket& visionPacket, ODPacket& refreshPacket)
+{
+    std::vector<uint32_t> noIndexes;
+    TilePacket::exportTileIndexes(visionPacket, indexes);
+    TilePacket::exportTileIndexes(visionPacket, noIndexes);
+
+    TileMeshNames meshNames;
+    std::vector<TileRefreshState> statesSent(indexes.size());
+    TilePacket::exportTileIndexes(refreshPacket, indexes);
+    for(uint32_t i = 0; i < indexes.size(); ++i)
+    {
+        const LevelTile& tile = level.mTiles[indexes[i]];
+        uint32_t nbEffects = 0;
+        refreshPacket << nbEffects;
+
+        TileRefreshState state;
+        state.mSeatId = tile.mSeatId;
+        state.mTileVisual = levelTileVisual(tile);
+        state.exportToPacket(refreshPacket, statesSent[i], false, meshNames);
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_varUInt)
+{
+    ODPacket packet;
+    const std::vector<uint32_t> values = { 0, 1, 127, 128, 16383, 16384, 0xFFFFFFFF };
+    for(uint32_t value : values)
+        TilePacket::exportVarUInt(packet, value);
+
+    for(uint32_t value : values)
+    {
+        uint32_t read = 0;
+        BOOST_CHECK(TilePacket::importVarUInt(packet, read));
+        BOOST_CHECK(read == value);
+    }
+    uint32_t read = 0;
+    BOOST_CHECK(!TilePacket::importVarUInt(packet, read));
+}
+
+BOOST_AUTO_TEST_CASE(test_tileIndexes)
+{
+    ODPacket packet;
+    const std::vector<uint32_t> indexes = { 0, 1, 2, 3, 10, 12, 13, 500, 501, 502, 100000 };
+    TilePacket::exportTileIndexes(packet, indexes);
+    // Vision gained on one big area only takes a few bytes
+    std::vector<uint32_t> area;
+    for(uint32_t index = 1000; index < 3000; ++index)
+        area.push_back(index);
+    ODPacket packetArea;
+    TilePacket::exportTileIndexes(packetArea, area);
+    BOOST_CHECK(packetArea.getDataSize() <= 5);
+
+    std::vector<uint32_t> read;
+    BOOST_CHECK(TilePacket::importTileIndexes(packet, read));
+    BOOST_CHECK(read == indexes);
+    BOOST_CHECK(TilePacket::importTileIndexes(packetArea, read));
+    BOOST_CHECK(read == area);
+
+    ODPacket packetEmpty;
+    TilePacket::exportTileIndexes(packetEmpty, std::vector<uint32_t>());
+    read.push_back(4);
+    BOOST_CHECK(TilePacket::importTileIndexes(packetEmpty, read));
+    BOOST_CHECK(read.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_tileRefreshState)
+{
+    TileMeshNames meshNamesServer;
+    TileMeshNames meshNamesClient;
+    TileRefreshState stateSent;
+    TileRefreshState stateReceived;
+
+    // The first refresh contains every field
+    ODPacket packet;
+    TileRefreshState state;
+    state.mIsRoom = true;
+    state.mRefundPriceRoom = 150;
+    state.mSeatId = 2;
+    state.mMeshName = "Dormitory.mesh";
+    state.mTileVisual = TileVisual::dirtGround;
+    state.exportToPacket(packet, stateSent, false, meshNamesServer);
+    uint8_t fields = stateReceived.importFromPacket(packet, meshNamesClient);
+    BOOST_CHECK(fields == 0x3F);
+    BOOST_CHECK(stateReceived.mIsRoom);
+    BOOST_CHECK(!stateReceived.mIsTrap);
+    BOOST_CHECK(stateReceived.mDisplayTileMesh);
+    BOOST_CHECK(stateReceived.mRefundPriceRoom == 150);
+    BOOST_CHECK(stateReceived.mSeatId == 2);
+    BOOST_CHECK(stateReceived.mMeshName == "Dormitory.mesh");
+    BOOST_CHECK(stateReceived.mTileVisual == TileVisual::dirtGround);
+    BOOST_CHECK(meshNamesClient.getNbNames() == 2);
+
+    // Then, only the fields that changed are sent
+    packet.clear();
+    state.mSeatId = -1;
+    state.exportToPacket(packet, stateSent, false, meshNamesServer);
+    fields = stateReceived.importFromPacket(packet, meshNamesClient);
+    BOOST_CHECK(fields == TileRefreshField::TileRefreshSeatId);
+    BOOST_CHECK(stateReceived.mSeatId == -1);
+    BOOST_CHECK(packet.getDataSize() == 2);
+
+    // A mesh name already sent is only sent by index
+    packet.clear();
+    TileRefreshState stateSent2;
+    state.exportToPacket(packet, stateSent2, false, meshNamesServer);
+    TileRefreshState stateReceived2;
+    fields = stateReceived2.importFromPacket(packet, meshNamesClient);
+    BOOST_CHECK(fields == 0x3F);
+    BOOST_CHECK(stateReceived2.mMeshName == "Dormitory.mesh");
+    BOOST_CHECK(packet.getDataSize() == 8);
+
+    // Full refreshes send mesh names inline without adding them to the dictionary
+    packet.clear();
+    state.mMeshName = "Treasury.mesh";
+    state.exportToPacket(packet, stateSent, true, meshNamesServer);
+    fields = stateReceived.importFromPacket(packet, meshNamesClient);
+    BOOST_CHECK(fields == 0x3F);
+    BOOST_CHECK(stateReceived.mMeshName == "Treasury.mesh");
+    BOOST_CHECK(meshNamesServer.getNbNames() == 2);
+    BOOST_CHECK(meshNamesClient.getNbNames() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_tileRefreshInlineBeforeQueued)
+{
+    TileMeshNames meshNamesServer;
+    TileMeshNames meshNamesClient;
+
+    // A refresh adds a new mesh name to the dictionary but the packet is still queued
+    ODPacket packetQueued;
+    TileRefreshState state;
+    state.mMeshName = "Dormitory.mesh";
+    TileRefreshState stateSentQueued;
+    state.exportToPacket(packetQueued, stateSentQueued, false, meshNamesServer);
+
+    // Then, a full refresh with the same name is sent asynchronously and reaches the client first
+    ODPacket packetAsync;
+    TileRefreshState stateSentAsync;
+    state.exportToPacket(packetAsync, stateSentAsync, true, meshNamesServer);
+
+    TileRefreshState stateReceivedAsync;
+    BOOST_CHECK(stateReceivedAsync.importFromPacket(packetAsync, meshNamesClient) == 0x3F);
+    BOOST_CHECK(stateReceivedAsync.mMeshName == "Dormitory.mesh");
+    BOOST_CHECK(meshNamesClient.getNbNames() == 1);
+
+    // The queued packet still defines the name for the next refreshes
+    TileRefreshState stateReceivedQueued;
+    BOOST_CHECK(stateReceivedQueued.importFromPacket(packetQueued, meshNamesClient) == 0x3F);
+    BOOST_CHECK(stateReceivedQueued.mMeshName == "Dormitory.mesh");
+    BOOST_CHECK(meshNamesClient.getNbNames() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(test_packetSizeShippedLevels)
+{
+    // Compares the size of the packets sent at game start by the former encoding and by the compact one
+    // when the whole map is visible and when the ground tiles and their walls are visible. Sizes are
+    // displayed with --log_level=message
+    const std::vector<std::string> levels = {
+        "multiplayer/TestBigMap.level",
+        "skirmish/TestLegacy.level",
+        "skirmish/StoneKeep.level",
+        "multiplayer/Angel.level",
+        "skirmish/DuelToDeath.level"
+    };
+
+    for(const std::string& levelName : levels)
+    {
+        Level level;
+        bool isLoaded = loadLevelTiles(levelName, level);
+        BOOST_CHECK_MESSAGE(isLoaded, "Cannot load level " + levelName);
+        if(!isLoaded)
+            continue;
+
+        std::vector<uint32_t> allIndexes;
+        std::vector<uint32_t> groundIndexes;
+        for(int x = 0; x < level.mSizeX; ++x)
+        {
+            for(int y = 0; y < level.mSizeY; ++y)
+            {
+                uint32_t index = static_cast<uint32_t>(x * level.mSizeY + y);
+                allIndexes.push_back(index);
+                bool isVisible = false;
+                for(int dx = -1; (dx <= 1) && !isVisible; ++dx)
+                {
+                    for(int dy = -1; (dy <= 1) && !isVisible; ++dy)
+                    {
+                        int xx = x + dx;
+                        int yy = y + dy;
+                        if((xx < 0) || (xx >= level.mSizeX) || (yy < 0) || (yy >= level.mSizeY))
+                            continue;
+
+                        isVisible = !level.mTiles[static_cast<uint32_t>(xx * level.mSizeY + yy)].mIsFull;
+                    }
+                }
+                if(isVisible)
+                    groundIndexes.push_back(index);
+            }
+        }
+
+        for(const std::vector<uint32_t>* indexes : { &allIndexes, &groundIndexes })
+        {
+            ODPacket legacyVision;
+            ODPacket legacyRefresh;
+            exportLegacy(level, *indexes, legacyVision, legacyRefresh);
+            ODPacket compactVision;
+            ODPacket compactRefresh;
+            exportCompact(level, *indexes, compactVision, compactRefresh);
+
+            uint32_t legacySize = legacyVision.getDataSize() + legacyRefresh.getDataSize();
+            uint32_t compactSize = compactVision.getDataSize() + compactRefresh.getDataSize();
+            BOOST_CHECK(compactSize * 3 < legacySize);
+
+            BOOST_TEST_MESSAGE(levelName + " (" + std::to_string(level.mSizeX) + "x" + std::to_string(level.mSizeY)
+                + ", " + std::to_string(indexes->size()) + " tiles visible): former vision="
+                + std::to_string(legacyVision.getDataSize()) + " bytes, refresh="
+                + std::to_string(legacyRefresh.getDataSize()) + " bytes. Compact vision="
+                + std::to_string(compactVision.getDataSize()) + " bytes, refresh="
+                + std::to_string(compactRefresh.getDataSize()) + " bytes");
+        }
+    }
+}
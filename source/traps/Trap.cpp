@@ -248,6 +248,8 @@ void Trap::activate(Tile* tile)
     trapTileData->setActivated(true);
     trapTileData->setNbShootsBeforeDeactivation(mNbShootsBeforeDeactivation);
     trapTileData->setReloadTime(0);
+    // Some traps (like doors) only block vision when activated
+    getGameMap()->notifyTileVisionBlockingChanged(tile);
 
     BuildingObject* entity = getBuildingObjectFromTile(tile);
     if (entity == nullptr)
@@ -263,6 +265,7 @@ void Trap::deactivate(Tile* tile)
 
     TrapTileData* trapTileData = static_cast<TrapTileData*>(mTileData[tile]);
     trapTileData->setActivated(false);
+    getGameMap()->notifyTileVisionBlockingChanged(tile);
 
     BuildingObject* entity = getBuildingObjectFromTile(tile);
     if (entity == nullptr)
@@ -639,18 +642,10 @@ bool Trap::shouldSetCoveringTileDirty(Seat* seat, Tile* tile)
 void Trap::fireTrapSound(Tile& tile, const std::string& soundFamily)
 {
     std::string sound = "Traps/" + soundFamily;
-    for(Seat* seat : tile.getSeatsWithVision())
-    {
-        if(seat->getPlayer() == nullptr)
-            continue;
-        if(!seat->getPlayer()->getIsHuman())
-            continue;
-
-        ServerNotification *serverNotification = new ServerNotification(
-            ServerNotificationType::playSpatialSound, seat->getPlayer());
-        serverNotification->mPacket << sound << tile.getX() << tile.getY();
-        ODServer::getSingleton().queueServerNotification(serverNotification);
-    }
+    ServerNotification *serverNotification = new ServerNotification(
+        ServerNotificationType::playSpatialSound, tile.getSeatsWithVision());
+    serverNotification->mPacket << sound << tile.getX() << tile.getY();
+    ODServer::getSingleton().queueServerNotification(serverNotification);
 }
 
 bool Trap::importTrapFromStream(Trap& trap, std::istream& is)
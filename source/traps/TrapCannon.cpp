@@ -128,8 +128,8 @@ TrapCannon::TrapCannon(GameMap* gameMap) :
 
 bool TrapCannon::shoot(Tile* tile)
 {
-    std::vector<Tile*> visibleTiles = getGameMap()->visibleTiles(tile->getX(), tile->getY(), mRange);
-    std::vector<GameEntity*> enemyObjects = getGameMap()->getVisibleCreatures(visibleTiles, getSeat(), true);
+    getGameMap()->visibleTiles(tile->getX(), tile->getY(), mRange, mVisibleTiles);
+    std::vector<GameEntity*> enemyObjects = getGameMap()->getVisibleCreatures(mVisibleTiles, getSeat(), true);
 
     if(enemyObjects.empty())
         return false;
@@ -21,6 +21,8 @@
 #include "Trap.h"
 #include "traps/TrapType.h"
 
+#include <vector>
+
 class ODPacket;
 
 class TrapCannon : public Trap
@@ -50,6 +52,9 @@ public:
 
 private:
     uint32_t mRange;
+
+    //! \brief Buffer for the tiles visible from the shooting tile. It is kept to avoid allocating memory at each shot
+    std::vector<Tile*> mVisibleTiles;
 };
 
 #endif // TRAPCANNON_H
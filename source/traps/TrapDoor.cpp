@@ -27,6 +27,7 @@
 #include "game/Player.h"
 #include "game/Seat.h"
 #include "gamemap/GameMap.h"
+#include "gamemap/Pathfinding.h"
 #include "modes/InputCommand.h"
 #include "modes/InputManager.h"
 #include "network/ODClient.h"
@@ -432,15 +433,11 @@ double TrapDoor::getCreatureSpeed(const Creature* creature, Tile* tile) const
     // Enemy units can go through doors. We need that otherwise, they won't be able to
     // get to the door. But in any case, if they are not fighting, we let them go. If
     // they are fighting, we don't
-    if(getSeat()->isAlliedSeat(creature->getSeat()))
+    bool isFightingOrFleeing = creature->isActionInList(CreatureActionType::fight) ||
+        creature->isActionInList(CreatureActionType::flee);
+    if(!Pathfinding::isClosedDoorPassable(getSeat()->isAlliedSeat(creature->getSeat()), isFightingOrFleeing))
         return 0.0;
 
-    if(creature->isActionInList(CreatureActionType::fight) ||
-       creature->isActionInList(CreatureActionType::flee))
-    {
-        return 0.0;
-    }
-
     return tile->getCreatureSpeedDefault(creature);
 }
 
@@ -168,18 +168,15 @@ bool TrapFactory::buildTrapDefault(GameMap* gameMap, Trap* trap, Seat* seat, con
             }
         }
 
-        for(const std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
+        for(std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
         {
-            uint32_t nbTiles = p.second.size();
             ServerNotification serverNotification(
                 ServerNotificationType::refreshTiles, p.first->getPlayer());
-            serverNotification.mPacket << nbTiles;
-            for(Tile* tile : p.second)
+            gameMap->tilesToPacket(serverNotification.mPacket, p.second, [&p, &serverNotification](Tile* tile)
             {
-                gameMap->tileToPacket(serverNotification.mPacket, tile);
                 p.first->updateTileStateForSeat(tile);
-                tile->exportToPacketForUpdate(serverNotification.mPacket, p.first);
-            }
+                tile->exportToPacketForAsyncUpdate(serverNotification.mPacket, p.first);
+            });
             ODServer::getSingleton().sendAsyncMsg(serverNotification);
         }
     }
@@ -601,18 +598,15 @@ void TrapManager::sellTrapTiles(GameMap* gameMap, Seat* seatSell, ODPacket& pack
         }
     }
 
-    for(const std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
+    for(std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
     {
-        uint32_t nbTiles = p.second.size();
         ServerNotification serverNotification(
             ServerNotificationType::refreshTiles, p.first->getPlayer());
-        serverNotification.mPacket << nbTiles;
-        for(Tile* tile : p.second)
+        gameMap->tilesToPacket(serverNotification.mPacket, p.second, [&p, &serverNotification](Tile* tile)
         {
-            gameMap->tileToPacket(serverNotification.mPacket, tile);
             p.first->updateTileStateForSeat(tile);
-            tile->exportToPacketForUpdate(serverNotification.mPacket, p.first);
-        }
+            tile->exportToPacketForAsyncUpdate(serverNotification.mPacket, p.first);
+        });
         ODServer::getSingleton().sendAsyncMsg(serverNotification);
     }
 
@@ -715,18 +709,15 @@ void TrapManager::sellTrapTilesEditor(GameMap* gameMap, ODPacket& packet)
         }
     }
 
-    for(const std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
+    for(std::pair<Seat* const,std::vector<Tile*>>& p : tilesPerSeat)
     {
-        uint32_t nbTiles = p.second.size();
         ServerNotification serverNotification(
             ServerNotificationType::refreshTiles, p.first->getPlayer());
-        serverNotification.mPacket << nbTiles;
-        for(Tile* tile : p.second)
+        gameMap->tilesToPacket(serverNotification.mPacket, p.second, [&p, &serverNotification](Tile* tile)
         {
-            gameMap->tileToPacket(serverNotification.mPacket, tile);
             p.first->updateTileStateForSeat(tile);
-            tile->exportToPacketForUpdate(serverNotification.mPacket, p.first);
-        }
+            tile->exportToPacketForAsyncUpdate(serverNotification.mPacket, p.first);
+        });
         ODServer::getSingleton().sendAsyncMsg(serverNotification);
     }
 
@@ -44,6 +44,9 @@ ConfigManager::ConfigManager(const std::string& configPath, const std::string& u
         const std::string& soundPath) :
     mNetworkPort(0),
     mClientConnectionTimeout(5000),
+    mNetworkCompression(false),
+    mMaxTurnsLag(0),
+    mMaxTurnsLagDisconnect(0),
     mBaseSpawnPoint(10),
     mCreatureDeathCounter(10),
     mMaxCreaturesPerSeatAbsolute(30),
@@ -64,7 +67,9 @@ ConfigManager::ConfigManager(const std::string& configPath, const std::string& u
     mNbTurnsKoCreatureAttacked(10),
     mCreatureDefinitionDefaultWorker(nullptr),
     mNbWorkersDigSameTile(2),
-    mNbWorkersClaimSameTile(1)
+    mNbWorkersClaimSameTile(1),
+    mPathClusterSize(0),
+    mPerceptionThreads(0)
 {
     // TODO: it might be better to go through the creature definitions and try to pickup the first worker we can find
     mCreatureDefinitionDefaultWorker = new CreatureDefinition(DefaultWorkerCreatureDefinition,
@@ -450,6 +455,27 @@ bool ConfigManager::loadGlobalGameConfig(std::stringstream& configFile)
             // Not mandatory
         }
 
+        if(nextParam == "NetworkCompression")
+        {
+            configFile >> nextParam;
+            mNetworkCompression = Helper::toInt(nextParam) != 0;
+            // Not mandatory
+        }
+
+        if(nextParam == "MaxTurnsLag")
+        {
+            configFile >> nextParam;
+            mMaxTurnsLag = Helper::toUInt32(nextParam);
+            // Not mandatory
+        }
+
+        if(nextParam == "MaxTurnsLagDisconnect")
+        {
+            configFile >> nextParam;
+            mMaxTurnsLagDisconnect = Helper::toUInt32(nextParam);
+            // Not mandatory
+        }
+
         if(nextParam == "CreatureDeathCounter")
         {
             configFile >> nextParam;
@@ -583,6 +609,20 @@ bool ConfigManager::loadGlobalGameConfig(std::stringstream& configFile)
             // Not mandatory
         }
 
+        if(nextParam == "PathClusterSize")
+        {
+            configFile >> nextParam;
+            mPathClusterSize = Helper::toUInt32(nextParam);
+            // Not mandatory
+        }
+
+        if(nextParam == "PerceptionThreads")
+        {
+            configFile >> nextParam;
+            mPerceptionThreads = Helper::toInt(nextParam);
+            // Not mandatory
+        }
+
         if(nextParam == "MainMenuMusic")
         {
             std::string line;
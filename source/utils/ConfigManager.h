@@ -127,6 +127,19 @@ public:
     inline uint32_t getClientConnectionTimeout() const
     { return mClientConnectionTimeout; }
 
+    //! \brief true if the server compresses the data sent to the clients supporting it
+    inline bool getNetworkCompression() const
+    { return mNetworkCompression; }
+
+    //! \brief Number of turns the server can be ahead of the slowest client. If 0, the server
+    //! waits for every client to acknowledge a turn before starting the next one
+    inline uint32_t getMaxTurnsLag() const
+    { return mMaxTurnsLag; }
+
+    //! \brief Clients later than that (in turns) are disconnected. If 0, they are never disconnected
+    inline uint32_t getMaxTurnsLagDisconnect() const
+    { return mMaxTurnsLagDisconnect; }
+
     inline uint32_t getBaseSpawnPoint() const
     { return mBaseSpawnPoint; }
 
@@ -197,6 +210,12 @@ public:
     inline uint32_t getNbWorkersClaimSameTile() const
     { return mNbWorkersClaimSameTile; }
 
+    inline uint32_t getPathClusterSize() const
+    { return mPathClusterSize; }
+
+    inline int32_t getPerceptionThreads() const
+    { return mPerceptionThreads; }
+
     //! Returns the tileset for the given name. If the tileset is not found, returns the default tileset
     const TileSet* getTileSet(const std::string& tileSetName) const;
 
@@ -282,6 +301,9 @@ private:
     std::string mFilenameUserCfg;
     uint32_t mNetworkPort;
     uint32_t mClientConnectionTimeout;
+    bool mNetworkCompression;
+    uint32_t mMaxTurnsLag;
+    uint32_t mMaxTurnsLagDisconnect;
     uint32_t mBaseSpawnPoint;
     uint32_t mCreatureDeathCounter;
     uint32_t mMaxCreaturesPerSeatAbsolute;
@@ -322,6 +344,14 @@ private:
     uint32_t mNbWorkersDigSameTile;
     uint32_t mNbWorkersClaimSameTile;
 
+    //! \brief Size of the clusters used to search long paths. 0 means that long paths are searched
+    //! tile by tile like the short ones
+    uint32_t mPathClusterSize;
+
+    //! \brief Number of threads added to the server one to compute what the creatures see at each turn.
+    //! 0 means that each creature computes it during its upkeep, as before. A negative value means one per core
+    int32_t mPerceptionThreads;
+
     //! \brief Allowed tilesets
     std::map<std::string, const TileSet*> mTileSets;
 
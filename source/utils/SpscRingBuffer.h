@@ -0,0 +1,104 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/*! \brief Bounded lock-free queue with one producer thread and one consumer thread. The slots are
+ * allocated once and no lock is taken when pushing or popping.
+ * push must only be called by the producer and front/pop by the consumer.
+ */
+template<typename T>
+class SpscRingBuffer
+{
+public:
+    //! \brief Creates a buffer able to store capacity elements
+    explicit SpscRingBuffer(uint32_t capacity) :
+        mSlots(capacity + 1),
+        mHead(0),
+        mTail(0)
+    {}
+
+    //! \brief Adds a copy of value at the end of the queue. Returns false if the queue is full
+    bool push(const T& value)
+    {
+        uint32_t tail = mTail.load(std::memory_order_relaxed);
+        uint32_t next = nextIndex(tail);
+        if(next == mHead.load(std::memory_order_acquire))
+            return false;
+
+        mSlots[tail] = value;
+        mTail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    //! \brief Returns the first element of the queue or nullptr if it is empty. The element stays
+    //! valid until pop is called
+    T* front()
+    {
+        uint32_t head = mHead.load(std::memory_order_relaxed);
+        if(head == mTail.load(std::memory_order_acquire))
+            return nullptr;
+
+        return &mSlots[head];
+    }
+
+    //! \brief Removes the first element of the queue. It must not be empty
+    void pop()
+    {
+        uint32_t head = mHead.load(std::memory_order_relaxed);
+        mHead.store(nextIndex(head), std::memory_order_release);
+    }
+
+    //! \brief Returns the number of elements in the queue. As the other thread may push or pop at the
+    //! same time, it is only an estimation
+    uint32_t size() const
+    {
+        uint32_t head = mHead.load(std::memory_order_acquire);
+        uint32_t tail = mTail.load(std::memory_order_acquire);
+        if(tail >= head)
+            return tail - head;
+
+        return static_cast<uint32_t>(mSlots.size()) - head + tail;
+    }
+
+    inline uint32_t getCapacity() const
+    { return static_cast<uint32_t>(mSlots.size()) - 1; }
+
+private:
+    inline uint32_t nextIndex(uint32_t index) const
+    {
+        ++index;
+        if(index >= mSlots.size())
+            return 0;
+
+        return index;
+    }
+
+    //! \brief One slot is always kept empty to tell a full queue from an empty one
+    std::vector<T> mSlots;
+    //! \brief Index of the first element. Only written by the consumer
+    std::atomic<uint32_t> mHead;
+    //! \brief Index where the next element will be pushed. Only written by the producer
+    std::atomic<uint32_t> mTail;
+};
+
+#endif // SPSCRINGBUFFER_H
@@ -0,0 +1,133 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "utils/ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(uint32_t nbWorkers) :
+    mJobGeneration(0),
+    mNbBusyWorkers(0),
+    mIsStopping(false),
+    mTask(nullptr),
+    mNbTasks(0),
+    mBatchSize(1),
+    mNextTask(0)
+{
+    for(uint32_t i = 0; i < nbWorkers; ++i)
+        mWorkers.push_back(std::thread(&ThreadPool::workerLoop, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mJobAvailable.notify_all();
+
+    for(std::thread& worker : mWorkers)
+        worker.join();
+}
+
+uint32_t ThreadPool::getDefaultNbWorkers()
+{
+    // hardware_concurrency may return 0 if the number of cores is unknown
+    uint32_t nbCores = std::thread::hardware_concurrency();
+    if(nbCores <= 1)
+        return 0;
+
+    return nbCores - 1;
+}
+
+void ThreadPool::parallelFor(uint32_t nbTasks, uint32_t batchSize, const std::function<void(uint32_t)>& task)
+{
+    if(nbTasks == 0)
+        return;
+
+    batchSize = std::max(1u, batchSize);
+    // If there is only one batch, there is no need to wake up the workers
+    if(mWorkers.empty() || (nbTasks <= batchSize))
+    {
+        for(uint32_t index = 0; index < nbTasks; ++index)
+            task(index);
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mNbTasks = nbTasks;
+        mBatchSize = batchSize;
+        mNextTask.store(0, std::memory_order_relaxed);
+        mNbBusyWorkers = static_cast<uint32_t>(mWorkers.size());
+        ++mJobGeneration;
+    }
+    mJobAvailable.notify_all();
+
+    runBatches();
+
+    // We wait for every worker to be done so that the task is not used after we return
+    std::unique_lock<std::mutex> lock(mMutex);
+    mJobDone.wait(lock, [this]() { return mNbBusyWorkers == 0; });
+    mTask = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+    uint64_t lastGeneration = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobAvailable.wait(lock, [this, lastGeneration]()
+                { return mIsStopping || (mJobGeneration != lastGeneration); });
+
+            if(mIsStopping)
+                return;
+
+            lastGeneration = mJobGeneration;
+        }
+
+        runBatches();
+
+        bool isLast;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mNbBusyWorkers;
+            isLast = (mNbBusyWorkers == 0);
+        }
+        if(isLast)
+            mJobDone.notify_one();
+    }
+}
+
+void ThreadPool::runBatches()
+{
+    const std::function<void(uint32_t)>& task = *mTask;
+    while(true)
+    {
+        uint32_t first = mNextTask.fetch_add(mBatchSize, std::memory_order_relaxed);
+        if(first >= mNbTasks)
+            return;
+
+        uint32_t last = std::min(mNbTasks, first + mBatchSize);
+        for(uint32_t index = first; index < last; ++index)
+            task(index);
+    }
+}
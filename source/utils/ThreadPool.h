@@ -0,0 +1,85 @@
+/*!
+ *  Copyright (C) 2011-2016  OpenDungeons Team
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*! \brief Pool of worker threads used to run independent tasks in parallel. The threads are created once
+ * and wait for work between two calls to parallelFor.
+ * Tasks are grouped in batches taken in order from a shared counter: a thread that is done with its batch
+ * takes the next one so that the work is balanced even if some tasks are much longer than others.
+ * parallelFor must only be called from one thread at a time (the one owning the pool).
+ */
+class ThreadPool
+{
+public:
+    //! \brief Creates a pool with the given number of worker threads. As the calling thread also runs tasks,
+    //! 0 is allowed (everything is then done by the calling thread)
+    explicit ThreadPool(uint32_t nbWorkers);
+
+    //! \brief Stops and joins the worker threads
+    ~ThreadPool();
+
+    //! \brief Calls task(index) for every index in [0, nbTasks) and returns once they are all done. The calling
+    //! thread runs tasks too. Tasks are taken by batches of batchSize indexes. The order in which the tasks are run
+    //! is not specified so they should not depend on each other
+    void parallelFor(uint32_t nbTasks, uint32_t batchSize, const std::function<void(uint32_t)>& task);
+
+    inline uint32_t getNbWorkers() const
+    { return static_cast<uint32_t>(mWorkers.size()); }
+
+    //! \brief Number of worker threads to use so that every core is used (the calling thread excluded)
+    static uint32_t getDefaultNbWorkers();
+
+private:
+    //! \brief Main loop of the worker threads
+    void workerLoop();
+
+    //! \brief Runs the batches of the current job until there is none left
+    void runBatches();
+
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mMutex;
+    //! \brief Notified when a job is available or when the pool is destroyed
+    std::condition_variable mJobAvailable;
+    //! \brief Notified when a worker is done with the current job
+    std::condition_variable mJobDone;
+
+    //! \brief Incremented for every job so that the workers know when a new one is available
+    uint64_t mJobGeneration;
+    //! \brief Number of workers still working on the current job
+    uint32_t mNbBusyWorkers;
+    bool mIsStopping;
+
+    //! \brief Current job. Only modified by parallelFor while no worker is busy
+    const std::function<void(uint32_t)>* mTask;
+    uint32_t mNbTasks;
+    uint32_t mBatchSize;
+    //! \brief Index of the next task to run
+    std::atomic<uint32_t> mNextTask;
+};
+
+#endif // THREADPOOL_H